@@ -5,20 +5,35 @@ set(DISPLAY_BACKEND_SRC "")
 if(${BACKEND_TYPE} STREQUAL "DRM-GBM")
   add_definitions(-DDISPLAY_BACKEND_TYPE_DRM_GBM)
   set(DISPLAY_BACKEND_SRC
-    src/flutter/shell/platform/linux_embedded/window/native_window_drm_gbm.cc)
+    src/flutter/shell/platform/linux_embedded/window/native_window_drm_gbm.cc
+    src/flutter/shell/platform/linux_embedded/window/drm_plane_assigner.cc
+    src/flutter/shell/platform/linux_embedded/surface/compositor_drm_gbm.cc
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_drm.cc)
 elseif(${BACKEND_TYPE} STREQUAL "DRM-EGLSTREAM")
   ## Define "EGL_NO_X11" to avoid including x11-related files.
   add_definitions(-DDISPLAY_BACKEND_TYPE_DRM_EGLSTREAM -DEGL_NO_X11)
   set(DISPLAY_BACKEND_SRC
     src/flutter/shell/platform/linux_embedded/surface/context_egl_drm_eglstream.cc
     src/flutter/shell/platform/linux_embedded/surface/environment_egl_drm_eglstream.cc
-    src/flutter/shell/platform/linux_embedded/window/native_window_drm_eglstream.cc)
+    src/flutter/shell/platform/linux_embedded/window/native_window_drm_eglstream.cc
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_drm.cc)
 elseif(${BACKEND_TYPE} STREQUAL "X11")
   add_definitions(-DDISPLAY_BACKEND_TYPE_X11)
   set(DISPLAY_BACKEND_SRC
     src/flutter/shell/platform/linux_embedded/window/linuxes_window_x11.cc
     src/flutter/shell/platform/linux_embedded/window/native_window_x11.cc
-    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_x11.cc)
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_x11.cc
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_x11.cc)
+elseif(${BACKEND_TYPE} STREQUAL "HEADLESS")
+  ## Define "EGL_NO_X11" to avoid including x11-related files.
+  add_definitions(-DDISPLAY_BACKEND_TYPE_HEADLESS -DEGL_NO_X11)
+  set(DISPLAY_BACKEND_SRC
+    src/flutter/shell/platform/linux_embedded/window/linuxes_window_headless.cc
+    src/flutter/shell/platform/linux_embedded/window/native_window_headless.cc
+    src/flutter/shell/platform/linux_embedded/surface/context_egl_headless.cc
+    src/flutter/shell/platform/linux_embedded/surface/environment_egl_headless.cc
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_headless.cc
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_headless.cc)
 else()
   find_program(WaylandScannerExec NAMES wayland-scanner)
   get_filename_component(_infile /usr/share/wayland-protocols/stable/xdg-shell/xdg-shell.xml ABSOLUTE)
@@ -43,7 +58,8 @@ else()
     ${_code}
     src/flutter/shell/platform/linux_embedded/window/linuxes_window_wayland.cc
     src/flutter/shell/platform/linux_embedded/window/native_window_wayland.cc
-    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_wayland.cc)
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_wayland.cc
+    src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_wayland.cc)
 endif()
 
 # desktop-shell for weston.
@@ -67,6 +83,11 @@ if(USE_GLES3)
   add_definitions(-DUSE_GLES3)
 endif()
 
+# Tracing of the embedder.
+if(ENABLE_TRACE)
+  add_definitions(-DENABLE_LINUXES_TRACE)
+endif()
+
 # Flutter embedder runtime mode.
 if(NOT CMAKE_BUILD_TYPE MATCHES Debug)
   add_definitions(
@@ -77,26 +98,40 @@ endif()
 # cmake script for developers.
 include(${USER_PROJECT_PATH}/cmake/user_build.cmake)
 
-add_executable(${TARGET}
-  ${USER_APP_SRCS}
+# Sources of the embedder, which are shared by the app and the tests.
+set(FLUTTER_LINUXES_SRCS
   src/client_wrapper/flutter_engine.cc
   src/client_wrapper/flutter_view_controller.cc
   src/flutter/shell/platform/linux_embedded/flutter_linuxes.cc
   src/flutter/shell/platform/linux_embedded/flutter_linuxes_engine.cc
   src/flutter/shell/platform/linux_embedded/flutter_linuxes_view.cc
+  src/flutter/shell/platform/linux_embedded/touch_tracker.cc
+  src/flutter/shell/platform/linux_embedded/pointer_resampler.cc
+  src/flutter/shell/platform/linux_embedded/event_loop.cc
+  src/flutter/shell/platform/linux_embedded/vsync_waiter.cc
+  src/flutter/shell/platform/linux_embedded/stats_dumper.cc
+  src/flutter/shell/platform/linux_embedded/frame_timeline.cc
+  src/flutter/shell/platform/linux_embedded/input_latency_tracker.cc
+  src/flutter/shell/platform/linux_embedded/trace_event.cc
   src/flutter/shell/platform/linux_embedded/flutter_project_bundle.cc
   src/flutter/shell/platform/linux_embedded/task_runner.cc
+  src/flutter/shell/platform/linux_embedded/worker_pool.cc
+  src/flutter/shell/platform/linux_embedded/channel_task_queues.cc
   src/flutter/shell/platform/linux_embedded/system_utils.cc
   src/flutter/shell/platform/linux_embedded/logger.cc
+  src/flutter/shell/platform/linux_embedded/external_texture_dmabuf.cc
   src/flutter/shell/platform/linux_embedded/external_texture_gl.cc
+  src/flutter/shell/platform/linux_embedded/pixel_format_converter_gl.cc
   src/flutter/shell/platform/linux_embedded/flutter_linuxes_texture_registrar.cc
   src/flutter/shell/platform/linux_embedded/plugin/key_event_plugin.cc
   src/flutter/shell/platform/linux_embedded/plugin/key_event_plugin_glfw_util.cc
   src/flutter/shell/platform/linux_embedded/plugin/text_input_plugin.cc
   src/flutter/shell/platform/linux_embedded/plugin/platform_plugin.cc
   src/flutter/shell/platform/linux_embedded/plugin/mouse_cursor_plugin.cc
+  src/flutter/shell/platform/linux_embedded/plugin/json_message_writer.cc
   src/flutter/shell/platform/linux_embedded/surface/context_egl.cc
   src/flutter/shell/platform/linux_embedded/surface/egl_utils.cc
+  src/flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.cc
   ${DISPLAY_BACKEND_SRC}
   ${WAYLAND_PROTOCOL_SRC}
   ## The following file were copied from:
@@ -114,9 +149,13 @@ add_executable(${TARGET}
   src/flutter/shell/platform/common/incoming_message_dispatcher.cc
 )
 
+add_executable(${TARGET}
+  ${USER_APP_SRCS}
+  ${FLUTTER_LINUXES_SRCS}
+)
+
 set(THIRD_PARTY_INCLUDE_DIR ${CMAKE_CURRENT_SOURCE_DIR}/src/third_party)
-target_include_directories(${TARGET}
-  PRIVATE
+set(FLUTTER_LINUXES_INCLUDE_DIRS
     src
     ## third-party libraries.
     ${XKBCOMMON_INCLUDE_DIRS}
@@ -132,15 +171,19 @@ target_include_directories(${TARGET}
     ${LIBUDEV_INCLUDE_DIRS}
     ${LIBSYSTEMD_INCLUDE_DIRS}
     ${X11_INCLUDE_DIRS}
+    ${XEXT_INCLUDE_DIRS}
     ${LIBWESTON_INCLUDE_DIRS}
     ## User libraries
     ${USER_APP_INCLUDE_DIRS}
 )
+target_include_directories(${TARGET}
+  PRIVATE
+    ${FLUTTER_LINUXES_INCLUDE_DIRS}
+)
 
 set(CMAKE_SKIP_RPATH true)
 set(FLUTTER_EMBEDDER_LIB ${CMAKE_CURRENT_SOURCE_DIR}/build/libflutter_engine.so)
-target_link_libraries(${TARGET}
-  PRIVATE
+set(FLUTTER_LINUXES_LIBRARIES
     ${XKBCOMMON_LIBRARIES}
     ${WAYLAND_CLIENT_LIBRARIES}
     ${WAYLAND_CURSOR_LIBRARIES}
@@ -152,11 +195,16 @@ target_link_libraries(${TARGET}
     ${LIBUDEV_LIBRARIES}
     ${LIBSYSTEMD_LIBRARIES}
     ${X11_LIBRARIES}
+    ${XEXT_LIBRARIES}
     ${LIBWESTON_LIBRARIES}
-    ${FLUTTER_EMBEDDER_LIB}
     ## User libraries
     ${USER_APP_LIBRARIES}
 )
+target_link_libraries(${TARGET}
+  PRIVATE
+    ${FLUTTER_LINUXES_LIBRARIES}
+    ${FLUTTER_EMBEDDER_LIB}
+)
 
 if(${BACKEND_TYPE} MATCHES "DRM-(GBM|EGLSTREAM)")
 target_link_libraries(${TARGET}
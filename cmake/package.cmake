@@ -22,6 +22,10 @@ if(${BACKEND_TYPE} MATCHES "DRM-(GBM|EGLSTREAM)")
   find_package(Threads REQUIRED)
 elseif(${BACKEND_TYPE} STREQUAL "X11")
   pkg_check_modules(X11 REQUIRED x11)
+  # MIT-SHM for the software renderer.
+  pkg_check_modules(XEXT REQUIRED xext)
+elseif(${BACKEND_TYPE} STREQUAL "HEADLESS")
+  # Headless backend needs only EGL and OpenGL ES.
 else()
   # Wayland backend
   pkg_check_modules(WAYLAND_PROTOCOLS REQUIRED wayland-protocols)
@@ -0,0 +1,95 @@
+cmake_minimum_required(VERSION 3.10)
+
+# The tests are linked with a fake of the Flutter engine library instead of
+# libflutter_engine.so, so that they run without the engine.
+find_package(GTest REQUIRED)
+find_package(benchmark REQUIRED)
+find_package(Threads REQUIRED)
+enable_testing()
+
+set(TEST_SUPPORT_SRCS
+  src/flutter/shell/platform/linux_embedded/testing/allocation_counter.cc
+  src/flutter/shell/platform/linux_embedded/testing/fake_embedder_api.cc
+  src/flutter/shell/platform/linux_embedded/testing/test_egl_context.cc
+  src/flutter/shell/platform/linux_embedded/testing/test_engine.cc
+)
+
+# Unit tests, which are run by ctest.
+set(UNITTEST_SRCS
+  src/flutter/shell/platform/common/client_wrapper/standard_codec_unittests.cc
+  src/flutter/shell/platform/common/incoming_message_dispatcher_unittests.cc
+  src/flutter/shell/platform/linux_embedded/channel_task_queues_unittests.cc
+  src/flutter/shell/platform/linux_embedded/external_texture_dmabuf_unittests.cc
+  src/flutter/shell/platform/linux_embedded/external_texture_gl_unittests.cc
+  src/flutter/shell/platform/linux_embedded/flutter_linuxes_view_unittests.cc
+  src/flutter/shell/platform/linux_embedded/input_latency_tracker_unittests.cc
+  src/flutter/shell/platform/linux_embedded/plugin/json_message_writer_unittests.cc
+  src/flutter/shell/platform/linux_embedded/pointer_resampler_unittests.cc
+  src/flutter/shell/platform/linux_embedded/spsc_ring_buffer_unittests.cc
+  src/flutter/shell/platform/linux_embedded/stats_dumper_unittests.cc
+  src/flutter/shell/platform/linux_embedded/surface/backing_store_pool_unittests.cc
+  src/flutter/shell/platform/linux_embedded/task_queue_unittests.cc
+  src/flutter/shell/platform/linux_embedded/touch_tracker_unittests.cc
+  src/flutter/shell/platform/linux_embedded/vsync_waiter_unittests.cc
+  src/flutter/shell/platform/linux_embedded/window/drm_plane_assigner_unittests.cc
+)
+# The plane assignment doesn't depend on libdrm, so it is tested with every
+# backend.
+if(NOT ${BACKEND_TYPE} STREQUAL "DRM-GBM")
+  list(APPEND UNITTEST_SRCS
+    src/flutter/shell/platform/linux_embedded/window/drm_plane_assigner.cc
+  )
+endif()
+
+# Benchmarks, which are run by hand since they take a while.
+set(BENCHMARK_SRCS
+  src/flutter/shell/platform/common/client_wrapper/standard_codec_benchmarks.cc
+  src/flutter/shell/platform/common/incoming_message_dispatcher_benchmarks.cc
+  src/flutter/shell/platform/linux_embedded/channel_task_queues_benchmarks.cc
+  src/flutter/shell/platform/linux_embedded/external_texture_gl_benchmarks.cc
+  src/flutter/shell/platform/linux_embedded/flutter_linuxes_view_benchmarks.cc
+  src/flutter/shell/platform/linux_embedded/plugin/json_message_writer_benchmarks.cc
+  src/flutter/shell/platform/linux_embedded/task_queue_benchmarks.cc
+  src/flutter/shell/platform/linux_embedded/task_runner_benchmarks.cc
+)
+
+add_executable(flutter_linuxes_unittests
+  ${UNITTEST_SRCS}
+  ${TEST_SUPPORT_SRCS}
+  ${FLUTTER_LINUXES_SRCS}
+)
+add_executable(flutter_linuxes_benchmarks
+  ${BENCHMARK_SRCS}
+  ${TEST_SUPPORT_SRCS}
+  ${FLUTTER_LINUXES_SRCS}
+)
+
+foreach(TEST_TARGET flutter_linuxes_unittests flutter_linuxes_benchmarks)
+  target_include_directories(${TEST_TARGET}
+    PRIVATE
+      ${FLUTTER_LINUXES_INCLUDE_DIRS}
+  )
+  target_link_libraries(${TEST_TARGET}
+    PRIVATE
+      ${FLUTTER_LINUXES_LIBRARIES}
+      ${GLES_LIBRARIES}
+      Threads::Threads
+  )
+  target_compile_options(${TEST_TARGET}
+    PUBLIC
+      ${EGL_CFLAGS}
+  )
+endforeach()
+
+target_link_libraries(flutter_linuxes_unittests
+  PRIVATE
+    GTest::GTest
+    GTest::Main
+)
+target_link_libraries(flutter_linuxes_benchmarks
+  PRIVATE
+    benchmark::benchmark
+    benchmark::benchmark_main
+)
+
+add_test(NAME flutter_linuxes_unittests COMMAND flutter_linuxes_unittests)
@@ -0,0 +1,8 @@
+cmake_minimum_required(VERSION 3.10)
+
+# Flutter embedder configurations.
+# See: https://github.com/sony/flutter-embedded-linux/doc/README.md#user-configuration-parameters-cmake-options
+set(BACKEND_TYPE HEADLESS)
+set(DESKTOP_SHELL OFF)
+set(USE_VIRTUAL_KEYBOARD OFF)
+set(USE_GLES3 OFF)
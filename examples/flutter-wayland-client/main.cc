@@ -41,10 +41,9 @@ int main(int argc, char** argv) {
     return 0;
   }
 
-  // Main loop.
-  while (flutter_controller->view()->DispatchEvent()) {
-    flutter_controller->engine()->ProcessMessages();
-  }
+  // Main loop. Sleeps until either a window event arrives or the next
+  // Flutter task is due.
+  flutter_controller->RunLoop();
 
   return 0;
 }
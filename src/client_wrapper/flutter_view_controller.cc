@@ -38,4 +38,10 @@ FlutterViewController::~FlutterViewController() {
   }
 }
 
+void FlutterViewController::RunLoop() {
+  if (controller_) {
+    FlutterDesktopRunLoop(controller_);
+  }
+}
+
 }  // namespace flutter
@@ -24,6 +24,10 @@ class FlutterView {
   // you have to call this every time in the main loop.
   bool DispatchEvent() { return FlutterDesktopViewDispatchEvent(view_); }
 
+  // Returns a pollable file descriptor that becomes readable when there are
+  // window events to be dispatched by DispatchEvent().
+  int GetEventFd() { return FlutterDesktopViewGetEventFd(view_); }
+
  private:
   // Handle for interacting with the C API's view.
   FlutterDesktopViewRef view_ = nullptr;
@@ -50,6 +50,10 @@ class FlutterViewController {
   // Returns the view managed by this controller.
   FlutterView* view() { return view_.get(); }
 
+  // Runs the event loop until the view is closed. The calling thread sleeps
+  // until either a window event arrives or the next Flutter task is due.
+  void RunLoop();
+
  private:
   // Handle for interacting with the C API's view controller, if any.
   FlutterDesktopViewControllerRef controller_ = nullptr;
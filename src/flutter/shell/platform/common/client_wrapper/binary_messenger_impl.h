@@ -36,12 +36,17 @@ class BinaryMessengerImpl : public BinaryMessenger {
   void SetMessageHandler(const std::string& channel,
                          BinaryMessageHandler handler) override;
 
+  // |flutter::BinaryMessenger|
+  void SetBackgroundMessageHandler(const std::string& channel,
+                                   BinaryMessageHandler handler) override;
+
  private:
   // Handle for interacting with the C API.
   FlutterDesktopMessengerRef messenger_;
 
   // A map from channel names to the BinaryMessageHandler that should be called
-  // for incoming messages on that channel.
+  // on the platform thread for incoming messages on that channel. The handlers
+  // which run on worker threads are owned by the C API instead.
   std::map<std::string, BinaryMessageHandler> handlers_;
 };
 
@@ -58,6 +58,12 @@ void ForwardToHandler(FlutterDesktopMessengerRef messenger,
   message_handler(message->message, message->message_size,
                   std::move(reply_handler));
 }
+
+// Deletes |user_data|, which must be a BinaryMessageHandler registered to run
+// on a worker thread.
+void ReleaseHandler(void* user_data) {
+  delete static_cast<BinaryMessageHandler*>(user_data);
+}
 }  // namespace
 
 BinaryMessengerImpl::BinaryMessengerImpl(
@@ -111,6 +117,21 @@ void BinaryMessengerImpl::SetMessageHandler(const std::string& channel,
                                      ForwardToHandler, message_handler);
 }
 
+void BinaryMessengerImpl::SetBackgroundMessageHandler(
+    const std::string& channel,
+    BinaryMessageHandler handler) {
+  if (!handler) {
+    SetMessageHandler(channel, nullptr);
+    return;
+  }
+  // The C API owns the handler from now on, and releases it on a worker
+  // thread once the messages queued for it have been handled.
+  FlutterDesktopMessengerSetBackgroundCallback(
+      messenger_, channel.c_str(), ForwardToHandler,
+      new BinaryMessageHandler(std::move(handler)), ReleaseHandler);
+  handlers_.erase(channel);
+}
+
 // ========== engine_method_result.h ==========
 
 namespace internal {
@@ -174,6 +195,39 @@ int64_t TextureRegistrarImpl::RegisterTexture(TextureVariant* texture) {
     return texture_id;
   }
 
+  if (auto descriptor_texture =
+          std::get_if<PixelBufferDescriptorTexture>(texture)) {
+    FlutterDesktopTextureInfo info = {};
+    info.type = kFlutterDesktopPixelBufferDescriptorTexture;
+    info.pixel_buffer_descriptor_config.user_data = descriptor_texture;
+    info.pixel_buffer_descriptor_config.callback =
+        [](size_t width, size_t height,
+           void* user_data) -> const FlutterDesktopPixelBufferDescriptor* {
+      auto texture = static_cast<PixelBufferDescriptorTexture*>(user_data);
+      return texture->CopyPixelBuffer(width, height);
+    };
+
+    int64_t texture_id = FlutterDesktopTextureRegistrarRegisterExternalTexture(
+        texture_registrar_ref_, &info);
+    return texture_id;
+  }
+
+  if (auto dma_buf_texture = std::get_if<DmaBufTexture>(texture)) {
+    FlutterDesktopTextureInfo info = {};
+    info.type = kFlutterDesktopDmaBufTexture;
+    info.dma_buf_config.user_data = dma_buf_texture;
+    info.dma_buf_config.callback =
+        [](size_t width, size_t height,
+           void* user_data) -> const FlutterDesktopDmaBuffer* {
+      auto texture = static_cast<DmaBufTexture*>(user_data);
+      return texture->ObtainBuffer(width, height);
+    };
+
+    int64_t texture_id = FlutterDesktopTextureRegistrarRegisterExternalTexture(
+        texture_registrar_ref_, &info);
+    return texture_id;
+  }
+
   std::cerr << "Attempting to register unknown texture variant." << std::endl;
   return -1;
 }  // namespace flutter
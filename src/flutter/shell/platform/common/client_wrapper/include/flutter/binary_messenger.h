@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <string>
+#include <utility>
 
 namespace flutter {
 
@@ -45,6 +46,19 @@ class BinaryMessenger {
   // existing handler.
   virtual void SetMessageHandler(const std::string& channel,
                                  BinaryMessageHandler handler) = 0;
+
+  // Registers a message handler like SetMessageHandler, but which is called on
+  // a worker thread instead of the platform thread, so that a slow handler
+  // doesn't delay input and rendering. The messages of a channel are handled
+  // one at a time and in order. The reply may be sent from the worker thread.
+  //
+  // Replacing or unregistering the handler doesn't wait for the messages
+  // already queued on the channel, which are still passed to the previous
+  // handler. It is destroyed on the worker thread after them.
+  virtual void SetBackgroundMessageHandler(const std::string& channel,
+                                           BinaryMessageHandler handler) {
+    SetMessageHandler(channel, std::move(handler));
+  }
 };
 
 }  // namespace flutter
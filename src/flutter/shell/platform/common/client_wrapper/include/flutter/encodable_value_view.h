@@ -0,0 +1,314 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_VIEW_H_
+#define FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "encodable_value.h"
+
+namespace flutter {
+
+class EncodableListView;
+class EncodableMapView;
+
+// A read-only view of a value encoded with the standard codec.
+//
+// Unlike StandardCodecSerializer::ReadValue, which builds an EncodableValue
+// with an allocation for each node, a view reads the value in place in the
+// encoded message and allocates nothing. Strings and typed lists refer to the
+// bytes of the message, and the elements of lists and maps are only read when
+// they are iterated. This makes large messages, such as maps with tens of
+// thousands of entries, cheap to inspect. A view is only valid as long as the
+// message it refers to.
+//
+// Malformed messages and values of types added by codec extensions give
+// views of type kInvalid rather than reading out of bounds.
+//
+// Example:
+//   auto value = EncodableValueView::FromMessage(message, message_size);
+//   for (const auto& [key, item] : value.AsMap()) {
+//     if (key.AsString() == "temperature") {
+//       temperature = item.AsDouble();
+//     }
+//   }
+class EncodableValueView {
+ public:
+  enum class Type {
+    kInvalid,
+    kNull,
+    kBool,
+    kInt32,
+    kInt64,
+    kDouble,
+    kString,
+    kUInt8List,
+    kInt32List,
+    kInt64List,
+    kFloat64List,
+    kList,
+    kMap,
+  };
+
+  // The elements of a typed list, which are stored in the message. They are
+  // read with memcpy because the message may not be suitably aligned.
+  template <typename T>
+  class TypedList {
+   public:
+    TypedList() = default;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Returns the element at |index|, which must be less than size().
+    T operator[](size_t index) const {
+      T value;
+      std::memcpy(&value, data_ + index * sizeof(T), sizeof(T));
+      return value;
+    }
+
+    // Returns the elements in place in the message if they are aligned for T,
+    // or nullptr otherwise. They are aligned when the message is, because the
+    // codec aligns them relative to the start of the message, which is the
+    // case for the messages from the engine. The elements are only valid as
+    // long as the message, e.g. during a message handler.
+    const T* data() const {
+      if (reinterpret_cast<uintptr_t>(data_) % alignof(T) != 0) {
+        return nullptr;
+      }
+      return reinterpret_cast<const T*>(data_);
+    }
+
+    // Returns the encoded elements, which are size() * sizeof(T) bytes.
+    const uint8_t* bytes() const { return data_; }
+
+    // Copies the elements into a new vector.
+    std::vector<T> ToVector() const {
+      std::vector<T> vector(size_);
+      if (size_ > 0) {
+        std::memcpy(vector.data(), data_, size_ * sizeof(T));
+      }
+      return vector;
+    }
+
+   private:
+    friend class EncodableValueView;
+
+    TypedList(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  // Creates an invalid view.
+  EncodableValueView() = default;
+
+  // Returns a view of the value encoded in |message|, as sent with
+  // StandardMessageCodec. |message| must outlive the view.
+  static EncodableValueView FromMessage(const uint8_t* message,
+                                        size_t message_size);
+
+  // Reads a method call encoded with StandardMethodCodec. Returns false if
+  // |message| isn't a method call. Otherwise, sets |method_name| and
+  // |arguments| to views into |message|, which must outlive them.
+  static bool FromMethodCall(const uint8_t* message,
+                             size_t message_size,
+                             std::string_view* method_name,
+                             EncodableValueView* arguments);
+
+  Type type() const { return type_; }
+  bool IsValid() const { return type_ != Type::kInvalid; }
+  bool IsNull() const { return type_ == Type::kNull; }
+
+  // Accessors for the value of each type. They return an empty or zero value
+  // if the value has another type, except that AsInt64() also accepts
+  // kInt32, as EncodableValue::LongValue() does.
+  bool AsBool() const;
+  int32_t AsInt32() const;
+  int64_t AsInt64() const;
+  double AsDouble() const;
+  std::string_view AsString() const;
+  TypedList<uint8_t> AsUInt8List() const;
+  TypedList<int32_t> AsInt32List() const;
+  TypedList<int64_t> AsInt64List() const;
+  TypedList<double> AsFloat64List() const;
+  EncodableListView AsList() const;
+  EncodableMapView AsMap() const;
+
+  // Copies the value into an EncodableValue, for the APIs which need one.
+  // Returns a null value if the view is invalid.
+  EncodableValue ToEncodableValue() const;
+
+ private:
+  friend class EncodableListView;
+  friend class EncodableMapView;
+
+  // Reads the header of the value at |offset| of |message|.
+  EncodableValueView(const uint8_t* message,
+                     size_t message_size,
+                     size_t offset);
+
+  // Returns the offset which follows the value, or a value larger than the
+  // message if the message is truncated.
+  size_t EndOffset() const;
+
+  // Returns the offset which follows the list of |count| values starting at
+  // |offset|, or a value larger than the message if it is truncated.
+  size_t EndOffsetOfValues(size_t offset, size_t count) const;
+
+  template <typename T>
+  TypedList<T> AsTypedList(Type type) const;
+
+  // The message which contains the value.
+  const uint8_t* message_ = nullptr;
+  size_t message_size_ = 0;
+
+  Type type_ = Type::kInvalid;
+
+  // The offset of the payload in the message, after the type, the size and
+  // the alignment padding.
+  size_t data_offset_ = 0;
+
+  // The number of elements of strings, lists and maps.
+  size_t size_ = 0;
+};
+
+// A view of the elements of a list, which are read while iterating.
+class EncodableListView {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EncodableValueView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const EncodableValueView*;
+    using reference = const EncodableValueView&;
+
+    reference operator*() const { return value_; }
+    pointer operator->() const { return &value_; }
+    Iterator& operator++();
+    Iterator operator++(int) {
+      auto previous = *this;
+      ++*this;
+      return previous;
+    }
+    bool operator==(const Iterator& other) const {
+      return remaining_ == other.remaining_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class EncodableListView;
+
+    Iterator(EncodableValueView value, size_t remaining)
+        : value_(value), remaining_(remaining) {}
+
+    EncodableValueView value_;
+    size_t remaining_;
+  };
+
+  EncodableListView() = default;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  Iterator begin() const;
+  Iterator end() const { return Iterator(EncodableValueView(), 0); }
+
+ private:
+  friend class EncodableValueView;
+
+  EncodableListView(const uint8_t* message,
+                    size_t message_size,
+                    size_t offset,
+                    size_t size)
+      : message_(message),
+        message_size_(message_size),
+        offset_(offset),
+        size_(size) {}
+
+  const uint8_t* message_ = nullptr;
+  size_t message_size_ = 0;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+};
+
+// A view of the entries of a map in the order of the message, which are read
+// while iterating. Looking up a key is a linear search, so iterate once
+// instead of calling Find() for many keys of a large map.
+class EncodableMapView {
+ public:
+  using Entry = std::pair<EncodableValueView, EncodableValueView>;
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Entry*;
+    using reference = const Entry&;
+
+    reference operator*() const { return entry_; }
+    pointer operator->() const { return &entry_; }
+    Iterator& operator++();
+    Iterator operator++(int) {
+      auto previous = *this;
+      ++*this;
+      return previous;
+    }
+    bool operator==(const Iterator& other) const {
+      return remaining_ == other.remaining_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class EncodableMapView;
+
+    Iterator(Entry entry, size_t remaining)
+        : entry_(entry), remaining_(remaining) {}
+
+    Entry entry_;
+    size_t remaining_;
+  };
+
+  EncodableMapView() = default;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  Iterator begin() const;
+  Iterator end() const { return Iterator(Entry(), 0); }
+
+  // Returns the value of the first entry whose key is the string |key|, or
+  // an invalid view if there is none.
+  EncodableValueView Find(std::string_view key) const;
+
+ private:
+  friend class EncodableValueView;
+
+  EncodableMapView(const uint8_t* message,
+                   size_t message_size,
+                   size_t offset,
+                   size_t size)
+      : message_(message),
+        message_size_(message_size),
+        offset_(offset),
+        size_(size) {}
+
+  const uint8_t* message_ = nullptr;
+  size_t message_size_ = 0;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_VIEW_H_
@@ -99,12 +99,29 @@ class MethodChannel {
       messenger_->SetMessageHandler(name_, nullptr);
       return;
     }
+    messenger_->SetMessageHandler(name_, WrapHandler(std::move(handler)));
+  }
+
+  // Registers a handler like SetMethodCallHandler, but which is called on a
+  // worker thread. See BinaryMessenger::SetBackgroundMessageHandler.
+  void SetBackgroundMethodCallHandler(MethodCallHandler<T> handler) const {
+    if (!handler) {
+      messenger_->SetBackgroundMessageHandler(name_, nullptr);
+      return;
+    }
+    messenger_->SetBackgroundMessageHandler(name_,
+                                            WrapHandler(std::move(handler)));
+  }
+
+ private:
+  // Returns a BinaryMessageHandler which decodes method calls with this
+  // channel's codec and passes them to |handler|.
+  BinaryMessageHandler WrapHandler(MethodCallHandler<T> handler) const {
     const auto* codec = codec_;
     std::string channel_name = name_;
-    BinaryMessageHandler binary_handler = [handler, codec, channel_name](
-                                              const uint8_t* message,
-                                              size_t message_size,
-                                              BinaryReply reply) {
+    return [handler, codec, channel_name](const uint8_t* message,
+                                          size_t message_size,
+                                          BinaryReply reply) {
       // Use this channel's codec to decode the call and build a result handler.
       auto result =
           std::make_unique<EngineMethodResult<T>>(std::move(reply), codec);
@@ -118,10 +135,8 @@ class MethodChannel {
       }
       handler(*method_call, std::move(result));
     };
-    messenger_->SetMessageHandler(name_, std::move(binary_handler));
   }
 
- private:
   BinaryMessenger* messenger_;
   std::string name_;
   const MethodCodec<T>* codec_;
@@ -0,0 +1,120 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_STANDARD_CODEC_WRITER_H_
+#define FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_STANDARD_CODEC_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "encodable_value.h"
+
+namespace flutter {
+
+// Encodes values with the standard codec directly into a byte buffer, without
+// building an EncodableValue first. The output is what StandardMessageCodec
+// would produce for the same values, and can be sent as is with
+// BinaryMessenger::Send.
+//
+// The values are appended to the buffer, so a buffer which is cleared and
+// reused for each message stops allocating once it has the capacity of the
+// largest message. Lists and maps are written as a header followed by their
+// elements:
+//   buffer.clear();
+//   StandardCodecWriter writer(&buffer);
+//   writer.WriteMapHeader(1);
+//   writer.WriteString("temperature");
+//   writer.WriteDouble(temperature);
+//   messenger->Send("sensors", buffer.data(), buffer.size());
+class StandardCodecWriter {
+ public:
+  // Creates a writer which appends to |buffer|. The message starts at the
+  // current end of |buffer|, which must remain valid for the lifetime of this
+  // object.
+  explicit StandardCodecWriter(std::vector<uint8_t>* buffer);
+
+  ~StandardCodecWriter() = default;
+
+  // Prevent copying.
+  StandardCodecWriter(StandardCodecWriter const&) = delete;
+  StandardCodecWriter& operator=(StandardCodecWriter const&) = delete;
+
+  void WriteNull();
+  void WriteBool(bool value);
+  void WriteInt32(int32_t value);
+  void WriteInt64(int64_t value);
+  void WriteDouble(double value);
+  void WriteString(std::string_view value);
+  void WriteUInt8List(const uint8_t* values, size_t count);
+  void WriteInt32List(const int32_t* values, size_t count);
+  void WriteInt64List(const int64_t* values, size_t count);
+  void WriteFloat64List(const double* values, size_t count);
+
+  // Writes a typed list of |count| elements whose values are filled in later,
+  // and returns where they start, so that a producer such as a sensor can
+  // write them directly into the message instead of into a buffer which is
+  // then copied. The elements may not be aligned in memory, and the pointer
+  // is only valid until the next write.
+  uint8_t* ReserveUInt8List(size_t count);
+  uint8_t* ReserveInt32List(size_t count);
+  uint8_t* ReserveInt64List(size_t count);
+  uint8_t* ReserveFloat64List(size_t count);
+
+  // Starts a list, which must be followed by |count| values.
+  void WriteListHeader(size_t count);
+
+  // Starts a map, which must be followed by |count| pairs of a key and a
+  // value.
+  void WriteMapHeader(size_t count);
+
+  // Writes |value|, for the parts of a message which are already
+  // EncodableValues. Custom values are not supported.
+  void WriteValue(const EncodableValue& value);
+
+  // Starts a method call as StandardMethodCodec encodes it, which must be
+  // followed by the arguments value.
+  void WriteMethodCallHeader(std::string_view method_name);
+
+  // Starts a successful method call response as StandardMethodCodec encodes
+  // it, which must be followed by the result value.
+  void WriteSuccessEnvelopeHeader();
+
+ private:
+  // Writes the type of a value, as defined in message_codecs.dart.
+  void WriteType(uint8_t type);
+
+  // Writes the variable-length size encoding.
+  void WriteSize(size_t size);
+
+  // Writes 0s until the next multiple of |alignment| relative to the start of
+  // the message.
+  void WriteAlignment(size_t alignment);
+
+  void WriteBytes(const void* bytes, size_t length);
+
+  // Writes the header of a typed list whose elements are |element_size|
+  // bytes. Returns where the elements start in |buffer_|.
+  size_t WriteTypedListHeader(uint8_t type, size_t count, size_t element_size);
+
+  // Writes a typed list whose elements are |element_size| bytes.
+  void WriteTypedList(uint8_t type,
+                      const void* values,
+                      size_t count,
+                      size_t element_size);
+
+  // Writes the header of a typed list and leaves room for its elements.
+  // Returns where the elements start.
+  uint8_t* ReserveTypedList(uint8_t type, size_t count, size_t element_size);
+
+  std::vector<uint8_t>* buffer_;
+
+  // The offset of the start of the message in |buffer_|.
+  size_t start_ = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_STANDARD_CODEC_WRITER_H_
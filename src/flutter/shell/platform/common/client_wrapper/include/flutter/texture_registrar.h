@@ -42,10 +42,69 @@ class PixelBufferTexture {
   const CopyBufferCallback copy_buffer_callback_;
 };
 
+// A pixel buffer texture whose buffers tell their format and the region which
+// has changed.
+class PixelBufferDescriptorTexture {
+ public:
+  // A callback used for retrieving pixel buffer descriptors.
+  typedef std::function<const FlutterDesktopPixelBufferDescriptor*(
+      size_t width,
+      size_t height)>
+      CopyBufferCallback;
+
+  // Creates a pixel buffer descriptor texture that uses the provided
+  // |copy_buffer_cb| to retrieve the buffer.
+  // As the callback is usually invoked from the render thread, the callee must
+  // take care of proper synchronization. It also needs to be ensured that the
+  // returned buffer isn't released prior to unregistering this texture.
+  PixelBufferDescriptorTexture(CopyBufferCallback copy_buffer_callback)
+      : copy_buffer_callback_(copy_buffer_callback) {}
+
+  // Returns the callback-provided FlutterDesktopPixelBufferDescriptor that
+  // contains the actual pixel data. The intended surface size is specified by
+  // |width| and |height|.
+  const FlutterDesktopPixelBufferDescriptor* CopyPixelBuffer(
+      size_t width,
+      size_t height) const {
+    return copy_buffer_callback_(width, height);
+  }
+
+ private:
+  const CopyBufferCallback copy_buffer_callback_;
+};
+
+// A DMA-BUF texture, which is shown without copying the pixels.
+class DmaBufTexture {
+ public:
+  // A callback used for retrieving DMA-BUFs.
+  typedef std::function<const FlutterDesktopDmaBuffer*(size_t width,
+                                                       size_t height)>
+      ObtainBufferCallback;
+
+  // Creates a DMA-BUF texture that uses the provided |obtain_buffer_cb| to
+  // retrieve the buffer.
+  // As the callback is usually invoked from the render thread, the callee must
+  // take care of proper synchronization. It also needs to be ensured that the
+  // fds of the returned buffer stay open until unregistering this texture.
+  DmaBufTexture(ObtainBufferCallback obtain_buffer_callback)
+      : obtain_buffer_callback_(obtain_buffer_callback) {}
+
+  // Returns the callback-provided FlutterDesktopDmaBuffer to show. The
+  // intended surface size is specified by |width| and |height|.
+  const FlutterDesktopDmaBuffer* ObtainBuffer(size_t width,
+                                              size_t height) const {
+    return obtain_buffer_callback_(width, height);
+  }
+
+ private:
+  const ObtainBufferCallback obtain_buffer_callback_;
+};
+
 // The available texture variants.
-// Only PixelBufferTexture is currently implemented.
-// Other variants are expected to be added in the future.
-typedef std::variant<PixelBufferTexture> TextureVariant;
+typedef std::variant<PixelBufferTexture,
+                     DmaBufTexture,
+                     PixelBufferDescriptorTexture>
+    TextureVariant;
 
 // An object keeping track of external textures.
 //
@@ -3,9 +3,10 @@
 // found in the LICENSE file.
 
 // This file contains what would normally be standard_codec_serializer.cc,
-// standard_message_codec.cc, and standard_method_codec.cc. They are grouped
+// standard_message_codec.cc, standard_method_codec.cc,
+// encodable_value_view.cc and standard_codec_writer.cc. They are grouped
 // together to simplify use of the client wrapper, since the common case is
-// that any client that needs one of these files needs all three.
+// that any client that needs one of these files needs all of them.
 
 #include <cassert>
 #include <cstring>
@@ -15,7 +16,9 @@
 #include <vector>
 
 #include "byte_buffer_streams.h"
+#include "include/flutter/encodable_value_view.h"
 #include "include/flutter/standard_codec_serializer.h"
+#include "include/flutter/standard_codec_writer.h"
 #include "include/flutter/standard_message_codec.h"
 #include "include/flutter/standard_method_codec.h"
 
@@ -266,13 +269,14 @@ void StandardCodecSerializer::WriteVector(const std::vector<T> vector,
                                           ByteStreamWriter* stream) const {
   size_t count = vector.size();
   WriteSize(count, stream);
-  if (count == 0) {
-    return;
-  }
+  // The readers align the elements even if there are none.
   uint8_t type_size = static_cast<uint8_t>(sizeof(T));
   if (type_size > 1) {
     stream->WriteAlignment(type_size);
   }
+  if (count == 0) {
+    return;
+  }
   stream->WriteBytes(reinterpret_cast<const uint8_t*>(vector.data()),
                      count * type_size);
 }
@@ -450,4 +454,617 @@ bool StandardMethodCodec::DecodeAndProcessResponseEnvelopeInternal(
   }
 }
 
+// ===== encodable_value_view.h =====
+
+namespace {
+
+// Reads the variable-length size at |*offset| of |message| and advances
+// |*offset| past it. Returns false if the message is truncated.
+bool ReadViewSize(const uint8_t* message,
+                  size_t message_size,
+                  size_t* offset,
+                  size_t* size) {
+  if (*offset >= message_size) {
+    return false;
+  }
+  uint8_t byte = message[(*offset)++];
+  if (byte < 254) {
+    *size = byte;
+    return true;
+  } else if (byte == 254) {
+    uint16_t value;
+    if (message_size - *offset < sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&value, &message[*offset], sizeof(value));
+    *offset += sizeof(value);
+    *size = value;
+    return true;
+  } else {
+    uint32_t value;
+    if (message_size - *offset < sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&value, &message[*offset], sizeof(value));
+    *offset += sizeof(value);
+    *size = value;
+    return true;
+  }
+}
+
+// Returns the next multiple of |alignment| from |offset|.
+size_t AlignOffset(size_t offset, size_t alignment) {
+  size_t mod = offset % alignment;
+  return mod ? offset + alignment - mod : offset;
+}
+
+}  // namespace
+
+EncodableValueView::EncodableValueView(const uint8_t* message,
+                                       size_t message_size,
+                                       size_t offset)
+    : message_(message), message_size_(message_size) {
+  if (!message || offset >= message_size) {
+    return;
+  }
+
+  // The number of bytes which must follow the header.
+  size_t data_size = 0;
+  Type type;
+  switch (static_cast<EncodedType>(message[offset++])) {
+    case EncodedType::kNull:
+      type = Type::kNull;
+      break;
+    case EncodedType::kTrue:
+    case EncodedType::kFalse:
+      type = Type::kBool;
+      break;
+    case EncodedType::kInt32:
+      type = Type::kInt32;
+      data_size = sizeof(int32_t);
+      break;
+    case EncodedType::kInt64:
+      type = Type::kInt64;
+      data_size = sizeof(int64_t);
+      break;
+    case EncodedType::kFloat64:
+      type = Type::kDouble;
+      offset = AlignOffset(offset, 8);
+      data_size = sizeof(double);
+      break;
+    case EncodedType::kLargeInt:
+    case EncodedType::kString:
+      type = Type::kString;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      data_size = size_;
+      break;
+    case EncodedType::kUInt8List:
+      type = Type::kUInt8List;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      data_size = size_;
+      break;
+    case EncodedType::kInt32List:
+      type = Type::kInt32List;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      offset = AlignOffset(offset, sizeof(int32_t));
+      data_size = size_ * sizeof(int32_t);
+      break;
+    case EncodedType::kInt64List:
+      type = Type::kInt64List;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      offset = AlignOffset(offset, sizeof(int64_t));
+      data_size = size_ * sizeof(int64_t);
+      break;
+    case EncodedType::kFloat64List:
+      type = Type::kFloat64List;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      offset = AlignOffset(offset, sizeof(double));
+      data_size = size_ * sizeof(double);
+      break;
+    case EncodedType::kList:
+      type = Type::kList;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      // Each element takes at least one byte.
+      data_size = size_;
+      break;
+    case EncodedType::kMap:
+      type = Type::kMap;
+      if (!ReadViewSize(message, message_size, &offset, &size_)) {
+        return;
+      }
+      data_size = size_ * 2;
+      break;
+    default:
+      return;
+  }
+  if (offset > message_size || data_size > message_size - offset) {
+    size_ = 0;
+    return;
+  }
+  type_ = type;
+  data_offset_ = offset;
+}
+
+// static
+EncodableValueView EncodableValueView::FromMessage(const uint8_t* message,
+                                                   size_t message_size) {
+  return EncodableValueView(message, message_size, 0);
+}
+
+// static
+bool EncodableValueView::FromMethodCall(const uint8_t* message,
+                                        size_t message_size,
+                                        std::string_view* method_name,
+                                        EncodableValueView* arguments) {
+  EncodableValueView name(message, message_size, 0);
+  if (name.type() != Type::kString) {
+    std::cerr << "Invalid method call; method name is not a string."
+              << std::endl;
+    return false;
+  }
+  EncodableValueView value(message, message_size, name.EndOffset());
+  if (!value.IsValid()) {
+    std::cerr << "Invalid method call; arguments are missing." << std::endl;
+    return false;
+  }
+  *method_name = name.AsString();
+  *arguments = value;
+  return true;
+}
+
+bool EncodableValueView::AsBool() const {
+  return type_ == Type::kBool &&
+         static_cast<EncodedType>(message_[data_offset_ - 1]) ==
+             EncodedType::kTrue;
+}
+
+int32_t EncodableValueView::AsInt32() const {
+  int32_t value = 0;
+  if (type_ == Type::kInt32) {
+    std::memcpy(&value, &message_[data_offset_], sizeof(value));
+  }
+  return value;
+}
+
+int64_t EncodableValueView::AsInt64() const {
+  if (type_ == Type::kInt32) {
+    return AsInt32();
+  }
+  int64_t value = 0;
+  if (type_ == Type::kInt64) {
+    std::memcpy(&value, &message_[data_offset_], sizeof(value));
+  }
+  return value;
+}
+
+double EncodableValueView::AsDouble() const {
+  double value = 0;
+  if (type_ == Type::kDouble) {
+    std::memcpy(&value, &message_[data_offset_], sizeof(value));
+  }
+  return value;
+}
+
+std::string_view EncodableValueView::AsString() const {
+  if (type_ != Type::kString) {
+    return std::string_view();
+  }
+  return std::string_view(
+      reinterpret_cast<const char*>(&message_[data_offset_]), size_);
+}
+
+template <typename T>
+EncodableValueView::TypedList<T> EncodableValueView::AsTypedList(
+    Type type) const {
+  if (type_ != type) {
+    return TypedList<T>();
+  }
+  return TypedList<T>(&message_[data_offset_], size_);
+}
+
+EncodableValueView::TypedList<uint8_t> EncodableValueView::AsUInt8List()
+    const {
+  return AsTypedList<uint8_t>(Type::kUInt8List);
+}
+
+EncodableValueView::TypedList<int32_t> EncodableValueView::AsInt32List()
+    const {
+  return AsTypedList<int32_t>(Type::kInt32List);
+}
+
+EncodableValueView::TypedList<int64_t> EncodableValueView::AsInt64List()
+    const {
+  return AsTypedList<int64_t>(Type::kInt64List);
+}
+
+EncodableValueView::TypedList<double> EncodableValueView::AsFloat64List()
+    const {
+  return AsTypedList<double>(Type::kFloat64List);
+}
+
+EncodableListView EncodableValueView::AsList() const {
+  if (type_ != Type::kList) {
+    return EncodableListView();
+  }
+  return EncodableListView(message_, message_size_, data_offset_, size_);
+}
+
+EncodableMapView EncodableValueView::AsMap() const {
+  if (type_ != Type::kMap) {
+    return EncodableMapView();
+  }
+  return EncodableMapView(message_, message_size_, data_offset_, size_);
+}
+
+EncodableValue EncodableValueView::ToEncodableValue() const {
+  switch (type_) {
+    case Type::kInvalid:
+    case Type::kNull:
+      return EncodableValue();
+    case Type::kBool:
+      return EncodableValue(AsBool());
+    case Type::kInt32:
+      return EncodableValue(AsInt32());
+    case Type::kInt64:
+      return EncodableValue(AsInt64());
+    case Type::kDouble:
+      return EncodableValue(AsDouble());
+    case Type::kString:
+      return EncodableValue(std::string(AsString()));
+    case Type::kUInt8List:
+      return EncodableValue(AsUInt8List().ToVector());
+    case Type::kInt32List:
+      return EncodableValue(AsInt32List().ToVector());
+    case Type::kInt64List:
+      return EncodableValue(AsInt64List().ToVector());
+    case Type::kFloat64List:
+      return EncodableValue(AsFloat64List().ToVector());
+    case Type::kList: {
+      EncodableList list_value;
+      list_value.reserve(size_);
+      for (const auto& item : AsList()) {
+        list_value.push_back(item.ToEncodableValue());
+      }
+      return EncodableValue(std::move(list_value));
+    }
+    case Type::kMap: {
+      EncodableMap map_value;
+      for (const auto& entry : AsMap()) {
+        map_value.emplace(entry.first.ToEncodableValue(),
+                          entry.second.ToEncodableValue());
+      }
+      return EncodableValue(std::move(map_value));
+    }
+  }
+  return EncodableValue();
+}
+
+size_t EncodableValueView::EndOffset() const {
+  switch (type_) {
+    case Type::kInvalid:
+      break;
+    case Type::kNull:
+    case Type::kBool:
+      return data_offset_;
+    case Type::kInt32:
+      return data_offset_ + sizeof(int32_t);
+    case Type::kInt64:
+      return data_offset_ + sizeof(int64_t);
+    case Type::kDouble:
+      return data_offset_ + sizeof(double);
+    case Type::kString:
+    case Type::kUInt8List:
+      return data_offset_ + size_;
+    case Type::kInt32List:
+      return data_offset_ + size_ * sizeof(int32_t);
+    case Type::kInt64List:
+      return data_offset_ + size_ * sizeof(int64_t);
+    case Type::kFloat64List:
+      return data_offset_ + size_ * sizeof(double);
+    case Type::kList:
+      return EndOffsetOfValues(data_offset_, size_);
+    case Type::kMap:
+      return EndOffsetOfValues(data_offset_, size_ * 2);
+  }
+  return message_size_ + 1;
+}
+
+size_t EncodableValueView::EndOffsetOfValues(size_t offset,
+                                             size_t count) const {
+  for (size_t i = 0; i < count; ++i) {
+    EncodableValueView value(message_, message_size_, offset);
+    if (!value.IsValid()) {
+      return message_size_ + 1;
+    }
+    offset = value.EndOffset();
+  }
+  return offset;
+}
+
+EncodableListView::Iterator EncodableListView::begin() const {
+  if (size_ == 0) {
+    return end();
+  }
+  return Iterator(EncodableValueView(message_, message_size_, offset_),
+                  size_);
+}
+
+EncodableListView::Iterator&
+EncodableListView::Iterator::operator++() {
+  if (--remaining_ > 0) {
+    value_ = EncodableValueView(value_.message_, value_.message_size_,
+                                value_.EndOffset());
+  } else {
+    value_ = EncodableValueView();
+  }
+  return *this;
+}
+
+EncodableMapView::Iterator EncodableMapView::begin() const {
+  if (size_ == 0) {
+    return end();
+  }
+  EncodableValueView key(message_, message_size_, offset_);
+  EncodableValueView value(message_, message_size_, key.EndOffset());
+  return Iterator(Entry(key, value), size_);
+}
+
+EncodableMapView::Iterator&
+EncodableMapView::Iterator::operator++() {
+  if (--remaining_ > 0) {
+    const auto& previous = entry_.second;
+    EncodableValueView key(previous.message_, previous.message_size_,
+                           previous.EndOffset());
+    EncodableValueView value(key.message_, key.message_size_,
+                             key.EndOffset());
+    entry_ = Entry(key, value);
+  } else {
+    entry_ = Entry();
+  }
+  return *this;
+}
+
+EncodableValueView EncodableMapView::Find(std::string_view key) const {
+  for (const auto& entry : *this) {
+    if (entry.first.type() == EncodableValueView::Type::kString &&
+        entry.first.AsString() == key) {
+      return entry.second;
+    }
+  }
+  return EncodableValueView();
+}
+
+// ===== standard_codec_writer.h =====
+
+StandardCodecWriter::StandardCodecWriter(std::vector<uint8_t>* buffer)
+    : buffer_(buffer) {
+  assert(buffer_);
+  start_ = buffer_->size();
+}
+
+void StandardCodecWriter::WriteNull() {
+  WriteType(static_cast<uint8_t>(EncodedType::kNull));
+}
+
+void StandardCodecWriter::WriteBool(bool value) {
+  WriteType(static_cast<uint8_t>(value ? EncodedType::kTrue
+                                       : EncodedType::kFalse));
+}
+
+void StandardCodecWriter::WriteInt32(int32_t value) {
+  WriteType(static_cast<uint8_t>(EncodedType::kInt32));
+  WriteBytes(&value, sizeof(value));
+}
+
+void StandardCodecWriter::WriteInt64(int64_t value) {
+  WriteType(static_cast<uint8_t>(EncodedType::kInt64));
+  WriteBytes(&value, sizeof(value));
+}
+
+void StandardCodecWriter::WriteDouble(double value) {
+  WriteType(static_cast<uint8_t>(EncodedType::kFloat64));
+  WriteAlignment(8);
+  WriteBytes(&value, sizeof(value));
+}
+
+void StandardCodecWriter::WriteString(std::string_view value) {
+  WriteType(static_cast<uint8_t>(EncodedType::kString));
+  WriteSize(value.size());
+  WriteBytes(value.data(), value.size());
+}
+
+void StandardCodecWriter::WriteUInt8List(const uint8_t* values, size_t count) {
+  WriteTypedList(static_cast<uint8_t>(EncodedType::kUInt8List), values, count,
+                 sizeof(uint8_t));
+}
+
+void StandardCodecWriter::WriteInt32List(const int32_t* values, size_t count) {
+  WriteTypedList(static_cast<uint8_t>(EncodedType::kInt32List), values, count,
+                 sizeof(int32_t));
+}
+
+void StandardCodecWriter::WriteInt64List(const int64_t* values, size_t count) {
+  WriteTypedList(static_cast<uint8_t>(EncodedType::kInt64List), values, count,
+                 sizeof(int64_t));
+}
+
+void StandardCodecWriter::WriteFloat64List(const double* values,
+                                           size_t count) {
+  WriteTypedList(static_cast<uint8_t>(EncodedType::kFloat64List), values,
+                 count, sizeof(double));
+}
+
+uint8_t* StandardCodecWriter::ReserveUInt8List(size_t count) {
+  return ReserveTypedList(static_cast<uint8_t>(EncodedType::kUInt8List), count,
+                          sizeof(uint8_t));
+}
+
+uint8_t* StandardCodecWriter::ReserveInt32List(size_t count) {
+  return ReserveTypedList(static_cast<uint8_t>(EncodedType::kInt32List), count,
+                          sizeof(int32_t));
+}
+
+uint8_t* StandardCodecWriter::ReserveInt64List(size_t count) {
+  return ReserveTypedList(static_cast<uint8_t>(EncodedType::kInt64List), count,
+                          sizeof(int64_t));
+}
+
+uint8_t* StandardCodecWriter::ReserveFloat64List(size_t count) {
+  return ReserveTypedList(static_cast<uint8_t>(EncodedType::kFloat64List),
+                          count, sizeof(double));
+}
+
+void StandardCodecWriter::WriteListHeader(size_t count) {
+  WriteType(static_cast<uint8_t>(EncodedType::kList));
+  WriteSize(count);
+}
+
+void StandardCodecWriter::WriteMapHeader(size_t count) {
+  WriteType(static_cast<uint8_t>(EncodedType::kMap));
+  WriteSize(count);
+}
+
+void StandardCodecWriter::WriteValue(const EncodableValue& value) {
+  switch (value.index()) {
+    case 0:
+      WriteNull();
+      break;
+    case 1:
+      WriteBool(std::get<bool>(value));
+      break;
+    case 2:
+      WriteInt32(std::get<int32_t>(value));
+      break;
+    case 3:
+      WriteInt64(std::get<int64_t>(value));
+      break;
+    case 4:
+      WriteDouble(std::get<double>(value));
+      break;
+    case 5:
+      WriteString(std::get<std::string>(value));
+      break;
+    case 6: {
+      const auto& list = std::get<std::vector<uint8_t>>(value);
+      WriteUInt8List(list.data(), list.size());
+      break;
+    }
+    case 7: {
+      const auto& list = std::get<std::vector<int32_t>>(value);
+      WriteInt32List(list.data(), list.size());
+      break;
+    }
+    case 8: {
+      const auto& list = std::get<std::vector<int64_t>>(value);
+      WriteInt64List(list.data(), list.size());
+      break;
+    }
+    case 9: {
+      const auto& list = std::get<std::vector<double>>(value);
+      WriteFloat64List(list.data(), list.size());
+      break;
+    }
+    case 10: {
+      const auto& list = std::get<EncodableList>(value);
+      WriteListHeader(list.size());
+      for (const auto& item : list) {
+        WriteValue(item);
+      }
+      break;
+    }
+    case 11: {
+      const auto& map = std::get<EncodableMap>(value);
+      WriteMapHeader(map.size());
+      for (const auto& pair : map) {
+        WriteValue(pair.first);
+        WriteValue(pair.second);
+      }
+      break;
+    }
+    case 12:
+      std::cerr << "Unhandled custom type in StandardCodecWriter::WriteValue."
+                << std::endl;
+      WriteNull();
+      break;
+  }
+}
+
+void StandardCodecWriter::WriteMethodCallHeader(std::string_view method_name) {
+  WriteString(method_name);
+}
+
+void StandardCodecWriter::WriteSuccessEnvelopeHeader() {
+  buffer_->push_back(0);
+}
+
+void StandardCodecWriter::WriteType(uint8_t type) {
+  buffer_->push_back(type);
+}
+
+void StandardCodecWriter::WriteSize(size_t size) {
+  if (size < 254) {
+    buffer_->push_back(static_cast<uint8_t>(size));
+  } else if (size <= 0xffff) {
+    buffer_->push_back(254);
+    uint16_t value = static_cast<uint16_t>(size);
+    WriteBytes(&value, sizeof(value));
+  } else {
+    buffer_->push_back(255);
+    uint32_t value = static_cast<uint32_t>(size);
+    WriteBytes(&value, sizeof(value));
+  }
+}
+
+void StandardCodecWriter::WriteAlignment(size_t alignment) {
+  size_t mod = (buffer_->size() - start_) % alignment;
+  if (mod) {
+    buffer_->insert(buffer_->end(), alignment - mod, 0);
+  }
+}
+
+void StandardCodecWriter::WriteBytes(const void* bytes, size_t length) {
+  auto begin = static_cast<const uint8_t*>(bytes);
+  buffer_->insert(buffer_->end(), begin, begin + length);
+}
+
+size_t StandardCodecWriter::WriteTypedListHeader(uint8_t type,
+                                                 size_t count,
+                                                 size_t element_size) {
+  WriteType(type);
+  WriteSize(count);
+  // The reader aligns the elements even if there are none.
+  if (element_size > 1) {
+    WriteAlignment(element_size);
+  }
+  return buffer_->size();
+}
+
+void StandardCodecWriter::WriteTypedList(uint8_t type,
+                                         const void* values,
+                                         size_t count,
+                                         size_t element_size) {
+  WriteTypedListHeader(type, count, element_size);
+  WriteBytes(values, count * element_size);
+}
+
+uint8_t* StandardCodecWriter::ReserveTypedList(uint8_t type,
+                                               size_t count,
+                                               size_t element_size) {
+  size_t offset = WriteTypedListHeader(type, count, element_size);
+  buffer_->resize(offset + count * element_size);
+  return buffer_->data() + offset;
+}
+
 }  // namespace flutter
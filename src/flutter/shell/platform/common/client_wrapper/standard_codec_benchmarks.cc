@@ -0,0 +1,297 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares encoding and decoding typical plugin messages through
+// EncodableValue with StandardMessageCodec and StandardMethodCodec, against
+// StandardCodecWriter and EncodableValueView, which skip the EncodableValue
+// tree.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "include/flutter/encodable_value.h"
+#include "include/flutter/encodable_value_view.h"
+#include "include/flutter/method_call.h"
+#include "include/flutter/standard_codec_writer.h"
+#include "include/flutter/standard_message_codec.h"
+#include "include/flutter/standard_method_codec.h"
+
+namespace flutter {
+
+namespace {
+
+// Returns the value of |key| in |map|, or null if there is none.
+const EncodableValue* FindValue(const EncodableMap& map, const char* key) {
+  auto it = map.find(EncodableValue(key));
+  return it == map.end() ? nullptr : &it->second;
+}
+
+// A method call with a couple of arguments, such as a media player's
+// setVolume.
+struct MethodCallPayload {
+  static std::unique_ptr<std::vector<uint8_t>> EncodeWithCodec() {
+    MethodCall<EncodableValue> call(
+        "setVolume", std::make_unique<EncodableValue>(EncodableMap{
+                         {EncodableValue("playerId"), EncodableValue(3)},
+                         {EncodableValue("volume"), EncodableValue(0.5)},
+                     }));
+    return StandardMethodCodec::GetInstance().EncodeMethodCall(call);
+  }
+
+  static void EncodeWithWriter(std::vector<uint8_t>* buffer) {
+    StandardCodecWriter writer(buffer);
+    writer.WriteMethodCallHeader("setVolume");
+    writer.WriteMapHeader(2);
+    writer.WriteString("playerId");
+    writer.WriteInt32(3);
+    writer.WriteString("volume");
+    writer.WriteDouble(0.5);
+  }
+
+  static double DecodeWithCodec(const std::vector<uint8_t>& message) {
+    auto call = StandardMethodCodec::GetInstance().DecodeMethodCall(message);
+    if (!call || call->method_name() != "setVolume") {
+      return 0;
+    }
+    const auto& args = std::get<EncodableMap>(*call->arguments());
+    return FindValue(args, "playerId")->LongValue() +
+           std::get<double>(*FindValue(args, "volume"));
+  }
+
+  static double DecodeWithView(const std::vector<uint8_t>& message) {
+    std::string_view method;
+    EncodableValueView args;
+    if (!EncodableValueView::FromMethodCall(message.data(), message.size(),
+                                            &method, &args) ||
+        method != "setVolume") {
+      return 0;
+    }
+    auto map = args.AsMap();
+    return map.Find("playerId").AsInt64() + map.Find("volume").AsDouble();
+  }
+};
+
+// A sensor reading sent on an event channel many times a second.
+struct SensorEventPayload {
+  static std::unique_ptr<std::vector<uint8_t>> EncodeWithCodec() {
+    EncodableValue value(EncodableMap{
+        {EncodableValue("x"), EncodableValue(0.12)},
+        {EncodableValue("y"), EncodableValue(-9.81)},
+        {EncodableValue("z"), EncodableValue(0.03)},
+        {EncodableValue("timestamp"), EncodableValue(int64_t{1634567890123})},
+    });
+    return StandardMessageCodec::GetInstance().EncodeMessage(value);
+  }
+
+  static void EncodeWithWriter(std::vector<uint8_t>* buffer) {
+    StandardCodecWriter writer(buffer);
+    writer.WriteMapHeader(4);
+    writer.WriteString("x");
+    writer.WriteDouble(0.12);
+    writer.WriteString("y");
+    writer.WriteDouble(-9.81);
+    writer.WriteString("z");
+    writer.WriteDouble(0.03);
+    writer.WriteString("timestamp");
+    writer.WriteInt64(1634567890123);
+  }
+
+  static double DecodeWithCodec(const std::vector<uint8_t>& message) {
+    auto value = StandardMessageCodec::GetInstance().DecodeMessage(message);
+    const auto& map = std::get<EncodableMap>(*value);
+    return std::get<double>(*FindValue(map, "x")) +
+           std::get<double>(*FindValue(map, "y")) +
+           std::get<double>(*FindValue(map, "z")) +
+           FindValue(map, "timestamp")->LongValue();
+  }
+
+  static double DecodeWithView(const std::vector<uint8_t>& message) {
+    double sum = 0;
+    auto value =
+        EncodableValueView::FromMessage(message.data(), message.size());
+    for (const auto& [key, item] : value.AsMap()) {
+      sum += key.AsString() == "timestamp" ? item.AsInt64() : item.AsDouble();
+    }
+    return sum;
+  }
+};
+
+// A camera frame at 320x240 in RGBA.
+struct FramePayload {
+  static constexpr int32_t kWidth = 320;
+  static constexpr int32_t kHeight = 240;
+
+  static const std::vector<uint8_t>& Pixels() {
+    static const std::vector<uint8_t> pixels(kWidth * kHeight * 4, 0x80);
+    return pixels;
+  }
+
+  static std::unique_ptr<std::vector<uint8_t>> EncodeWithCodec() {
+    EncodableValue value(EncodableMap{
+        {EncodableValue("width"), EncodableValue(kWidth)},
+        {EncodableValue("height"), EncodableValue(kHeight)},
+        {EncodableValue("pixels"), EncodableValue(Pixels())},
+    });
+    return StandardMessageCodec::GetInstance().EncodeMessage(value);
+  }
+
+  static void EncodeWithWriter(std::vector<uint8_t>* buffer) {
+    StandardCodecWriter writer(buffer);
+    writer.WriteMapHeader(3);
+    writer.WriteString("width");
+    writer.WriteInt32(kWidth);
+    writer.WriteString("height");
+    writer.WriteInt32(kHeight);
+    writer.WriteString("pixels");
+    writer.WriteUInt8List(Pixels().data(), Pixels().size());
+  }
+
+  static double DecodeWithCodec(const std::vector<uint8_t>& message) {
+    auto value = StandardMessageCodec::GetInstance().DecodeMessage(message);
+    const auto& map = std::get<EncodableMap>(*value);
+    const auto& pixels =
+        std::get<std::vector<uint8_t>>(*FindValue(map, "pixels"));
+    return FindValue(map, "width")->LongValue() + pixels[pixels.size() / 2];
+  }
+
+  static double DecodeWithView(const std::vector<uint8_t>& message) {
+    auto map = EncodableValueView::FromMessage(message.data(), message.size())
+                   .AsMap();
+    auto pixels = map.Find("pixels").AsUInt8List();
+    return map.Find("width").AsInt32() + pixels[pixels.size() / 2];
+  }
+};
+
+// A list of records, such as the results of a Bluetooth scan.
+struct RecordListPayload {
+  static constexpr int kRecordCount = 100;
+
+  static std::string Name(int index) {
+    return "device-" + std::to_string(index);
+  }
+
+  static std::unique_ptr<std::vector<uint8_t>> EncodeWithCodec() {
+    EncodableList records;
+    for (int i = 0; i < kRecordCount; i++) {
+      records.emplace_back(EncodableMap{
+          {EncodableValue("id"), EncodableValue(i)},
+          {EncodableValue("name"), EncodableValue(Name(i))},
+          {EncodableValue("rssi"), EncodableValue(-40 - i % 50)},
+          {EncodableValue("connectable"), EncodableValue(i % 2 == 0)},
+      });
+    }
+    return StandardMessageCodec::GetInstance().EncodeMessage(
+        EncodableValue(std::move(records)));
+  }
+
+  static void EncodeWithWriter(std::vector<uint8_t>* buffer) {
+    StandardCodecWriter writer(buffer);
+    writer.WriteListHeader(kRecordCount);
+    for (int i = 0; i < kRecordCount; i++) {
+      writer.WriteMapHeader(4);
+      writer.WriteString("id");
+      writer.WriteInt32(i);
+      writer.WriteString("name");
+      writer.WriteString(Name(i));
+      writer.WriteString("rssi");
+      writer.WriteInt32(-40 - i % 50);
+      writer.WriteString("connectable");
+      writer.WriteBool(i % 2 == 0);
+    }
+  }
+
+  static double DecodeWithCodec(const std::vector<uint8_t>& message) {
+    auto value = StandardMessageCodec::GetInstance().DecodeMessage(message);
+    double sum = 0;
+    for (const auto& record : std::get<EncodableList>(*value)) {
+      const auto& map = std::get<EncodableMap>(record);
+      sum += FindValue(map, "rssi")->LongValue() +
+             std::get<std::string>(*FindValue(map, "name")).size();
+    }
+    return sum;
+  }
+
+  static double DecodeWithView(const std::vector<uint8_t>& message) {
+    auto value =
+        EncodableValueView::FromMessage(message.data(), message.size());
+    double sum = 0;
+    for (const auto& record : value.AsList()) {
+      for (const auto& [key, item] : record.AsMap()) {
+        auto name = key.AsString();
+        if (name == "rssi") {
+          sum += item.AsInt32();
+        } else if (name == "name") {
+          sum += item.AsString().size();
+        }
+      }
+    }
+    return sum;
+  }
+};
+
+// Encodes through an EncodableValue, which is how a plugin sends a message
+// with the codecs.
+template <typename Payload>
+void BM_EncodeWithCodec(benchmark::State& state) {
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto message = Payload::EncodeWithCodec();
+    bytes += message->size();
+    benchmark::DoNotOptimize(message->data());
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+// Encodes straight into a buffer which is reused for every message.
+template <typename Payload>
+void BM_EncodeWithWriter(benchmark::State& state) {
+  std::vector<uint8_t> buffer;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    buffer.clear();
+    Payload::EncodeWithWriter(&buffer);
+    bytes += buffer.size();
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+// Decodes into an EncodableValue and reads some of the fields.
+template <typename Payload>
+void BM_DecodeWithCodec(benchmark::State& state) {
+  auto message = Payload::EncodeWithCodec();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Payload::DecodeWithCodec(*message));
+  }
+  state.SetBytesProcessed(state.iterations() * message->size());
+}
+
+// Reads the same fields in place in the message.
+template <typename Payload>
+void BM_DecodeWithView(benchmark::State& state) {
+  auto message = Payload::EncodeWithCodec();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Payload::DecodeWithView(*message));
+  }
+  state.SetBytesProcessed(state.iterations() * message->size());
+}
+
+}  // namespace
+
+#define BENCHMARK_CODEC(Payload)                      \
+  BENCHMARK_TEMPLATE(BM_EncodeWithCodec, Payload);    \
+  BENCHMARK_TEMPLATE(BM_EncodeWithWriter, Payload);   \
+  BENCHMARK_TEMPLATE(BM_DecodeWithCodec, Payload);    \
+  BENCHMARK_TEMPLATE(BM_DecodeWithView, Payload)
+
+BENCHMARK_CODEC(MethodCallPayload);
+BENCHMARK_CODEC(SensorEventPayload);
+BENCHMARK_CODEC(FramePayload);
+BENCHMARK_CODEC(RecordListPayload);
+
+}  // namespace flutter
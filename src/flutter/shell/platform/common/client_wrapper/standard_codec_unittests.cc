@@ -0,0 +1,120 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/testing/allocation_counter.h"
+#include "gtest/gtest.h"
+#include "include/flutter/encodable_value.h"
+#include "include/flutter/encodable_value_view.h"
+#include "include/flutter/standard_codec_writer.h"
+#include "include/flutter/standard_message_codec.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr size_t kSampleCount = 1024;
+
+// Writes a sensor frame, whose samples are filled in place.
+void WriteSensorFrame(std::vector<uint8_t>* buffer, int64_t timestamp) {
+  StandardCodecWriter writer(buffer);
+  writer.WriteMapHeader(2);
+  writer.WriteString("timestamp");
+  writer.WriteInt64(timestamp);
+  writer.WriteString("samples");
+  auto samples = writer.ReserveFloat64List(kSampleCount);
+  for (size_t i = 0; i < kSampleCount; i++) {
+    double sample = i * 0.5;
+    std::memcpy(samples + i * sizeof(double), &sample, sizeof(double));
+  }
+}
+
+}  // namespace
+
+TEST(StandardCodecTest, WriterMatchesStandardMessageCodec) {
+  EncodableValue value(EncodableMap{
+      {EncodableValue("name"), EncodableValue("sensor")},
+      {EncodableValue("enabled"), EncodableValue(true)},
+      {EncodableValue("rates"), EncodableValue(std::vector<int32_t>{1, 10})},
+      {EncodableValue("gain"), EncodableValue(1.5)},
+  });
+  auto expected = StandardMessageCodec::GetInstance().EncodeMessage(value);
+
+  std::vector<uint8_t> buffer;
+  StandardCodecWriter writer(&buffer);
+  writer.WriteValue(value);
+  EXPECT_EQ(buffer, *expected);
+}
+
+TEST(StandardCodecTest, ReservedListDecodesWithCodec) {
+  std::vector<uint8_t> buffer;
+  WriteSensorFrame(&buffer, 42);
+
+  auto decoded = StandardMessageCodec::GetInstance().DecodeMessage(buffer);
+  ASSERT_NE(decoded, nullptr);
+  const auto& map = std::get<EncodableMap>(*decoded);
+  const auto& samples =
+      std::get<std::vector<double>>(map.at(EncodableValue("samples")));
+  ASSERT_EQ(samples.size(), kSampleCount);
+  EXPECT_EQ(samples[3], 1.5);
+  EXPECT_EQ(map.at(EncodableValue("timestamp")).LongValue(), 42);
+}
+
+TEST(StandardCodecTest, WriterDoesNotAllocateWithReusedBuffer) {
+  std::vector<uint8_t> buffer;
+  WriteSensorFrame(&buffer, 1);
+
+  ScopedAllocationCounter counter;
+  for (int64_t i = 0; i < 10; i++) {
+    buffer.clear();
+    WriteSensorFrame(&buffer, i);
+  }
+  EXPECT_EQ(counter.count(), 0u);
+}
+
+TEST(StandardCodecTest, ViewReadsTypedListInPlaceWithoutAllocating) {
+  std::vector<uint8_t> message;
+  WriteSensorFrame(&message, 7);
+
+  ScopedAllocationCounter counter;
+  auto map =
+      EncodableValueView::FromMessage(message.data(), message.size()).AsMap();
+  EXPECT_EQ(map.Find("timestamp").AsInt64(), 7);
+  auto samples = map.Find("samples").AsFloat64List();
+  ASSERT_EQ(samples.size(), kSampleCount);
+  const double* data = samples.data();
+  EXPECT_EQ(counter.count(), 0u);
+
+  // The elements are aligned relative to the start of the message, so they
+  // are read in place rather than copied.
+  ASSERT_NE(data, nullptr);
+  EXPECT_GE(reinterpret_cast<const uint8_t*>(data), message.data());
+  EXPECT_LT(reinterpret_cast<const uint8_t*>(data),
+            message.data() + message.size());
+  EXPECT_EQ(data[kSampleCount - 1], (kSampleCount - 1) * 0.5);
+}
+
+TEST(StandardCodecTest, ViewOfMisalignedMessageCopiesElements) {
+  std::vector<uint8_t> message;
+  WriteSensorFrame(&message, 7);
+  std::vector<uint8_t> shifted(message.size() + 1);
+  std::memcpy(shifted.data() + 1, message.data(), message.size());
+
+  auto samples =
+      EncodableValueView::FromMessage(shifted.data() + 1, message.size())
+          .AsMap()
+          .Find("samples")
+          .AsFloat64List();
+  ASSERT_EQ(samples.size(), kSampleCount);
+  EXPECT_EQ(samples.data(), nullptr);
+  EXPECT_EQ(samples[2], 1.0);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -6,9 +6,15 @@
 
 namespace flutter {
 
+namespace {
+
+constexpr size_t kInitialSlotCount = 64;
+
+}  // namespace
+
 IncomingMessageDispatcher::IncomingMessageDispatcher(
     FlutterDesktopMessengerRef messenger)
-    : messenger_(messenger) {}
+    : messenger_(messenger), slots_(kInitialSlotCount, kEmptySlot) {}
 
 IncomingMessageDispatcher::~IncomingMessageDispatcher() = default;
 
@@ -17,23 +23,24 @@ void IncomingMessageDispatcher::HandleMessage(
     const FlutterDesktopMessage& message,
     const std::function<void(void)>& input_block_cb,
     const std::function<void(void)>& input_unblock_cb) {
-  std::string channel(message.channel);
+  std::string_view name(message.channel);
+  auto* channel = FindChannel(name, Hash(name));
 
   // Find the handler for the channel; if there isn't one, report the failure.
-  if (callbacks_.find(channel) == callbacks_.end()) {
+  if (!channel || !channel->callback) {
     FlutterDesktopMessengerSendResponse(messenger_, message.response_handle,
                                         nullptr, 0);
     return;
   }
-  auto& callback_info = callbacks_[channel];
-  FlutterDesktopMessageCallback message_callback = callback_info.first;
 
-  // Process the call, handling input blocking if requested.
-  bool block_input = input_blocking_channels_.count(channel) > 0;
+  // Process the call, handling input blocking if requested. The callback may
+  // register other channels, which moves |channel|, so it is not used after
+  // the call.
+  bool block_input = channel->input_blocking;
   if (block_input) {
     input_block_cb();
   }
-  message_callback(messenger_, &message, callback_info.second);
+  channel->callback(messenger_, &message, channel->user_data);
   if (block_input) {
     input_unblock_cb();
   }
@@ -44,15 +51,82 @@ void IncomingMessageDispatcher::SetMessageCallback(
     FlutterDesktopMessageCallback callback,
     void* user_data) {
   if (!callback) {
-    callbacks_.erase(channel);
+    // The channel stays interned, so that it can be registered again without
+    // rehashing.
+    auto* entry = FindChannel(channel, Hash(channel));
+    if (entry) {
+      entry->callback = nullptr;
+      entry->user_data = nullptr;
+    }
     return;
   }
-  callbacks_[channel] = std::make_pair(callback, user_data);
+  auto& entry = InternChannel(channel);
+  entry.callback = callback;
+  entry.user_data = user_data;
 }
 
 void IncomingMessageDispatcher::EnableInputBlockingForChannel(
     const std::string& channel) {
-  input_blocking_channels_.insert(channel);
+  InternChannel(channel).input_blocking = true;
+}
+
+uint64_t IncomingMessageDispatcher::Hash(std::string_view name) {
+  uint64_t hash = 14695981039346656037ull;
+  for (auto c : name) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+IncomingMessageDispatcher::Channel* IncomingMessageDispatcher::FindChannel(
+    std::string_view name,
+    uint64_t hash) {
+  auto mask = slots_.size() - 1;
+  for (auto i = hash & mask;; i = (i + 1) & mask) {
+    auto index = slots_[i];
+    if (index == kEmptySlot) {
+      return nullptr;
+    }
+    auto& channel = channels_[index];
+    if (channel.hash == hash && channel.name == name) {
+      return &channel;
+    }
+  }
+}
+
+IncomingMessageDispatcher::Channel& IncomingMessageDispatcher::InternChannel(
+    std::string_view name) {
+  auto hash = Hash(name);
+  auto* channel = FindChannel(name, hash);
+  if (channel) {
+    return *channel;
+  }
+
+  channels_.push_back(Channel{std::string(name), hash});
+  if (channels_.size() * 2 > slots_.size()) {
+    Rehash(slots_.size() * 2);
+  } else {
+    auto mask = slots_.size() - 1;
+    auto i = hash & mask;
+    while (slots_[i] != kEmptySlot) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = static_cast<uint32_t>(channels_.size() - 1);
+  }
+  return channels_.back();
+}
+
+void IncomingMessageDispatcher::Rehash(size_t slot_count) {
+  slots_.assign(slot_count, kEmptySlot);
+  auto mask = slot_count - 1;
+  for (size_t index = 0; index < channels_.size(); index++) {
+    auto i = channels_[index].hash & mask;
+    while (slots_[i] != kEmptySlot) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = static_cast<uint32_t>(index);
+  }
 }
 
 }  // namespace flutter
@@ -5,11 +5,11 @@
 #ifndef FLUTTER_SHELL_PLATFORM_CPP_INCOMING_MESSAGE_DISPATCHER_H_
 #define FLUTTER_SHELL_PLATFORM_CPP_INCOMING_MESSAGE_DISPATCHER_H_
 
+#include <cstdint>
 #include <functional>
-#include <map>
-#include <set>
 #include <string>
-#include <utility>
+#include <string_view>
+#include <vector>
 
 #include "flutter/shell/platform/common/public/flutter_messenger.h"
 
@@ -17,6 +17,11 @@ namespace flutter {
 
 // Manages per-channel registration of callbacks for handling messages from the
 // Flutter engine, and dispatching incoming messages to those handlers.
+//
+// Channel names are interned when a callback is registered or input blocking
+// is enabled, into an open-addressing hash table whose entries are never
+// removed. Dispatching a message hashes its channel name once and probes the
+// table without copying the name, so it doesn't allocate.
 class IncomingMessageDispatcher {
  public:
   // Creates a new IncomingMessageDispatcher. |messenger| must remain valid as
@@ -59,18 +64,44 @@ class IncomingMessageDispatcher {
   void EnableInputBlockingForChannel(const std::string& channel);
 
  private:
+  struct Channel {
+    std::string name;
+    uint64_t hash;
+
+    // The callback to be called for incoming messages on the channel, or null
+    // if the channel has no handler, along with the user data to pass to it.
+    FlutterDesktopMessageCallback callback = nullptr;
+    void* user_data = nullptr;
+
+    // Whether input blocking should be enabled during the call to the
+    // channel's handler.
+    bool input_blocking = false;
+  };
+
+  // Marks an empty slot of |slots_|.
+  static constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+  // Returns the FNV-1a hash of |name|.
+  static uint64_t Hash(std::string_view name);
+
+  // Returns the channel named |name|, or null if it has not been interned.
+  Channel* FindChannel(std::string_view name, uint64_t hash);
+
+  // Returns the channel named |name|, which is interned if needed.
+  Channel& InternChannel(std::string_view name);
+
+  // Rebuilds |slots_| with |slot_count| slots.
+  void Rehash(size_t slot_count);
+
   // Handle for interacting with the C messaging API.
   FlutterDesktopMessengerRef messenger_;
 
-  // A map from channel names to the FlutterDesktopMessageCallback that should
-  // be called for incoming messages on that channel, along with the void* user
-  // data to pass to it.
-  std::map<std::string, std::pair<FlutterDesktopMessageCallback, void*>>
-      callbacks_;
+  // The interned channels, in the order they were interned.
+  std::vector<Channel> channels_;
 
-  // Channel names for which input blocking should be enabled during the call to
-  // that channel's handler.
-  std::set<std::string> input_blocking_channels_;
+  // The hash table of indices into |channels_|, probed linearly. Its size is a
+  // power of two and at least twice the number of channels.
+  std::vector<uint32_t> slots_;
 };
 
 }  // namespace flutter
@@ -0,0 +1,76 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures dispatching platform messages to the callbacks of many channels
+// with long names, like those of a set of plugins.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/common/incoming_message_dispatcher.h"
+#include "flutter/shell/platform/linux_embedded/testing/allocation_counter.h"
+
+namespace flutter {
+
+namespace {
+
+void CountMessage(FlutterDesktopMessengerRef messenger,
+                  const FlutterDesktopMessage* message,
+                  void* user_data) {
+  (*static_cast<int64_t*>(user_data))++;
+}
+
+// Returns the names of |count| channels, which share a long prefix.
+std::vector<std::string> GetChannelNames(int64_t count) {
+  std::vector<std::string> names;
+  for (int64_t i = 0; i < count; i++) {
+    names.push_back("plugins.flutter.io/some_long_plugin_channel_" +
+                    std::to_string(i));
+  }
+  return names;
+}
+
+void BM_HandleMessage(benchmark::State& state) {
+  // Every message is handled, so no response is sent to the messenger.
+  IncomingMessageDispatcher dispatcher(nullptr);
+  auto names = GetChannelNames(state.range(0));
+  int64_t handled_count = 0;
+  for (const auto& name : names) {
+    dispatcher.SetMessageCallback(name, CountMessage, &handled_count);
+  }
+  dispatcher.EnableInputBlockingForChannel(names[0]);
+
+  // The engine gives every message its own copy of the channel name.
+  auto channels = GetChannelNames(state.range(0));
+  std::function<void(void)> input_cb = [] {};
+  size_t index = 0;
+  testing::ScopedAllocationCounter counter;
+  for (auto _ : state) {
+    FlutterDesktopMessage message = {
+        sizeof(FlutterDesktopMessage),
+        channels[index].c_str(),
+        nullptr,
+        0,
+        nullptr,
+    };
+    dispatcher.HandleMessage(message, input_cb, input_cb);
+    index = index + 1 == channels.size() ? 0 : index + 1;
+  }
+  auto allocations = counter.count();
+  if (handled_count != state.iterations()) {
+    state.SkipWithError("Messages were not handled.");
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocs_per_message"] = benchmark::Counter(
+      allocations, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_HandleMessage)->Arg(4)->Arg(40);
+
+}  // namespace
+
+}  // namespace flutter
@@ -0,0 +1,131 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/common/incoming_message_dispatcher.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/testing/allocation_counter.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// The number of channels, enough to rehash the table of the dispatcher.
+constexpr int kChannelCount = 40;
+
+// Records the channel of each message in the vector of strings at
+// |user_data|.
+void RecordMessage(FlutterDesktopMessengerRef messenger,
+                   const FlutterDesktopMessage* message,
+                   void* user_data) {
+  static_cast<std::vector<std::string>*>(user_data)->push_back(
+      message->channel);
+}
+
+void CountMessage(FlutterDesktopMessengerRef messenger,
+                  const FlutterDesktopMessage* message,
+                  void* user_data) {
+  (*static_cast<int*>(user_data))++;
+}
+
+std::string GetChannelName(int index) {
+  return "plugins.flutter.io/some_long_plugin_channel_" +
+         std::to_string(index);
+}
+
+FlutterDesktopMessage CreateMessage(const std::string& channel) {
+  return {sizeof(FlutterDesktopMessage), channel.c_str(), nullptr, 0,
+          nullptr};
+}
+
+}  // namespace
+
+TEST(IncomingMessageDispatcherTest, DispatchesToCallbackOfChannel) {
+  IncomingMessageDispatcher dispatcher(nullptr);
+  std::vector<std::vector<std::string>> received(kChannelCount);
+  for (int i = 0; i < kChannelCount; i++) {
+    dispatcher.SetMessageCallback(GetChannelName(i), RecordMessage,
+                                  &received[i]);
+  }
+
+  for (int i = kChannelCount - 1; i >= 0; i--) {
+    auto channel = GetChannelName(i);
+    dispatcher.HandleMessage(CreateMessage(channel));
+  }
+  for (int i = 0; i < kChannelCount; i++) {
+    ASSERT_EQ(received[i].size(), 1u);
+    EXPECT_EQ(received[i][0], GetChannelName(i));
+  }
+}
+
+TEST(IncomingMessageDispatcherTest, BlocksInputOnlyForEnabledChannels) {
+  IncomingMessageDispatcher dispatcher(nullptr);
+  int handled_count = 0;
+  dispatcher.SetMessageCallback(GetChannelName(0), CountMessage,
+                                &handled_count);
+  dispatcher.SetMessageCallback(GetChannelName(1), CountMessage,
+                                &handled_count);
+  dispatcher.EnableInputBlockingForChannel(GetChannelName(1));
+
+  int block_count = 0;
+  int unblock_count = 0;
+  auto block = [&block_count]() { block_count++; };
+  auto unblock = [&unblock_count]() { unblock_count++; };
+  auto channel = GetChannelName(0);
+  dispatcher.HandleMessage(CreateMessage(channel), block, unblock);
+  EXPECT_EQ(block_count, 0);
+  channel = GetChannelName(1);
+  dispatcher.HandleMessage(CreateMessage(channel), block, unblock);
+  EXPECT_EQ(block_count, 1);
+  EXPECT_EQ(unblock_count, 1);
+  EXPECT_EQ(handled_count, 2);
+}
+
+TEST(IncomingMessageDispatcherTest, UnregisteredChannelCanBeRegisteredAgain) {
+  IncomingMessageDispatcher dispatcher(nullptr);
+  int first_count = 0;
+  int second_count = 0;
+  auto channel = GetChannelName(0);
+  dispatcher.SetMessageCallback(channel, CountMessage, &first_count);
+  dispatcher.HandleMessage(CreateMessage(channel));
+  dispatcher.SetMessageCallback(channel, nullptr, nullptr);
+  dispatcher.SetMessageCallback(channel, CountMessage, &second_count);
+  dispatcher.HandleMessage(CreateMessage(channel));
+  EXPECT_EQ(first_count, 1);
+  EXPECT_EQ(second_count, 1);
+}
+
+TEST(IncomingMessageDispatcherTest, HandleMessageDoesNotAllocate) {
+  IncomingMessageDispatcher dispatcher(nullptr);
+  int handled_count = 0;
+  for (int i = 0; i < kChannelCount; i++) {
+    dispatcher.SetMessageCallback(GetChannelName(i), CountMessage,
+                                  &handled_count);
+  }
+  dispatcher.EnableInputBlockingForChannel(GetChannelName(3));
+
+  // The engine gives every message its own copy of the channel name.
+  std::vector<std::string> channels;
+  for (int i = 0; i < kChannelCount; i++) {
+    channels.push_back(GetChannelName(i));
+  }
+  std::function<void(void)> input_cb = [] {};
+
+  ScopedAllocationCounter counter;
+  for (int round = 0; round < 10; round++) {
+    for (const auto& channel : channels) {
+      dispatcher.HandleMessage(CreateMessage(channel), input_cb, input_cb);
+    }
+  }
+  EXPECT_EQ(counter.count(), 0u);
+  EXPECT_EQ(handled_count, 10 * kChannelCount);
+}
+
+}  // namespace testing
+}  // namespace flutter
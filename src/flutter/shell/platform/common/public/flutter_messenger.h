@@ -50,6 +50,10 @@ typedef void (*FlutterDesktopMessageCallback)(
     const FlutterDesktopMessage* /* message*/,
     void* /* user data */);
 
+// Function pointer type for releasing the user data of a message handler
+// callback which runs on a worker thread.
+typedef void (*FlutterDesktopMessageCallbackRelease)(void* /* user data */);
+
 // Sends a binary message to the Flutter side on the specified channel.
 FLUTTER_EXPORT bool FlutterDesktopMessengerSend(
     FlutterDesktopMessengerRef messenger,
@@ -87,6 +91,29 @@ FLUTTER_EXPORT void FlutterDesktopMessengerSetCallback(
     FlutterDesktopMessageCallback callback,
     void* user_data);
 
+// Registers a callback function like FlutterDesktopMessengerSetCallback, but
+// which is called on a worker thread of the embedder instead of the platform
+// thread, so that a slow handler doesn't delay input and rendering.
+//
+// The messages of a channel are handled one at a time and in order, while the
+// messages of different channels may be handled concurrently. The message
+// passed to |callback| is a copy which is valid during the call, and the
+// response may be sent with FlutterDesktopMessengerSendResponse from the
+// worker thread.
+//
+// Replacing or unregistering the callback of the channel, with either
+// function, doesn't wait for the messages already queued on it, which are
+// still passed to |callback| with |user_data|. |release|, if not null, is
+// then called with |user_data| on the worker thread, after which |user_data|
+// is no longer used. It is called on the calling thread instead if the
+// callback is still registered when the engine is destroyed.
+FLUTTER_EXPORT void FlutterDesktopMessengerSetBackgroundCallback(
+    FlutterDesktopMessengerRef messenger,
+    const char* channel,
+    FlutterDesktopMessageCallback callback,
+    void* user_data,
+    FlutterDesktopMessageCallbackRelease release);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
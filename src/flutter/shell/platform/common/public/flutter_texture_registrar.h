@@ -23,9 +23,42 @@ typedef struct FlutterDesktopTextureRegistrar*
 // Additional types may be added in the future.
 typedef enum {
   // A Pixel buffer-based texture.
-  kFlutterDesktopPixelBufferTexture
+  kFlutterDesktopPixelBufferTexture,
+  // A DMA-BUF-based texture, which is imported into GL without copying.
+  kFlutterDesktopDmaBufTexture,
+  // A pixel buffer-based texture, whose buffers also tell their format and
+  // the region which has changed.
+  kFlutterDesktopPixelBufferDescriptorTexture
 } FlutterDesktopTextureType;
 
+// Possible values for the format specified in
+// FlutterDesktopPixelBufferDescriptor.
+// The planes of a multi-planar format are tightly packed one after another in
+// the buffer. The YUV formats use BT.601 limited range.
+typedef enum {
+  // 8-bit R, G, B and A, in this byte order.
+  kFlutterDesktopPixelFormatRGBA8888,
+  // 8-bit B, G, R and A, in this byte order.
+  kFlutterDesktopPixelFormatBGRA8888,
+  // 16-bit native-endian words with 5-bit R, 6-bit G and 5-bit B, from the
+  // most significant bit.
+  kFlutterDesktopPixelFormatRGB565,
+  // An 8-bit Y plane followed by an interleaved 8-bit U/V plane, which is
+  // subsampled by 2 in both directions.
+  kFlutterDesktopPixelFormatNV12,
+  // 8-bit Y, U and V planes, where U and V are subsampled by 2 in both
+  // directions.
+  kFlutterDesktopPixelFormatI420
+} FlutterDesktopPixelFormat;
+
+// A rectangle in a pixel buffer.
+typedef struct {
+  size_t x;
+  size_t y;
+  size_t width;
+  size_t height;
+} FlutterDesktopPixelBufferRect;
+
 // An image buffer object.
 typedef struct {
   // The pixel data buffer.
@@ -36,6 +69,25 @@ typedef struct {
   size_t height;
 } FlutterDesktopPixelBuffer;
 
+// An image buffer object, with its format and the region which has changed.
+typedef struct {
+  // The size of this struct. Must be
+  // sizeof(FlutterDesktopPixelBufferDescriptor).
+  size_t struct_size;
+  // The pixel data buffer.
+  const uint8_t* buffer;
+  // Width of the pixel buffer.
+  size_t width;
+  // Height of the pixel buffer.
+  size_t height;
+  // The format of the pixel data.
+  FlutterDesktopPixelFormat format;
+  // The region which has changed since the previous frame. Only this region
+  // is uploaded if the size of the buffer is unchanged. A zero-sized rect
+  // means the whole buffer. This is ignored for the YUV formats.
+  FlutterDesktopPixelBufferRect dirty_rect;
+} FlutterDesktopPixelBufferDescriptor;
+
 // The pixel buffer copy callback definition provided to
 // the Flutter engine to copy the texture.
 // It is invoked with the intended surface size specified by |width| and
@@ -58,10 +110,87 @@ typedef struct {
   void* user_data;
 } FlutterDesktopPixelBufferTextureConfig;
 
+// The pixel buffer descriptor callback definition provided to the Flutter
+// engine to copy the texture. It is invoked like
+// FlutterDesktopPixelBufferTextureCallback, and has the same requirements.
+typedef const FlutterDesktopPixelBufferDescriptor* (
+    *FlutterDesktopPixelBufferDescriptorCallback)(size_t width,
+                                                  size_t height,
+                                                  void* user_data);
+
+// An object used to configure pixel buffer descriptor textures.
+typedef struct {
+  // The callback used by the engine to copy the pixel buffer object.
+  FlutterDesktopPixelBufferDescriptorCallback callback;
+  // Opaque data that will get passed to the provided |callback|.
+  void* user_data;
+} FlutterDesktopPixelBufferDescriptorTextureConfig;
+
+// The maximum number of planes of a DMA-BUF.
+#define FLUTTER_DESKTOP_DMA_BUF_MAX_PLANES 4
+
+// The DRM format modifier which means that the layout is implied by the
+// driver (DRM_FORMAT_MOD_INVALID).
+#define FLUTTER_DESKTOP_DMA_BUF_MODIFIER_INVALID 0x00ffffffffffffffULL
+
+// A plane of a DMA-BUF.
+typedef struct {
+  // The DMA-BUF file descriptor.
+  int fd;
+  // Offset of the plane in bytes.
+  uint32_t offset;
+  // Row stride of the plane in bytes.
+  uint32_t stride;
+} FlutterDesktopDmaBufPlane;
+
+// A buffer object shared by DMA-BUF.
+typedef struct {
+  // Width of the buffer.
+  size_t width;
+  // Height of the buffer.
+  size_t height;
+  // The DRM fourcc code of the pixel format (see drm_fourcc.h).
+  uint32_t fourcc;
+  // The DRM format modifier, or FLUTTER_DESKTOP_DMA_BUF_MODIFIER_INVALID.
+  uint64_t modifier;
+  // Number of valid entries in |planes|.
+  uint32_t num_planes;
+  FlutterDesktopDmaBufPlane planes[FLUTTER_DESKTOP_DMA_BUF_MAX_PLANES];
+  // A sync_file fd which signals when the producer has finished writing the
+  // buffer, or -1 if the buffer is ready. The embedder takes the ownership of
+  // the fd and closes it.
+  int fence_fd;
+} FlutterDesktopDmaBuffer;
+
+// The DMA-BUF callback definition provided to the Flutter engine to get the
+// buffer to show. It is invoked with the intended surface size specified by
+// |width| and |height| and the |user_data| held by
+// FlutterDesktopDmaBufTextureConfig.
+//
+// As this is usually called from the render thread, the callee must take
+// care of proper synchronization. The imported buffer is cached by the
+// DMA-BUFs which its fds refer to and its layout, so the fds need only stay
+// open during the call, and may be duplicates of earlier ones.
+typedef const FlutterDesktopDmaBuffer* (*FlutterDesktopDmaBufTextureCallback)(
+    size_t width,
+    size_t height,
+    void* user_data);
+
+// An object used to configure DMA-BUF textures.
+typedef struct {
+  // The callback used by the engine to get the DMA-BUF.
+  FlutterDesktopDmaBufTextureCallback callback;
+  // Opaque data that will get passed to the provided |callback|.
+  void* user_data;
+} FlutterDesktopDmaBufTextureConfig;
+
 typedef struct {
   FlutterDesktopTextureType type;
   union {
     FlutterDesktopPixelBufferTextureConfig pixel_buffer_config;
+    FlutterDesktopDmaBufTextureConfig dma_buf_config;
+    FlutterDesktopPixelBufferDescriptorTextureConfig
+        pixel_buffer_descriptor_config;
   };
 } FlutterDesktopTextureInfo;
 
@@ -0,0 +1,140 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/channel_task_queues.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace flutter {
+
+ChannelTaskQueues::ChannelTaskQueues(IncomingMessageDispatcher* dispatcher)
+    : dispatcher_(dispatcher) {}
+
+ChannelTaskQueues::~ChannelTaskQueues() {
+  // Destroying the pool runs the queued tasks, which only answer the messages
+  // now, so that the callbacks which are still registered are no longer used.
+  DropPendingMessages();
+  worker_pool_.reset();
+  for (auto& channel : channels_) {
+    if (channel.second->release) {
+      channel.second->release(channel.second->user_data);
+    }
+  }
+}
+
+void ChannelTaskQueues::SetMessageCallback(
+    const std::string& channel,
+    FlutterDesktopMessageCallback callback,
+    void* user_data) {
+  auto it = channels_.find(channel);
+  if (it != channels_.end()) {
+    ClearCallback(*it->second);
+  }
+  dispatcher_->SetMessageCallback(channel, callback, user_data);
+}
+
+void ChannelTaskQueues::SetWorkerMessageCallback(
+    const std::string& channel,
+    FlutterDesktopMessageCallback callback,
+    void* user_data,
+    FlutterDesktopMessageCallbackRelease release) {
+  if (!callback) {
+    SetMessageCallback(channel, nullptr, nullptr);
+    return;
+  }
+
+  auto it = channels_.find(channel);
+  if (it == channels_.end()) {
+    if (!worker_pool_) {
+      worker_pool_ = std::make_unique<WorkerPool>(kWorkerThreadCount);
+    }
+    it = channels_
+             .emplace(channel, std::make_unique<Channel>(
+                                   channel, worker_pool_.get(),
+                                   &drops_messages_))
+             .first;
+  } else {
+    ClearCallback(*it->second);
+  }
+  auto& entry = *it->second;
+  entry.callback = callback;
+  entry.user_data = user_data;
+  entry.release = release;
+  dispatcher_->SetMessageCallback(channel, PostMessage, &entry);
+}
+
+bool ChannelTaskQueues::WaitUntilIdle(std::chrono::milliseconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (auto& channel : channels_) {
+    if (!channel.second->queue.WaitUntilIdle(deadline)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ChannelTaskQueues::WaitUntilIdle() {
+  for (auto& channel : channels_) {
+    channel.second->queue.WaitUntilIdle();
+  }
+}
+
+void ChannelTaskQueues::DropPendingMessages() {
+  drops_messages_.store(true, std::memory_order_relaxed);
+}
+
+// static
+void ChannelTaskQueues::ClearCallback(Channel& channel) {
+  if (channel.release) {
+    channel.queue.PostTask(
+        [release = channel.release, user_data = channel.user_data]() {
+          release(user_data);
+        });
+  }
+  channel.callback = nullptr;
+  channel.user_data = nullptr;
+  channel.release = nullptr;
+}
+
+// static
+void ChannelTaskQueues::PostMessage(FlutterDesktopMessengerRef messenger,
+                                    const FlutterDesktopMessage* message,
+                                    void* user_data) {
+  auto channel = static_cast<Channel*>(user_data);
+
+  // The callback and the user data are captured, since they may be replaced
+  // on the platform thread while the message is queued.
+  auto callback = channel->callback;
+  auto callback_user_data = channel->user_data;
+  auto name = channel->name.c_str();
+  auto drops_messages = channel->drops_messages;
+  auto response_handle = message->response_handle;
+  std::vector<uint8_t> data(message->message,
+                            message->message + message->message_size);
+  channel->queue.PostTask([messenger, callback, callback_user_data, name,
+                           drops_messages, response_handle,
+                           data = std::move(data)]() {
+    if (drops_messages->load(std::memory_order_relaxed)) {
+      // Like a message without a handler, so that the engine releases the
+      // response handle and the Dart side gets null.
+      if (response_handle) {
+        FlutterDesktopMessengerSendResponse(messenger, response_handle,
+                                            nullptr, 0);
+      }
+      return;
+    }
+    FlutterDesktopMessage message = {
+        sizeof(FlutterDesktopMessage), name, data.data(), data.size(),
+        response_handle,
+    };
+    // The handler replies with FlutterDesktopMessengerSendResponse from this
+    // thread, which is safe because the engine posts the response to the
+    // Dart thread.
+    callback(messenger, &message, callback_user_data);
+  });
+}
+
+}  // namespace flutter
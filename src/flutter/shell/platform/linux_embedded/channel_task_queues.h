@@ -0,0 +1,122 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_CHANNEL_TASK_QUEUES_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_CHANNEL_TASK_QUEUES_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "flutter/shell/platform/common/incoming_message_dispatcher.h"
+#include "flutter/shell/platform/common/public/flutter_messenger.h"
+#include "flutter/shell/platform/linux_embedded/worker_pool.h"
+
+namespace flutter {
+
+// Registers the message callbacks of channels with an
+// IncomingMessageDispatcher, either to be called on the platform thread, or on
+// a pool of worker threads so that a slow handler (file I/O, database access,
+// image decoding, etc.) doesn't delay the input and the frames.
+//
+// Each channel which runs on the workers has its own SerialTaskQueue, so its
+// messages are handled one at a time and in order, while the messages of
+// different channels are handled concurrently. The pool is only started when
+// the first such channel is registered.
+//
+// Replacing a callback never waits for the workers. The messages queued on
+// the channel are still handled by the previous callback, and the release of
+// its user data is queued after them.
+class ChannelTaskQueues {
+ public:
+  // The number of worker threads.
+  static constexpr size_t kWorkerThreadCount = 2;
+
+  // |dispatcher| must outlive this object.
+  explicit ChannelTaskQueues(IncomingMessageDispatcher* dispatcher);
+
+  // Drops the queued messages, waits for the running ones to be handled, then
+  // releases the user data of the callbacks which run on the workers.
+  ~ChannelTaskQueues();
+
+  // Prevent copying.
+  ChannelTaskQueues(ChannelTaskQueues const&) = delete;
+  ChannelTaskQueues& operator=(ChannelTaskQueues const&) = delete;
+
+  // Registers |callback| to be called with |user_data| on the platform thread
+  // for the messages on |channel|. Replaces any existing callback, and a null
+  // callback unregisters it. Platform thread only.
+  void SetMessageCallback(const std::string& channel,
+                          FlutterDesktopMessageCallback callback,
+                          void* user_data);
+
+  // Registers |callback| like SetMessageCallback, but to be called on a worker
+  // thread. |release|, if not null, is called with |user_data| on a worker
+  // thread once the callback has been replaced and the messages queued for it
+  // have been handled, or by the destructor if it is still registered then.
+  // Platform thread only.
+  void SetWorkerMessageCallback(const std::string& channel,
+                                FlutterDesktopMessageCallback callback,
+                                void* user_data,
+                                FlutterDesktopMessageCallbackRelease release);
+
+  // Blocks until the messages queued on all the channels have been handled,
+  // or |timeout| has passed. Returns false on timeout.
+  bool WaitUntilIdle(std::chrono::milliseconds timeout);
+
+  // Blocks until the messages queued on all the channels have been handled.
+  void WaitUntilIdle();
+
+  // Makes the messages which are queued, or queued from now on, be answered
+  // with an empty response instead of being passed to the callbacks, e.g.
+  // before the plugins are destroyed. The messages which are being handled
+  // are not affected, and the user data is still released after them. Can be
+  // called from any thread.
+  void DropPendingMessages();
+
+ private:
+  struct Channel {
+    Channel(const std::string& name,
+            WorkerPool* pool,
+            const std::atomic<bool>* drops_messages)
+        : name(name), drops_messages(drops_messages), queue(pool) {}
+
+    std::string name;
+    const std::atomic<bool>* drops_messages;
+    FlutterDesktopMessageCallback callback = nullptr;
+    void* user_data = nullptr;
+    FlutterDesktopMessageCallbackRelease release = nullptr;
+    SerialTaskQueue queue;
+  };
+
+  // Clears the callback of |channel|, and posts the release of its user data
+  // after the messages queued on the channel.
+  static void ClearCallback(Channel& channel);
+
+  // The callback registered with the dispatcher for the channels which run on
+  // the workers. Copies |message|, whose data is only valid during the call,
+  // and posts it to the queue of the channel.
+  static void PostMessage(FlutterDesktopMessengerRef messenger,
+                          const FlutterDesktopMessage* message,
+                          void* user_data);
+
+  IncomingMessageDispatcher* dispatcher_;
+
+  // Set by DropPendingMessages(), and read by the tasks on the workers.
+  std::atomic<bool> drops_messages_{false};
+
+  // The channels which have run on the workers, which are kept until this
+  // object is destroyed because their queues may still have tasks.
+  std::map<std::string, std::unique_ptr<Channel>> channels_;
+
+  // Declared after |channels_| so that it is destroyed, i.e. finishes the
+  // queued tasks, before the queues are.
+  std::unique_ptr<WorkerPool> worker_pool_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_CHANNEL_TASK_QUEUES_H_
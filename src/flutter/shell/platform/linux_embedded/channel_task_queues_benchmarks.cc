@@ -0,0 +1,106 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how late the platform thread handles input events while a slow
+// plugin, e.g. one which queries a database, receives messages, with its
+// handler on the platform thread and on the worker threads.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "flutter/shell/platform/common/incoming_message_dispatcher.h"
+#include "flutter/shell/platform/linux_embedded/channel_task_queues.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr char kChannelName[] = "plugins.flutter.io/database";
+
+// The interval of the input events, as of a 250 Hz touch panel.
+constexpr std::chrono::milliseconds kInputInterval{4};
+
+// The interval of the messages to the plugin, and how long each takes.
+constexpr std::chrono::milliseconds kMessageInterval{100};
+constexpr std::chrono::milliseconds kMessageDuration{40};
+
+// How long the platform loop runs per iteration.
+constexpr std::chrono::seconds kRunDuration{1};
+
+void HandleSlowly(FlutterDesktopMessengerRef messenger,
+                  const FlutterDesktopMessage* message,
+                  void* user_data) {
+  std::this_thread::sleep_for(kMessageDuration);
+}
+
+// Runs a platform loop which handles an input event every kInputInterval and
+// dispatches a message to the plugin every kMessageInterval, and returns how
+// late each input event was handled, in milliseconds.
+std::vector<double> RunPlatformLoop(IncomingMessageDispatcher& dispatcher) {
+  using Clock = std::chrono::steady_clock;
+  std::vector<double> delays;
+  uint8_t payload[64] = {};
+  auto start = Clock::now();
+  auto next_input = start;
+  auto next_message = start;
+  while (Clock::now() - start < kRunDuration) {
+    auto now = Clock::now();
+    while (next_input <= now) {
+      delays.push_back(
+          std::chrono::duration<double, std::milli>(now - next_input).count());
+      next_input += kInputInterval;
+    }
+    if (next_message <= now) {
+      FlutterDesktopMessage message = {
+          sizeof(FlutterDesktopMessage), kChannelName, payload,
+          sizeof(payload),               nullptr,
+      };
+      dispatcher.HandleMessage(message);
+      next_message += kMessageInterval;
+    }
+    std::this_thread::sleep_until(std::min(next_input, next_message));
+  }
+  return delays;
+}
+
+// Returns the |fraction| quantile of the sorted |values|.
+double GetQuantile(const std::vector<double>& values, double fraction) {
+  return values[static_cast<size_t>(fraction * (values.size() - 1))];
+}
+
+void BM_InputDelayWithSlowPlugin(benchmark::State& state) {
+  auto run_on_worker_pool = state.range(0) != 0;
+  std::vector<double> delays;
+  for (auto _ : state) {
+    IncomingMessageDispatcher dispatcher(nullptr);
+    ChannelTaskQueues queues(&dispatcher);
+    if (run_on_worker_pool) {
+      queues.SetWorkerMessageCallback(kChannelName, HandleSlowly, nullptr,
+                                      nullptr);
+    } else {
+      queues.SetMessageCallback(kChannelName, HandleSlowly, nullptr);
+    }
+    auto run_delays = RunPlatformLoop(dispatcher);
+    delays.insert(delays.end(), run_delays.begin(), run_delays.end());
+  }
+  std::sort(delays.begin(), delays.end());
+  state.counters["p50_ms"] = GetQuantile(delays, 0.5);
+  state.counters["p99_ms"] = GetQuantile(delays, 0.99);
+  state.counters["max_ms"] = delays.back();
+}
+BENCHMARK(BM_InputDelayWithSlowPlugin)
+    ->ArgName("worker_pool")
+    ->Arg(0)
+    ->Arg(1)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace flutter
@@ -0,0 +1,260 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/channel_task_queues.h"
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/testing/engine_embedder_api_modifier.h"
+#include "flutter/shell/platform/linux_embedded/testing/test_engine.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr char kChannelName[] = "plugins.flutter.io/database";
+
+// Records what the callbacks and the releases are called for, in order.
+class Recorder {
+ public:
+  void Add(const std::string& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back(entry);
+  }
+
+  std::vector<std::string> entries() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::string> entries_;
+};
+
+// The user data of a callback. It is released when the ChannelTaskQueues is
+// destroyed, so it must outlive it.
+struct Handler {
+  std::string name;
+  Recorder* recorder;
+
+  // If set, the first message waits for this before it is handled.
+  std::shared_future<void> blocker;
+
+  // If set, is fulfilled when the first message starts to wait for
+  // |blocker|.
+  std::promise<void>* started = nullptr;
+};
+
+// Records the message, and replies with its data if it expects a response.
+void HandleMessage(FlutterDesktopMessengerRef messenger,
+                   const FlutterDesktopMessage* message,
+                   void* user_data) {
+  auto handler = static_cast<Handler*>(user_data);
+  if (handler->blocker.valid()) {
+    if (handler->started) {
+      handler->started->set_value();
+    }
+    handler->blocker.wait();
+    handler->blocker = {};
+  }
+  handler->recorder->Add(
+      handler->name + ":" +
+      std::string(reinterpret_cast<const char*>(message->message),
+                  message->message_size));
+  if (message->response_handle) {
+    FlutterDesktopMessengerSendResponse(messenger, message->response_handle,
+                                        message->message,
+                                        message->message_size);
+  }
+}
+
+void ReleaseHandler(void* user_data) {
+  auto handler = static_cast<Handler*>(user_data);
+  handler->recorder->Add(handler->name + ":released");
+}
+
+void Dispatch(IncomingMessageDispatcher& dispatcher,
+              const std::string& data,
+              const FlutterDesktopMessageResponseHandle* response_handle =
+                  nullptr) {
+  FlutterDesktopMessage message = {
+      sizeof(FlutterDesktopMessage),
+      kChannelName,
+      reinterpret_cast<const uint8_t*>(data.data()),
+      data.size(),
+      response_handle,
+  };
+  dispatcher.HandleMessage(message);
+}
+
+// The responses sent to the fake engine, as the handle and the data size.
+std::mutex sent_responses_mutex;
+std::vector<std::pair<const FlutterPlatformMessageResponseHandle*, size_t>>
+    sent_responses;
+
+FlutterEngineResult RecordResponse(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    const uint8_t* data,
+    size_t data_length) {
+  std::lock_guard<std::mutex> lock(sent_responses_mutex);
+  sent_responses.emplace_back(handle, data_length);
+  return kSuccess;
+}
+
+// Where RecordPluginsDestroyed records, since the callback has no user data.
+Recorder* plugins_recorder = nullptr;
+
+void RecordPluginsDestroyed(FlutterDesktopPluginRegistrarRef registrar) {
+  plugins_recorder->Add("plugins:destroyed");
+}
+
+}  // namespace
+
+TEST(ChannelTaskQueuesTest, ReplacingCallbackReleasesAfterQueuedMessages) {
+  Recorder recorder;
+  std::promise<void> unblock;
+  Handler first = {"first", &recorder, unblock.get_future().share()};
+  Handler second = {"second", &recorder, {}};
+  IncomingMessageDispatcher dispatcher(nullptr);
+  ChannelTaskQueues queues(&dispatcher);
+
+  queues.SetWorkerMessageCallback(kChannelName, HandleMessage, &first,
+                                  ReleaseHandler);
+  Dispatch(dispatcher, "1");
+  Dispatch(dispatcher, "2");
+
+  // The first message is still being handled, so this would never return if
+  // it waited for the queued messages.
+  queues.SetWorkerMessageCallback(kChannelName, HandleMessage, &second,
+                                  ReleaseHandler);
+  Dispatch(dispatcher, "3");
+  EXPECT_TRUE(recorder.entries().empty());
+
+  unblock.set_value();
+  EXPECT_TRUE(queues.WaitUntilIdle(std::chrono::seconds(10)));
+  std::vector<std::string> expected = {"first:1", "first:2", "first:released",
+                                       "second:3"};
+  EXPECT_EQ(recorder.entries(), expected);
+}
+
+TEST(ChannelTaskQueuesTest, MovingCallbackToPlatformThreadReleasesIt) {
+  Recorder recorder;
+  Handler background = {"background", &recorder, {}};
+  Handler platform = {"platform", &recorder, {}};
+  IncomingMessageDispatcher dispatcher(nullptr);
+  ChannelTaskQueues queues(&dispatcher);
+
+  queues.SetWorkerMessageCallback(kChannelName, HandleMessage, &background,
+                                  ReleaseHandler);
+  Dispatch(dispatcher, "1");
+  queues.SetMessageCallback(kChannelName, HandleMessage, &platform);
+  EXPECT_TRUE(queues.WaitUntilIdle(std::chrono::seconds(10)));
+
+  // The platform callback is called during the dispatch.
+  Dispatch(dispatcher, "2");
+  std::vector<std::string> expected = {"background:1", "background:released",
+                                       "platform:2"};
+  EXPECT_EQ(recorder.entries(), expected);
+}
+
+TEST(ChannelTaskQueuesTest, WaitUntilIdleTimesOut) {
+  Recorder recorder;
+  std::promise<void> unblock;
+  Handler handler = {"handler", &recorder, unblock.get_future().share()};
+  IncomingMessageDispatcher dispatcher(nullptr);
+  ChannelTaskQueues queues(&dispatcher);
+
+  queues.SetWorkerMessageCallback(kChannelName, HandleMessage, &handler,
+                                  nullptr);
+  Dispatch(dispatcher, "1");
+  EXPECT_FALSE(queues.WaitUntilIdle(std::chrono::milliseconds(10)));
+
+  unblock.set_value();
+  EXPECT_TRUE(queues.WaitUntilIdle(std::chrono::seconds(10)));
+}
+
+TEST(ChannelTaskQueuesTest, EngineStopDropsMessagesQueuedBehindStuckHandler) {
+  sent_responses.clear();
+  Recorder recorder;
+  plugins_recorder = &recorder;
+  std::promise<void> unblock;
+  Handler handler = {"handler", &recorder, unblock.get_future().share()};
+  auto engine = CreateTestEngine();
+  EngineEmbedderApiModifier modifier(engine.get());
+  modifier.embedder_api().SendPlatformMessageResponse = RecordResponse;
+  ASSERT_TRUE(engine->RunWithEntrypoint(nullptr));
+  engine->SetPluginRegistrarDestructionCallback(RecordPluginsDestroyed);
+
+  engine->channel_task_queues()->SetWorkerMessageCallback(
+      kChannelName, HandleMessage, &handler, ReleaseHandler);
+  // The fake engine never dereferences the handles.
+  int handles[3];
+  for (int i = 0; i < 3; i++) {
+    Dispatch(*engine->message_dispatcher(), std::to_string(i + 1),
+             reinterpret_cast<const FlutterDesktopMessageResponseHandle*>(
+                 &handles[i]));
+  }
+
+  // The first message is handled until well after Stop() has stopped
+  // waiting for the queued messages.
+  std::thread stopper([&engine]() { engine->Stop(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  EXPECT_TRUE(recorder.entries().empty());
+  unblock.set_value();
+  stopper.join();
+  engine.reset();
+
+  // The plugins are destroyed after the running handler has returned, and
+  // the queued messages are answered without reaching it.
+  std::vector<std::string> expected = {"handler:1", "plugins:destroyed",
+                                       "handler:released"};
+  EXPECT_EQ(recorder.entries(), expected);
+  ASSERT_EQ(sent_responses.size(), 3u);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(sent_responses[i].first,
+              reinterpret_cast<const FlutterPlatformMessageResponseHandle*>(
+                  &handles[i]));
+    EXPECT_EQ(sent_responses[i].second, i == 0 ? 1u : 0u);
+  }
+}
+
+TEST(ChannelTaskQueuesTest, DestructorDropsQueuedMessagesAndReleases) {
+  Recorder recorder;
+  std::promise<void> started;
+  std::promise<void> unblock;
+  Handler handler = {"handler", &recorder, unblock.get_future().share(),
+                     &started};
+  IncomingMessageDispatcher dispatcher(nullptr);
+  std::thread unblocker;
+  {
+    ChannelTaskQueues queues(&dispatcher);
+    queues.SetWorkerMessageCallback(kChannelName, HandleMessage, &handler,
+                                    ReleaseHandler);
+    Dispatch(dispatcher, "1");
+    Dispatch(dispatcher, "2");
+    started.get_future().wait();
+
+    // Lets the running message return while the destructor waits for it.
+    unblocker = std::thread([&unblock]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      unblock.set_value();
+    });
+  }
+  unblocker.join();
+  std::vector<std::string> expected = {"handler:1", "handler:released"};
+  EXPECT_EQ(recorder.entries(), expected);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,117 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/event_loop.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+namespace {
+constexpr int kMaxEpollEvents = 8;
+constexpr int64_t kNanosecondsPerSecond = 1000000000;
+}  // namespace
+
+EventLoop::EventLoop() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ == -1) {
+    LINUXES_LOG(ERROR) << "Failed to create epoll instance: "
+                       << strerror(errno);
+    return;
+  }
+
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd_ == -1) {
+    LINUXES_LOG(ERROR) << "Failed to create timerfd: " << strerror(errno);
+    return;
+  }
+  AddFd(timer_fd_);
+}
+
+EventLoop::~EventLoop() {
+  if (timer_fd_ != -1) {
+    close(timer_fd_);
+  }
+  if (epoll_fd_ != -1) {
+    close(epoll_fd_);
+  }
+}
+
+bool EventLoop::AddFd(int fd) {
+  if (epoll_fd_ == -1 || fd == -1) {
+    return false;
+  }
+
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+    LINUXES_LOG(ERROR) << "Failed to add fd " << fd
+                       << " to epoll: " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+void EventLoop::RemoveFd(int fd) {
+  if (epoll_fd_ == -1 || fd == -1) {
+    return;
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+bool EventLoop::Wait(std::chrono::nanoseconds timeout) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  // The next task is already due.
+  if (timeout.count() <= 0) {
+    return true;
+  }
+
+  // Use timerfd instead of the timeout of epoll_wait because the latter only
+  // has a millisecond resolution.
+  if (!ArmTimer(timeout)) {
+    return false;
+  }
+
+  epoll_event events[kMaxEpollEvents];
+  auto count = epoll_wait(epoll_fd_, events, kMaxEpollEvents, -1);
+  if (count == -1) {
+    if (errno == EINTR) {
+      return true;
+    }
+    LINUXES_LOG(ERROR) << "Failed to wait for events: " << strerror(errno);
+    return false;
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (events[i].data.fd == timer_fd_) {
+      uint64_t expirations;
+      read(timer_fd_, &expirations, sizeof(expirations));
+    }
+  }
+  return true;
+}
+
+bool EventLoop::ArmTimer(std::chrono::nanoseconds timeout) {
+  itimerspec spec = {};
+  if (timeout != std::chrono::nanoseconds::max()) {
+    spec.it_value.tv_sec = timeout.count() / kNanosecondsPerSecond;
+    spec.it_value.tv_nsec = timeout.count() % kNanosecondsPerSecond;
+  }
+  if (timerfd_settime(timer_fd_, 0, &spec, nullptr) == -1) {
+    LINUXES_LOG(ERROR) << "Failed to arm timerfd: " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace flutter
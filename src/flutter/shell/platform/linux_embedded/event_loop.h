@@ -0,0 +1,55 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EVENT_LOOP_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EVENT_LOOP_H_
+
+#include <chrono>
+
+namespace flutter {
+
+// Waits on a set of file descriptors (window system events, libinput, etc.)
+// and a timer, so that the platform thread can sleep until either an input
+// event arrives or the next Flutter task is due.
+class EventLoop {
+ public:
+  EventLoop();
+  ~EventLoop();
+
+  // Prevent copying.
+  EventLoop(EventLoop const&) = delete;
+  EventLoop& operator=(EventLoop const&) = delete;
+
+  bool IsValid() const { return epoll_fd_ != -1 && timer_fd_ != -1; }
+
+  // Returns the epoll file descriptor. It becomes readable when one of the
+  // watched file descriptors is readable or the timer has expired.
+  int GetFd() const { return epoll_fd_; }
+
+  // Adds |fd| to the set of watched file descriptors. The owner is
+  // responsible for draining |fd| after Wait() returns.
+  bool AddFd(int fd);
+
+  // Removes |fd| from the set of watched file descriptors.
+  void RemoveFd(int fd);
+
+  // Blocks until one of the watched file descriptors becomes readable or
+  // |timeout| elapses. A timeout of std::chrono::nanoseconds::max() waits
+  // forever, and a non-positive timeout returns immediately.
+  //
+  // Returns false if waiting failed.
+  bool Wait(std::chrono::nanoseconds timeout);
+
+ private:
+  // Arms the timer to expire after |timeout|, or disarms it if |timeout| is
+  // std::chrono::nanoseconds::max().
+  bool ArmTimer(std::chrono::nanoseconds timeout);
+
+  int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EVENT_LOOP_H_
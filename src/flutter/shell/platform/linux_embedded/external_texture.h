@@ -0,0 +1,32 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EXTERNAL_TEXTURE_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EXTERNAL_TEXTURE_H_
+
+#include <stdint.h>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+namespace flutter {
+
+// An abstraction of a texture provided by a plugin.
+class ExternalTexture {
+ public:
+  virtual ~ExternalTexture() = default;
+
+  // Returns the unique id of this texture.
+  int64_t texture_id() { return reinterpret_cast<int64_t>(this); }
+
+  // Attempts to populate the specified |opengl_texture| with texture details
+  // such as the name, width, height and the pixel format.
+  // Returns true on success.
+  virtual bool PopulateTexture(size_t width,
+                               size_t height,
+                               FlutterOpenGLTexture* opengl_texture) = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EXTERNAL_TEXTURE_H_
@@ -0,0 +1,374 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/external_texture_dmabuf.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef USE_GLES3
+#include <GLES3/gl32.h>
+#else
+#include <GLES2/gl2.h>
+#endif
+#include <GLES2/gl2ext.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/surface/egl_utils.h"
+
+namespace {
+
+// The number of imported buffers to keep. Producers usually cycle through a
+// small pool of buffers, so that each of them is imported only once.
+constexpr size_t kMaxCachedImages = 4;
+
+// Bounds the wait for a fence on the CPU.
+constexpr int kFenceTimeoutMs = 1000;
+
+constexpr EGLint kPlaneAttributes[FLUTTER_DESKTOP_DMA_BUF_MAX_PLANES][5] = {
+    {EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+     EGL_DMA_BUF_PLANE0_PITCH_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+     EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
+    {EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+     EGL_DMA_BUF_PLANE1_PITCH_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+     EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
+    {EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+     EGL_DMA_BUF_PLANE2_PITCH_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+     EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT},
+    {EGL_DMA_BUF_PLANE3_FD_EXT, EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+     EGL_DMA_BUF_PLANE3_PITCH_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+     EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT},
+};
+
+typedef void (*glGenTexturesProc)(GLsizei n, GLuint* textures);
+typedef void (*glDeleteTexturesProc)(GLsizei n, const GLuint* textures);
+typedef void (*glBindTextureProc)(GLenum target, GLuint texture);
+typedef void (*glTexParameteriProc)(GLenum target, GLenum pname, GLint param);
+
+// A struct containing pointers to resolved gl* and egl* functions.
+struct DmaBufProcs {
+  glGenTexturesProc glGenTextures;
+  glDeleteTexturesProc glDeleteTextures;
+  glBindTextureProc glBindTexture;
+  glTexParameteriProc glTexParameteri;
+  PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+  PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR;
+  PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR;
+  PFNEGLCREATESYNCKHRPROC eglCreateSyncKHR;
+  PFNEGLDESTROYSYNCKHRPROC eglDestroySyncKHR;
+  PFNEGLWAITSYNCKHRPROC eglWaitSyncKHR;
+  bool valid;
+};
+
+static const DmaBufProcs& DmaBufProcs() {
+  static struct DmaBufProcs procs = {};
+  static bool initialized = false;
+  if (!initialized) {
+    procs.glGenTextures =
+        reinterpret_cast<glGenTexturesProc>(eglGetProcAddress("glGenTextures"));
+    procs.glDeleteTextures = reinterpret_cast<glDeleteTexturesProc>(
+        eglGetProcAddress("glDeleteTextures"));
+    procs.glBindTexture =
+        reinterpret_cast<glBindTextureProc>(eglGetProcAddress("glBindTexture"));
+    procs.glTexParameteri = reinterpret_cast<glTexParameteriProc>(
+        eglGetProcAddress("glTexParameteri"));
+    procs.glEGLImageTargetTexture2DOES =
+        reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+            eglGetProcAddress("glEGLImageTargetTexture2DOES"));
+    procs.eglCreateImageKHR = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(
+        eglGetProcAddress("eglCreateImageKHR"));
+    procs.eglDestroyImageKHR = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(
+        eglGetProcAddress("eglDestroyImageKHR"));
+    procs.eglCreateSyncKHR = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(
+        eglGetProcAddress("eglCreateSyncKHR"));
+    procs.eglDestroySyncKHR = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(
+        eglGetProcAddress("eglDestroySyncKHR"));
+    procs.eglWaitSyncKHR = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(
+        eglGetProcAddress("eglWaitSyncKHR"));
+
+    procs.valid = procs.glGenTextures && procs.glDeleteTextures &&
+                  procs.glBindTexture && procs.glTexParameteri &&
+                  procs.glEGLImageTargetTexture2DOES &&
+                  procs.eglCreateImageKHR && procs.eglDestroyImageKHR;
+    initialized = true;
+  }
+  return procs;
+}
+
+// Identifies the DMA-BUF which an fd refers to. Unlike the fd number, it
+// stays the same when the fd is duplicated, and can't be reused by another
+// buffer while an EGLImage of the buffer exists.
+struct DmaBufId {
+  dev_t device;
+  ino_t inode;
+};
+
+// Gets the ids of the planes of |buffer|. Returns false if an fd is invalid.
+bool GetDmaBufIds(const FlutterDesktopDmaBuffer& buffer, DmaBufId* ids) {
+  for (uint32_t i = 0; i < buffer.num_planes; i++) {
+    struct stat st;
+    if (fstat(buffer.planes[i].fd, &st) == -1) {
+      return false;
+    }
+    ids[i] = {st.st_dev, st.st_ino};
+  }
+  return true;
+}
+
+// Returns true if |a| and |b| refer to the same memory with the same layout.
+bool IsSameBuffer(const FlutterDesktopDmaBuffer& a,
+                  const DmaBufId* a_ids,
+                  const FlutterDesktopDmaBuffer& b,
+                  const DmaBufId* b_ids) {
+  if (a.width != b.width || a.height != b.height || a.fourcc != b.fourcc ||
+      a.modifier != b.modifier || a.num_planes != b.num_planes) {
+    return false;
+  }
+  for (uint32_t i = 0; i < a.num_planes; i++) {
+    if (a_ids[i].device != b_ids[i].device ||
+        a_ids[i].inode != b_ids[i].inode ||
+        a.planes[i].offset != b.planes[i].offset ||
+        a.planes[i].stride != b.planes[i].stride) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+namespace flutter {
+
+struct ExternalTextureDmaBufState {
+  // An imported buffer.
+  struct Image {
+    FlutterDesktopDmaBuffer buffer;
+    DmaBufId ids[FLUTTER_DESKTOP_DMA_BUF_MAX_PLANES];
+    EGLImageKHR egl_image;
+    GLuint gl_texture;
+  };
+
+  EGLDisplay display = EGL_NO_DISPLAY;
+  bool dma_buf_import_supported = false;
+  bool modifiers_supported = false;
+  bool native_fence_supported = false;
+
+  // Imported buffers, the most recently used last.
+  std::vector<Image> images;
+};
+
+ExternalTextureDmaBuf::ExternalTextureDmaBuf(
+    FlutterDesktopDmaBufTextureCallback texture_callback,
+    void* user_data)
+    : state_(std::make_unique<ExternalTextureDmaBufState>()),
+      texture_callback_(texture_callback),
+      user_data_(user_data) {}
+
+ExternalTextureDmaBuf::~ExternalTextureDmaBuf() {
+  const auto& procs = DmaBufProcs();
+  if (!procs.valid) {
+    return;
+  }
+  for (const auto& image : state_->images) {
+    procs.glDeleteTextures(1, &image.gl_texture);
+    procs.eglDestroyImageKHR(state_->display, image.egl_image);
+  }
+}
+
+bool ExternalTextureDmaBuf::PopulateTexture(
+    size_t width,
+    size_t height,
+    FlutterOpenGLTexture* opengl_texture) {
+  const FlutterDesktopDmaBuffer* buffer =
+      texture_callback_(width, height, user_data_);
+  if (!buffer) {
+    return false;
+  }
+
+  auto texture = ObtainTexture(*buffer);
+  WaitForFence(buffer->fence_fd);
+  if (texture == 0) {
+    return false;
+  }
+
+  // Populate the texture object used by the engine.
+  opengl_texture->target = GL_TEXTURE_EXTERNAL_OES;
+  opengl_texture->name = texture;
+#ifdef USE_GLES3
+  opengl_texture->format = GL_RGBA8;
+#else
+  opengl_texture->format = GL_RGBA8_OES;
+#endif
+  opengl_texture->destruction_callback = nullptr;
+  opengl_texture->user_data = nullptr;
+  opengl_texture->width = buffer->width;
+  opengl_texture->height = buffer->height;
+
+  return true;
+}
+
+uint32_t ExternalTextureDmaBuf::ObtainTexture(
+    const FlutterDesktopDmaBuffer& buffer) {
+  const auto& procs = DmaBufProcs();
+  if (!procs.valid) {
+    return 0;
+  }
+
+  auto& state = *state_;
+  if (state.display == EGL_NO_DISPLAY) {
+    state.display = eglGetCurrentDisplay();
+    if (state.display == EGL_NO_DISPLAY) {
+      LINUXES_LOG(ERROR) << "No EGL display is current.";
+      return 0;
+    }
+    auto extensions = eglQueryString(state.display, EGL_EXTENSIONS);
+    std::string egl_extensions = extensions ? extensions : "";
+    state.dma_buf_import_supported =
+        egl_extensions.find("EGL_EXT_image_dma_buf_import") !=
+        std::string::npos;
+    state.modifiers_supported =
+        egl_extensions.find("EGL_EXT_image_dma_buf_import_modifiers") !=
+        std::string::npos;
+    state.native_fence_supported =
+        procs.eglCreateSyncKHR && procs.eglDestroySyncKHR &&
+        procs.eglWaitSyncKHR &&
+        egl_extensions.find("EGL_ANDROID_native_fence_sync") !=
+            std::string::npos &&
+        egl_extensions.find("EGL_KHR_wait_sync") != std::string::npos;
+    if (!state.dma_buf_import_supported) {
+      LINUXES_LOG(ERROR) << "EGL_EXT_image_dma_buf_import is not supported.";
+    }
+  }
+  if (!state.dma_buf_import_supported) {
+    return 0;
+  }
+
+  if (buffer.num_planes == 0 ||
+      buffer.num_planes > FLUTTER_DESKTOP_DMA_BUF_MAX_PLANES) {
+    LINUXES_LOG(ERROR) << "Invalid number of DMA-BUF planes: "
+                       << buffer.num_planes;
+    return 0;
+  }
+  DmaBufId ids[FLUTTER_DESKTOP_DMA_BUF_MAX_PLANES];
+  if (!GetDmaBufIds(buffer, ids)) {
+    LINUXES_LOG(ERROR) << "Invalid DMA-BUF fd: " << strerror(errno);
+    return 0;
+  }
+
+  for (auto it = state.images.begin(); it != state.images.end(); ++it) {
+    if (IsSameBuffer(it->buffer, it->ids, buffer, ids)) {
+      auto texture = it->gl_texture;
+      std::rotate(it, it + 1, state.images.end());
+      return texture;
+    }
+  }
+  const bool has_modifier =
+      buffer.modifier != FLUTTER_DESKTOP_DMA_BUF_MODIFIER_INVALID;
+  if (has_modifier && !state.modifiers_supported) {
+    LINUXES_LOG(ERROR) << "DMA-BUF format modifiers are not supported.";
+    return 0;
+  }
+
+  std::vector<EGLint> attributes = {
+      EGL_WIDTH,
+      static_cast<EGLint>(buffer.width),
+      EGL_HEIGHT,
+      static_cast<EGLint>(buffer.height),
+      EGL_LINUX_DRM_FOURCC_EXT,
+      static_cast<EGLint>(buffer.fourcc),
+  };
+  for (uint32_t i = 0; i < buffer.num_planes; i++) {
+    const auto& plane = buffer.planes[i];
+    attributes.insert(attributes.end(),
+                      {kPlaneAttributes[i][0], plane.fd,
+                       kPlaneAttributes[i][1],
+                       static_cast<EGLint>(plane.offset),
+                       kPlaneAttributes[i][2],
+                       static_cast<EGLint>(plane.stride)});
+    if (has_modifier) {
+      attributes.insert(
+          attributes.end(),
+          {kPlaneAttributes[i][3],
+           static_cast<EGLint>(buffer.modifier & 0xffffffff),
+           kPlaneAttributes[i][4], static_cast<EGLint>(buffer.modifier >> 32)});
+    }
+  }
+  attributes.push_back(EGL_NONE);
+
+  auto egl_image = procs.eglCreateImageKHR(state.display, EGL_NO_CONTEXT,
+                                           EGL_LINUX_DMA_BUF_EXT, nullptr,
+                                           attributes.data());
+  if (egl_image == EGL_NO_IMAGE_KHR) {
+    LINUXES_LOG(ERROR) << "Failed to import a DMA-BUF: "
+                       << get_egl_error_cause();
+    return 0;
+  }
+
+  GLuint texture;
+  procs.glGenTextures(1, &texture);
+  procs.glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture);
+  procs.glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S,
+                        GL_CLAMP_TO_EDGE);
+  procs.glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T,
+                        GL_CLAMP_TO_EDGE);
+  procs.glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER,
+                        GL_LINEAR);
+  procs.glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER,
+                        GL_LINEAR);
+  procs.glEGLImageTargetTexture2DOES(GL_TEXTURE_EXTERNAL_OES, egl_image);
+
+  if (state.images.size() >= kMaxCachedImages) {
+    const auto& oldest = state.images.front();
+    procs.glDeleteTextures(1, &oldest.gl_texture);
+    procs.eglDestroyImageKHR(state.display, oldest.egl_image);
+    state.images.erase(state.images.begin());
+  }
+  state.images.push_back({buffer, {}, egl_image, texture});
+  state.images.back().buffer.fence_fd = -1;
+  std::copy(ids, ids + buffer.num_planes, state.images.back().ids);
+
+  return texture;
+}
+
+void ExternalTextureDmaBuf::WaitForFence(int fence_fd) {
+  if (fence_fd < 0) {
+    return;
+  }
+
+  const auto& procs = DmaBufProcs();
+  if (state_->native_fence_supported) {
+    const EGLint attributes[] = {
+        EGL_SYNC_NATIVE_FENCE_FD_ANDROID,
+        fence_fd,
+        EGL_NONE,
+    };
+    auto sync = procs.eglCreateSyncKHR(
+        state_->display, EGL_SYNC_NATIVE_FENCE_ANDROID, attributes);
+    if (sync != EGL_NO_SYNC_KHR) {
+      // The sync object owns |fence_fd| now. The wait is queued in the GL
+      // command stream, so the CPU doesn't block.
+      procs.eglWaitSyncKHR(state_->display, sync, 0);
+      procs.eglDestroySyncKHR(state_->display, sync);
+      return;
+    }
+    LINUXES_LOG(WARNING) << "Failed to import a fence: "
+                         << get_egl_error_cause();
+  }
+
+  pollfd fds = {fence_fd, POLLIN, 0};
+  while (poll(&fds, 1, kFenceTimeoutMs) == -1 && errno == EINTR) {
+  }
+  close(fence_fd);
+}
+
+}  // namespace flutter
@@ -0,0 +1,52 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EXTERNAL_TEXTURE_DMABUF_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EXTERNAL_TEXTURE_DMABUF_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "flutter/shell/platform/common/public/flutter_texture_registrar.h"
+#include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/external_texture.h"
+
+namespace flutter {
+
+typedef struct ExternalTextureDmaBufState ExternalTextureDmaBufState;
+
+// A texture which shows DMA-BUFs provided by a plugin without copying them.
+// The buffers are imported as EGLImages with EGL_EXT_image_dma_buf_import and
+// bound to GL_TEXTURE_EXTERNAL_OES textures.
+class ExternalTextureDmaBuf : public ExternalTexture {
+ public:
+  ExternalTextureDmaBuf(FlutterDesktopDmaBufTextureCallback texture_callback,
+                        void* user_data);
+
+  virtual ~ExternalTextureDmaBuf();
+
+  // |ExternalTexture|
+  bool PopulateTexture(size_t width,
+                       size_t height,
+                       FlutterOpenGLTexture* opengl_texture) override;
+
+ private:
+  // Returns the texture bound to |buffer|, importing |buffer| if it has not
+  // been imported yet. Returns 0 on failure.
+  uint32_t ObtainTexture(const FlutterDesktopDmaBuffer& buffer);
+
+  // Makes the GPU wait for |fence_fd| before sampling the texture, and closes
+  // |fence_fd|. Falls back to waiting on the CPU if the driver doesn't support
+  // native fences.
+  void WaitForFence(int fence_fd);
+
+  std::unique_ptr<ExternalTextureDmaBufState> state_;
+  FlutterDesktopDmaBufTextureCallback texture_callback_ = nullptr;
+  void* user_data_ = nullptr;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_EXTERNAL_TEXTURE_DMABUF_H_
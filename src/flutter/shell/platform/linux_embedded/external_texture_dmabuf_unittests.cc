@@ -0,0 +1,279 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/external_texture_dmabuf.h"
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <fcntl.h>
+#include <linux/udmabuf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "flutter/shell/platform/linux_embedded/testing/test_egl_context.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// DRM_FORMAT_XRGB8888.
+constexpr uint32_t kFourccXrgb8888 = 0x34325258;
+
+constexpr size_t kWidth = 64;
+constexpr size_t kHeight = 64;
+
+// The color of all pixels in the buffer, as 0xXXRRGGBB.
+constexpr uint32_t kPixel = 0xff336699;
+
+// A DMA-BUF backed by a memfd, created through /dev/udmabuf.
+class MemfdDmaBuf {
+ public:
+  MemfdDmaBuf(size_t width, size_t height, uint32_t pixel) {
+    const size_t size = width * height * sizeof(uint32_t);
+    int memfd = memfd_create("external_texture_dmabuf_unittests",
+                             MFD_ALLOW_SEALING | MFD_CLOEXEC);
+    if (memfd == -1) {
+      return;
+    }
+    if (ftruncate(memfd, size) == -1) {
+      close(memfd);
+      return;
+    }
+    auto pixels = static_cast<uint32_t*>(
+        mmap(nullptr, size, PROT_WRITE, MAP_SHARED, memfd, 0));
+    if (pixels != MAP_FAILED) {
+      for (size_t i = 0; i < width * height; i++) {
+        pixels[i] = pixel;
+      }
+      munmap(pixels, size);
+    }
+    // udmabuf requires that the memfd can't shrink.
+    fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK);
+
+    int device = open("/dev/udmabuf", O_RDWR | O_CLOEXEC);
+    if (device != -1) {
+      udmabuf_create create = {};
+      create.memfd = memfd;
+      create.flags = UDMABUF_FLAGS_CLOEXEC;
+      create.offset = 0;
+      create.size = size;
+      fd_ = ioctl(device, UDMABUF_CREATE, &create);
+      close(device);
+    }
+    close(memfd);
+  }
+
+  ~MemfdDmaBuf() {
+    if (fd_ != -1) {
+      close(fd_);
+    }
+  }
+
+  // Returns the DMA-BUF fd, or -1 if udmabuf is not available.
+  int fd() const { return fd_; }
+
+ private:
+  int fd_ = -1;
+};
+
+// Returns a readable fd which stands in for a signaled sync_file.
+int CreateSignaledFence() {
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) == -1) {
+    return -1;
+  }
+  char signal = 1;
+  write(fds[1], &signal, sizeof(signal));
+  close(fds[1]);
+  return fds[0];
+}
+
+bool IsFdOpen(int fd) {
+  return fcntl(fd, F_GETFD) != -1;
+}
+
+GLuint CompileShader(GLenum type, const char* source) {
+  auto shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  EXPECT_EQ(compiled, GL_TRUE);
+  return shader;
+}
+
+// Draws the external |texture| into a new framebuffer and returns the color
+// of its center pixel as RGBA bytes.
+void ReadExternalTexture(GLuint texture, uint8_t rgba[4]) {
+  constexpr char kVertexShader[] = R"(
+attribute vec2 position;
+varying vec2 uv;
+void main() {
+  uv = position * 0.5 + 0.5;
+  gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+  constexpr char kFragmentShader[] = R"(
+#extension GL_OES_EGL_image_external : require
+precision mediump float;
+uniform samplerExternalOES tex;
+varying vec2 uv;
+void main() {
+  gl_FragColor = texture2D(tex, uv);
+}
+)";
+
+  GLuint color_buffer;
+  glGenTextures(1, &color_buffer);
+  glBindTexture(GL_TEXTURE_2D, color_buffer);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kWidth, kHeight, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  GLuint framebuffer;
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         color_buffer, 0);
+  ASSERT_EQ(glCheckFramebufferStatus(GL_FRAMEBUFFER),
+            static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE));
+
+  auto program = glCreateProgram();
+  auto vertex_shader = CompileShader(GL_VERTEX_SHADER, kVertexShader);
+  auto fragment_shader = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glBindAttribLocation(program, 0, "position");
+  glLinkProgram(program);
+  glUseProgram(program);
+
+  const GLfloat vertices[] = {-1, -1, 1, -1, -1, 1, 1, 1};
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+  glEnableVertexAttribArray(0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture);
+  glUniform1i(glGetUniformLocation(program, "tex"), 0);
+  glViewport(0, 0, kWidth, kHeight);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glReadPixels(kWidth / 2, kHeight / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+  EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+  glDeleteProgram(program);
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &color_buffer);
+}
+
+// Serves |buffer| to ExternalTextureDmaBuf.
+const FlutterDesktopDmaBuffer* GetBuffer(size_t width,
+                                         size_t height,
+                                         void* user_data) {
+  return static_cast<const FlutterDesktopDmaBuffer*>(user_data);
+}
+
+FlutterDesktopDmaBuffer MakeBuffer(int fd) {
+  FlutterDesktopDmaBuffer buffer = {};
+  buffer.width = kWidth;
+  buffer.height = kHeight;
+  buffer.fourcc = kFourccXrgb8888;
+  buffer.modifier = FLUTTER_DESKTOP_DMA_BUF_MODIFIER_INVALID;
+  buffer.num_planes = 1;
+  buffer.planes[0].fd = fd;
+  buffer.planes[0].offset = 0;
+  buffer.planes[0].stride = kWidth * sizeof(uint32_t);
+  buffer.fence_fd = -1;
+  return buffer;
+}
+
+}  // namespace
+
+TEST(ExternalTextureDmaBufTest, FailsWithoutBuffer) {
+  ExternalTextureDmaBuf texture(GetBuffer, nullptr);
+  FlutterOpenGLTexture opengl_texture = {};
+  EXPECT_FALSE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+}
+
+TEST(ExternalTextureDmaBufTest, FailsWithoutCurrentContext) {
+  auto buffer = MakeBuffer(-1);
+  ExternalTextureDmaBuf texture(GetBuffer, &buffer);
+  FlutterOpenGLTexture opengl_texture = {};
+  EXPECT_FALSE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+}
+
+TEST(ExternalTextureDmaBufTest, ClosesFenceOfRejectedBuffer) {
+  TestEglContext context;
+  if (!context.IsValid()) {
+    GTEST_SKIP() << "No surfaceless EGL context.";
+  }
+
+  auto buffer = MakeBuffer(-1);
+  buffer.num_planes = 0;
+  buffer.fence_fd = CreateSignaledFence();
+  ASSERT_TRUE(IsFdOpen(buffer.fence_fd));
+
+  ExternalTextureDmaBuf texture(GetBuffer, &buffer);
+  FlutterOpenGLTexture opengl_texture = {};
+  EXPECT_FALSE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_FALSE(IsFdOpen(buffer.fence_fd));
+}
+
+TEST(ExternalTextureDmaBufTest, ImportsMemfdBackedBufferWithoutCopy) {
+  TestEglContext context;
+  if (!context.IsValid()) {
+    GTEST_SKIP() << "No surfaceless EGL context.";
+  }
+  if (!context.HasExtension("EGL_EXT_image_dma_buf_import")) {
+    GTEST_SKIP() << "EGL_EXT_image_dma_buf_import is not supported.";
+  }
+  MemfdDmaBuf dma_buf(kWidth, kHeight, kPixel);
+  if (dma_buf.fd() == -1) {
+    GTEST_SKIP() << "/dev/udmabuf is not available.";
+  }
+
+  auto buffer = MakeBuffer(dma_buf.fd());
+  buffer.fence_fd = CreateSignaledFence();
+  auto fence_fd = buffer.fence_fd;
+  ExternalTextureDmaBuf texture(GetBuffer, &buffer);
+  FlutterOpenGLTexture opengl_texture = {};
+  ASSERT_TRUE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_EQ(opengl_texture.target,
+            static_cast<uint32_t>(GL_TEXTURE_EXTERNAL_OES));
+  EXPECT_NE(opengl_texture.name, 0u);
+  EXPECT_EQ(opengl_texture.width, kWidth);
+  EXPECT_EQ(opengl_texture.height, kHeight);
+  EXPECT_FALSE(IsFdOpen(fence_fd));
+
+  uint8_t rgba[4];
+  ReadExternalTexture(opengl_texture.name, rgba);
+  EXPECT_NEAR(rgba[0], 0x33, 1);
+  EXPECT_NEAR(rgba[1], 0x66, 1);
+  EXPECT_NEAR(rgba[2], 0x99, 1);
+
+  // The same buffer is not imported again.
+  auto name = opengl_texture.name;
+  buffer.fence_fd = -1;
+  ASSERT_TRUE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_EQ(opengl_texture.name, name);
+
+  // Neither is it when it comes with another fd.
+  int duplicate = dup(dma_buf.fd());
+  buffer.planes[0].fd = duplicate;
+  ASSERT_TRUE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_EQ(opengl_texture.name, name);
+
+  // Another buffer behind the same fd number is imported.
+  MemfdDmaBuf other_dma_buf(kWidth, kHeight, kPixel);
+  ASSERT_NE(dup2(other_dma_buf.fd(), duplicate), -1);
+  ASSERT_TRUE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_NE(opengl_texture.name, name);
+  close(duplicate);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -10,11 +10,52 @@
 #include <GLES3/gl32.h>
 #else
 #include <GLES2/gl2.h>
-#include <GLES2/gl2ext.h>
 #endif
+#include <GLES2/gl2ext.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/pixel_format_converter_gl.h"
 
 namespace {
 
+// How pixels of a plane are stored in a texture.
+struct TextureFormat {
+  // The internal format passed to glTexImage2D.
+  GLint internal_format;
+  // The sized internal format, which is also reported to the engine.
+  GLenum sized_format;
+  GLenum format;
+  GLenum type;
+  size_t bytes_per_pixel;
+  // Whether immutable storage can be allocated with |sized_format|.
+  bool immutable;
+};
+
+#ifdef USE_GLES3
+constexpr TextureFormat kRgbaTextureFormat = {
+    GL_RGBA8, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, true};
+constexpr TextureFormat kRgb565TextureFormat = {
+    GL_RGB565, GL_RGB565, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2, true};
+#else
+constexpr TextureFormat kRgbaTextureFormat = {
+    GL_RGBA, GL_RGBA8_OES, GL_RGBA, GL_UNSIGNED_BYTE, 4, false};
+constexpr TextureFormat kRgb565TextureFormat = {
+    GL_RGB, GL_RGB565, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2, false};
+#endif
+// GL_EXT_texture_format_BGRA8888.
+constexpr TextureFormat kBgraTextureFormat = {
+    GL_BGRA_EXT, GL_BGRA8_EXT, GL_BGRA_EXT, GL_UNSIGNED_BYTE, 4, false};
+// YUV planes, which are only sampled by the conversion shaders.
+constexpr TextureFormat kLuminanceTextureFormat = {
+    GL_LUMINANCE, GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1, false};
+constexpr TextureFormat kLuminanceAlphaTextureFormat = {
+    GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA,
+    GL_UNSIGNED_BYTE,   2,                  false};
+
 typedef void (*glGenTexturesProc)(GLsizei n, GLuint* textures);
 typedef void (*glDeleteTexturesProc)(GLsizei n, const GLuint* textures);
 typedef void (*glBindTextureProc)(GLenum target, GLuint texture);
@@ -28,6 +69,36 @@ typedef void (*glTexImage2DProc)(GLenum target,
                                  GLenum format,
                                  GLenum type,
                                  const void* data);
+typedef void (*glTexSubImage2DProc)(GLenum target,
+                                    GLint level,
+                                    GLint xoffset,
+                                    GLint yoffset,
+                                    GLsizei width,
+                                    GLsizei height,
+                                    GLenum format,
+                                    GLenum type,
+                                    const void* data);
+typedef void (*glPixelStoreiProc)(GLenum pname, GLint param);
+typedef const GLubyte* (*glGetStringProc)(GLenum name);
+#ifdef USE_GLES3
+typedef void (*glTexStorage2DProc)(GLenum target,
+                                   GLsizei levels,
+                                   GLenum internalformat,
+                                   GLsizei width,
+                                   GLsizei height);
+typedef void (*glGenBuffersProc)(GLsizei n, GLuint* buffers);
+typedef void (*glDeleteBuffersProc)(GLsizei n, const GLuint* buffers);
+typedef void (*glBindBufferProc)(GLenum target, GLuint buffer);
+typedef void (*glBufferDataProc)(GLenum target,
+                                 GLsizeiptr size,
+                                 const void* data,
+                                 GLenum usage);
+typedef void* (*glMapBufferRangeProc)(GLenum target,
+                                      GLintptr offset,
+                                      GLsizeiptr length,
+                                      GLbitfield access);
+typedef GLboolean (*glUnmapBufferProc)(GLenum target);
+#endif
 
 // A struct containing pointers to resolved gl* functions.
 struct GlProcs {
@@ -36,7 +107,21 @@ struct GlProcs {
   glBindTextureProc glBindTexture;
   glTexParameteriProc glTexParameteri;
   glTexImage2DProc glTexImage2D;
+  glTexSubImage2DProc glTexSubImage2D;
+  glPixelStoreiProc glPixelStorei;
+  glGetStringProc glGetString;
   bool valid;
+#ifdef USE_GLES3
+  glTexStorage2DProc glTexStorage2D;
+  glGenBuffersProc glGenBuffers;
+  glDeleteBuffersProc glDeleteBuffers;
+  glBindBufferProc glBindBuffer;
+  glBufferDataProc glBufferData;
+  glMapBufferRangeProc glMapBufferRange;
+  glUnmapBufferProc glUnmapBuffer;
+  // Whether pixel-unpack buffers can be used to stream the pixels.
+  bool pixel_unpack_buffer_valid;
+#endif
 };
 
 static const GlProcs& GlProcs() {
@@ -53,10 +138,38 @@ static const GlProcs& GlProcs() {
         eglGetProcAddress("glTexParameteri"));
     procs.glTexImage2D =
         reinterpret_cast<glTexImage2DProc>(eglGetProcAddress("glTexImage2D"));
+    procs.glTexSubImage2D = reinterpret_cast<glTexSubImage2DProc>(
+        eglGetProcAddress("glTexSubImage2D"));
+    procs.glPixelStorei =
+        reinterpret_cast<glPixelStoreiProc>(eglGetProcAddress("glPixelStorei"));
+    procs.glGetString =
+        reinterpret_cast<glGetStringProc>(eglGetProcAddress("glGetString"));
 
     procs.valid = procs.glGenTextures && procs.glDeleteTextures &&
                   procs.glBindTexture && procs.glTexParameteri &&
-                  procs.glTexImage2D;
+                  procs.glTexImage2D && procs.glTexSubImage2D &&
+                  procs.glPixelStorei && procs.glGetString;
+
+#ifdef USE_GLES3
+    procs.glTexStorage2D = reinterpret_cast<glTexStorage2DProc>(
+        eglGetProcAddress("glTexStorage2D"));
+    procs.glGenBuffers =
+        reinterpret_cast<glGenBuffersProc>(eglGetProcAddress("glGenBuffers"));
+    procs.glDeleteBuffers = reinterpret_cast<glDeleteBuffersProc>(
+        eglGetProcAddress("glDeleteBuffers"));
+    procs.glBindBuffer =
+        reinterpret_cast<glBindBufferProc>(eglGetProcAddress("glBindBuffer"));
+    procs.glBufferData =
+        reinterpret_cast<glBufferDataProc>(eglGetProcAddress("glBufferData"));
+    procs.glMapBufferRange = reinterpret_cast<glMapBufferRangeProc>(
+        eglGetProcAddress("glMapBufferRange"));
+    procs.glUnmapBuffer =
+        reinterpret_cast<glUnmapBufferProc>(eglGetProcAddress("glUnmapBuffer"));
+
+    procs.pixel_unpack_buffer_valid =
+        procs.glGenBuffers && procs.glDeleteBuffers && procs.glBindBuffer &&
+        procs.glBufferData && procs.glMapBufferRange && procs.glUnmapBuffer;
+#endif
     initialized = true;
   }
   return procs;
@@ -64,12 +177,186 @@ static const GlProcs& GlProcs() {
 
 }  // namespace
 
+
 namespace flutter {
 
 struct ExternalTextureGLState {
-  GLuint gl_texture = 0;
+  // A texture holding a plane of the pixel buffer.
+  struct Plane {
+    GLuint texture = 0;
+    // The size and the format of the allocated storage.
+    size_t width = 0;
+    size_t height = 0;
+    GLint internal_format = 0;
+  };
+
+  // Binds the texture of plane |index| and (re)allocates its storage if the
+  // size or the format has changed. Returns true if the storage has been
+  // (re)allocated, i.e. the whole plane needs to be uploaded.
+  bool PreparePlane(int index,
+                    const TextureFormat& format,
+                    size_t width,
+                    size_t height);
+
+  // Uploads the region of |pixels| specified by |x|, |y|, |width| and
+  // |height| to the bound texture. |buffer_width| is the width of the whole
+  // plane.
+  void UploadPixels(const TextureFormat& format,
+                    const uint8_t* pixels,
+                    size_t buffer_width,
+                    size_t x,
+                    size_t y,
+                    size_t width,
+                    size_t height);
+
+  Plane planes[PixelFormatConverterGL::kMaxPlanes];
+
+  // Draws the planes of the formats which can't be sampled directly.
+  std::unique_ptr<PixelFormatConverterGL> converter;
+
+  // Whether GL_EXT_texture_format_BGRA8888 is supported. Queried on first use
+  // because a context must be current.
+  bool bgra_queried = false;
+  bool bgra_supported = false;
+
+  // The texture given to the engine.
+  GLuint texture = 0;
+  GLenum texture_format = 0;
+
+#ifdef USE_GLES3
+  // Pixel-unpack buffers used in turn, so that writing the pixels of a frame
+  // does not wait for the transfer of the previous frame.
+  static constexpr int kPixelUnpackBufferCount = 2;
+  GLuint pixel_unpack_buffers[kPixelUnpackBufferCount] = {};
+  size_t pixel_unpack_buffer_sizes[kPixelUnpackBufferCount] = {};
+  int pixel_unpack_buffer_index = 0;
+#endif
 };
 
+bool ExternalTextureGLState::PreparePlane(int index,
+                                          const TextureFormat& format,
+                                          size_t width,
+                                          size_t height) {
+  const auto& gl = GlProcs();
+  auto& plane = planes[index];
+  if (plane.texture != 0 && plane.width == width && plane.height == height &&
+      plane.internal_format == format.internal_format) {
+    gl.glBindTexture(GL_TEXTURE_2D, plane.texture);
+    return false;
+  }
+
+#ifdef USE_GLES3
+  // Immutable storage can't be reallocated, so a new texture is needed
+  // whenever the size or the format changes.
+  if (plane.texture != 0 && gl.glTexStorage2D) {
+    gl.glDeleteTextures(1, &plane.texture);
+    plane.texture = 0;
+  }
+#endif
+
+  if (plane.texture == 0) {
+    gl.glGenTextures(1, &plane.texture);
+
+    gl.glBindTexture(GL_TEXTURE_2D, plane.texture);
+
+#ifdef USE_GLES3
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+#else
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+                       GL_CLAMP_TO_BORDER_OES);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
+                       GL_CLAMP_TO_BORDER_OES);
+#endif
+
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  } else {
+    gl.glBindTexture(GL_TEXTURE_2D, plane.texture);
+  }
+
+#ifdef USE_GLES3
+  if (format.immutable && gl.glTexStorage2D) {
+    gl.glTexStorage2D(GL_TEXTURE_2D, 1, format.sized_format, width, height);
+  } else {
+    gl.glTexImage2D(GL_TEXTURE_2D, 0, format.internal_format, width, height, 0,
+                    format.format, format.type, nullptr);
+  }
+#else
+  gl.glTexImage2D(GL_TEXTURE_2D, 0, format.internal_format, width, height, 0,
+                  format.format, format.type, nullptr);
+#endif
+
+  plane.width = width;
+  plane.height = height;
+  plane.internal_format = format.internal_format;
+  return true;
+}
+
+void ExternalTextureGLState::UploadPixels(const TextureFormat& format,
+                                          const uint8_t* pixels,
+                                          size_t buffer_width,
+                                          size_t x,
+                                          size_t y,
+                                          size_t width,
+                                          size_t height) {
+  const auto& gl = GlProcs();
+  const size_t bytes_per_pixel = format.bytes_per_pixel;
+  const size_t stride = buffer_width * bytes_per_pixel;
+
+#ifdef USE_GLES3
+  if (gl.pixel_unpack_buffer_valid) {
+    const auto index = pixel_unpack_buffer_index;
+    pixel_unpack_buffer_index = (index + 1) % kPixelUnpackBufferCount;
+    if (pixel_unpack_buffers[0] == 0) {
+      gl.glGenBuffers(kPixelUnpackBufferCount, pixel_unpack_buffers);
+    }
+
+    // Pack the rows of the region tightly into the buffer. Invalidating the
+    // buffer lets the driver hand out fresh memory instead of waiting for a
+    // pending transfer.
+    const size_t row_size = width * bytes_per_pixel;
+    const size_t size = row_size * height;
+    gl.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_unpack_buffers[index]);
+    if (pixel_unpack_buffer_sizes[index] < size) {
+      gl.glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+      pixel_unpack_buffer_sizes[index] = size;
+    }
+    auto mapped = static_cast<uint8_t*>(
+        gl.glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (mapped) {
+      const uint8_t* src = pixels + y * stride + x * bytes_per_pixel;
+      if (row_size == stride) {
+        std::memcpy(mapped, src, size);
+      } else {
+        for (size_t row = 0; row < height; row++) {
+          std::memcpy(mapped + row * row_size, src + row * stride, row_size);
+        }
+      }
+      if (gl.glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+        gl.glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+                           format.format, format.type, nullptr);
+        gl.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+      }
+    }
+    // Fall back to a synchronous upload if the buffer couldn't be mapped.
+    gl.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  gl.glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer_width);
+  gl.glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format.format,
+                     format.type, pixels + y * stride + x * bytes_per_pixel);
+  gl.glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#else
+  // GLES2 has no GL_UNPACK_ROW_LENGTH, so upload the full rows covering the
+  // region.
+  gl.glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, buffer_width, height,
+                     format.format, format.type, pixels + y * stride);
+#endif
+}
+
 ExternalTextureGL::ExternalTextureGL(
     FlutterDesktopPixelBufferTextureCallback texture_callback,
     void* user_data)
@@ -77,11 +364,29 @@ ExternalTextureGL::ExternalTextureGL(
       texture_callback_(texture_callback),
       user_data_(user_data) {}
 
+ExternalTextureGL::ExternalTextureGL(
+    FlutterDesktopPixelBufferDescriptorCallback descriptor_callback,
+    void* user_data)
+    : state_(std::make_unique<ExternalTextureGLState>()),
+      descriptor_callback_(descriptor_callback),
+      user_data_(user_data) {}
+
 ExternalTextureGL::~ExternalTextureGL() {
   const auto& gl = GlProcs();
-  if (gl.valid && state_->gl_texture != 0) {
-    gl.glDeleteTextures(1, &state_->gl_texture);
+  if (!gl.valid) {
+    return;
+  }
+  for (auto& plane : state_->planes) {
+    if (plane.texture != 0) {
+      gl.glDeleteTextures(1, &plane.texture);
+    }
+  }
+#ifdef USE_GLES3
+  if (gl.pixel_unpack_buffer_valid && state_->pixel_unpack_buffers[0] != 0) {
+    gl.glDeleteBuffers(ExternalTextureGLState::kPixelUnpackBufferCount,
+                       state_->pixel_unpack_buffers);
   }
+#endif
 }
 
 bool ExternalTextureGL::PopulateTexture(size_t width,
@@ -93,12 +398,8 @@ bool ExternalTextureGL::PopulateTexture(size_t width,
 
   // Populate the texture object used by the engine.
   opengl_texture->target = GL_TEXTURE_2D;
-  opengl_texture->name = state_->gl_texture;
-#ifdef USE_GLES3
-  opengl_texture->format = GL_RGBA8;
-#else
-  opengl_texture->format = GL_RGBA8_OES;
-#endif
+  opengl_texture->name = state_->texture;
+  opengl_texture->format = state_->texture_format;
   opengl_texture->destruction_callback = nullptr;
   opengl_texture->user_data = nullptr;
   opengl_texture->width = width;
@@ -108,8 +409,28 @@ bool ExternalTextureGL::PopulateTexture(size_t width,
 }
 
 bool ExternalTextureGL::CopyPixelBuffer(size_t& width, size_t& height) {
-  const FlutterDesktopPixelBuffer* pixel_buffer =
-      texture_callback_(width, height, user_data_);
+  const FlutterDesktopPixelBufferDescriptor* pixel_buffer = nullptr;
+  FlutterDesktopPixelBufferDescriptor rgba_buffer = {};
+  if (descriptor_callback_) {
+    pixel_buffer = descriptor_callback_(width, height, user_data_);
+    if (pixel_buffer && pixel_buffer->struct_size <
+                            sizeof(FlutterDesktopPixelBufferDescriptor)) {
+      LINUXES_LOG(ERROR) << "Invalid struct_size of the pixel buffer: "
+                         << pixel_buffer->struct_size;
+      return false;
+    }
+  } else {
+    // A plain pixel buffer is an RGBA8888 buffer which is uploaded whole.
+    auto plain_buffer = texture_callback_(width, height, user_data_);
+    if (plain_buffer) {
+      rgba_buffer.struct_size = sizeof(FlutterDesktopPixelBufferDescriptor);
+      rgba_buffer.buffer = plain_buffer->buffer;
+      rgba_buffer.width = plain_buffer->width;
+      rgba_buffer.height = plain_buffer->height;
+      rgba_buffer.format = kFlutterDesktopPixelFormatRGBA8888;
+      pixel_buffer = &rgba_buffer;
+    }
+  }
   const auto& gl = GlProcs();
   if (!gl.valid || !pixel_buffer || !pixel_buffer->buffer) {
     return false;
@@ -117,36 +438,128 @@ bool ExternalTextureGL::CopyPixelBuffer(size_t& width, size_t& height) {
   width = pixel_buffer->width;
   height = pixel_buffer->height;
 
-  if (state_->gl_texture == 0) {
-    gl.glGenTextures(1, &state_->gl_texture);
+  // Rows of the 8-bit and 16-bit formats aren't 4-byte aligned in general.
+  gl.glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  auto result = pixel_buffer->format == kFlutterDesktopPixelFormatNV12 ||
+                        pixel_buffer->format == kFlutterDesktopPixelFormatI420
+                    ? CopyYuvPixelBuffer(*pixel_buffer)
+                    : CopyRgbPixelBuffer(*pixel_buffer);
+  gl.glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  return result;
+}
 
-    gl.glBindTexture(GL_TEXTURE_2D, state_->gl_texture);
+bool ExternalTextureGL::CopyRgbPixelBuffer(
+    const FlutterDesktopPixelBufferDescriptor& pixel_buffer) {
+  const auto& gl = GlProcs();
+  const auto width = pixel_buffer.width;
+  const auto height = pixel_buffer.height;
 
-#ifdef USE_GLES3
-    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-#else
-    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                       GL_CLAMP_TO_BORDER_OES);
-    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
-                       GL_CLAMP_TO_BORDER_OES);
-#endif
+  const TextureFormat* format = nullptr;
+  bool needs_conversion = false;
+  switch (pixel_buffer.format) {
+    case kFlutterDesktopPixelFormatRGBA8888:
+      format = &kRgbaTextureFormat;
+      break;
+    case kFlutterDesktopPixelFormatBGRA8888:
+      if (!state_->bgra_queried) {
+        auto extensions =
+            reinterpret_cast<const char*>(gl.glGetString(GL_EXTENSIONS));
+        state_->bgra_supported =
+            extensions && std::string(extensions).find(
+                              "GL_EXT_texture_format_BGRA8888") !=
+                              std::string::npos;
+        state_->bgra_queried = true;
+      }
+      // Without the extension, upload the bytes as RGBA and swap the red and
+      // the blue channels in a conversion pass.
+      format = state_->bgra_supported ? &kBgraTextureFormat
+                                      : &kRgbaTextureFormat;
+      needs_conversion = !state_->bgra_supported;
+      break;
+    case kFlutterDesktopPixelFormatRGB565:
+      format = &kRgb565TextureFormat;
+      break;
+    default:
+      LINUXES_LOG(ERROR) << "Unsupported pixel format: " << pixel_buffer.format;
+      return false;
+  }
 
-    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  // The whole buffer is uploaded when the storage is (re)allocated.
+  auto full_upload = state_->PreparePlane(0, *format, width, height);
+
+  size_t x = 0;
+  size_t y = 0;
+  size_t w = width;
+  size_t h = height;
+  const auto& dirty_rect = pixel_buffer.dirty_rect;
+  if (!full_upload && dirty_rect.width != 0 && dirty_rect.height != 0) {
+    x = std::min(dirty_rect.x, width);
+    y = std::min(dirty_rect.y, height);
+    w = std::min(dirty_rect.width, width - x);
+    h = std::min(dirty_rect.height, height - y);
+  }
+  if (w != 0 && h != 0) {
+    state_->UploadPixels(*format, pixel_buffer.buffer, width, x, y, w, h);
+  }
+
+  if (needs_conversion) {
+    return Convert(pixel_buffer.format, width, height);
+  }
+  state_->texture = state_->planes[0].texture;
+  state_->texture_format = format->sized_format;
+  return true;
+}
+
+bool ExternalTextureGL::CopyYuvPixelBuffer(
+    const FlutterDesktopPixelBufferDescriptor& pixel_buffer) {
+  const auto width = pixel_buffer.width;
+  const auto height = pixel_buffer.height;
+  const auto chroma_width = (width + 1) / 2;
+  const auto chroma_height = (height + 1) / 2;
+
+  const uint8_t* y_plane = pixel_buffer.buffer;
+  const uint8_t* chroma_planes = y_plane + width * height;
+  state_->PreparePlane(0, kLuminanceTextureFormat, width, height);
+  state_->UploadPixels(kLuminanceTextureFormat, y_plane, width, 0, 0, width,
+                       height);
 
+  if (pixel_buffer.format == kFlutterDesktopPixelFormatNV12) {
+    state_->PreparePlane(1, kLuminanceAlphaTextureFormat, chroma_width,
+                         chroma_height);
+    state_->UploadPixels(kLuminanceAlphaTextureFormat, chroma_planes,
+                         chroma_width, 0, 0, chroma_width, chroma_height);
   } else {
-    gl.glBindTexture(GL_TEXTURE_2D, state_->gl_texture);
+    const uint8_t* u_plane = chroma_planes;
+    const uint8_t* v_plane = u_plane + chroma_width * chroma_height;
+    state_->PreparePlane(1, kLuminanceTextureFormat, chroma_width,
+                         chroma_height);
+    state_->UploadPixels(kLuminanceTextureFormat, u_plane, chroma_width, 0, 0,
+                         chroma_width, chroma_height);
+    state_->PreparePlane(2, kLuminanceTextureFormat, chroma_width,
+                         chroma_height);
+    state_->UploadPixels(kLuminanceTextureFormat, v_plane, chroma_width, 0, 0,
+                         chroma_width, chroma_height);
   }
-#ifdef USE_GLES3
-  gl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pixel_buffer->width,
-                  pixel_buffer->height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                  pixel_buffer->buffer);
-#else
-  gl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pixel_buffer->width,
-                  pixel_buffer->height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                  pixel_buffer->buffer);
-#endif
+
+  return Convert(pixel_buffer.format, width, height);
+}
+
+bool ExternalTextureGL::Convert(FlutterDesktopPixelFormat format,
+                                size_t width,
+                                size_t height) {
+  if (!state_->converter) {
+    state_->converter = std::make_unique<PixelFormatConverterGL>();
+  }
+
+  uint32_t planes[PixelFormatConverterGL::kMaxPlanes];
+  for (int i = 0; i < PixelFormatConverterGL::kMaxPlanes; i++) {
+    planes[i] = state_->planes[i].texture;
+  }
+  if (!state_->converter->Convert(format, planes, width, height)) {
+    return false;
+  }
+  state_->texture = state_->converter->texture();
+  state_->texture_format = kRgbaTextureFormat.sized_format;
   return true;
 }
 
@@ -11,21 +11,24 @@
 
 #include "flutter/shell/platform/common/public/flutter_texture_registrar.h"
 #include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/external_texture.h"
 
 namespace flutter {
 
 typedef struct ExternalTextureGLState ExternalTextureGLState;
 
 // An abstraction of an OpenGL texture.
-class ExternalTextureGL {
+class ExternalTextureGL : public ExternalTexture {
  public:
   ExternalTextureGL(FlutterDesktopPixelBufferTextureCallback texture_callback,
                     void* user_data);
 
-  virtual ~ExternalTextureGL();
+  // A texture whose buffers tell their format and dirty rect.
+  ExternalTextureGL(
+      FlutterDesktopPixelBufferDescriptorCallback descriptor_callback,
+      void* user_data);
 
-  // Returns the unique id of this texture.
-  int64_t texture_id() { return reinterpret_cast<int64_t>(this); }
+  virtual ~ExternalTextureGL();
 
   void MarkFrameAvailable();
 
@@ -33,21 +36,39 @@ class ExternalTextureGL {
   // such as the name, width, height and the pixel format upon successfully
   // copying the buffer provided by |texture_callback_|. See |CopyPixelBuffer|.
   // Returns true on success or false if the pixel buffer could not be copied.
+  //
+  // |ExternalTexture|
   bool PopulateTexture(size_t width,
                        size_t height,
-                       FlutterOpenGLTexture* opengl_texture);
+                       FlutterOpenGLTexture* opengl_texture) override;
 
  private:
-  // Attempts to copy the pixel buffer returned by |texture_callback_| to
-  // OpenGL.
+  // Attempts to copy the pixel buffer returned by |texture_callback_| or
+  // |descriptor_callback_| to OpenGL.
   // The |width| and |height| will be set to the actual bounds of the copied
   // pixel buffer.
   // Returns true on success or false if the pixel buffer returned
-  // by |texture_callback_| was invalid.
+  // by the callback was invalid.
+  // Only the dirty rect of the pixel buffer is uploaded unless the size has
+  // changed.
   bool CopyPixelBuffer(size_t& width, size_t& height);
 
+  // Uploads a pixel buffer of a packed RGB format. BGRA8888 is converted by
+  // |Convert| if GL_EXT_texture_format_BGRA8888 is not supported.
+  bool CopyRgbPixelBuffer(
+      const FlutterDesktopPixelBufferDescriptor& pixel_buffer);
+
+  // Uploads the planes of a YUV pixel buffer and converts them to RGBA.
+  bool CopyYuvPixelBuffer(
+      const FlutterDesktopPixelBufferDescriptor& pixel_buffer);
+
+  // Converts the uploaded planes of |format| to the RGBA texture given to the
+  // engine.
+  bool Convert(FlutterDesktopPixelFormat format, size_t width, size_t height);
+
   std::unique_ptr<ExternalTextureGLState> state_;
   FlutterDesktopPixelBufferTextureCallback texture_callback_ = nullptr;
+  FlutterDesktopPixelBufferDescriptorCallback descriptor_callback_ = nullptr;
   void* user_data_ = nullptr;
 };
 
@@ -0,0 +1,138 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <GLES2/gl2.h>
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/external_texture_gl.h"
+#include "flutter/shell/platform/linux_embedded/testing/test_egl_context.h"
+
+namespace flutter {
+
+namespace {
+
+// A frame of a video-like RGBA pixel buffer of the size given by the
+// benchmark arguments.
+class TestFrame {
+ public:
+  explicit TestFrame(const benchmark::State& state)
+      : pixels_(state.range(0) * state.range(1) * 4) {
+    for (size_t i = 0; i < pixels_.size(); i++) {
+      pixels_[i] = static_cast<uint8_t>(i * 31);
+    }
+    pixel_buffer_.struct_size = sizeof(FlutterDesktopPixelBufferDescriptor);
+    pixel_buffer_.buffer = pixels_.data();
+    pixel_buffer_.width = state.range(0);
+    pixel_buffer_.height = state.range(1);
+    pixel_buffer_.format = kFlutterDesktopPixelFormatRGBA8888;
+  }
+
+  // Marks the region the producer updated in this frame. An empty rect means
+  // the whole buffer.
+  void SetDirtyRect(size_t x, size_t y, size_t width, size_t height) {
+    pixel_buffer_.dirty_rect = {x, y, width, height};
+  }
+
+  size_t width() const { return pixel_buffer_.width; }
+  size_t height() const { return pixel_buffer_.height; }
+  const uint8_t* pixels() const { return pixels_.data(); }
+  int64_t size() const { return pixels_.size(); }
+
+  static const FlutterDesktopPixelBufferDescriptor* GetPixelBuffer(
+      size_t width,
+      size_t height,
+      void* user_data) {
+    return &static_cast<TestFrame*>(user_data)->pixel_buffer_;
+  }
+
+ private:
+  std::vector<uint8_t> pixels_;
+  FlutterDesktopPixelBufferDescriptor pixel_buffer_ = {};
+};
+
+void SetSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height"});
+  benchmark->Args({1280, 720});
+  benchmark->Args({1920, 1080});
+  benchmark->Args({3840, 2160});
+  benchmark->Unit(benchmark::kMillisecond);
+  benchmark->UseRealTime();
+}
+
+// The upload which ExternalTextureGL did before: the storage is reallocated
+// by glTexImage2D for every frame.
+void BM_TexImage2DUpload(benchmark::State& state) {
+  testing::TestEglContext context;
+  if (!context.IsValid()) {
+    state.SkipWithError("No EGL context");
+    return;
+  }
+  TestFrame frame(state);
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  for (auto _ : state) {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, frame.width(), frame.height(), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels());
+    glFinish();
+  }
+  glDeleteTextures(1, &texture);
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_TexImage2DUpload)->Apply(SetSizes);
+
+// Uploads the whole frame every time through ExternalTextureGL.
+void BM_ExternalTextureGLUpload(benchmark::State& state) {
+  testing::TestEglContext context;
+  if (!context.IsValid()) {
+    state.SkipWithError("No EGL context");
+    return;
+  }
+  TestFrame frame(state);
+  ExternalTextureGL texture(TestFrame::GetPixelBuffer, &frame);
+  FlutterOpenGLTexture opengl_texture = {};
+  for (auto _ : state) {
+    if (!texture.PopulateTexture(frame.width(), frame.height(),
+                                 &opengl_texture)) {
+      state.SkipWithError("Failed to upload");
+      break;
+    }
+    glFinish();
+  }
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_ExternalTextureGLUpload)->Apply(SetSizes);
+
+// Uploads the dirty center quarter of the frame every time, like a producer
+// updating a part of the frame, through ExternalTextureGL. Without
+// GL_UNPACK_ROW_LENGTH (GLES2), the full rows covering it are uploaded.
+void BM_ExternalTextureGLDirtyRectUpload(benchmark::State& state) {
+  testing::TestEglContext context;
+  if (!context.IsValid()) {
+    state.SkipWithError("No EGL context");
+    return;
+  }
+  TestFrame frame(state);
+  ExternalTextureGL texture(TestFrame::GetPixelBuffer, &frame);
+  FlutterOpenGLTexture opengl_texture = {};
+  // The first upload allocates the storage and uploads the whole frame.
+  texture.PopulateTexture(frame.width(), frame.height(), &opengl_texture);
+  frame.SetDirtyRect(frame.width() / 4, frame.height() / 4, frame.width() / 2,
+                     frame.height() / 2);
+  for (auto _ : state) {
+    if (!texture.PopulateTexture(frame.width(), frame.height(),
+                                 &opengl_texture)) {
+      state.SkipWithError("Failed to upload");
+      break;
+    }
+    glFinish();
+  }
+}
+BENCHMARK(BM_ExternalTextureGLDirtyRectUpload)->Apply(SetSizes);
+
+}  // namespace
+
+}  // namespace flutter
@@ -0,0 +1,297 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/external_texture_gl.h"
+
+#include <GLES2/gl2.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/testing/test_egl_context.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// Small enough to compare every pixel, and even so that the chroma planes
+// are exactly half the size.
+constexpr size_t kWidth = 8;
+constexpr size_t kHeight = 4;
+
+// The maximum difference from the reference per channel. The GPU works with
+// mediump floats and filters the chroma planes at 8-bit precision.
+constexpr int kTolerance = 2;
+
+// A pixel buffer of |format| filled with a pattern.
+struct TestBuffer {
+  TestBuffer(FlutterDesktopPixelFormat format, size_t size) : bytes(size) {
+    for (size_t i = 0; i < bytes.size(); i++) {
+      bytes[i] = static_cast<uint8_t>(37 + i * 53);
+    }
+    pixel_buffer.struct_size = sizeof(FlutterDesktopPixelBufferDescriptor);
+    pixel_buffer.buffer = bytes.data();
+    pixel_buffer.width = kWidth;
+    pixel_buffer.height = kHeight;
+    pixel_buffer.format = format;
+  }
+
+  static const FlutterDesktopPixelBufferDescriptor* Get(size_t width,
+                                                        size_t height,
+                                                        void* user_data) {
+    return &static_cast<TestBuffer*>(user_data)->pixel_buffer;
+  }
+
+  // Returns the buffer as a plain pixel buffer, which has no format.
+  static const FlutterDesktopPixelBuffer* GetPlain(size_t width,
+                                                   size_t height,
+                                                   void* user_data) {
+    auto buffer = static_cast<TestBuffer*>(user_data);
+    buffer->plain_pixel_buffer = {buffer->pixel_buffer.buffer,
+                                  buffer->pixel_buffer.width,
+                                  buffer->pixel_buffer.height};
+    return &buffer->plain_pixel_buffer;
+  }
+
+  std::vector<uint8_t> bytes;
+  FlutterDesktopPixelBufferDescriptor pixel_buffer = {};
+  FlutterDesktopPixelBuffer plain_pixel_buffer = {};
+};
+
+uint8_t ToByte(float value) {
+  return static_cast<uint8_t>(
+      std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+}
+
+// Samples a |width| x |height| plane of bytes at the normalized |u|, |v| with
+// bilinear filtering, clamping to the edges.
+float SampleBilinear(const uint8_t* plane,
+                     size_t width,
+                     size_t height,
+                     size_t pixel_stride,
+                     float u,
+                     float v) {
+  auto x = u * width - 0.5f;
+  auto y = v * height - 0.5f;
+  auto x0 = static_cast<int>(std::floor(x));
+  auto y0 = static_cast<int>(std::floor(y));
+  auto fx = x - x0;
+  auto fy = y - y0;
+  auto at = [&](int px, int py) {
+    px = std::min(std::max(px, 0), static_cast<int>(width) - 1);
+    py = std::min(std::max(py, 0), static_cast<int>(height) - 1);
+    return plane[(py * width + px) * pixel_stride] / 255.0f;
+  };
+  return (at(x0, y0) * (1 - fx) + at(x0 + 1, y0) * fx) * (1 - fy) +
+         (at(x0, y0 + 1) * (1 - fx) + at(x0 + 1, y0 + 1) * fx) * fy;
+}
+
+// The reference of the conversion shaders: BT.601 limited range.
+void YuvToRgba(float y, float u, float v, uint8_t* rgba) {
+  y -= 16.0f / 255.0f;
+  u -= 0.5f;
+  v -= 0.5f;
+  rgba[0] = ToByte(1.164384f * y + 1.596027f * v);
+  rgba[1] = ToByte(1.164384f * y - 0.391762f * u - 0.812968f * v);
+  rgba[2] = ToByte(1.164384f * y + 2.017232f * u);
+  rgba[3] = 255;
+}
+
+// Converts |buffer| to RGBA on the CPU.
+std::vector<uint8_t> ConvertOnCpu(const TestBuffer& buffer) {
+  std::vector<uint8_t> rgba(kWidth * kHeight * 4);
+  const auto* bytes = buffer.bytes.data();
+  const size_t chroma_width = kWidth / 2;
+  const size_t chroma_height = kHeight / 2;
+  for (size_t y = 0; y < kHeight; y++) {
+    for (size_t x = 0; x < kWidth; x++) {
+      auto i = y * kWidth + x;
+      auto out = &rgba[i * 4];
+      switch (buffer.pixel_buffer.format) {
+        case kFlutterDesktopPixelFormatRGBA8888:
+          std::copy(bytes + i * 4, bytes + i * 4 + 4, out);
+          break;
+        case kFlutterDesktopPixelFormatBGRA8888:
+          out[0] = bytes[i * 4 + 2];
+          out[1] = bytes[i * 4 + 1];
+          out[2] = bytes[i * 4];
+          out[3] = bytes[i * 4 + 3];
+          break;
+        case kFlutterDesktopPixelFormatRGB565: {
+          uint16_t pixel = bytes[i * 2] | (bytes[i * 2 + 1] << 8);
+          out[0] = ToByte((pixel >> 11) / 31.0f);
+          out[1] = ToByte(((pixel >> 5) & 0x3f) / 63.0f);
+          out[2] = ToByte((pixel & 0x1f) / 31.0f);
+          out[3] = 255;
+          break;
+        }
+        case kFlutterDesktopPixelFormatNV12:
+        case kFlutterDesktopPixelFormatI420: {
+          auto u = (x + 0.5f) / kWidth;
+          auto v = (y + 0.5f) / kHeight;
+          const uint8_t* chroma = bytes + kWidth * kHeight;
+          float cb, cr;
+          if (buffer.pixel_buffer.format == kFlutterDesktopPixelFormatNV12) {
+            cb = SampleBilinear(chroma, chroma_width, chroma_height, 2, u, v);
+            cr = SampleBilinear(chroma + 1, chroma_width, chroma_height, 2,
+                                u, v);
+          } else {
+            cb = SampleBilinear(chroma, chroma_width, chroma_height, 1, u, v);
+            cr = SampleBilinear(chroma + chroma_width * chroma_height,
+                                chroma_width, chroma_height, 1, u, v);
+          }
+          YuvToRgba(bytes[i] / 255.0f, cb, cr, out);
+          break;
+        }
+      }
+    }
+  }
+  return rgba;
+}
+
+// Draws |texture| into an RGBA framebuffer of the same size and reads it
+// back, so that textures of any format can be compared.
+std::vector<uint8_t> ReadTexture(GLuint texture) {
+  constexpr char kVertexShader[] = R"(
+attribute vec2 position;
+varying vec2 uv;
+void main() {
+  uv = position * 0.5 + 0.5;
+  gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+  constexpr char kFragmentShader[] = R"(
+precision mediump float;
+uniform sampler2D tex;
+varying vec2 uv;
+void main() {
+  gl_FragColor = texture2D(tex, uv);
+}
+)";
+
+  GLuint color_buffer;
+  glGenTextures(1, &color_buffer);
+  glBindTexture(GL_TEXTURE_2D, color_buffer);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kWidth, kHeight, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  GLuint framebuffer;
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         color_buffer, 0);
+  EXPECT_EQ(glCheckFramebufferStatus(GL_FRAMEBUFFER),
+            static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE));
+
+  auto program = glCreateProgram();
+  for (auto [type, source] : {std::make_pair(GL_VERTEX_SHADER, kVertexShader),
+                              std::make_pair(GL_FRAGMENT_SHADER,
+                                             kFragmentShader)}) {
+    auto shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+  }
+  glBindAttribLocation(program, 0, "position");
+  glLinkProgram(program);
+  glUseProgram(program);
+
+  const GLfloat vertices[] = {-1, -1, 1, -1, -1, 1, 1, 1};
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+  glEnableVertexAttribArray(0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glUniform1i(glGetUniformLocation(program, "tex"), 0);
+  glViewport(0, 0, kWidth, kHeight);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+  std::vector<uint8_t> rgba(kWidth * kHeight * 4);
+  glReadPixels(0, 0, kWidth, kHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+  EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+  glDeleteProgram(program);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteTextures(1, &color_buffer);
+  return rgba;
+}
+
+struct FormatParam {
+  FlutterDesktopPixelFormat format;
+  size_t size;
+  const char* name;
+};
+
+class ExternalTextureGLConversionTest
+    : public ::testing::TestWithParam<FormatParam> {};
+
+}  // namespace
+
+TEST_P(ExternalTextureGLConversionTest, MatchesCpuReference) {
+  TestEglContext context;
+  if (!context.IsValid()) {
+    GTEST_SKIP() << "No surfaceless EGL context.";
+  }
+
+  TestBuffer buffer(GetParam().format, GetParam().size);
+  ExternalTextureGL texture(TestBuffer::Get, &buffer);
+  FlutterOpenGLTexture opengl_texture = {};
+  ASSERT_TRUE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_EQ(opengl_texture.target, static_cast<uint32_t>(GL_TEXTURE_2D));
+  EXPECT_EQ(opengl_texture.width, kWidth);
+  EXPECT_EQ(opengl_texture.height, kHeight);
+
+  auto actual = ReadTexture(opengl_texture.name);
+  auto expected = ConvertOnCpu(buffer);
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR(actual[i], expected[i], kTolerance)
+        << "pixel (" << (i / 4) % kWidth << ", " << (i / 4) / kWidth
+        << ") channel " << i % 4;
+  }
+}
+
+TEST(ExternalTextureGLTest, PlainPixelBufferIsRgba) {
+  TestEglContext context;
+  if (!context.IsValid()) {
+    GTEST_SKIP() << "No surfaceless EGL context.";
+  }
+
+  TestBuffer buffer(kFlutterDesktopPixelFormatRGBA8888, kWidth * kHeight * 4);
+  ExternalTextureGL texture(TestBuffer::GetPlain, &buffer);
+  FlutterOpenGLTexture opengl_texture = {};
+  ASSERT_TRUE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+  EXPECT_EQ(ReadTexture(opengl_texture.name), buffer.bytes);
+}
+
+TEST(ExternalTextureGLTest, RejectsDescriptorOfUnknownSize) {
+  TestBuffer buffer(kFlutterDesktopPixelFormatRGBA8888, kWidth * kHeight * 4);
+  buffer.pixel_buffer.struct_size = 0;
+  ExternalTextureGL texture(TestBuffer::Get, &buffer);
+  FlutterOpenGLTexture opengl_texture = {};
+  EXPECT_FALSE(texture.PopulateTexture(kWidth, kHeight, &opengl_texture));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Formats,
+    ExternalTextureGLConversionTest,
+    ::testing::Values(
+        FormatParam{kFlutterDesktopPixelFormatRGBA8888, kWidth * kHeight * 4,
+                    "RGBA8888"},
+        FormatParam{kFlutterDesktopPixelFormatBGRA8888, kWidth * kHeight * 4,
+                    "BGRA8888"},
+        FormatParam{kFlutterDesktopPixelFormatRGB565, kWidth * kHeight * 2,
+                    "RGB565"},
+        FormatParam{kFlutterDesktopPixelFormatNV12, kWidth * kHeight * 3 / 2,
+                    "NV12"},
+        FormatParam{kFlutterDesktopPixelFormatI420, kWidth * kHeight * 3 / 2,
+                    "I420"}),
+    [](const ::testing::TestParamInfo<FormatParam>& info) {
+      return info.param.name;
+    });
+
+}  // namespace testing
+}  // namespace flutter
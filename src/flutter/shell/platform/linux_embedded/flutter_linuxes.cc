@@ -15,6 +15,8 @@
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_engine.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_state.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_view.h"
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
 
 #if defined(DISPLAY_BACKEND_TYPE_DRM_GBM)
@@ -29,6 +31,8 @@
 #include "flutter/shell/platform/linux_embedded/window/native_window_drm_eglstream.h"
 #elif defined(DISPLAY_BACKEND_TYPE_X11)
 #include "flutter/shell/platform/linux_embedded/window/linuxes_window_x11.h"
+#elif defined(DISPLAY_BACKEND_TYPE_HEADLESS)
+#include "flutter/shell/platform/linux_embedded/window/linuxes_window_headless.h"
 #else
 #include "flutter/shell/platform/linux_embedded/window/linuxes_window_wayland.h"
 #endif
@@ -97,6 +101,10 @@ FlutterDesktopViewControllerRef FlutterDesktopViewControllerCreate(
       std::make_unique<flutter::LinuxesWindowX11>(
           view_properties.windw_display_mode, view_properties.width,
           view_properties.height, view_properties.show_cursor);
+#elif defined(DISPLAY_BACKEND_TYPE_HEADLESS)
+      std::make_unique<flutter::LinuxesWindowHeadless>(
+          view_properties.windw_display_mode, view_properties.width,
+          view_properties.height, view_properties.show_cursor);
 #else
       std::make_unique<flutter::LinuxesWindowWayland>(
           view_properties.windw_display_mode, view_properties.width,
@@ -143,6 +151,23 @@ bool FlutterDesktopViewDispatchEvent(FlutterDesktopViewRef view) {
   return ViewFromHandle(view)->DispatchEvent();
 }
 
+int FlutterDesktopViewGetEventFd(FlutterDesktopViewRef view) {
+  return ViewFromHandle(view)->GetEventFd();
+}
+
+void FlutterDesktopRunLoop(FlutterDesktopViewControllerRef controller) {
+  auto view = controller->view.get();
+  auto task_runner = view->GetEngine()->task_runner();
+  while (view->DispatchEvent()) {
+    // Processes any pending events in the Flutter engine, and then sleeps
+    // until the next scheduled event or the next window event.
+    auto wait_duration = task_runner->ProcessTasks();
+    if (!view->WaitEvent(wait_duration)) {
+      break;
+    }
+  }
+}
+
 FlutterDesktopEngineRef FlutterDesktopEngineCreate(
     const FlutterDesktopEngineProperties& engine_properties) {
   flutter::FlutterProjectBundle project(engine_properties);
@@ -189,6 +214,39 @@ FlutterDesktopTextureRegistrarRef FlutterDesktopEngineGetTextureRegistrar(
       EngineFromHandle(engine)->texture_registrar());
 }
 
+void FlutterDesktopEngineNotifyLowMemoryWarning(
+    FlutterDesktopEngineRef engine) {
+  EngineFromHandle(engine)->NotifyLowMemoryWarning();
+}
+
+bool FlutterDesktopEngineGetBackingStorePoolStats(
+    FlutterDesktopEngineRef engine,
+    FlutterDesktopBackingStorePoolStats* stats) {
+  auto view = EngineFromHandle(engine)->view();
+  return view && view->GetBackingStorePoolStats(stats);
+}
+
+void FlutterDesktopFrameTimelineSetEnabled(bool enabled) {
+  flutter::FrameTimeline::GetInstance().SetEnabled(enabled);
+}
+
+size_t FlutterDesktopFrameTimelineGetEvents(FlutterDesktopFrameEvent* events,
+                                            size_t max_events) {
+  return flutter::FrameTimeline::GetInstance().GetEvents(events, max_events);
+}
+
+void FlutterDesktopInputLatencySetEnabled(bool enabled) {
+  flutter::InputLatencyTracker::GetInstance().SetEnabled(enabled);
+}
+
+size_t FlutterDesktopInputLatencyGetHistogram(
+    FlutterDesktopInputLatencyType type,
+    uint64_t* counts,
+    size_t bucket_count) {
+  return flutter::InputLatencyTracker::GetInstance().GetHistogram(
+      type, counts, bucket_count);
+}
+
 FlutterDesktopViewRef FlutterDesktopPluginRegistrarGetView(
     FlutterDesktopPluginRegistrarRef registrar) {
   return HandleForView(registrar->engine->view());
@@ -235,8 +293,16 @@ void FlutterDesktopMessengerSetCallback(FlutterDesktopMessengerRef messenger,
                                         const char* channel,
                                         FlutterDesktopMessageCallback callback,
                                         void* user_data) {
-  messenger->engine->message_dispatcher()->SetMessageCallback(channel, callback,
-                                                              user_data);
+  messenger->engine->channel_task_queues()->SetMessageCallback(
+      channel, callback, user_data);
+}
+
+void FlutterDesktopMessengerSetBackgroundCallback(
+    FlutterDesktopMessengerRef messenger, const char* channel,
+    FlutterDesktopMessageCallback callback, void* user_data,
+    FlutterDesktopMessageCallbackRelease release) {
+  messenger->engine->channel_task_queues()->SetWorkerMessageCallback(
+      channel, callback, user_data, release);
 }
 
 FlutterDesktopTextureRegistrarRef FlutterDesktopRegistrarGetTextureRegistrar(
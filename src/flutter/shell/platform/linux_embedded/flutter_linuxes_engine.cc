@@ -6,6 +6,9 @@
 
 #include <rapidjson/document.h>
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -13,22 +16,50 @@
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/basic_message_channel.h"
 #include "flutter/shell/platform/common/json_message_codec.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_view.h"
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
 #include "flutter/shell/platform/linux_embedded/system_utils.h"
 #include "flutter/shell/platform/linux_embedded/task_runner.h"
+#include "flutter/shell/platform/linux_embedded/trace_event.h"
 
 namespace flutter {
 
 namespace {
 
+// The default interval of the frame stats and input latency dumps.
+constexpr int kDefaultFrameStatsIntervalSeconds = 5;
+
+// How long Stop() waits for the platform channel handlers on the worker
+// threads.
+constexpr std::chrono::milliseconds kMaxChannelTaskWait{1000};
+
 // Creates and returns a FlutterRendererConfig that renders to the view (if any)
 // of a FlutterLinuxesEngine, which should be the user_data received by the
 // render callbacks.
 FlutterRendererConfig GetRendererConfig() {
   FlutterRendererConfig config = {};
+  if (IsSoftwareRendererSelected()) {
+    config.type = kSoftware;
+    config.software.struct_size = sizeof(config.software);
+    config.software.surface_present_callback =
+        [](void* user_data, const void* allocation, size_t row_bytes,
+           size_t height) -> bool {
+      LINUXES_TRACE_EVENT("FlutterLinuxesEngine::PresentSoftwareBitmap");
+      auto host = static_cast<FlutterLinuxesEngine*>(user_data);
+      if (!host->view()) {
+        return false;
+      }
+      return host->view()->PresentSoftwareBitmap(allocation, row_bytes,
+                                                 height);
+    };
+    return config;
+  }
+
   config.type = kOpenGL;
   config.open_gl.struct_size = sizeof(config.open_gl);
   config.open_gl.make_current = [](void* user_data) -> bool {
+    LINUXES_TRACE_EVENT("FlutterLinuxesEngine::MakeCurrent");
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     if (!host->view()) {
       return false;
@@ -36,6 +67,7 @@ FlutterRendererConfig GetRendererConfig() {
     return host->view()->MakeCurrent();
   };
   config.open_gl.clear_current = [](void* user_data) -> bool {
+    LINUXES_TRACE_EVENT("FlutterLinuxesEngine::ClearCurrent");
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     if (!host->view()) {
       return false;
@@ -43,6 +75,7 @@ FlutterRendererConfig GetRendererConfig() {
     return host->view()->ClearCurrent();
   };
   config.open_gl.present = [](void* user_data) -> bool {
+    LINUXES_TRACE_EVENT("FlutterLinuxesEngine::Present");
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     if (!host->view()) {
       return false;
@@ -50,6 +83,7 @@ FlutterRendererConfig GetRendererConfig() {
     return host->view()->Present();
   };
   config.open_gl.fbo_callback = [](void* user_data) -> uint32_t {
+    LINUXES_TRACE_EVENT("FlutterLinuxesEngine::GetOnscreenFBO");
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     if (!host->view()) {
       return false;
@@ -65,6 +99,7 @@ FlutterRendererConfig GetRendererConfig() {
     return host->view()->ProcResolver(name);
   };
   config.open_gl.make_resource_current = [](void* user_data) -> bool {
+    LINUXES_TRACE_EVENT("FlutterLinuxesEngine::MakeResourceCurrent");
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     if (!host->view()) {
       return false;
@@ -74,6 +109,7 @@ FlutterRendererConfig GetRendererConfig() {
   config.open_gl.gl_external_texture_frame_callback =
       [](void* user_data, int64_t texture_id, size_t width, size_t height,
          FlutterOpenGLTexture* texture) -> bool {
+    LINUXES_TRACE_EVENT("FlutterLinuxesEngine::PopulateTexture");
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     if (!host->texture_registrar()) {
       return false;
@@ -98,6 +134,11 @@ static FlutterDesktopMessage ConvertToDesktopMessage(
 
 }  // namespace
 
+bool IsSoftwareRendererSelected() {
+  auto renderer = std::getenv(kRendererEnvironmentKey);
+  return renderer && std::strcmp(renderer, "software") == 0;
+}
+
 FlutterLinuxesEngine::FlutterLinuxesEngine(const FlutterProjectBundle& project)
     : project_(std::make_unique<FlutterProjectBundle>(project)),
       aot_data_(nullptr) {
@@ -116,6 +157,31 @@ FlutterLinuxesEngine::FlutterLinuxesEngine(const FlutterProjectBundle& project)
           LINUXES_LOG(ERROR) << "Failed to post an engine task.";
         }
       });
+  vsync_waiter_ = std::make_unique<VsyncWaiter>(embedder_api_.GetCurrentTime);
+
+  if (auto frame_stats = std::getenv(kFrameStatsEnvironmentKey)) {
+    auto interval = std::atoi(frame_stats);
+    if (interval <= 0) {
+      interval = kDefaultFrameStatsIntervalSeconds;
+    }
+    FrameTimeline::GetInstance().StartStatsDump(std::chrono::seconds(interval));
+  }
+
+  if (auto input_latency = std::getenv(kInputLatencyEnvironmentKey)) {
+    auto interval = std::atoi(input_latency);
+    if (interval <= 0) {
+      interval = kDefaultFrameStatsIntervalSeconds;
+    }
+    InputLatencyTracker::GetInstance().StartStatsDump(
+        std::chrono::seconds(interval));
+  }
+
+#if defined(ENABLE_LINUXES_TRACE)
+  if (auto trace_file = std::getenv(kTraceFileEnvironmentKey)) {
+    trace_file_path_ = trace_file;
+    TraceLog::GetInstance().SetEnabled(true);
+  }
+#endif
 
   // Set up the legacy structs backing the API handles.
   messenger_ = std::make_unique<FlutterDesktopMessenger>();
@@ -126,6 +192,8 @@ FlutterLinuxesEngine::FlutterLinuxesEngine(const FlutterProjectBundle& project)
   messenger_wrapper_ = std::make_unique<BinaryMessengerImpl>(messenger_.get());
   message_dispatcher_ =
       std::make_unique<IncomingMessageDispatcher>(messenger_.get());
+  channel_task_queues_ =
+      std::make_unique<ChannelTaskQueues>(message_dispatcher_.get());
   texture_registrar_ = std::make_unique<FlutterLinuxesTextureRegistrar>(this);
 
   // Set up internal channels.
@@ -204,6 +272,10 @@ bool FlutterLinuxesEngine::RunWithEntrypoint(const char* entrypoint) {
     auto host = static_cast<FlutterLinuxesEngine*>(user_data);
     return host->HandlePlatformMessage(engine_message);
   };
+  args.vsync_callback = [](void* user_data, intptr_t baton) -> void {
+    auto host = static_cast<FlutterLinuxesEngine*>(user_data);
+    host->OnVsync(baton);
+  };
 
   args.custom_task_runners = &custom_task_runners;
 
@@ -214,6 +286,45 @@ bool FlutterLinuxesEngine::RunWithEntrypoint(const char* entrypoint) {
     args.custom_dart_entrypoint = entrypoint;
   }
 
+  // Let the display show the layers of a frame by itself when it can.
+  FlutterCompositor compositor = {};
+  if (view_ && view_->GetCompositor()) {
+    compositor.struct_size = sizeof(FlutterCompositor);
+    compositor.user_data = this;
+    compositor.create_backing_store_callback =
+        [](const FlutterBackingStoreConfig* config,
+           FlutterBackingStore* backing_store_out, void* user_data) -> bool {
+      LINUXES_TRACE_EVENT("FlutterLinuxesEngine::CreateBackingStore");
+      auto host = static_cast<FlutterLinuxesEngine*>(user_data);
+      if (!host->view()) {
+        return false;
+      }
+      return host->view()->CreateBackingStore(*config, backing_store_out);
+    };
+    compositor.collect_backing_store_callback =
+        [](const FlutterBackingStore* backing_store, void* user_data) -> bool {
+      auto host = static_cast<FlutterLinuxesEngine*>(user_data);
+      if (!host->view()) {
+        return false;
+      }
+      return host->view()->CollectBackingStore(*backing_store);
+    };
+    compositor.present_layers_callback = [](const FlutterLayer** layers,
+                                            size_t layers_count,
+                                            void* user_data) -> bool {
+      LINUXES_TRACE_EVENT("FlutterLinuxesEngine::PresentLayers");
+      auto host = static_cast<FlutterLinuxesEngine*>(user_data);
+      if (!host->view()) {
+        return false;
+      }
+      return host->view()->PresentLayers(layers, layers_count);
+    };
+    // The compositor recycles the backing stores by itself, since a store
+    // can't be rendered into while a plane still scans it out.
+    compositor.avoid_backing_store_cache = true;
+    args.compositor = &compositor;
+  }
+
   auto renderer_config = GetRendererConfig();
   auto result = embedder_api_.Run(FLUTTER_ENGINE_VERSION, &renderer_config,
                                   &args, this, &engine_);
@@ -229,11 +340,28 @@ bool FlutterLinuxesEngine::RunWithEntrypoint(const char* entrypoint) {
 
 bool FlutterLinuxesEngine::Stop() {
   if (engine_) {
+    // Let the handlers on the worker threads reply before the plugins are
+    // destroyed, but don't let a long backlog keep the engine from stopping.
+    // The handlers which are running still have to return, since they use the
+    // plugins.
+    if (!channel_task_queues_->WaitUntilIdle(kMaxChannelTaskWait)) {
+      LINUXES_LOG(WARNING) << "Platform channel handlers are still running "
+                              "on worker threads after "
+                           << kMaxChannelTaskWait.count()
+                           << " ms, dropping the queued messages.";
+      channel_task_queues_->DropPendingMessages();
+      channel_task_queues_->WaitUntilIdle();
+    }
     if (plugin_registrar_destruction_callback_) {
       plugin_registrar_destruction_callback_(plugin_registrar_.get());
     }
     FlutterEngineResult result = embedder_api_.Shutdown(engine_);
     engine_ = nullptr;
+    if (!trace_file_path_.empty()) {
+      TraceLog::GetInstance().SetEnabled(false);
+      TraceLog::GetInstance().WriteJson(trace_file_path_);
+      trace_file_path_.clear();
+    }
     return (result == kSuccess);
   }
   return false;
@@ -251,6 +379,35 @@ void FlutterLinuxesEngine::SetPluginRegistrarDestructionCallback(
   plugin_registrar_destruction_callback_ = callback;
 }
 
+void FlutterLinuxesEngine::NotifyLowMemoryWarning() {
+  if (engine_) {
+    embedder_api_.NotifyLowMemoryWarning(engine_);
+  }
+  if (view_) {
+    view_->OnLowMemoryWarning();
+  }
+}
+
+bool FlutterLinuxesEngine::PostRenderThreadTask(std::function<void()> task) {
+  if (!engine_) {
+    return false;
+  }
+  auto callback_data = new std::function<void()>(std::move(task));
+  auto result = embedder_api_.PostRenderThreadTask(
+      engine_,
+      [](void* user_data) {
+        auto task = static_cast<std::function<void()>*>(user_data);
+        (*task)();
+        delete task;
+      },
+      callback_data);
+  if (result != kSuccess) {
+    delete callback_data;
+    return false;
+  }
+  return true;
+}
+
 void FlutterLinuxesEngine::SendWindowMetricsEvent(
     const FlutterWindowMetricsEvent& event) {
   if (engine_) {
@@ -259,11 +416,47 @@ void FlutterLinuxesEngine::SendWindowMetricsEvent(
 }
 
 void FlutterLinuxesEngine::SendPointerEvent(const FlutterPointerEvent& event) {
-  if (engine_) {
-    embedder_api_.SendPointerEvent(engine_, &event, 1);
+  SendPointerEvents(&event, 1);
+}
+
+void FlutterLinuxesEngine::SendPointerEvents(const FlutterPointerEvent* events,
+                                             size_t count) {
+  if (engine_ && count > 0) {
+    embedder_api_.SendPointerEvent(engine_, events, count);
   }
 }
 
+void FlutterLinuxesEngine::OnVblank(uint64_t vblank_time_nanos,
+                                    uint64_t vsync_interval_nanos) {
+  vsync_waiter_->NotifyVblank(vblank_time_nanos, vsync_interval_nanos);
+}
+
+void FlutterLinuxesEngine::OnVsync(intptr_t baton) {
+  // FlutterEngineOnVsync must be called on the platform thread. The frame
+  // times are computed there too, as late as possible, so that they reflect
+  // the latest vblank reported by the backend.
+  task_runner_->PostTask([this, baton]() {
+    if (!engine_) {
+      return;
+    }
+    uint64_t frame_start_time_nanos;
+    uint64_t frame_target_time_nanos;
+    vsync_waiter_->GetNextFrameTimes(&frame_start_time_nanos,
+                                     &frame_target_time_nanos);
+    if (view_) {
+      view_->OnFrameStart(frame_start_time_nanos);
+    }
+    // After the resampled events, which the frame shows.
+    if (InputLatencyTracker::IsEnabled()) {
+      InputLatencyTracker::GetInstance().OnFrameStart(FrameTimeline::Now());
+    }
+    if (embedder_api_.OnVsync(engine_, baton, frame_start_time_nanos,
+                              frame_target_time_nanos) != kSuccess) {
+      LINUXES_LOG(ERROR) << "Failed to notify the engine of vsync.";
+    }
+  });
+}
+
 bool FlutterLinuxesEngine::SendPlatformMessage(
     const char* channel, const uint8_t* message, const size_t message_size,
     const FlutterDesktopBinaryReply reply, void* user_data) {
@@ -312,6 +505,7 @@ void FlutterLinuxesEngine::HandlePlatformMessage(
 
   auto message = ConvertToDesktopMessage(*engine_message);
 
+  LINUXES_TRACE_EVENT("IncomingMessageDispatcher::HandleMessage");
   message_dispatcher_->HandleMessage(
       message, [this] {}, [this] {});
 }
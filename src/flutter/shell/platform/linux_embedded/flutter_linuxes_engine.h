@@ -7,25 +7,37 @@
 
 #include <rapidjson/document.h>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "flutter/shell/platform/common/client_wrapper/binary_messenger_impl.h"
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/basic_message_channel.h"
 #include "flutter/shell/platform/common/incoming_message_dispatcher.h"
 #include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/channel_task_queues.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_state.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_texture_registrar.h"
 #include "flutter/shell/platform/linux_embedded/flutter_project_bundle.h"
 #include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
 #include "flutter/shell/platform/linux_embedded/task_runner.h"
+#include "flutter/shell/platform/linux_embedded/vsync_waiter.h"
 
 namespace flutter {
 
 class FlutterLinuxesView;
 
+// The environment variable which selects the renderer. If it is "software",
+// frames are rendered by the CPU and copied to the display instead of being
+// rendered with OpenGL ES.
+constexpr char kRendererEnvironmentKey[] = "FLUTTER_LINUXES_RENDERER";
+
+// Returns whether the software renderer is selected by kRendererEnvironmentKey.
+bool IsSoftwareRendererSelected();
+
 class FlutterLinuxesEngine {
  public:
   explicit FlutterLinuxesEngine(const FlutterProjectBundle& project);
@@ -69,18 +81,37 @@ class FlutterLinuxesEngine {
     return message_dispatcher_.get();
   }
 
+  ChannelTaskQueues* channel_task_queues() {
+    return channel_task_queues_.get();
+  }
+
   TaskRunner* task_runner() { return task_runner_.get(); }
 
   FlutterLinuxesTextureRegistrar* texture_registrar() {
     return texture_registrar_.get();
   }
 
+  // Informs the engine and the view that the system is low on memory.
+  void NotifyLowMemoryWarning();
+
+  // Runs |task| on the raster thread, where the compositor is used. Returns
+  // false if the engine isn't running.
+  bool PostRenderThreadTask(std::function<void()> task);
+
   // Informs the engine that the window metrics have changed.
   void SendWindowMetricsEvent(const FlutterWindowMetricsEvent& event);
 
   // Informs the engine of an incoming pointer event.
   void SendPointerEvent(const FlutterPointerEvent& event);
 
+  // Informs the engine of |count| incoming pointer events in a single call.
+  void SendPointerEvents(const FlutterPointerEvent* events, size_t count);
+
+  // Informs the engine that the display has refreshed at |vblank_time_nanos|,
+  // so that frames are scheduled in phase with the display. This can be called
+  // from any thread.
+  void OnVblank(uint64_t vblank_time_nanos, uint64_t vsync_interval_nanos);
+
   // Sends the given message to the engine, calling |reply| with |user_data|
   // when a reponse is received from the engine if they are non-null.
   bool SendPlatformMessage(const char* channel, const uint8_t* message,
@@ -120,6 +151,10 @@ class FlutterLinuxesEngine {
   // system changes.
   void SendSystemSettings();
 
+  // Callback passed to Flutter engine for waiting for the next vsync. Called
+  // on the engine's UI thread.
+  void OnVsync(intptr_t baton);
+
   // The handle to the embedder.h engine instance.
   FLUTTER_API_SYMBOL(FlutterEngine) engine_ = nullptr;
 
@@ -136,6 +171,12 @@ class FlutterLinuxesEngine {
   // Task runner for tasks posted from the engine.
   std::unique_ptr<TaskRunner> task_runner_;
 
+  // The source of the frame times given to the engine on vsync.
+  std::unique_ptr<VsyncWaiter> vsync_waiter_;
+
+  // The file which the trace is written to on shutdown, if tracing is enabled.
+  std::string trace_file_path_;
+
   // The plugin messenger handle given to API clients.
   std::unique_ptr<FlutterDesktopMessenger> messenger_;
 
@@ -145,6 +186,10 @@ class FlutterLinuxesEngine {
   // Message dispatch manager for messages from engine_.
   std::unique_ptr<IncomingMessageDispatcher> message_dispatcher_;
 
+  // The registry of the message callbacks, which runs some of them on worker
+  // threads.
+  std::unique_ptr<ChannelTaskQueues> channel_task_queues_;
+
   // The plugin registrar handle given to API clients.
   std::unique_ptr<FlutterDesktopPluginRegistrar> plugin_registrar_;
 
@@ -4,7 +4,10 @@
 
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_texture_registrar.h"
 
+#include "flutter/shell/platform/linux_embedded/external_texture_dmabuf.h"
+#include "flutter/shell/platform/linux_embedded/external_texture_gl.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_engine.h"
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
 
 #include <iostream>
 #include <mutex>
@@ -17,20 +20,41 @@ FlutterLinuxesTextureRegistrar::FlutterLinuxesTextureRegistrar(
 
 int64_t FlutterLinuxesTextureRegistrar::RegisterTexture(
     const FlutterDesktopTextureInfo* texture_info) {
-  if (texture_info->type != kFlutterDesktopPixelBufferTexture) {
-    std::cerr << "Attempted to register texture of unsupport type."
-              << std::endl;
-    return -1;
+  std::unique_ptr<flutter::ExternalTexture> texture_gl;
+  switch (texture_info->type) {
+    case kFlutterDesktopPixelBufferTexture:
+      if (!texture_info->pixel_buffer_config.callback) {
+        std::cerr << "Invalid pixel buffer texture callback." << std::endl;
+        return -1;
+      }
+      texture_gl = std::make_unique<flutter::ExternalTextureGL>(
+          texture_info->pixel_buffer_config.callback,
+          texture_info->pixel_buffer_config.user_data);
+      break;
+    case kFlutterDesktopPixelBufferDescriptorTexture:
+      if (!texture_info->pixel_buffer_descriptor_config.callback) {
+        std::cerr << "Invalid pixel buffer descriptor texture callback."
+                  << std::endl;
+        return -1;
+      }
+      texture_gl = std::make_unique<flutter::ExternalTextureGL>(
+          texture_info->pixel_buffer_descriptor_config.callback,
+          texture_info->pixel_buffer_descriptor_config.user_data);
+      break;
+    case kFlutterDesktopDmaBufTexture:
+      if (!texture_info->dma_buf_config.callback) {
+        std::cerr << "Invalid DMA-BUF texture callback." << std::endl;
+        return -1;
+      }
+      texture_gl = std::make_unique<flutter::ExternalTextureDmaBuf>(
+          texture_info->dma_buf_config.callback,
+          texture_info->dma_buf_config.user_data);
+      break;
+    default:
+      std::cerr << "Attempted to register texture of unsupport type."
+                << std::endl;
+      return -1;
   }
-
-  if (!texture_info->pixel_buffer_config.callback) {
-    std::cerr << "Invalid pixel buffer texture callback." << std::endl;
-    return -1;
-  }
-
-  auto texture_gl = std::make_unique<flutter::ExternalTextureGL>(
-      texture_info->pixel_buffer_config.callback,
-      texture_info->pixel_buffer_config.user_data);
   int64_t texture_id = texture_gl->texture_id();
 
   {
@@ -74,7 +98,8 @@ bool FlutterLinuxesTextureRegistrar::PopulateTexture(
     size_t width,
     size_t height,
     FlutterOpenGLTexture* opengl_texture) {
-  flutter::ExternalTextureGL* texture;
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventPopulateTexture);
+  flutter::ExternalTexture* texture;
   {
     std::lock_guard<std::mutex> lock(map_mutex_);
     auto it = textures_.find(texture_id);
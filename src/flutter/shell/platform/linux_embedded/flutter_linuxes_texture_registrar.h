@@ -9,7 +9,8 @@
 #include <mutex>
 #include <unordered_map>
 
-#include "flutter/shell/platform/linux_embedded/external_texture_gl.h"
+#include "flutter/shell/platform/common/public/flutter_texture_registrar.h"
+#include "flutter/shell/platform/linux_embedded/external_texture.h"
 
 namespace flutter {
 
@@ -45,7 +46,7 @@ class FlutterLinuxesTextureRegistrar {
   FlutterLinuxesEngine* engine_ = nullptr;
 
   // All registered textures, keyed by their IDs.
-  std::unordered_map<int64_t, std::unique_ptr<flutter::ExternalTextureGL>>
+  std::unordered_map<int64_t, std::unique_ptr<flutter::ExternalTexture>>
       textures_;
   std::mutex map_mutex_;
 };
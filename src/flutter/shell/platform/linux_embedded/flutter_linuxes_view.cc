@@ -4,17 +4,55 @@
 
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_view.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
 
 namespace flutter {
 
+namespace {
+
+// How long WaitEvent() sleeps at most when the posted tasks or the window
+// events cannot wake it up, which is how long the examples slept before
+// they had an event loop.
+constexpr std::chrono::milliseconds kMaxWaitWithoutWakeup(13);
+
+}  // namespace
+
 FlutterLinuxesView::FlutterLinuxesView(
     std::unique_ptr<WindowBindingHandler> window_binding) {
   // Take the binding handler, and give it a pointer back to self.
   binding_handler_ = std::move(window_binding);
   binding_handler_->SetView(this);
+
+  event_loop_ = std::make_unique<EventLoop>();
+  auto window_event_fd = binding_handler_->GetEventFd();
+  if (window_event_fd != -1 && !event_loop_->AddFd(window_event_fd)) {
+    LINUXES_LOG(WARNING) << "Window events cannot be waited on.";
+    can_wake_up_ = false;
+  }
+
+  if (auto coalesce = std::getenv(kCoalescePointerMotionEnvironmentKey)) {
+    coalesce_pointer_motion_ = std::strcmp(coalesce, "0") != 0;
+  }
+  if (auto resample = std::getenv(kResamplePointerEnvironmentKey)) {
+    if (std::strcmp(resample, "0") != 0) {
+      pointer_resampler_ = std::make_unique<PointerResampler>();
+    }
+  }
+  if (pointer_resampler_ && coalesce_pointer_motion_) {
+    // The resampler interpolates between the moves, so it needs all of them.
+    LINUXES_LOG(WARNING) << "Pointer motion coalescing is disabled because "
+                            "pointer resampling is enabled.";
+    coalesce_pointer_motion_ = false;
+  }
+  software_rendering_ = IsSoftwareRendererSelected();
 }
 
 FlutterLinuxesView::~FlutterLinuxesView() {
@@ -26,7 +64,29 @@ FlutterLinuxesView::~FlutterLinuxesView() {
 }
 
 bool FlutterLinuxesView::DispatchEvent() {
-  return binding_handler_->DispatchEvent();
+  auto result = binding_handler_->DispatchEvent();
+  // Not every backend reports the end of input frames, so don't let events
+  // wait for the next dispatch.
+  FlushPointerEvents();
+  return result;
+}
+
+int FlutterLinuxesView::GetEventFd() const {
+  return event_loop_->GetFd();
+}
+
+bool FlutterLinuxesView::WaitEvent(std::chrono::nanoseconds timeout) {
+  // Poll instead of sleeping until an event which may never come.
+  if (!can_wake_up_ || !engine_) {
+    timeout = std::min<std::chrono::nanoseconds>(timeout,
+                                                 kMaxWaitWithoutWakeup);
+  }
+  if (!binding_handler_->PrepareWaitEvent()) {
+    return true;
+  }
+  auto result = event_loop_->Wait(timeout);
+  binding_handler_->FinishWaitEvent();
+  return result;
 }
 
 void FlutterLinuxesView::SetEngine(
@@ -35,6 +95,12 @@ void FlutterLinuxesView::SetEngine(
 
   engine_->SetView(this);
 
+  // Wake up the event loop when tasks are posted from other threads.
+  if (!event_loop_->AddFd(engine_->task_runner()->GetEventFd())) {
+    LINUXES_LOG(WARNING) << "Posted tasks cannot wake up the event loop.";
+    can_wake_up_ = false;
+  }
+
   internal_plugin_registrar_ =
       std::make_unique<flutter::PluginRegistrar>(engine_->GetRegistrar());
 
@@ -56,13 +122,19 @@ void FlutterLinuxesView::SetEngine(
 
 void FlutterLinuxesView::OnWindowSizeChanged(size_t width,
                                              size_t height) const {
-  if (!GetRenderSurfaceTarget()->OnScreenSurfaceResize(width, height)) {
+  // Software surfaces follow the size of the frames.
+  if (!software_rendering_ &&
+      !GetRenderSurfaceTarget()->OnScreenSurfaceResize(width, height)) {
     LINUXES_LOG(ERROR) << "Failed to change surface size.";
     return;
   }
   SendWindowMetrics(width, height, binding_handler_->GetDpiScale());
 }
 
+void FlutterLinuxesView::OnInputTimestamp(uint64_t timestamp_micros) {
+  input_timestamp_micros_ = timestamp_micros;
+}
+
 void FlutterLinuxesView::OnPointerMove(double x, double y) {
   SendPointerMove(x, y);
 }
@@ -87,84 +159,59 @@ void FlutterLinuxesView::OnPointerUp(
 
 void FlutterLinuxesView::OnPointerLeave() { SendPointerLeave(); }
 
+void FlutterLinuxesView::OnPointerFrame() { FlushPointerEvents(); }
+
 void FlutterLinuxesView::OnTouchDown(uint32_t time, int32_t id, double x,
                                      double y) {
-  auto* point = GgeTouchPoint(id);
+  // A touch point which is still down has missed its up event, so cancel it
+  // rather than sending a second down.
+  if (auto stale_point = touch_tracker_.Find(id)) {
+    QueueTouchEvent(FlutterPointerPhase::kCancel, time, *stale_point);
+    touch_tracker_.Up(id);
+  }
+
+  auto point = touch_tracker_.Down(id, x, y);
   if (!point) {
     return;
   }
-  point->event_mask = TouchEvent::kDown;
-  point->x = x;
-  point->y = y;
-  touch_event_.time = time;
-
-  FlutterPointerEvent event = {
-      .struct_size = sizeof(event),
-      .phase = FlutterPointerPhase::kDown,
-      .timestamp = time,
-      .x = x,
-      .y = y,
-      .device = kFlutterPointerDeviceKindTouch,
-      .signal_kind = kFlutterPointerSignalKindNone,
-      .scroll_delta_x = 0,
-      .scroll_delta_y = 0,
-      .device_kind = kFlutterPointerDeviceKindTouch,
-      .buttons = 0,
-  };
-  engine_->SendPointerEvent(event);
+  QueueTouchEvent(FlutterPointerPhase::kDown, time, *point);
 }
 
 void FlutterLinuxesView::OnTouchUp(uint32_t time, int32_t id) {
-  auto* point = GgeTouchPoint(id);
+  auto point = touch_tracker_.Find(id);
   if (!point) {
     return;
   }
-  point->event_mask = TouchEvent::kUp;
-
-  FlutterPointerEvent event = {
-      .struct_size = sizeof(event),
-      .phase = FlutterPointerPhase::kUp,
-      .timestamp = time,
-      .x = point->x,
-      .y = point->y,
-      .device = kFlutterPointerDeviceKindTouch,
-      .signal_kind = kFlutterPointerSignalKindNone,
-      .scroll_delta_x = 0,
-      .scroll_delta_y = 0,
-      .device_kind = kFlutterPointerDeviceKindTouch,
-      .buttons = 0,
-  };
-  engine_->SendPointerEvent(event);
+  QueueTouchEvent(FlutterPointerPhase::kUp, time, *point);
+  touch_tracker_.Up(id);
 }
 
 void FlutterLinuxesView::OnTouchMotion(uint32_t time, int32_t id, double x,
                                        double y) {
-  auto* point = GgeTouchPoint(id);
+  auto point = touch_tracker_.Find(id);
   if (!point) {
     return;
   }
-  point->event_mask = TouchEvent::kMotion;
   point->x = x;
   point->y = y;
-  touch_event_.time = time;
+  QueueTouchEvent(FlutterPointerPhase::kMove, time, *point);
+}
 
-  FlutterPointerEvent event = {
-      .struct_size = sizeof(event),
-      .phase = FlutterPointerPhase::kMove,
-      .timestamp = time,
-      .x = x,
-      .y = y,
-      .device = kFlutterPointerDeviceKindTouch,
-      .signal_kind = kFlutterPointerSignalKindNone,
-      .scroll_delta_x = 0,
-      .scroll_delta_y = 0,
-      .device_kind = kFlutterPointerDeviceKindTouch,
-      .buttons = 0,
-  };
-  engine_->SendPointerEvent(event);
+void FlutterLinuxesView::OnTouchCancel() {
+  // The compositor or the device has taken over the touch sequence.
+  touch_tracker_.CancelAll([this](const TouchTracker::TouchPoint& point) {
+    QueueTouchEvent(FlutterPointerPhase::kCancel, 0, point);
+  });
+  FlushPointerEvents();
+}
+
+void FlutterLinuxesView::OnTouchDeviceAdded(int32_t touch_count) {
+  if (touch_count > 0) {
+    touch_tracker_.Reserve(touch_count);
+  }
 }
 
-void FlutterLinuxesView::OnTouchCancel() {}
+void FlutterLinuxesView::OnTouchFrame() { FlushPointerEvents(); }
 
 void FlutterLinuxesView::OnKeyMap(uint32_t format, int fd, uint32_t size) {
   keyboard_handler_->OnKeymap(format, fd, size);
@@ -204,23 +251,11 @@ void FlutterLinuxesView::OnScroll(double x, double y, double delta_x,
   SendScroll(x, y, delta_x, delta_y, scroll_offset_multiplier);
 }
 
-FlutterLinuxesView::touch_point* FlutterLinuxesView::GgeTouchPoint(int32_t id) {
-  const size_t nmemb = sizeof(touch_event_) / sizeof(struct touch_point);
-  int invalid = -1;
-  for (size_t i = 0; i < nmemb; ++i) {
-    if (touch_event_.points[i].id == id) {
-      return &touch_event_.points[i];
-    }
-    if (invalid == -1 && !touch_event_.points[i].valid) {
-      invalid = i;
-    }
-  }
-  if (invalid == -1) {
-    return nullptr;
+void FlutterLinuxesView::OnVblank(uint64_t vblank_time_nanos,
+                                  uint64_t vsync_interval_nanos) {
+  if (engine_) {
+    engine_->OnVblank(vblank_time_nanos, vsync_interval_nanos);
   }
-  touch_event_.points[invalid].valid = true;
-  touch_event_.points[invalid].id = id;
-  return &touch_event_.points[invalid];
 }
 
 // Sends new size  information to FlutterEngine.
@@ -327,12 +362,9 @@ void FlutterLinuxesView::SendPointerEventWithData(
 
   // Set metadata that's always the same regardless of the event.
   event.struct_size = sizeof(event);
-  event.timestamp =
-      std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::high_resolution_clock::now().time_since_epoch())
-          .count();
+  event.timestamp = GetInputTimestamp();
 
-  engine_->SendPointerEvent(event);
+  QueuePointerEvent(event);
 
   if (event_data.phase == FlutterPointerPhase::kAdd) {
     SetMouseFlutterStateAdded(true);
@@ -342,11 +374,141 @@ void FlutterLinuxesView::SendPointerEventWithData(
   }
 }
 
+void FlutterLinuxesView::QueueTouchEvent(
+    FlutterPointerPhase phase, uint32_t time,
+    const TouchTracker::TouchPoint& point) {
+  // The windows give touch times in milliseconds, while the engine expects
+  // microseconds.
+  uint64_t timestamp = static_cast<uint64_t>(time) * 1000;
+  if (input_timestamp_micros_ != 0 || time == 0) {
+    timestamp = GetInputTimestamp();
+  }
+  FlutterPointerEvent event = {
+      .struct_size = sizeof(event),
+      .phase = phase,
+      .timestamp = timestamp,
+      .x = point.x,
+      .y = point.y,
+      .device = point.device,
+      .signal_kind = kFlutterPointerSignalKindNone,
+      .scroll_delta_x = 0,
+      .scroll_delta_y = 0,
+      .device_kind = kFlutterPointerDeviceKindTouch,
+      .buttons = 0,
+  };
+  QueuePointerEvent(event);
+}
+
+void FlutterLinuxesView::QueuePointerEvent(const FlutterPointerEvent& event) {
+  if (coalesce_pointer_motion_ &&
+      event.signal_kind == kFlutterPointerSignalKindNone &&
+      (event.phase == FlutterPointerPhase::kMove ||
+       event.phase == FlutterPointerPhase::kHover)) {
+    // Replace the last queued event of the pointer only if it is a move
+    // with the same buttons, so that no transition is lost.
+    for (auto it = pending_pointer_events_.rbegin();
+         it != pending_pointer_events_.rend(); ++it) {
+      if (it->device_kind != event.device_kind || it->device != event.device) {
+        continue;
+      }
+      if (it->phase == event.phase && it->buttons == event.buttons &&
+          it->signal_kind == kFlutterPointerSignalKindNone) {
+        pending_pointer_events_.erase(std::next(it).base());
+      }
+      break;
+    }
+  }
+  pending_pointer_events_.push_back(event);
+}
+
+void FlutterLinuxesView::FlushPointerEvents() {
+  // The timestamp only applies to the events of the input frame.
+  input_timestamp_micros_ = 0;
+  if (!engine_ || pending_pointer_events_.empty()) {
+    return;
+  }
+  if (pointer_resampler_) {
+    pointer_resampler_->Filter(&pending_pointer_events_);
+    if (pointer_resampler_->HasPendingMoves()) {
+      ScheduleResampleTimeout();
+    }
+  }
+  SendPointerEvents(&pending_pointer_events_, nullptr);
+}
+
+void FlutterLinuxesView::SendPointerEvents(
+    std::vector<FlutterPointerEvent>* events,
+    std::vector<uint64_t>* input_timestamps_micros) {
+  if (events->empty()) {
+    return;
+  }
+  engine_->SendPointerEvents(events->data(), events->size());
+  if (InputLatencyTracker::IsEnabled()) {
+    for (size_t i = 0; i < events->size(); i++) {
+      const auto& event = (*events)[i];
+      if (event.phase != FlutterPointerPhase::kAdd &&
+          event.phase != FlutterPointerPhase::kRemove) {
+        auto timestamp_micros = input_timestamps_micros
+                                    ? (*input_timestamps_micros)[i]
+                                    : event.timestamp;
+        InputLatencyTracker::GetInstance().OnInputSent(timestamp_micros *
+                                                       1000);
+      }
+    }
+  }
+  events->clear();
+  if (input_timestamps_micros) {
+    input_timestamps_micros->clear();
+  }
+}
+
+void FlutterLinuxesView::OnFrameStart(uint64_t frame_start_time_nanos) {
+  frame_count_++;
+  if (pointer_resampler_ && engine_) {
+    pointer_resampler_->Resample(frame_start_time_nanos / 1000,
+                                 &resampled_pointer_events_,
+                                 &resampled_input_timestamps_);
+    SendPointerEvents(&resampled_pointer_events_,
+                      &resampled_input_timestamps_);
+  }
+}
+
+void FlutterLinuxesView::ScheduleResampleTimeout() {
+  if (is_resample_timeout_pending_) {
+    return;
+  }
+  is_resample_timeout_pending_ = true;
+  engine_->task_runner()->PostDelayedTask(
+      [this, frame_count = frame_count_]() {
+        is_resample_timeout_pending_ = false;
+        if (frame_count_ == frame_count) {
+          // Sample at the current time, as if a frame started now.
+          OnFrameStart(FrameTimeline::Now() +
+                       PointerResampler::kResampleLatencyMicros * 1000);
+        }
+        if (pointer_resampler_->HasPendingMoves()) {
+          ScheduleResampleTimeout();
+        }
+      },
+      kMaxResampleDelay);
+}
+
+uint64_t FlutterLinuxesView::GetInputTimestamp() const {
+  if (input_timestamp_micros_ != 0) {
+    return input_timestamp_micros_;
+  }
+  // The engine uses the monotonic clock, as steady_clock does.
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 void* FlutterLinuxesView::ProcResolver(const char* name) {
   return GetRenderSurfaceTarget()->GlProcResolver(name);
 }
 
 bool FlutterLinuxesView::MakeCurrent() {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventMakeCurrent);
   return GetRenderSurfaceTarget()->GLContextMakeCurrent();
 }
 
@@ -355,10 +517,12 @@ bool FlutterLinuxesView::ClearCurrent() {
 }
 
 bool FlutterLinuxesView::Present() {
-  return GetRenderSurfaceTarget()->GLContextPresent(0);
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventPresent);
+  return OnFramePresented(GetRenderSurfaceTarget()->GLContextPresent(0));
 }
 
 uint32_t FlutterLinuxesView::GetOnscreenFBO() {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventGetOnscreenFbo);
   return GetRenderSurfaceTarget()->GLContextFBO();
 }
 
@@ -366,8 +530,76 @@ bool FlutterLinuxesView::MakeResourceCurrent() {
   return GetRenderSurfaceTarget()->ResourceContextMakeCurrent();
 }
 
+LinuxesCompositor* FlutterLinuxesView::GetCompositor() const {
+  return binding_handler_->GetCompositor();
+}
+
+bool FlutterLinuxesView::CreateBackingStore(
+    const FlutterBackingStoreConfig& config,
+    FlutterBackingStore* backing_store_out) {
+  return GetCompositor()->CreateBackingStore(config, backing_store_out);
+}
+
+bool FlutterLinuxesView::CollectBackingStore(
+    const FlutterBackingStore& backing_store) {
+  return GetCompositor()->CollectBackingStore(backing_store);
+}
+
+bool FlutterLinuxesView::PresentLayers(const FlutterLayer** layers,
+                                       size_t layers_count) {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventPresent);
+  return OnFramePresented(
+      GetCompositor()->PresentLayers(layers, layers_count));
+}
+
+bool FlutterLinuxesView::GetBackingStorePoolStats(
+    FlutterDesktopBackingStorePoolStats* stats) {
+  auto compositor = GetCompositor();
+  if (!compositor) {
+    return false;
+  }
+  *stats = compositor->GetBackingStorePoolStats();
+  return true;
+}
+
+void FlutterLinuxesView::OnLowMemoryWarning() {
+  auto compositor = GetCompositor();
+  if (!compositor) {
+    return;
+  }
+  // The backing stores are GL objects, which are deleted on the raster thread.
+  // The compositor outlives the raster thread, which is joined by Stop().
+  if (!engine_->PostRenderThreadTask(
+          [compositor]() { compositor->ReleaseIdleBackingStores(); })) {
+    LINUXES_LOG(WARNING) << "Failed to release the idle backing stores.";
+  }
+}
+
+bool FlutterLinuxesView::PresentSoftwareBitmap(const void* allocation,
+                                               size_t row_bytes,
+                                               size_t height) {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventPresent);
+  auto surface = binding_handler_->GetSoftwareRenderSurface();
+  if (!surface) {
+    return false;
+  }
+  return OnFramePresented(surface->Present(allocation, row_bytes, height));
+}
+
+bool FlutterLinuxesView::OnFramePresented(bool presented) {
+  if (presented && InputLatencyTracker::IsEnabled()) {
+    InputLatencyTracker::GetInstance().OnFramePresented(FrameTimeline::Now());
+  }
+  return presented;
+}
+
 bool FlutterLinuxesView::CreateRenderSurface() {
   PhysicalWindowBounds bounds = binding_handler_->GetPhysicalWindowBounds();
+  if (software_rendering_) {
+    LINUXES_LOG(INFO) << "Use the software renderer.";
+    return binding_handler_->CreateSoftwareRenderSurface(bounds.width,
+                                                         bounds.height);
+  }
   return binding_handler_->CreateRenderSurface(bounds.width, bounds.height);
 }
 
@@ -5,24 +5,41 @@
 #ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_FLUTTER_LINUXES_VIEW_H_
 #define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_FLUTTER_LINUXES_VIEW_H_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/plugin_registrar.h"
 #include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/event_loop.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_engine.h"
 #include "flutter/shell/platform/linux_embedded/flutter_linuxes_state.h"
 #include "flutter/shell/platform/linux_embedded/plugin/key_event_plugin.h"
 #include "flutter/shell/platform/linux_embedded/plugin/mouse_cursor_plugin.h"
 #include "flutter/shell/platform/linux_embedded/plugin/platform_plugin.h"
 #include "flutter/shell/platform/linux_embedded/plugin/text_input_plugin.h"
+#include "flutter/shell/platform/linux_embedded/pointer_resampler.h"
 #include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
+#include "flutter/shell/platform/linux_embedded/touch_tracker.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler_delegate.h"
 
 namespace flutter {
 
+// The environment variable which enables pointer motion coalescing. When set
+// to a value other than "0", only the latest move of each pointer in an input
+// frame is sent to the engine.
+constexpr char kCoalescePointerMotionEnvironmentKey[] =
+    "FLUTTER_LINUXES_COALESCE_POINTER_MOTION";
+
+// The environment variable which enables pointer resampling. When set to a
+// value other than "0", the moves of each pointer are sent to the engine once
+// per frame, at a time aligned with the frame. See PointerResampler. Motion
+// coalescing is disabled while resampling is enabled.
+constexpr char kResamplePointerEnvironmentKey[] =
+    "FLUTTER_LINUXES_RESAMPLE_POINTER";
+
 class FlutterLinuxesView : public WindowBindingHandlerDelegate {
  public:
   // Creates a FlutterLinuxesView with the given implementator of
@@ -38,11 +55,22 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   // you have to call this every time in the main loop.
   bool DispatchEvent();
 
+  // Returns a file descriptor that becomes readable when there are events to
+  // be dispatched by DispatchEvent() or tasks to be processed by the engine,
+  // or -1 if it is not available.
+  int GetEventFd() const;
+
+  // Blocks until there are events to be dispatched by DispatchEvent() or
+  // |timeout| elapses. Returns immediately if the window has already queued
+  // events. Returns false if waiting failed.
+  bool WaitEvent(std::chrono::nanoseconds timeout);
+
   // Configures the window instance with an instance of a running Flutter
   // engine.
   void SetEngine(std::unique_ptr<FlutterLinuxesEngine> engine);
 
-  // Creates rendering surface for Flutter engine to draw into.
+  // Creates rendering surface for Flutter engine to draw into. This is a
+  // software surface if the software renderer is selected.
   // Should be called before calling FlutterEngineRun using this view.
   bool CreateRenderSurface();
 
@@ -63,12 +91,39 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   uint32_t GetOnscreenFBO();
   bool MakeResourceCurrent();
 
+  // Returns the compositor which shows the layers of a frame, or nullptr.
+  LinuxesCompositor* GetCompositor() const;
+
+  // Callbacks of the compositor.
+  bool CreateBackingStore(const FlutterBackingStoreConfig& config,
+                          FlutterBackingStore* backing_store_out);
+  bool CollectBackingStore(const FlutterBackingStore& backing_store);
+  bool PresentLayers(const FlutterLayer** layers, size_t layers_count);
+
+  // Copies the statistics of the backing store pool of the compositor to
+  // |stats|. Returns false if there is no compositor.
+  bool GetBackingStorePoolStats(FlutterDesktopBackingStorePoolStats* stats);
+
+  // Releases the resources which the view can recreate.
+  void OnLowMemoryWarning();
+
+  // Callback for showing a frame rendered by the software renderer.
+  bool PresentSoftwareBitmap(const void* allocation, size_t row_bytes,
+                             size_t height);
+
   // Send initial bounds to embedder.  Must occur after engine has initialized.
   void SendInitialBounds();
 
+  // Called on the platform thread before the engine is told to begin the
+  // frame which starts at |frame_start_time_nanos| on the engine clock.
+  void OnFrameStart(uint64_t frame_start_time_nanos);
+
   // |WindowBindingHandlerDelegate|
   void OnWindowSizeChanged(size_t width, size_t height) const override;
 
+  // |WindowBindingHandlerDelegate|
+  void OnInputTimestamp(uint64_t timestamp_micros) override;
+
   // |WindowBindingHandlerDelegate|
   void OnPointerMove(double x, double y) override;
 
@@ -83,6 +138,9 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   // |WindowBindingHandlerDelegate|
   void OnPointerLeave() override;
 
+  // |WindowBindingHandlerDelegate|
+  void OnPointerFrame() override;
+
   // |WindowBindingHandlerDelegate|
   void OnTouchDown(uint32_t time, int32_t id, double x, double y) override;
 
@@ -95,6 +153,12 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   // |WindowBindingHandlerDelegate|
   void OnTouchCancel() override;
 
+  // |WindowBindingHandlerDelegate|
+  void OnTouchFrame() override;
+
+  // |WindowBindingHandlerDelegate|
+  void OnTouchDeviceAdded(int32_t touch_count) override;
+
   // |WindowBindingHandlerDelegate|
   void OnKeyMap(uint32_t format, int fd, uint32_t size) override;
 
@@ -115,7 +179,14 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   void OnScroll(double x, double y, double delta_x, double delta_y,
                 int scroll_offset_multiplier) override;
 
+  // |WindowBindingHandlerDelegate|
+  void OnVblank(uint64_t vblank_time_nanos,
+                uint64_t vsync_interval_nanos) override;
+
  private:
+  // How long the moves are held at most for resampling when no frame starts.
+  static constexpr std::chrono::milliseconds kMaxResampleDelay{32};
+
   // Struct holding the mouse state. The engine doesn't keep track of which
   // mouse buttons have been pressed, so it's the embedding's responsibility.
   struct MouseState {
@@ -132,31 +203,6 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
     uint64_t buttons = 0;
   };
 
-  // User touch input event type.
-  enum TouchEvent {
-    kDown = 1 << 0,
-    kUp = 1 << 1,
-    kMotion = 1 << 2,
-    kCancel = 1 << 3,
-    kShape = 1 << 4,
-    kOrientation = 1 << 5,
-  };
-
-  struct touch_point {
-    bool valid;
-    int32_t id;
-    uint32_t event_mask;
-    double x, y;
-  };
-
-  struct touch_event {
-    uint32_t time;
-    touch_point points[10];
-  };
-
-  //
-  touch_point* GgeTouchPoint(int32_t id);
-
   // Sends a window metrics update to the Flutter engine using current window
   // dimensions in physical
   void SendWindowMetrics(size_t width, size_t height, double dpiscale) const;
@@ -191,6 +237,38 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   // needed before passing on to engine.
   void SendPointerEventWithData(const FlutterPointerEvent& event_data);
 
+  // Queues a touch event of |point| with |phase|.
+  void QueueTouchEvent(FlutterPointerPhase phase, uint32_t time,
+                       const TouchTracker::TouchPoint& point);
+
+  // Queues a pointer event to be sent to the engine together with the other
+  // events of the same input frame. If motion coalescing is enabled, a queued
+  // move of the same pointer is replaced by |event|.
+  void QueuePointerEvent(const FlutterPointerEvent& event);
+
+  // Sends the queued pointer events to the engine in a single call. If
+  // resampling is enabled, the moves are held until the next frame.
+  void FlushPointerEvents();
+
+  // Sends |events| to the engine in a single call, and clears them. The
+  // input latency of the events is measured from |input_timestamps_micros|,
+  // which is also cleared, if it is not null, or else from their timestamps.
+  void SendPointerEvents(std::vector<FlutterPointerEvent>* events,
+                         std::vector<uint64_t>* input_timestamps_micros);
+
+  // Sends the moves held by |pointer_resampler_| if no frame has started
+  // within kMaxResampleDelay, e.g. because the engine doesn't produce frames
+  // until it has received them.
+  void ScheduleResampleTimeout();
+
+  // Returns the timestamp of the pointer events of the current input frame,
+  // in microseconds on the clock of the engine.
+  uint64_t GetInputTimestamp() const;
+
+  // Records the presentation of a frame for the input latency measurement if
+  // |presented|, and returns |presented|.
+  bool OnFramePresented(bool presented);
+
   // Resets the mouse state to its default values.
   void ResetMouseState() { mouse_state_ = MouseState(); }
 
@@ -233,8 +311,45 @@ class FlutterLinuxesView : public WindowBindingHandlerDelegate {
   // Currently configured WindowBindingHandler for view.
   std::unique_ptr<flutter::WindowBindingHandler> binding_handler_;
 
-  // Current user touch event status.
-  touch_event touch_event_;
+  // Waits for window events and the next Flutter task.
+  std::unique_ptr<EventLoop> event_loop_;
+
+  // Whether |event_loop_| is woken up by the window events and the tasks
+  // posted from other threads. If not, WaitEvent() polls.
+  bool can_wake_up_ = true;
+
+  // The touch points which are currently down.
+  TouchTracker touch_tracker_;
+
+  // Pointer events of the current input frame which haven't been sent yet.
+  std::vector<FlutterPointerEvent> pending_pointer_events_;
+
+  // The time at which the pointer events of the current input frame were
+  // generated, in microseconds, or 0 if the window doesn't know it.
+  uint64_t input_timestamp_micros_ = 0;
+
+  // Whether to send only the latest move of each pointer per input frame.
+  bool coalesce_pointer_motion_ = false;
+
+  // Holds the moves until the next frame if resampling is enabled.
+  std::unique_ptr<PointerResampler> pointer_resampler_;
+
+  // The moves resampled at the start of a frame which haven't been sent yet.
+  std::vector<FlutterPointerEvent> resampled_pointer_events_;
+
+  // The timestamps of the received moves which |resampled_pointer_events_|
+  // are computed from.
+  std::vector<uint64_t> resampled_input_timestamps_;
+
+  // The number of frames which have started, to tell whether the held moves
+  // have been sent by a frame.
+  uint64_t frame_count_ = 0;
+
+  // Whether a task which sends the held moves is posted.
+  bool is_resample_timeout_pending_ = false;
+
+  // Whether frames are rendered by the software renderer instead of OpenGL ES.
+  bool software_rendering_ = false;
 };
 
 }  // namespace flutter
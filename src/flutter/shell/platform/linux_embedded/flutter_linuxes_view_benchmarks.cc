@@ -0,0 +1,197 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/flutter_linuxes_view.h"
+#include "flutter/shell/platform/linux_embedded/testing/engine_embedder_api_modifier.h"
+#include "flutter/shell/platform/linux_embedded/testing/fake_window_binding_handler.h"
+#include "flutter/shell/platform/linux_embedded/testing/test_engine.h"
+
+namespace flutter {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The replayed input: a 1000Hz mouse and a 240Hz touch panel with 10 fingers
+// moving at the same time, for 100ms.
+constexpr auto kReplayDuration = std::chrono::milliseconds(100);
+constexpr auto kMouseInterval = std::chrono::milliseconds(1);
+constexpr auto kTouchFrameInterval = std::chrono::microseconds(4167);
+constexpr int kFingerCount = 10;
+
+// How often the platform thread dispatches the window events. Events which
+// arrive while it is busy with other tasks are dispatched together.
+constexpr auto kDispatchInterval = std::chrono::milliseconds(4);
+
+// How the view sends the input to the engine.
+enum ReplayMode {
+  // One engine call per event, as if every event ended an input frame.
+  kUnbatched,
+  // One engine call per input frame.
+  kBatched,
+  // One engine call per input frame, with only the latest move of each
+  // pointer.
+  kBatchedAndCoalesced,
+};
+
+// An input event of the replayed trace.
+struct ReplayEvent {
+  enum Type { kMouseMove, kTouchMotion, kTouchFrame };
+
+  Clock::duration time;
+  Type type;
+  int32_t id;
+  double x;
+  double y;
+};
+
+std::vector<ReplayEvent> CreateTrace() {
+  std::vector<ReplayEvent> trace;
+  for (auto t = Clock::duration::zero(); t < kReplayDuration;
+       t += kMouseInterval) {
+    auto phase = std::chrono::duration<double>(t).count();
+    trace.push_back({t, ReplayEvent::kMouseMove, 0, 400 + 300 * std::sin(phase),
+                     300 + 200 * std::cos(phase)});
+  }
+  for (auto t = Clock::duration::zero(); t < kReplayDuration;
+       t += kTouchFrameInterval) {
+    auto phase = std::chrono::duration<double>(t).count();
+    for (int i = 0; i < kFingerCount; i++) {
+      trace.push_back({t, ReplayEvent::kTouchMotion, i, 60.0 + 70 * i,
+                       300 + 200 * std::sin(phase + i)});
+    }
+    trace.push_back({t, ReplayEvent::kTouchFrame, 0, 0, 0});
+  }
+  std::stable_sort(
+      trace.begin(), trace.end(),
+      [](const auto& a, const auto& b) { return a.time < b.time; });
+  return trace;
+}
+
+// What the fake engine has received.
+struct EngineStats {
+  int64_t calls = 0;
+  int64_t events = 0;
+  double total_latency_micros = 0;
+  int64_t max_latency_micros = 0;
+};
+EngineStats engine_stats;
+
+FlutterEngineResult SendPointerEvent(FLUTTER_API_SYMBOL(FlutterEngine) engine,
+                                     const FlutterPointerEvent* events,
+                                     size_t count) {
+  auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                 Clock::now().time_since_epoch())
+                 .count();
+  engine_stats.calls++;
+  for (size_t i = 0; i < count; i++) {
+    if (events[i].phase == FlutterPointerPhase::kAdd) {
+      continue;
+    }
+    auto latency = now - static_cast<int64_t>(events[i].timestamp);
+    engine_stats.events++;
+    engine_stats.total_latency_micros += latency;
+    engine_stats.max_latency_micros =
+        std::max(engine_stats.max_latency_micros, latency);
+  }
+  return kSuccess;
+}
+
+// Replays the input trace to a view in real time, and reports how many
+// engine calls it took and how long the events took from the device to the
+// engine.
+void BM_ReplayInput(benchmark::State& state) {
+  auto mode = static_cast<ReplayMode>(state.range(0));
+  if (mode == kBatchedAndCoalesced) {
+    setenv(kCoalescePointerMotionEnvironmentKey, "1", 1);
+  }
+  auto window = std::make_unique<testing::FakeWindowBindingHandler>();
+  auto delegate_holder = window.get();
+  FlutterLinuxesView view(std::move(window));
+  unsetenv(kCoalescePointerMotionEnvironmentKey);
+  auto delegate = delegate_holder->view();
+
+  auto engine = testing::CreateTestEngine();
+  EngineEmbedderApiModifier modifier(engine.get());
+  modifier.embedder_api().SendPointerEvent = SendPointerEvent;
+  if (!engine->RunWithEntrypoint(nullptr)) {
+    state.SkipWithError("Failed to run the engine");
+    return;
+  }
+  view.SetEngine(std::move(engine));
+
+  for (int i = 0; i < kFingerCount; i++) {
+    delegate->OnTouchDown(0, i, 60.0 + 70 * i, 300);
+  }
+  delegate->OnTouchFrame();
+
+  const auto trace = CreateTrace();
+  engine_stats = EngineStats();
+  for (auto _ : state) {
+    const auto start = Clock::now();
+    auto next = trace.begin();
+    while (next != trace.end()) {
+      auto dispatch_time = Clock::now();
+      for (; next != trace.end() && start + next->time <= dispatch_time;
+           ++next) {
+        // The time the device generated the event.
+        delegate->OnInputTimestamp(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                (start + next->time).time_since_epoch())
+                .count());
+        switch (next->type) {
+          case ReplayEvent::kMouseMove:
+            delegate->OnPointerMove(next->x, next->y);
+            if (mode == kUnbatched) {
+              delegate->OnPointerFrame();
+            }
+            break;
+          case ReplayEvent::kTouchMotion:
+            delegate->OnTouchMotion(0, next->id, next->x, next->y);
+            if (mode == kUnbatched) {
+              delegate->OnTouchFrame();
+            }
+            break;
+          case ReplayEvent::kTouchFrame:
+            delegate->OnTouchFrame();
+            break;
+        }
+      }
+      view.DispatchEvent();
+      std::this_thread::sleep_until(dispatch_time + kDispatchInterval);
+    }
+  }
+
+  state.counters["engine_calls"] = benchmark::Counter(
+      engine_stats.calls, benchmark::Counter::kAvgIterations);
+  state.counters["events"] = benchmark::Counter(
+      engine_stats.events, benchmark::Counter::kAvgIterations);
+  state.counters["mean_latency_us"] =
+      engine_stats.events
+          ? engine_stats.total_latency_micros / engine_stats.events
+          : 0;
+  state.counters["max_latency_us"] = engine_stats.max_latency_micros;
+}
+BENCHMARK(BM_ReplayInput)
+    ->ArgName("mode")
+    ->Arg(kUnbatched)
+    ->Arg(kBatched)
+    ->Arg(kBatchedAndCoalesced)
+    ->Iterations(10)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace flutter
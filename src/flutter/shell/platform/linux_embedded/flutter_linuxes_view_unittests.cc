@@ -0,0 +1,263 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/flutter_linuxes_view.h"
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_compositor.h"
+#include "flutter/shell/platform/linux_embedded/testing/engine_embedder_api_modifier.h"
+#include "flutter/shell/platform/linux_embedded/testing/fake_window_binding_handler.h"
+#include "flutter/shell/platform/linux_embedded/testing/test_engine.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// The pointer events received by the fake engine, one entry per call.
+std::vector<std::vector<FlutterPointerEvent>> sent_pointer_events;
+
+FlutterEngineResult RecordPointerEvents(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPointerEvent* events,
+    size_t count) {
+  sent_pointer_events.emplace_back(events, events + count);
+  return kSuccess;
+}
+
+// Feeds input to a view running on the fake engine, the way a libinput or
+// Wayland window would.
+class FlutterLinuxesViewTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    sent_pointer_events.clear();
+    auto window = std::make_unique<FakeWindowBindingHandler>();
+    auto window_ptr = window.get();
+    view_ = std::make_unique<FlutterLinuxesView>(std::move(window));
+    delegate_ = window_ptr->view();
+
+    auto engine = CreateTestEngine();
+    EngineEmbedderApiModifier modifier(engine.get());
+    modifier.embedder_api().SendPointerEvent = RecordPointerEvents;
+    ASSERT_TRUE(engine->RunWithEntrypoint(nullptr));
+    view_->SetEngine(std::move(engine));
+  }
+
+  void TearDown() override { view_.reset(); }
+
+  // Returns the events of the only engine call since the last call of this,
+  // and clears them.
+  std::vector<FlutterPointerEvent> TakeSingleBatch() {
+    EXPECT_EQ(sent_pointer_events.size(), 1u);
+    if (sent_pointer_events.empty()) {
+      return {};
+    }
+    auto events = sent_pointer_events.front();
+    sent_pointer_events.clear();
+    return events;
+  }
+
+  std::unique_ptr<FlutterLinuxesView> view_;
+  WindowBindingHandlerDelegate* delegate_ = nullptr;
+};
+
+// The number of fingers, more than the 10 which are commonly supported.
+constexpr int32_t kFingerCount = 12;
+
+// The tasks posted to the raster thread of the fake engine, which the tests
+// run by themselves.
+std::vector<std::pair<VoidCallback, void*>> render_thread_tasks;
+
+FlutterEngineResult RecordRenderThreadTask(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    VoidCallback callback,
+    void* callback_data) {
+  render_thread_tasks.emplace_back(callback, callback_data);
+  return kSuccess;
+}
+
+// A compositor which only counts how often the idle backing stores are
+// released.
+class FakeCompositor : public LinuxesCompositor {
+ public:
+  // |LinuxesCompositor|
+  bool CreateBackingStore(const FlutterBackingStoreConfig& config,
+                          FlutterBackingStore* backing_store_out) override {
+    return false;
+  }
+
+  // |LinuxesCompositor|
+  bool CollectBackingStore(const FlutterBackingStore& backing_store) override {
+    return false;
+  }
+
+  // |LinuxesCompositor|
+  bool PresentLayers(const FlutterLayer** layers,
+                     size_t layers_count) override {
+    return false;
+  }
+
+  // |LinuxesCompositor|
+  FlutterDesktopBackingStorePoolStats GetBackingStorePoolStats()
+      const override {
+    return {};
+  }
+
+  // |LinuxesCompositor|
+  void ReleaseIdleBackingStores() override { release_count++; }
+
+  int release_count = 0;
+};
+
+}  // namespace
+
+TEST_F(FlutterLinuxesViewTest, GivesEachFingerItsOwnDevice) {
+  for (int32_t slot = 0; slot < kFingerCount; slot++) {
+    delegate_->OnTouchDown(100, slot, 10.0 * slot, 20.0);
+  }
+  EXPECT_TRUE(sent_pointer_events.empty());
+  delegate_->OnTouchFrame();
+
+  auto downs = TakeSingleBatch();
+  ASSERT_EQ(downs.size(), static_cast<size_t>(kFingerCount));
+  std::set<int32_t> devices;
+  for (int32_t slot = 0; slot < kFingerCount; slot++) {
+    const auto& event = downs[slot];
+    EXPECT_EQ(event.phase, FlutterPointerPhase::kDown);
+    EXPECT_EQ(event.device_kind, kFlutterPointerDeviceKindTouch);
+    EXPECT_EQ(event.x, 10.0 * slot);
+    EXPECT_EQ(event.timestamp, 100000u);
+    devices.insert(event.device);
+  }
+  EXPECT_EQ(devices.size(), static_cast<size_t>(kFingerCount));
+
+  // The moves of each finger keep its device.
+  for (int32_t slot = kFingerCount - 1; slot >= 0; slot--) {
+    delegate_->OnTouchMotion(108, slot, 10.0 * slot + 1, 30.0);
+  }
+  delegate_->OnTouchFrame();
+  auto moves = TakeSingleBatch();
+  ASSERT_EQ(moves.size(), static_cast<size_t>(kFingerCount));
+  for (int32_t i = 0; i < kFingerCount; i++) {
+    const auto& event = moves[i];
+    auto slot = kFingerCount - 1 - i;
+    EXPECT_EQ(event.phase, FlutterPointerPhase::kMove);
+    EXPECT_EQ(event.device, downs[slot].device);
+    EXPECT_EQ(event.x, 10.0 * slot + 1);
+    EXPECT_EQ(event.y, 30.0);
+  }
+}
+
+TEST_F(FlutterLinuxesViewTest, ReusesSlotOfLiftedFinger) {
+  for (int32_t slot = 0; slot < kFingerCount; slot++) {
+    delegate_->OnTouchDown(100, slot, 10.0 * slot, 20.0);
+  }
+  delegate_->OnTouchFrame();
+  auto downs = TakeSingleBatch();
+
+  delegate_->OnTouchUp(110, 3);
+  delegate_->OnTouchFrame();
+  auto ups = TakeSingleBatch();
+  ASSERT_EQ(ups.size(), 1u);
+  EXPECT_EQ(ups[0].phase, FlutterPointerPhase::kUp);
+  EXPECT_EQ(ups[0].device, downs[3].device);
+  EXPECT_EQ(ups[0].x, 30.0);
+
+  // Events for the lifted finger are dropped until it touches again.
+  delegate_->OnTouchMotion(115, 3, 50.0, 50.0);
+  delegate_->OnTouchUp(115, 3);
+  delegate_->OnTouchFrame();
+  EXPECT_TRUE(sent_pointer_events.empty());
+
+  // A new finger in the same slot starts a new touch sequence while the
+  // other fingers stay down.
+  delegate_->OnTouchDown(120, 3, 200.0, 210.0);
+  delegate_->OnTouchMotion(120, 4, 41.0, 20.0);
+  delegate_->OnTouchFrame();
+  auto events = TakeSingleBatch();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].phase, FlutterPointerPhase::kDown);
+  EXPECT_EQ(events[0].device, downs[3].device);
+  EXPECT_EQ(events[0].x, 200.0);
+  EXPECT_EQ(events[1].phase, FlutterPointerPhase::kMove);
+  EXPECT_EQ(events[1].device, downs[4].device);
+}
+
+TEST_F(FlutterLinuxesViewTest, CancelsStaleTouchOnSecondDown) {
+  delegate_->OnTouchDown(100, 5, 10.0, 20.0);
+  delegate_->OnTouchFrame();
+  auto down = TakeSingleBatch();
+
+  // The up of the first touch got lost.
+  delegate_->OnTouchDown(200, 5, 30.0, 40.0);
+  delegate_->OnTouchFrame();
+  auto events = TakeSingleBatch();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].phase, FlutterPointerPhase::kCancel);
+  EXPECT_EQ(events[0].device, down[0].device);
+  EXPECT_EQ(events[0].x, 10.0);
+  EXPECT_EQ(events[1].phase, FlutterPointerPhase::kDown);
+  EXPECT_EQ(events[1].device, down[0].device);
+  EXPECT_EQ(events[1].x, 30.0);
+}
+
+TEST_F(FlutterLinuxesViewTest, CancelsAllTouchesOnTouchCancel) {
+  for (int32_t slot = 0; slot < kFingerCount; slot++) {
+    delegate_->OnTouchDown(100, slot, 10.0 * slot, 20.0);
+  }
+  delegate_->OnTouchFrame();
+  auto downs = TakeSingleBatch();
+  delegate_->OnTouchUp(110, 0);
+  delegate_->OnTouchFrame();
+  TakeSingleBatch();
+
+  // The cancel is sent right away, without waiting for a frame.
+  delegate_->OnTouchCancel();
+  auto cancels = TakeSingleBatch();
+  ASSERT_EQ(cancels.size(), static_cast<size_t>(kFingerCount - 1));
+  for (int32_t i = 0; i < kFingerCount - 1; i++) {
+    EXPECT_EQ(cancels[i].phase, FlutterPointerPhase::kCancel);
+    EXPECT_EQ(cancels[i].device, downs[i + 1].device);
+  }
+
+  // All the slots can be used again.
+  delegate_->OnTouchDown(130, 0, 1.0, 2.0);
+  delegate_->OnTouchDown(130, 1, 3.0, 4.0);
+  delegate_->OnTouchFrame();
+  auto events = TakeSingleBatch();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].phase, FlutterPointerPhase::kDown);
+  EXPECT_EQ(events[1].phase, FlutterPointerPhase::kDown);
+}
+
+TEST(FlutterLinuxesViewLowMemoryTest, ReleasesBackingStoresOnRasterThread) {
+  render_thread_tasks.clear();
+  FakeCompositor compositor;
+  auto window = std::make_unique<FakeWindowBindingHandler>();
+  window->set_compositor(&compositor);
+  FlutterLinuxesView view(std::move(window));
+
+  auto engine = CreateTestEngine();
+  EngineEmbedderApiModifier modifier(engine.get());
+  modifier.embedder_api().PostRenderThreadTask = RecordRenderThreadTask;
+  ASSERT_TRUE(engine->RunWithEntrypoint(nullptr));
+  view.SetEngine(std::move(engine));
+
+  // The warning comes on the platform thread, where the GL objects of the
+  // stores can't be deleted.
+  view.GetEngine()->NotifyLowMemoryWarning();
+  EXPECT_EQ(compositor.release_count, 0);
+  ASSERT_EQ(render_thread_tasks.size(), 1u);
+
+  render_thread_tasks[0].first(render_thread_tasks[0].second);
+  EXPECT_EQ(compositor.release_count, 1);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,126 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace flutter {
+
+namespace {
+
+constexpr const char* kEventNames[kFlutterDesktopFrameEventCount] = {
+    "make_current", "get_fbo",   "present",
+    "swap_buffers", "page_flip", "populate_texture"};
+
+double ToMilliseconds(uint64_t nanos) {
+  return nanos / 1e6;
+}
+
+}  // namespace
+
+FrameTimeline& FrameTimeline::GetInstance() {
+  static FrameTimeline instance;
+  return instance;
+}
+
+void FrameTimeline::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void FrameTimeline::Record(FlutterDesktopFrameEventType type,
+                           uint64_t start_time_nanos,
+                           uint64_t end_time_nanos) {
+  auto index = next_index_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[index & (kCapacity - 1)];
+
+  // A seqlock per slot, so that readers can detect torn events.
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.type.store(type, std::memory_order_relaxed);
+  slot.start_time_nanos.store(start_time_nanos, std::memory_order_relaxed);
+  slot.end_time_nanos.store(end_time_nanos, std::memory_order_relaxed);
+  slot.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+bool FrameTimeline::ReadEvent(uint64_t index,
+                              FlutterDesktopFrameEvent* event) const {
+  const auto& slot = slots_[index & (kCapacity - 1)];
+  const auto sequence = 2 * (index + 1);
+  if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+    return false;
+  }
+  event->type = static_cast<FlutterDesktopFrameEventType>(
+      slot.type.load(std::memory_order_relaxed));
+  event->start_time_nanos =
+      slot.start_time_nanos.load(std::memory_order_relaxed);
+  event->end_time_nanos = slot.end_time_nanos.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+size_t FrameTimeline::GetEvents(FlutterDesktopFrameEvent* events,
+                                size_t max_events) const {
+  const auto end = next_index_.load(std::memory_order_acquire);
+  const auto count = std::min<uint64_t>({end, kCapacity, max_events});
+
+  size_t copied = 0;
+  for (auto index = end - count; index < end; index++) {
+    if (ReadEvent(index, &events[copied])) {
+      copied++;
+    }
+  }
+  return copied;
+}
+
+void FrameTimeline::StartStatsDump(std::chrono::seconds interval) {
+  SetEnabled(true);
+  auto last_dumped_index = next_index_.load(std::memory_order_acquire);
+  stats_dumper_.Start(interval, [this, last_dumped_index]() mutable {
+    return DumpStats(&last_dumped_index);
+  });
+}
+
+std::string FrameTimeline::DumpStats(uint64_t* last_dumped_index) {
+  const auto end = next_index_.load(std::memory_order_acquire);
+  auto begin = std::max<uint64_t>(*last_dumped_index,
+                                  end > kCapacity ? end - kCapacity : 0);
+  *last_dumped_index = end;
+
+  std::vector<uint64_t> durations[kFlutterDesktopFrameEventCount];
+  for (auto index = begin; index < end; index++) {
+    FlutterDesktopFrameEvent event;
+    if (ReadEvent(index, &event) && event.type >= 0 &&
+        event.type < kFlutterDesktopFrameEventCount) {
+      durations[event.type].push_back(event.end_time_nanos -
+                                      event.start_time_nanos);
+    }
+  }
+
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  stream << "[FRAME STATS] "
+         << durations[kFlutterDesktopFrameEventPresent].size()
+         << " frames (ms):";
+  for (int type = 0; type < kFlutterDesktopFrameEventCount; type++) {
+    auto& values = durations[type];
+    if (values.empty()) {
+      continue;
+    }
+    std::sort(values.begin(), values.end());
+    stream << " " << kEventNames[type];
+    for (auto percentile : kDumpedPercentiles) {
+      stream << " p" << percentile << "="
+             << ToMilliseconds(Percentile(values, percentile));
+    }
+    stream << ";";
+  }
+  stream << std::endl;
+  return stream.str();
+}
+
+}  // namespace flutter
@@ -0,0 +1,121 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_FRAME_TIMELINE_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_FRAME_TIMELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
+#include "flutter/shell/platform/linux_embedded/stats_dumper.h"
+
+namespace flutter {
+
+// The environment variable which enables the frame timeline and periodically
+// dumps the percentiles of each step. Its value is the dump interval in
+// seconds.
+constexpr char kFrameStatsEnvironmentKey[] = "FLUTTER_LINUXES_FRAME_STATS";
+
+// Records the time spent in each step of the render path into a fixed-size
+// ring buffer. Recording is lock-free and can be done from any thread. When
+// disabled, recording costs a relaxed atomic load and does not read the clock.
+class FrameTimeline {
+ public:
+  // The number of events kept. Must be a power of two.
+  static constexpr size_t kCapacity = 4096;
+
+  // Returns the process-wide timeline.
+  static FrameTimeline& GetInstance();
+
+  // Returns whether recording is enabled.
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns the current time on the monotonic clock.
+  static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  ~FrameTimeline() = default;
+
+  // Prevent copying.
+  FrameTimeline(FrameTimeline const&) = delete;
+  FrameTimeline& operator=(FrameTimeline const&) = delete;
+
+  void SetEnabled(bool enabled);
+
+  // Records an event. The oldest event is overwritten when the buffer is full.
+  void Record(FlutterDesktopFrameEventType type,
+              uint64_t start_time_nanos,
+              uint64_t end_time_nanos);
+
+  // Copies up to |max_events| of the most recent events to |events|, oldest
+  // first. Events which are being overwritten while copying are skipped.
+  // Returns the number of copied events.
+  size_t GetEvents(FlutterDesktopFrameEvent* events, size_t max_events) const;
+
+  // Enables recording and starts a thread which logs the p50/p95/p99 of each
+  // step every |interval|.
+  void StartStatsDump(std::chrono::seconds interval);
+
+ private:
+  struct Slot {
+    // 2 * (index + 1) once the event at |index| has been written, odd while
+    // it is being written.
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint32_t> type{0};
+    std::atomic<uint64_t> start_time_nanos{0};
+    std::atomic<uint64_t> end_time_nanos{0};
+  };
+
+  FrameTimeline() = default;
+
+  // Reads the event at |index| into |event|. Returns false if it has been
+  // overwritten or is being written.
+  bool ReadEvent(uint64_t index, FlutterDesktopFrameEvent* event) const;
+
+  // Returns the line of the percentiles of the events recorded since
+  // |*last_dumped_index|, which is updated.
+  std::string DumpStats(uint64_t* last_dumped_index);
+
+  static inline std::atomic<bool> enabled_{false};
+
+  Slot slots_[kCapacity];
+  std::atomic<uint64_t> next_index_{0};
+
+  // Declared last so that the thread stops first.
+  StatsDumper stats_dumper_;
+};
+
+// Records the duration of the enclosing scope.
+class ScopedFrameEvent {
+ public:
+  explicit ScopedFrameEvent(FlutterDesktopFrameEventType type)
+      : type_(type),
+        start_time_nanos_(FrameTimeline::IsEnabled() ? FrameTimeline::Now()
+                                                     : 0) {}
+
+  ~ScopedFrameEvent() {
+    if (start_time_nanos_ != 0) {
+      FrameTimeline::GetInstance().Record(type_, start_time_nanos_,
+                                          FrameTimeline::Now());
+    }
+  }
+
+  // Prevent copying.
+  ScopedFrameEvent(ScopedFrameEvent const&) = delete;
+  ScopedFrameEvent& operator=(ScopedFrameEvent const&) = delete;
+
+ private:
+  FlutterDesktopFrameEventType type_;
+  uint64_t start_time_nanos_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_FRAME_TIMELINE_H_
@@ -0,0 +1,185 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace flutter {
+
+namespace {
+
+constexpr const char* kLatencyNames[kFlutterDesktopInputLatencyCount] = {
+    "present", "scanout"};
+
+constexpr uint64_t kNanosPerMillisecond = 1000000;
+
+}  // namespace
+
+InputLatencyTracker& InputLatencyTracker::GetInstance() {
+  static InputLatencyTracker instance;
+  return instance;
+}
+
+void InputLatencyTracker::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void InputLatencyTracker::OnInputSent(uint64_t input_time_nanos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (sent_events_.size() >= kMaxPendingEvents) {
+    DropExpiredEvents(input_time_nanos);
+    if (sent_events_.size() >= kMaxPendingEvents) {
+      sent_events_.erase(sent_events_.begin());
+      dropped_count_++;
+    }
+  }
+  sent_events_.push_back({input_time_nanos, frame_start_count_});
+}
+
+void InputLatencyTracker::OnFrameStart(uint64_t start_time_nanos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  frame_start_count_++;
+  started_frames_.push_back({frame_start_count_, start_time_nanos});
+  if (started_frames_.size() > kMaxFramesInFlight) {
+    started_frames_.pop_front();
+  }
+}
+
+void InputLatencyTracker::OnFramePresented(uint64_t present_time_nanos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DropExpiredEvents(present_time_nanos);
+
+  // The frame which was started the earliest is presented first. Without a
+  // known start, e.g. just after enabling, it is taken as the latest one.
+  const uint64_t max_latency_nanos =
+      std::chrono::nanoseconds(kMaxLatency).count();
+  while (!started_frames_.empty() &&
+         started_frames_.front().start_time_nanos + max_latency_nanos <
+             present_time_nanos) {
+    started_frames_.pop_front();
+  }
+  uint64_t frame = frame_start_count_;
+  if (!started_frames_.empty()) {
+    frame = started_frames_.front().number;
+    started_frames_.pop_front();
+  }
+
+  // Only the last presented frame can be scanned out next. The events of the
+  // frames which the display hasn't shown, e.g. on backends without page
+  // flip events, are not measured.
+  presented_input_times_nanos_.clear();
+  auto shown = std::stable_partition(
+      sent_events_.begin(), sent_events_.end(),
+      [frame](const SentEvent& event) {
+        return event.frame_start_count < frame;
+      });
+  for (auto it = sent_events_.begin(); it != shown; ++it) {
+    presented_input_times_nanos_.push_back(it->input_time_nanos);
+  }
+  sent_events_.erase(sent_events_.begin(), shown);
+  RecordLatencies(kFlutterDesktopInputLatencyPresent,
+                  presented_input_times_nanos_, present_time_nanos);
+}
+
+void InputLatencyTracker::OnFrameScannedOut(uint64_t scanout_time_nanos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RecordLatencies(kFlutterDesktopInputLatencyScanout,
+                  presented_input_times_nanos_, scanout_time_nanos);
+  presented_input_times_nanos_.clear();
+}
+
+size_t InputLatencyTracker::GetHistogram(FlutterDesktopInputLatencyType type,
+                                         uint64_t* counts,
+                                         size_t bucket_count) {
+  if (type < 0 || type >= kFlutterDesktopInputLatencyCount) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  bucket_count = std::min(bucket_count, kBucketCount);
+  std::copy_n(histograms_[type].counts, bucket_count, counts);
+  return bucket_count;
+}
+
+void InputLatencyTracker::StartStatsDump(std::chrono::seconds interval) {
+  SetEnabled(true);
+  stats_dumper_.Start(interval, [this]() { return DumpStats(); });
+}
+
+void InputLatencyTracker::DropExpiredEvents(uint64_t time_nanos) {
+  const uint64_t max_latency_nanos =
+      std::chrono::nanoseconds(kMaxLatency).count();
+  auto expired = std::remove_if(
+      sent_events_.begin(), sent_events_.end(),
+      [time_nanos, max_latency_nanos](const SentEvent& event) {
+        return event.input_time_nanos + max_latency_nanos < time_nanos;
+      });
+  dropped_count_ += std::distance(expired, sent_events_.end());
+  sent_events_.erase(expired, sent_events_.end());
+}
+
+void InputLatencyTracker::RecordLatencies(
+    FlutterDesktopInputLatencyType type,
+    const std::vector<uint64_t>& input_times_nanos,
+    uint64_t end_time_nanos) {
+  auto& histogram = histograms_[type];
+  for (auto input_time_nanos : input_times_nanos) {
+    // The clocks of some input sources may be slightly ahead.
+    auto latency_nanos = end_time_nanos > input_time_nanos
+                             ? end_time_nanos - input_time_nanos
+                             : 0;
+    auto bucket =
+        std::min<uint64_t>(latency_nanos / kNanosPerMillisecond,
+                           kBucketCount - 1);
+    histogram.counts[bucket]++;
+    histogram.total_count++;
+  }
+}
+
+std::string InputLatencyTracker::DumpStats() {
+  Histogram histograms[kFlutterDesktopInputLatencyCount];
+  uint64_t dropped_count;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::copy_n(histograms_, kFlutterDesktopInputLatencyCount, histograms);
+    dropped_count = dropped_count_;
+    dropped_count_ = 0;
+  }
+
+  std::ostringstream stream;
+  stream << "[INPUT LATENCY] "
+         << histograms[kFlutterDesktopInputLatencyPresent].total_count -
+                last_dumped_histograms_[kFlutterDesktopInputLatencyPresent]
+                    .total_count
+         << " events, " << dropped_count << " dropped (ms):";
+  for (int type = 0; type < kFlutterDesktopInputLatencyCount; type++) {
+    // The latencies measured since the last dump.
+    Histogram interval;
+    for (size_t bucket = 0; bucket < kBucketCount; bucket++) {
+      interval.counts[bucket] = histograms[type].counts[bucket] -
+                                last_dumped_histograms_[type].counts[bucket];
+    }
+    interval.total_count = histograms[type].total_count -
+                           last_dumped_histograms_[type].total_count;
+    if (interval.total_count == 0) {
+      continue;
+    }
+    stream << " " << kLatencyNames[type];
+    // The buckets are 1 ms wide.
+    for (auto percentile : kDumpedPercentiles) {
+      stream << " p" << percentile << "="
+             << HistogramPercentile(interval.counts, kBucketCount,
+                                    interval.total_count, percentile);
+    }
+    stream << ";";
+  }
+  stream << std::endl;
+
+  std::copy_n(histograms, kFlutterDesktopInputLatencyCount,
+              last_dumped_histograms_);
+  return stream.str();
+}
+
+}  // namespace flutter
@@ -0,0 +1,159 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_INPUT_LATENCY_TRACKER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_INPUT_LATENCY_TRACKER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
+#include "flutter/shell/platform/linux_embedded/stats_dumper.h"
+
+namespace flutter {
+
+// The environment variable which enables the input latency measurement and
+// periodically dumps the percentiles. Its value is the dump interval in
+// seconds.
+constexpr char kInputLatencyEnvironmentKey[] = "FLUTTER_LINUXES_INPUT_LATENCY";
+
+// Measures the latency from the generation of input events to the frames
+// which show them.
+//
+// The engine doesn't tell which frame reflects an input event. An event sent
+// to the engine is handled before the next frame starts, so it is attributed
+// to the first frame which starts after it, and that frame to the first page
+// flip which completes after it is presented. The frames are assumed to be
+// presented in the order they start. A frame which isn't presented within
+// kMaxLatency, or while kMaxFramesInFlight newer ones start, is assumed to
+// have been skipped by the engine. Events which don't change the screen are
+// attributed to the next frame, unless it comes later than kMaxLatency.
+class InputLatencyTracker {
+ public:
+  // The number of buckets of 1 millisecond in the histograms. The last one
+  // also counts the longer latencies.
+  static constexpr size_t kBucketCount = 200;
+
+  // The events which are not presented within this time are dropped.
+  static constexpr std::chrono::seconds kMaxLatency{1};
+
+  // The number of events which can wait for a frame.
+  static constexpr size_t kMaxPendingEvents = 4096;
+
+  // The number of frames which can be started but not presented yet, as the
+  // engine builds a frame while it rasterizes the previous one.
+  static constexpr size_t kMaxFramesInFlight = 2;
+
+  // Returns the process-wide tracker.
+  static InputLatencyTracker& GetInstance();
+
+  // Returns whether measuring is enabled.
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  ~InputLatencyTracker() = default;
+
+  // Prevent copying.
+  InputLatencyTracker(InputLatencyTracker const&) = delete;
+  InputLatencyTracker& operator=(InputLatencyTracker const&) = delete;
+
+  void SetEnabled(bool enabled);
+
+  // Records that an input event generated at |input_time_nanos| on the
+  // monotonic clock has been sent to the engine.
+  void OnInputSent(uint64_t input_time_nanos);
+
+  // Records that the engine has been told at |start_time_nanos| to start a
+  // frame.
+  void OnFrameStart(uint64_t start_time_nanos);
+
+  // Records that the engine has presented a frame at |present_time_nanos|.
+  void OnFramePresented(uint64_t present_time_nanos);
+
+  // Records that the display has started to scan out the last presented frame
+  // at |scanout_time_nanos|.
+  void OnFrameScannedOut(uint64_t scanout_time_nanos);
+
+  // Copies up to |bucket_count| buckets of the histogram of |type| to
+  // |counts|. Returns the number of copied buckets.
+  size_t GetHistogram(FlutterDesktopInputLatencyType type,
+                      uint64_t* counts,
+                      size_t bucket_count);
+
+  // Enables measuring and starts a thread which logs the p50/p95/p99 of the
+  // latencies measured every |interval|.
+  void StartStatsDump(std::chrono::seconds interval);
+
+ private:
+  struct Histogram {
+    uint64_t counts[kBucketCount] = {};
+    uint64_t total_count = 0;
+  };
+
+  // An event sent to the engine.
+  struct SentEvent {
+    uint64_t input_time_nanos;
+    // The number of frames started before the event was sent.
+    uint64_t frame_start_count;
+  };
+
+  // A frame which has started but not been presented yet.
+  struct StartedFrame {
+    // The value of |frame_start_count_| after the frame started.
+    uint64_t number;
+    uint64_t start_time_nanos;
+  };
+
+  InputLatencyTracker() = default;
+
+  // Removes the events of |sent_events_| generated more than kMaxLatency
+  // before |time_nanos|.
+  void DropExpiredEvents(uint64_t time_nanos);
+
+  // Adds the latencies from |input_times_nanos| to |end_time_nanos| to the
+  // histogram of |type|.
+  void RecordLatencies(FlutterDesktopInputLatencyType type,
+                       const std::vector<uint64_t>& input_times_nanos,
+                       uint64_t end_time_nanos);
+
+  // Returns the line of the percentiles of the latencies measured since the
+  // last dump.
+  std::string DumpStats();
+
+  static inline std::atomic<bool> enabled_{false};
+
+  std::mutex mutex_;
+
+  // The events sent to the engine which no presented frame has started after.
+  std::vector<SentEvent> sent_events_;
+
+  // The number of frames started so far.
+  uint64_t frame_start_count_ = 0;
+
+  // The frames which have started but not been presented yet, the oldest
+  // first.
+  std::deque<StartedFrame> started_frames_;
+
+  // The events of the last presented frame, until it is scanned out.
+  std::vector<uint64_t> presented_input_times_nanos_;
+
+  Histogram histograms_[kFlutterDesktopInputLatencyCount];
+
+  // The events dropped since the last dump.
+  uint64_t dropped_count_ = 0;
+
+  // Only used by the dump thread.
+  Histogram last_dumped_histograms_[kFlutterDesktopInputLatencyCount];
+
+  // Declared last so that the thread stops first.
+  StatsDumper stats_dumper_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_INPUT_LATENCY_TRACKER_H_
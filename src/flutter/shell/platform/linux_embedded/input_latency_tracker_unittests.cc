@@ -0,0 +1,170 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr uint64_t kNanosPerMillisecond = 1000000;
+
+// The tracker is process-wide, so the tests look at what they add to its
+// histograms after flushing the events of the previous tests.
+class InputLatencyTrackerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Each test starts a minute after the previous one, so that nothing is
+    // attributed across tests.
+    static uint64_t next_start_nanos = 60000 * kNanosPerMillisecond;
+    start_nanos_ = next_start_nanos;
+    next_start_nanos += 60000 * kNanosPerMillisecond;
+
+    tracker().OnFrameStart(start_nanos_);
+    tracker().OnFramePresented(start_nanos_);
+    tracker().OnFrameScannedOut(start_nanos_);
+    present_before_ = GetHistogram(kFlutterDesktopInputLatencyPresent);
+    scanout_before_ = GetHistogram(kFlutterDesktopInputLatencyScanout);
+  }
+
+  InputLatencyTracker& tracker() { return InputLatencyTracker::GetInstance(); }
+
+  // Returns the time |millis| after the start of the test.
+  uint64_t At(uint64_t millis) const {
+    return start_nanos_ + millis * kNanosPerMillisecond;
+  }
+
+  std::vector<uint64_t> GetHistogram(FlutterDesktopInputLatencyType type) {
+    std::vector<uint64_t> counts(InputLatencyTracker::kBucketCount);
+    EXPECT_EQ(tracker().GetHistogram(type, counts.data(), counts.size()),
+              counts.size());
+    return counts;
+  }
+
+  // Returns the counts added to the histogram of |type| by the test.
+  std::vector<uint64_t> GetAddedCounts(FlutterDesktopInputLatencyType type) {
+    auto counts = GetHistogram(type);
+    const auto& before = type == kFlutterDesktopInputLatencyPresent
+                             ? present_before_
+                             : scanout_before_;
+    for (size_t i = 0; i < counts.size(); i++) {
+      counts[i] -= before[i];
+    }
+    return counts;
+  }
+
+ private:
+  uint64_t start_nanos_ = 0;
+  std::vector<uint64_t> present_before_;
+  std::vector<uint64_t> scanout_before_;
+};
+
+}  // namespace
+
+TEST_F(InputLatencyTrackerTest, AttributesEventsToNextPresentAndScanout) {
+  // Two events 3 and 7 ms before a frame, which is scanned out 10 ms later.
+  tracker().OnInputSent(At(1000));
+  tracker().OnInputSent(At(1004));
+  tracker().OnFrameStart(At(1005));
+  tracker().OnFramePresented(At(1007));
+  tracker().OnFrameScannedOut(At(1017));
+
+  auto present = GetAddedCounts(kFlutterDesktopInputLatencyPresent);
+  EXPECT_EQ(present[3], 1u);
+  EXPECT_EQ(present[7], 1u);
+  auto scanout = GetAddedCounts(kFlutterDesktopInputLatencyScanout);
+  EXPECT_EQ(scanout[13], 1u);
+  EXPECT_EQ(scanout[17], 1u);
+
+  // The next frame has no new events.
+  tracker().OnFrameStart(At(1022));
+  tracker().OnFramePresented(At(1024));
+  tracker().OnFrameScannedOut(At(1034));
+  EXPECT_EQ(GetAddedCounts(kFlutterDesktopInputLatencyPresent), present);
+  EXPECT_EQ(GetAddedCounts(kFlutterDesktopInputLatencyScanout), scanout);
+}
+
+TEST_F(InputLatencyTrackerTest, MeasuresOnlyScanoutOfLastPresentedFrame) {
+  // The display skips the first frame, so its event gets no scanout
+  // latency.
+  tracker().OnInputSent(At(1000));
+  tracker().OnFrameStart(At(1001));
+  tracker().OnFramePresented(At(1002));
+  tracker().OnInputSent(At(1005));
+  tracker().OnFrameStart(At(1006));
+  tracker().OnFramePresented(At(1008));
+  tracker().OnFrameScannedOut(At(1016));
+
+  auto present = GetAddedCounts(kFlutterDesktopInputLatencyPresent);
+  EXPECT_EQ(present[2], 1u);
+  EXPECT_EQ(present[3], 1u);
+  auto scanout = GetAddedCounts(kFlutterDesktopInputLatencyScanout);
+  uint64_t scanout_total = 0;
+  for (auto count : scanout) {
+    scanout_total += count;
+  }
+  EXPECT_EQ(scanout_total, 1u);
+  EXPECT_EQ(scanout[11], 1u);
+}
+
+TEST_F(InputLatencyTrackerTest, DropsEventsWithoutFrame) {
+  auto max_latency_millis =
+      std::chrono::milliseconds(InputLatencyTracker::kMaxLatency).count();
+  tracker().OnInputSent(At(1000));
+  tracker().OnFrameStart(At(1000 + max_latency_millis));
+  tracker().OnFramePresented(At(1000 + max_latency_millis + 1));
+
+  for (auto count : GetAddedCounts(kFlutterDesktopInputLatencyPresent)) {
+    EXPECT_EQ(count, 0u);
+  }
+}
+
+TEST_F(InputLatencyTrackerTest, CountsLongLatenciesInLastBucket) {
+  tracker().OnInputSent(At(1000));
+  tracker().OnFrameStart(At(1001));
+  tracker().OnFramePresented(At(1500));
+
+  auto present = GetAddedCounts(kFlutterDesktopInputLatencyPresent);
+  EXPECT_EQ(present[InputLatencyTracker::kBucketCount - 1], 1u);
+}
+
+TEST_F(InputLatencyTrackerTest, AttributesEventsToFrameStartedAfterThem) {
+  // The event comes while the first frame is being built, and the second
+  // frame starts before the first one is presented.
+  tracker().OnFrameStart(At(1000));
+  tracker().OnInputSent(At(1002));
+  tracker().OnFrameStart(At(1016));
+  tracker().OnFramePresented(At(1020));
+  for (auto count : GetAddedCounts(kFlutterDesktopInputLatencyPresent)) {
+    EXPECT_EQ(count, 0u);
+  }
+
+  tracker().OnFramePresented(At(1036));
+  auto present = GetAddedCounts(kFlutterDesktopInputLatencyPresent);
+  EXPECT_EQ(present[34], 1u);
+}
+
+TEST_F(InputLatencyTrackerTest, ForgetsFramesWhichWereNotPresented) {
+  // The engine produces nothing for the first frame, and the app goes idle.
+  tracker().OnFrameStart(At(1000));
+  auto max_latency_millis =
+      std::chrono::milliseconds(InputLatencyTracker::kMaxLatency).count();
+  auto later = 1000 + max_latency_millis + 1000;
+  tracker().OnInputSent(At(later));
+  tracker().OnFrameStart(At(later + 2));
+  tracker().OnFramePresented(At(later + 10));
+
+  auto present = GetAddedCounts(kFlutterDesktopInputLatencyPresent);
+  EXPECT_EQ(present[10], 1u);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,508 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/pixel_format_converter_gl.h"
+
+#include <EGL/egl.h>
+
+#ifdef USE_GLES3
+#include <GLES3/gl32.h>
+#else
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#endif
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace {
+
+constexpr GLuint kPositionAttribute = 0;
+
+// A quad covering the whole viewport, drawn as a triangle strip.
+constexpr GLfloat kQuadVertices[] = {-1.0f, -1.0f, 1.0f, -1.0f,
+                                     -1.0f, 1.0f,  1.0f, 1.0f};
+
+// The first row of the planes is drawn to the first row of the output
+// texture, which keeps the orientation of the uploaded pixel buffers.
+constexpr char kVertexShader[] = R"(
+attribute vec2 position;
+varying vec2 texcoord;
+void main() {
+  texcoord = position * 0.5 + 0.5;
+  gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+constexpr char kFragmentShaderHeader[] = R"(
+precision mediump float;
+varying vec2 texcoord;
+uniform sampler2D plane0;
+uniform sampler2D plane1;
+uniform sampler2D plane2;
+
+// BT.601 limited range.
+const mat3 kYuvToRgb = mat3(1.164384, 1.164384, 1.164384,
+                            0.0, -0.391762, 2.017232,
+                            1.596027, -0.812968, 0.0);
+
+vec4 YuvToRgba(float y, float u, float v) {
+  vec3 yuv = vec3(y - 16.0 / 255.0, u - 0.5, v - 0.5);
+  return vec4(clamp(kYuvToRgb * yuv, 0.0, 1.0), 1.0);
+}
+)";
+
+constexpr char kBgraFragmentShader[] = R"(
+void main() {
+  gl_FragColor = texture2D(plane0, texcoord).bgra;
+}
+)";
+
+// The U/V plane is uploaded as luminance-alpha, so U is in r and V is in a.
+constexpr char kNv12FragmentShader[] = R"(
+void main() {
+  vec2 uv = texture2D(plane1, texcoord).ra;
+  gl_FragColor = YuvToRgba(texture2D(plane0, texcoord).r, uv.x, uv.y);
+}
+)";
+
+constexpr char kI420FragmentShader[] = R"(
+void main() {
+  gl_FragColor = YuvToRgba(texture2D(plane0, texcoord).r,
+                           texture2D(plane1, texcoord).r,
+                           texture2D(plane2, texcoord).r);
+}
+)";
+
+typedef GLuint (*glCreateShaderProc)(GLenum type);
+typedef void (*glShaderSourceProc)(GLuint shader,
+                                   GLsizei count,
+                                   const GLchar* const* string,
+                                   const GLint* length);
+typedef void (*glCompileShaderProc)(GLuint shader);
+typedef void (*glGetShaderivProc)(GLuint shader, GLenum pname, GLint* params);
+typedef void (*glDeleteShaderProc)(GLuint shader);
+typedef GLuint (*glCreateProgramProc)();
+typedef void (*glAttachShaderProc)(GLuint program, GLuint shader);
+typedef void (*glBindAttribLocationProc)(GLuint program,
+                                         GLuint index,
+                                         const GLchar* name);
+typedef void (*glLinkProgramProc)(GLuint program);
+typedef void (*glGetProgramivProc)(GLuint program,
+                                   GLenum pname,
+                                   GLint* params);
+typedef void (*glDeleteProgramProc)(GLuint program);
+typedef void (*glUseProgramProc)(GLuint program);
+typedef GLint (*glGetUniformLocationProc)(GLuint program, const GLchar* name);
+typedef void (*glUniform1iProc)(GLint location, GLint v0);
+typedef void (*glGenFramebuffersProc)(GLsizei n, GLuint* framebuffers);
+typedef void (*glDeleteFramebuffersProc)(GLsizei n, const GLuint* framebuffers);
+typedef void (*glBindFramebufferProc)(GLenum target, GLuint framebuffer);
+typedef void (*glFramebufferTexture2DProc)(GLenum target,
+                                           GLenum attachment,
+                                           GLenum textarget,
+                                           GLuint texture,
+                                           GLint level);
+typedef GLenum (*glCheckFramebufferStatusProc)(GLenum target);
+typedef void (*glGenTexturesProc)(GLsizei n, GLuint* textures);
+typedef void (*glDeleteTexturesProc)(GLsizei n, const GLuint* textures);
+typedef void (*glBindTextureProc)(GLenum target, GLuint texture);
+typedef void (*glActiveTextureProc)(GLenum texture);
+typedef void (*glTexParameteriProc)(GLenum target, GLenum pname, GLint param);
+typedef void (*glTexImage2DProc)(GLenum target,
+                                 GLint level,
+                                 GLint internalformat,
+                                 GLsizei width,
+                                 GLsizei height,
+                                 GLint border,
+                                 GLenum format,
+                                 GLenum type,
+                                 const void* data);
+typedef void (*glGetIntegervProc)(GLenum pname, GLint* data);
+typedef GLboolean (*glIsEnabledProc)(GLenum cap);
+typedef void (*glEnableProc)(GLenum cap);
+typedef void (*glDisableProc)(GLenum cap);
+typedef void (*glViewportProc)(GLint x, GLint y, GLsizei width, GLsizei height);
+typedef void (*glBindBufferProc)(GLenum target, GLuint buffer);
+typedef void (*glVertexAttribPointerProc)(GLuint index,
+                                          GLint size,
+                                          GLenum type,
+                                          GLboolean normalized,
+                                          GLsizei stride,
+                                          const void* pointer);
+typedef void (*glEnableVertexAttribArrayProc)(GLuint index);
+typedef void (*glDisableVertexAttribArrayProc)(GLuint index);
+typedef void (*glDrawArraysProc)(GLenum mode, GLint first, GLsizei count);
+#ifdef USE_GLES3
+typedef void (*glBindVertexArrayProc)(GLuint array);
+#endif
+
+// A struct containing pointers to resolved gl* functions.
+struct ConverterProcs {
+  glCreateShaderProc glCreateShader;
+  glShaderSourceProc glShaderSource;
+  glCompileShaderProc glCompileShader;
+  glGetShaderivProc glGetShaderiv;
+  glDeleteShaderProc glDeleteShader;
+  glCreateProgramProc glCreateProgram;
+  glAttachShaderProc glAttachShader;
+  glBindAttribLocationProc glBindAttribLocation;
+  glLinkProgramProc glLinkProgram;
+  glGetProgramivProc glGetProgramiv;
+  glDeleteProgramProc glDeleteProgram;
+  glUseProgramProc glUseProgram;
+  glGetUniformLocationProc glGetUniformLocation;
+  glUniform1iProc glUniform1i;
+  glGenFramebuffersProc glGenFramebuffers;
+  glDeleteFramebuffersProc glDeleteFramebuffers;
+  glBindFramebufferProc glBindFramebuffer;
+  glFramebufferTexture2DProc glFramebufferTexture2D;
+  glCheckFramebufferStatusProc glCheckFramebufferStatus;
+  glGenTexturesProc glGenTextures;
+  glDeleteTexturesProc glDeleteTextures;
+  glBindTextureProc glBindTexture;
+  glActiveTextureProc glActiveTexture;
+  glTexParameteriProc glTexParameteri;
+  glTexImage2DProc glTexImage2D;
+  glGetIntegervProc glGetIntegerv;
+  glIsEnabledProc glIsEnabled;
+  glEnableProc glEnable;
+  glDisableProc glDisable;
+  glViewportProc glViewport;
+  glBindBufferProc glBindBuffer;
+  glVertexAttribPointerProc glVertexAttribPointer;
+  glEnableVertexAttribArrayProc glEnableVertexAttribArray;
+  glDisableVertexAttribArrayProc glDisableVertexAttribArray;
+  glDrawArraysProc glDrawArrays;
+#ifdef USE_GLES3
+  glBindVertexArrayProc glBindVertexArray;
+#endif
+  bool valid;
+};
+
+template <typename T>
+void ResolveProc(T* proc, const char* name) {
+  *proc = reinterpret_cast<T>(eglGetProcAddress(name));
+}
+
+static const ConverterProcs& ConverterProcs() {
+  static struct ConverterProcs procs = {};
+  static bool initialized = false;
+  if (!initialized) {
+    ResolveProc(&procs.glCreateShader, "glCreateShader");
+    ResolveProc(&procs.glShaderSource, "glShaderSource");
+    ResolveProc(&procs.glCompileShader, "glCompileShader");
+    ResolveProc(&procs.glGetShaderiv, "glGetShaderiv");
+    ResolveProc(&procs.glDeleteShader, "glDeleteShader");
+    ResolveProc(&procs.glCreateProgram, "glCreateProgram");
+    ResolveProc(&procs.glAttachShader, "glAttachShader");
+    ResolveProc(&procs.glBindAttribLocation, "glBindAttribLocation");
+    ResolveProc(&procs.glLinkProgram, "glLinkProgram");
+    ResolveProc(&procs.glGetProgramiv, "glGetProgramiv");
+    ResolveProc(&procs.glDeleteProgram, "glDeleteProgram");
+    ResolveProc(&procs.glUseProgram, "glUseProgram");
+    ResolveProc(&procs.glGetUniformLocation, "glGetUniformLocation");
+    ResolveProc(&procs.glUniform1i, "glUniform1i");
+    ResolveProc(&procs.glGenFramebuffers, "glGenFramebuffers");
+    ResolveProc(&procs.glDeleteFramebuffers, "glDeleteFramebuffers");
+    ResolveProc(&procs.glBindFramebuffer, "glBindFramebuffer");
+    ResolveProc(&procs.glFramebufferTexture2D, "glFramebufferTexture2D");
+    ResolveProc(&procs.glCheckFramebufferStatus, "glCheckFramebufferStatus");
+    ResolveProc(&procs.glGenTextures, "glGenTextures");
+    ResolveProc(&procs.glDeleteTextures, "glDeleteTextures");
+    ResolveProc(&procs.glBindTexture, "glBindTexture");
+    ResolveProc(&procs.glActiveTexture, "glActiveTexture");
+    ResolveProc(&procs.glTexParameteri, "glTexParameteri");
+    ResolveProc(&procs.glTexImage2D, "glTexImage2D");
+    ResolveProc(&procs.glGetIntegerv, "glGetIntegerv");
+    ResolveProc(&procs.glIsEnabled, "glIsEnabled");
+    ResolveProc(&procs.glEnable, "glEnable");
+    ResolveProc(&procs.glDisable, "glDisable");
+    ResolveProc(&procs.glViewport, "glViewport");
+    ResolveProc(&procs.glBindBuffer, "glBindBuffer");
+    ResolveProc(&procs.glVertexAttribPointer, "glVertexAttribPointer");
+    ResolveProc(&procs.glEnableVertexAttribArray, "glEnableVertexAttribArray");
+    ResolveProc(&procs.glDisableVertexAttribArray,
+                "glDisableVertexAttribArray");
+    ResolveProc(&procs.glDrawArrays, "glDrawArrays");
+#ifdef USE_GLES3
+    ResolveProc(&procs.glBindVertexArray, "glBindVertexArray");
+#endif
+
+    procs.valid =
+        procs.glCreateShader && procs.glShaderSource && procs.glCompileShader &&
+        procs.glGetShaderiv && procs.glDeleteShader && procs.glCreateProgram &&
+        procs.glAttachShader && procs.glBindAttribLocation &&
+        procs.glLinkProgram && procs.glGetProgramiv && procs.glDeleteProgram &&
+        procs.glUseProgram && procs.glGetUniformLocation && procs.glUniform1i &&
+        procs.glGenFramebuffers && procs.glDeleteFramebuffers &&
+        procs.glBindFramebuffer && procs.glFramebufferTexture2D &&
+        procs.glCheckFramebufferStatus && procs.glGenTextures &&
+        procs.glDeleteTextures && procs.glBindTexture &&
+        procs.glActiveTexture && procs.glTexParameteri && procs.glTexImage2D &&
+        procs.glGetIntegerv && procs.glIsEnabled && procs.glEnable &&
+        procs.glDisable && procs.glViewport && procs.glBindBuffer &&
+        procs.glVertexAttribPointer && procs.glEnableVertexAttribArray &&
+        procs.glDisableVertexAttribArray && procs.glDrawArrays;
+#ifdef USE_GLES3
+    procs.valid = procs.valid && procs.glBindVertexArray;
+#endif
+    initialized = true;
+  }
+  return procs;
+}
+
+const char* GetFragmentShader(FlutterDesktopPixelFormat format) {
+  switch (format) {
+    case kFlutterDesktopPixelFormatBGRA8888:
+      return kBgraFragmentShader;
+    case kFlutterDesktopPixelFormatNV12:
+      return kNv12FragmentShader;
+    case kFlutterDesktopPixelFormatI420:
+      return kI420FragmentShader;
+    default:
+      return nullptr;
+  }
+}
+
+GLuint CompileShader(GLenum type, const char* const* sources, GLsizei count) {
+  const auto& gl = ConverterProcs();
+  auto shader = gl.glCreateShader(type);
+  gl.glShaderSource(shader, count, sources, nullptr);
+  gl.glCompileShader(shader);
+
+  GLint compiled = GL_FALSE;
+  gl.glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (compiled != GL_TRUE) {
+    gl.glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+// The GL state which the conversion changes. The engine resets the cached GL
+// state of its renderer before it resolves an external texture, but the
+// bindings are restored anyway so that the conversion has no side effects.
+class ScopedGlState {
+ public:
+  ScopedGlState() : gl_(ConverterProcs()) {
+    gl_.glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer_);
+    gl_.glGetIntegerv(GL_VIEWPORT, viewport_);
+    gl_.glGetIntegerv(GL_CURRENT_PROGRAM, &program_);
+    gl_.glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &array_buffer_);
+    gl_.glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture_);
+    for (int i = 0; i < flutter::PixelFormatConverterGL::kMaxPlanes; i++) {
+      gl_.glActiveTexture(GL_TEXTURE0 + i);
+      gl_.glGetIntegerv(GL_TEXTURE_BINDING_2D, &textures_[i]);
+    }
+#ifdef USE_GLES3
+    gl_.glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array_);
+#endif
+    for (size_t i = 0; i < kCapabilityCount; i++) {
+      capabilities_enabled_[i] = gl_.glIsEnabled(kCapabilities[i]);
+      gl_.glDisable(kCapabilities[i]);
+    }
+  }
+
+  ~ScopedGlState() {
+    for (size_t i = 0; i < kCapabilityCount; i++) {
+      if (capabilities_enabled_[i]) {
+        gl_.glEnable(kCapabilities[i]);
+      }
+    }
+#ifdef USE_GLES3
+    gl_.glBindVertexArray(vertex_array_);
+#endif
+    for (int i = 0; i < flutter::PixelFormatConverterGL::kMaxPlanes; i++) {
+      gl_.glActiveTexture(GL_TEXTURE0 + i);
+      gl_.glBindTexture(GL_TEXTURE_2D, textures_[i]);
+    }
+    gl_.glActiveTexture(active_texture_);
+    gl_.glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
+    gl_.glUseProgram(program_);
+    gl_.glViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+    gl_.glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  }
+
+ private:
+  static constexpr GLenum kCapabilities[] = {
+      GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST};
+  static constexpr size_t kCapabilityCount =
+      sizeof(kCapabilities) / sizeof(kCapabilities[0]);
+
+  const struct ConverterProcs& gl_;
+  GLint framebuffer_ = 0;
+  GLint viewport_[4] = {};
+  GLint program_ = 0;
+  GLint array_buffer_ = 0;
+  GLint active_texture_ = GL_TEXTURE0;
+  GLint textures_[flutter::PixelFormatConverterGL::kMaxPlanes] = {};
+#ifdef USE_GLES3
+  GLint vertex_array_ = 0;
+#endif
+  GLboolean capabilities_enabled_[kCapabilityCount] = {};
+};
+
+}  // namespace
+
+namespace flutter {
+
+PixelFormatConverterGL::PixelFormatConverterGL() = default;
+
+PixelFormatConverterGL::~PixelFormatConverterGL() {
+  const auto& gl = ConverterProcs();
+  if (!gl.valid) {
+    return;
+  }
+  for (auto program : programs_) {
+    if (program != 0) {
+      gl.glDeleteProgram(program);
+    }
+  }
+  if (framebuffer_ != 0) {
+    gl.glDeleteFramebuffers(1, &framebuffer_);
+  }
+  if (texture_ != 0) {
+    gl.glDeleteTextures(1, &texture_);
+  }
+}
+
+bool PixelFormatConverterGL::Convert(FlutterDesktopPixelFormat format,
+                                     const uint32_t planes[kMaxPlanes],
+                                     size_t width,
+                                     size_t height) {
+  const auto& gl = ConverterProcs();
+  if (!gl.valid) {
+    LINUXES_LOG(ERROR) << "Failed to resolve GL functions for the pixel "
+                          "format conversion.";
+    return false;
+  }
+
+  ScopedGlState scoped_state;
+
+  auto program = GetProgram(format);
+  if (program == 0) {
+    return false;
+  }
+
+  if (texture_ == 0) {
+    gl.glGenTextures(1, &texture_);
+    gl.glGenFramebuffers(1, &framebuffer_);
+  }
+  gl.glActiveTexture(GL_TEXTURE0);
+  if (width_ != width || height_ != height) {
+    gl.glBindTexture(GL_TEXTURE_2D, texture_);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+                    GL_UNSIGNED_BYTE, nullptr);
+
+    gl.glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    gl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_TEXTURE_2D, texture_, 0);
+    if (gl.glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+        GL_FRAMEBUFFER_COMPLETE) {
+      LINUXES_LOG(ERROR) << "The pixel format conversion framebuffer is "
+                            "incomplete.";
+      return false;
+    }
+    width_ = width;
+    height_ = height;
+  } else {
+    gl.glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  }
+
+  for (int i = 0; i < kMaxPlanes; i++) {
+    gl.glActiveTexture(GL_TEXTURE0 + i);
+    gl.glBindTexture(GL_TEXTURE_2D, planes[i]);
+    // Subsampled chroma planes are sampled between texels, so the pixels at
+    // the edges would blend in the border color if the planes clamped to it.
+    if (planes[i] != 0) {
+      gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+  }
+
+#ifdef USE_GLES3
+  // Client-side vertex arrays can only be used with the default vertex array
+  // object.
+  gl.glBindVertexArray(0);
+#endif
+  gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+  gl.glUseProgram(program);
+  gl.glViewport(0, 0, width, height);
+  gl.glVertexAttribPointer(kPositionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
+                           kQuadVertices);
+  gl.glEnableVertexAttribArray(kPositionAttribute);
+  gl.glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  gl.glDisableVertexAttribArray(kPositionAttribute);
+
+  return true;
+}
+
+uint32_t PixelFormatConverterGL::GetProgram(FlutterDesktopPixelFormat format) {
+  if (format < 0 || format >= kMaxFormats) {
+    return 0;
+  }
+  if (programs_[format] != 0) {
+    return programs_[format];
+  }
+
+  auto fragment_shader_source = GetFragmentShader(format);
+  if (!fragment_shader_source) {
+    LINUXES_LOG(ERROR) << "Unsupported pixel format for conversion: "
+                       << format;
+    return 0;
+  }
+
+  const auto& gl = ConverterProcs();
+  const char* vertex_sources[] = {kVertexShader};
+  const char* fragment_sources[] = {kFragmentShaderHeader,
+                                    fragment_shader_source};
+  auto vertex_shader = CompileShader(GL_VERTEX_SHADER, vertex_sources, 1);
+  auto fragment_shader =
+      CompileShader(GL_FRAGMENT_SHADER, fragment_sources, 2);
+  if (vertex_shader == 0 || fragment_shader == 0) {
+    LINUXES_LOG(ERROR) << "Failed to compile a pixel format conversion shader.";
+    if (vertex_shader != 0) {
+      gl.glDeleteShader(vertex_shader);
+    }
+    if (fragment_shader != 0) {
+      gl.glDeleteShader(fragment_shader);
+    }
+    return 0;
+  }
+
+  auto program = gl.glCreateProgram();
+  gl.glAttachShader(program, vertex_shader);
+  gl.glAttachShader(program, fragment_shader);
+  gl.glBindAttribLocation(program, kPositionAttribute, "position");
+  gl.glLinkProgram(program);
+  gl.glDeleteShader(vertex_shader);
+  gl.glDeleteShader(fragment_shader);
+
+  GLint linked = GL_FALSE;
+  gl.glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE) {
+    LINUXES_LOG(ERROR) << "Failed to link a pixel format conversion program.";
+    gl.glDeleteProgram(program);
+    return 0;
+  }
+
+  // The samplers are bound to the texture units of the planes once.
+  gl.glUseProgram(program);
+  const char* sampler_names[kMaxPlanes] = {"plane0", "plane1", "plane2"};
+  for (int i = 0; i < kMaxPlanes; i++) {
+    auto location = gl.glGetUniformLocation(program, sampler_names[i]);
+    if (location >= 0) {
+      gl.glUniform1i(location, i);
+    }
+  }
+
+  programs_[format] = program;
+  return program;
+}
+
+}  // namespace flutter
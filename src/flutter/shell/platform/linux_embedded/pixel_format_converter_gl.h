@@ -0,0 +1,59 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PIXEL_FORMAT_CONVERTER_GL_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PIXEL_FORMAT_CONVERTER_GL_H_
+
+#include <stdint.h>
+
+#include "flutter/shell/platform/common/public/flutter_texture_registrar.h"
+
+namespace flutter {
+
+// Converts pixel formats which the engine can't sample directly into an RGBA
+// texture, by drawing the planes uploaded as separate textures with a small
+// shader. This must be used on the thread where the GL context is current.
+class PixelFormatConverterGL {
+ public:
+  // The maximum number of planes of a format.
+  static constexpr int kMaxPlanes = 3;
+
+  PixelFormatConverterGL();
+  ~PixelFormatConverterGL();
+
+  // Prevent copying.
+  PixelFormatConverterGL(PixelFormatConverterGL const&) = delete;
+  PixelFormatConverterGL& operator=(PixelFormatConverterGL const&) = delete;
+
+  // Draws the |planes| of |format| to the output texture, which is resized to
+  // |width| x |height|. The planes are GL_TEXTURE_2D textures: RGBA for
+  // BGRA8888, luminance for the Y, U and V planes, and luminance-alpha for the
+  // U/V plane of NV12.
+  // Returns false if the format is not supported or the GL objects couldn't be
+  // created.
+  bool Convert(FlutterDesktopPixelFormat format,
+               const uint32_t planes[kMaxPlanes],
+               size_t width,
+               size_t height);
+
+  // The RGBA texture drawn by the last |Convert|.
+  uint32_t texture() const { return texture_; }
+
+ private:
+  // Returns the program for |format|, creating it on first use, or 0.
+  uint32_t GetProgram(FlutterDesktopPixelFormat format);
+
+  // Programs indexed by FlutterDesktopPixelFormat.
+  static constexpr int kMaxFormats = kFlutterDesktopPixelFormatI420 + 1;
+  uint32_t programs_[kMaxFormats] = {};
+
+  uint32_t framebuffer_ = 0;
+  uint32_t texture_ = 0;
+  size_t width_ = 0;
+  size_t height_ = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PIXEL_FORMAT_CONVERTER_GL_H_
@@ -0,0 +1,48 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/plugin/json_message_writer.h"
+
+namespace flutter {
+
+namespace {
+// The keys of a method call, as in json_method_codec.cc.
+constexpr char kMessageMethodKey[] = "method";
+constexpr char kMessageArgumentsKey[] = "args";
+}  // namespace
+
+JsonMessageWriter::JsonMessageWriter(BinaryMessenger* messenger,
+                                     const std::string& channel)
+    : messenger_(messenger), channel_(channel), writer_(buffer_) {}
+
+JsonMessageWriter::Writer& JsonMessageWriter::BeginMessage() {
+  // Clearing keeps the memory of the buffer and the stack of the writer.
+  buffer_.Clear();
+  writer_.Reset(buffer_);
+  method_call_ = false;
+  return writer_;
+}
+
+JsonMessageWriter::Writer& JsonMessageWriter::BeginMethodCall(
+    const char* method_name) {
+  BeginMessage();
+  writer_.StartObject();
+  writer_.Key(kMessageMethodKey);
+  writer_.String(method_name);
+  writer_.Key(kMessageArgumentsKey);
+  method_call_ = true;
+  return writer_;
+}
+
+void JsonMessageWriter::Send() {
+  if (method_call_) {
+    writer_.EndObject();
+    method_call_ = false;
+  }
+  messenger_->Send(channel_,
+                   reinterpret_cast<const uint8_t*>(buffer_.GetString()),
+                   buffer_.GetSize());
+}
+
+}  // namespace flutter
@@ -0,0 +1,58 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PLUGIN_JSON_MESSAGE_WRITER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PLUGIN_JSON_MESSAGE_WRITER_H_
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <string>
+
+#include "flutter/shell/platform/common/client_wrapper/include/flutter/binary_messenger.h"
+
+namespace flutter {
+
+// Writes the JSON messages which the internal plugins send on a channel.
+//
+// Building a rapidjson::Document for every event allocates its members, and
+// the codecs copy and serialize it into a new buffer. This serializes the
+// values directly into a buffer which is kept across messages, so sending an
+// event doesn't allocate once the buffer has grown to the largest message.
+class JsonMessageWriter {
+ public:
+  using Writer = rapidjson::Writer<rapidjson::StringBuffer>;
+
+  JsonMessageWriter(BinaryMessenger* messenger, const std::string& channel);
+  ~JsonMessageWriter() = default;
+
+  // Prevent copying.
+  JsonMessageWriter(JsonMessageWriter const&) = delete;
+  JsonMessageWriter& operator=(JsonMessageWriter const&) = delete;
+
+  // Starts a message as JsonMessageCodec encodes it. Returns the writer to
+  // write its value with.
+  Writer& BeginMessage();
+
+  // Starts a method call as JsonMethodCodec encodes it. Returns the writer to
+  // write its arguments with.
+  Writer& BeginMethodCall(const char* method_name);
+
+  // Sends the message which has been written.
+  void Send();
+
+ private:
+  BinaryMessenger* messenger_;
+  std::string channel_;
+
+  rapidjson::StringBuffer buffer_;
+  Writer writer_;
+
+  // Whether the message is a method call, whose object is closed by Send().
+  bool method_call_ = false;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PLUGIN_JSON_MESSAGE_WRITER_H_
@@ -0,0 +1,122 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures sending the flutter/keyevent message of a key press, the way
+// KeyeventPlugin writes it with JsonMessageWriter, against building a
+// rapidjson::Document and encoding it with JsonMessageCodec.
+
+#include <benchmark/benchmark.h>
+#include <rapidjson/document.h>
+
+#include <cstdint>
+#include <string>
+
+#include "flutter/shell/platform/common/client_wrapper/include/flutter/binary_messenger.h"
+#include "flutter/shell/platform/common/json_message_codec.h"
+#include "flutter/shell/platform/linux_embedded/plugin/json_message_writer.h"
+#include "flutter/shell/platform/linux_embedded/testing/allocation_counter.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr char kChannelName[] = "flutter/keyevent";
+
+// A messenger which drops the messages, like an engine which copies them.
+class NullBinaryMessenger : public BinaryMessenger {
+ public:
+  // |BinaryMessenger|
+  void Send(const std::string& channel,
+            const uint8_t* message,
+            size_t message_size,
+            BinaryReply reply) const override {
+    benchmark::DoNotOptimize(message);
+    bytes_ += message_size;
+  }
+
+  // |BinaryMessenger|
+  void SetMessageHandler(const std::string& channel,
+                         BinaryMessageHandler handler) override {}
+
+  size_t bytes() const { return bytes_; }
+
+ private:
+  mutable size_t bytes_ = 0;
+};
+
+// The events are presses and releases of 'a', alternating.
+bool IsKeyDown(int64_t index) { return index % 2 == 0; }
+
+void ReportCounters(benchmark::State& state,
+                    const NullBinaryMessenger& messenger,
+                    size_t allocations) {
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(messenger.bytes());
+  state.counters["allocs_per_event"] = benchmark::Counter(
+      allocations, benchmark::Counter::kAvgIterations);
+}
+
+// How the key events were sent before JsonMessageWriter.
+void BM_KeyEventWithDocument(benchmark::State& state) {
+  NullBinaryMessenger messenger;
+  std::string channel(kChannelName);
+  testing::ScopedAllocationCounter counter;
+  for (auto _ : state) {
+    auto down = IsKeyDown(state.iterations());
+    rapidjson::Document event(rapidjson::kObjectType);
+    auto& allocator = event.GetAllocator();
+    event.AddMember("keyCode", 65, allocator);
+    event.AddMember("keymap", "linux", allocator);
+    event.AddMember("toolkit", "glfw", allocator);
+    event.AddMember("scanCode", 65, allocator);
+    event.AddMember("modifiers", 0, allocator);
+    event.AddMember("unicodeScalarValues", 97, allocator);
+    event.AddMember("type", rapidjson::StringRef(down ? "keydown" : "keyup"),
+                    allocator);
+    auto message = JsonMessageCodec::GetInstance().EncodeMessage(event);
+    messenger.Send(channel, message->data(), message->size(), nullptr);
+  }
+  ReportCounters(state, messenger, counter.count());
+}
+BENCHMARK(BM_KeyEventWithDocument);
+
+// Writes a key event as KeyeventPlugin::SendKeyEvent does.
+void WriteKeyEvent(JsonMessageWriter& writer, bool down) {
+  auto& event = writer.BeginMessage();
+  event.StartObject();
+  event.Key("keyCode");
+  event.Uint(65);
+  event.Key("keymap");
+  event.String("linux");
+  event.Key("toolkit");
+  event.String("glfw");
+  event.Key("scanCode");
+  event.Uint(65);
+  event.Key("modifiers");
+  event.Uint(0);
+  event.Key("unicodeScalarValues");
+  event.Uint(97);
+  event.Key("type");
+  event.String(down ? "keydown" : "keyup");
+  event.EndObject();
+  writer.Send();
+}
+
+// How KeyeventPlugin sends the key events. The buffer of the writer grows
+// with the first event, before the allocations are counted.
+void BM_KeyEventWithWriter(benchmark::State& state) {
+  NullBinaryMessenger messenger;
+  JsonMessageWriter writer(&messenger, kChannelName);
+  WriteKeyEvent(writer, true);
+  testing::ScopedAllocationCounter counter;
+  for (auto _ : state) {
+    WriteKeyEvent(writer, IsKeyDown(state.iterations()));
+  }
+  ReportCounters(state, messenger, counter.count());
+}
+BENCHMARK(BM_KeyEventWithWriter);
+
+}  // namespace
+
+}  // namespace flutter
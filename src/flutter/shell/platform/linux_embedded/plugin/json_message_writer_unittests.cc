@@ -0,0 +1,112 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/plugin/json_message_writer.h"
+
+#include <rapidjson/document.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/common/json_message_codec.h"
+#include "flutter/shell/platform/common/json_method_codec.h"
+#include "flutter/shell/platform/linux_embedded/testing/allocation_counter.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// A messenger which keeps the last message.
+class RecordingBinaryMessenger : public BinaryMessenger {
+ public:
+  // |BinaryMessenger|
+  void Send(const std::string& channel,
+            const uint8_t* message,
+            size_t message_size,
+            BinaryReply reply) const override {
+    last_channel_ = channel;
+    last_message_.assign(message, message + message_size);
+  }
+
+  // |BinaryMessenger|
+  void SetMessageHandler(const std::string& channel,
+                         BinaryMessageHandler handler) override {}
+
+  const std::string& last_channel() const { return last_channel_; }
+  const std::vector<uint8_t>& last_message() const { return last_message_; }
+
+ private:
+  mutable std::string last_channel_;
+  mutable std::vector<uint8_t> last_message_;
+};
+
+void WriteKeyEvent(JsonMessageWriter& writer, const char* type) {
+  auto& event = writer.BeginMessage();
+  event.StartObject();
+  event.Key("keyCode");
+  event.Uint(65);
+  event.Key("keymap");
+  event.String("linux");
+  event.Key("type");
+  event.String(type);
+  event.EndObject();
+  writer.Send();
+}
+
+}  // namespace
+
+TEST(JsonMessageWriterTest, WritesWhatJsonMessageCodecEncodes) {
+  RecordingBinaryMessenger messenger;
+  JsonMessageWriter writer(&messenger, "flutter/keyevent");
+  WriteKeyEvent(writer, "keydown");
+
+  rapidjson::Document event(rapidjson::kObjectType);
+  auto& allocator = event.GetAllocator();
+  event.AddMember("keyCode", 65, allocator);
+  event.AddMember("keymap", "linux", allocator);
+  event.AddMember("type", "keydown", allocator);
+  auto expected = JsonMessageCodec::GetInstance().EncodeMessage(event);
+  EXPECT_EQ(messenger.last_channel(), "flutter/keyevent");
+  EXPECT_EQ(messenger.last_message(), *expected);
+}
+
+TEST(JsonMessageWriterTest, WritesWhatJsonMethodCodecEncodes) {
+  RecordingBinaryMessenger messenger;
+  JsonMessageWriter writer(&messenger, "flutter/textinput");
+  auto& args = writer.BeginMethodCall("TextInputClient.performAction");
+  args.StartArray();
+  args.Int(3);
+  args.String("TextInputAction.done");
+  args.EndArray();
+  writer.Send();
+
+  auto arguments = std::make_unique<rapidjson::Document>(rapidjson::kArrayType);
+  auto& allocator = arguments->GetAllocator();
+  arguments->PushBack(3, allocator);
+  arguments->PushBack("TextInputAction.done", allocator);
+  MethodCall<rapidjson::Document> call("TextInputClient.performAction",
+                                       std::move(arguments));
+  auto expected = JsonMethodCodec::GetInstance().EncodeMethodCall(call);
+  EXPECT_EQ(messenger.last_message(), *expected);
+}
+
+TEST(JsonMessageWriterTest, DoesNotAllocateAfterFirstMessage) {
+  // Only the last message is kept, in a vector which doesn't grow.
+  RecordingBinaryMessenger messenger;
+  JsonMessageWriter writer(&messenger, "flutter/keyevent");
+  WriteKeyEvent(writer, "keydown");
+
+  ScopedAllocationCounter counter;
+  for (int i = 0; i < 10; i++) {
+    WriteKeyEvent(writer, i % 2 == 0 ? "keyup" : "keydown");
+  }
+  EXPECT_EQ(counter.count(), 0u);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -12,7 +12,6 @@
 #include <regex>
 #include <unordered_map>
 
-#include "flutter/shell/platform/common/json_message_codec.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
 #include "flutter/shell/platform/linux_embedded/plugin/key_event_plugin_glfw_util.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler_delegate.h"
@@ -41,8 +40,7 @@ constexpr char kXkboptionsKey[] = "XKBOPTIONS";
 }  // namespace
 
 KeyeventPlugin::KeyeventPlugin(BinaryMessenger* messenger)
-    : channel_(std::make_unique<BasicMessageChannel<rapidjson::Document>>(
-          messenger, kChannelName, &flutter::JsonMessageCodec::GetInstance())),
+    : writer_(messenger, kChannelName),
       xkb_context_(xkb_context_new(XKB_CONTEXT_NO_FLAGS)) {
 #if defined(DISPLAY_BACKEND_TYPE_WAYLAND)
   xkb_keymap_ = nullptr;
@@ -112,28 +110,39 @@ void KeyeventPlugin::OnModifiers(uint32_t mods_depressed, uint32_t mods_latched,
 
 void KeyeventPlugin::SendKeyEvent(uint32_t keycode, uint32_t unicode,
                                   uint32_t modifiers, uint32_t key_state) {
-  rapidjson::Document event(rapidjson::kObjectType);
-  auto& allocator = event.GetAllocator();
-  event.AddMember(kKeyCodeKey, keycode, allocator);
-  event.AddMember(kKeyMapKey, kLinuxKeyMap, allocator);
-  event.AddMember(kToolkitKey, kGLFWKey, allocator);
-  event.AddMember(kScanCodeKey, keycode, allocator);
-  event.AddMember(kModifiersKey, modifiers, allocator);
-  if (unicode != 0) {
-    event.AddMember(kUnicodeScalarValues, unicode, allocator);
-  }
+  const char* type;
   switch (key_state) {
     case FLUTTER_LINUXES_BUTTON_DOWN:
-      event.AddMember(kTypeKey, kKeyDown, allocator);
+      type = kKeyDown;
       break;
     case FLUTTER_LINUXES_BUTTON_UP:
-      event.AddMember(kTypeKey, kKeyUp, allocator);
+      type = kKeyUp;
       break;
     default:
       LINUXES_LOG(ERROR) << "Unknown key event action: " << key_state;
       return;
   }
-  channel_->Send(event);
+
+  auto& event = writer_.BeginMessage();
+  event.StartObject();
+  event.Key(kKeyCodeKey);
+  event.Uint(keycode);
+  event.Key(kKeyMapKey);
+  event.String(kLinuxKeyMap);
+  event.Key(kToolkitKey);
+  event.String(kGLFWKey);
+  event.Key(kScanCodeKey);
+  event.Uint(keycode);
+  event.Key(kModifiersKey);
+  event.Uint(modifiers);
+  if (unicode != 0) {
+    event.Key(kUnicodeScalarValues);
+    event.Uint(unicode);
+  }
+  event.Key(kTypeKey);
+  event.String(type);
+  event.EndObject();
+  writer_.Send();
 }
 
 void KeyeventPlugin::OnModifiers(uint32_t keycode, uint32_t state) {
@@ -5,14 +5,13 @@
 #ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PLUGIN_KEY_EVENT_PLUGIN_H_
 #define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_PLUGIN_KEY_EVENT_PLUGIN_H_
 
-#include <rapidjson/document.h>
 #include <xkbcommon/xkbcommon.h>
 
 #include <memory>
 #include <unordered_map>
 
-#include "flutter/shell/platform/common/client_wrapper/include/flutter/basic_message_channel.h"
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/binary_messenger.h"
+#include "flutter/shell/platform/linux_embedded/plugin/json_message_writer.h"
 
 namespace flutter {
 
@@ -40,7 +39,8 @@ class KeyeventPlugin {
   std::unordered_map<std::string, std::string> GetKeyboardConfig(
       std::string filename);
 
-  std::unique_ptr<BasicMessageChannel<rapidjson::Document>> channel_;
+  // Writes the key events, which are sent for every key press and release.
+  JsonMessageWriter writer_;
   xkb_context* xkb_context_;
   xkb_state* xkb_state_;
   xkb_keymap* xkb_keymap_;
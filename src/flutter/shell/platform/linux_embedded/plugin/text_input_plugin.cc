@@ -18,8 +18,11 @@
 // /usr/include/X11/X.h:350:21: note: expanded from macro 'Success'
 // #define Success            0    /* everything's okay */
 // ----------------------------------------------------------------
+// Bool, which is defined in /usr/include/X11/Xlib.h, conflicts with
+// rapidjson::Writer::Bool in the same way.
 #if defined(DISPLAY_BACKEND_TYPE_X11)
 #undef Success
+#undef Bool
 #endif
 
 namespace flutter {
@@ -99,6 +102,7 @@ TextInputPlugin::TextInputPlugin(BinaryMessenger* messenger,
                                  WindowBindingHandler* delegate)
     : channel_(std::make_unique<flutter::MethodChannel<rapidjson::Document>>(
           messenger, kChannelName, &flutter::JsonMethodCodec::GetInstance())),
+      writer_(messenger, kChannelName),
       delegate_(delegate),
       active_model_(nullptr) {
   channel_->SetMethodCallHandler(
@@ -205,24 +209,31 @@ void TextInputPlugin::HandleMethodCall(
 }
 
 void TextInputPlugin::SendStateUpdate(const TextInputModel& model) {
-  auto args = std::make_unique<rapidjson::Document>(rapidjson::kArrayType);
-  auto& allocator = args->GetAllocator();
-  args->PushBack(client_id_, allocator);
+  auto& args = writer_.BeginMethodCall(kUpdateEditingStateMethod);
+  args.StartArray();
+  args.Int(client_id_);
 
   TextRange selection = model.selection();
-  rapidjson::Value editing_state(rapidjson::kObjectType);
-  editing_state.AddMember(kComposingBaseKey, -1, allocator);
-  editing_state.AddMember(kComposingExtentKey, -1, allocator);
-  editing_state.AddMember(kSelectionAffinityKey, kAffinityDownstream,
-                          allocator);
-  editing_state.AddMember(kSelectionBaseKey, selection.base(), allocator);
-  editing_state.AddMember(kSelectionExtentKey, selection.extent(), allocator);
-  editing_state.AddMember(kSelectionIsDirectionalKey, false, allocator);
-  editing_state.AddMember(
-      kTextKey, rapidjson::Value(model.GetText(), allocator).Move(), allocator);
-  args->PushBack(editing_state, allocator);
-
-  channel_->InvokeMethod(kUpdateEditingStateMethod, std::move(args));
+  args.StartObject();
+  args.Key(kComposingBaseKey);
+  args.Int(-1);
+  args.Key(kComposingExtentKey);
+  args.Int(-1);
+  args.Key(kSelectionAffinityKey);
+  args.String(kAffinityDownstream);
+  args.Key(kSelectionBaseKey);
+  args.Uint64(selection.base());
+  args.Key(kSelectionExtentKey);
+  args.Uint64(selection.extent());
+  args.Key(kSelectionIsDirectionalKey);
+  args.Bool(false);
+  args.Key(kTextKey);
+  auto text = model.GetText();
+  args.String(text.data(), text.size());
+  args.EndObject();
+
+  args.EndArray();
+  writer_.Send();
 }
 
 void TextInputPlugin::EnterPressed(TextInputModel* model) {
@@ -230,12 +241,12 @@ void TextInputPlugin::EnterPressed(TextInputModel* model) {
     model->AddCodePoint('\n');
     SendStateUpdate(*model);
   }
-  auto args = std::make_unique<rapidjson::Document>(rapidjson::kArrayType);
-  auto& allocator = args->GetAllocator();
-  args->PushBack(client_id_, allocator);
-  args->PushBack(rapidjson::Value(input_action_, allocator).Move(), allocator);
-
-  channel_->InvokeMethod(kPerformActionMethod, std::move(args));
+  auto& args = writer_.BeginMethodCall(kPerformActionMethod);
+  args.StartArray();
+  args.Int(client_id_);
+  args.String(input_action_.data(), input_action_.size());
+  args.EndArray();
+  writer_.Send();
 }
 
 }  // namespace flutter
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/binary_messenger.h"
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/method_channel.h"
 #include "flutter/shell/platform/common/text_input_model.h"
+#include "flutter/shell/platform/linux_embedded/plugin/json_message_writer.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
 
 namespace flutter {
@@ -38,6 +39,9 @@ class TextInputPlugin {
   // The MethodChannel used for communication with the Flutter engine.
   std::unique_ptr<flutter::MethodChannel<rapidjson::Document>> channel_;
 
+  // Writes the method calls to the engine, which are sent for every edit.
+  JsonMessageWriter writer_;
+
   // The active client id.
   int client_id_;
 
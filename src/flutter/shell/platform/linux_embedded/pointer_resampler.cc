@@ -0,0 +1,192 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/pointer_resampler.h"
+
+#include <algorithm>
+
+namespace flutter {
+
+namespace {
+
+bool IsMove(const FlutterPointerEvent& event) {
+  return event.signal_kind == kFlutterPointerSignalKindNone &&
+         (event.phase == FlutterPointerPhase::kMove ||
+          event.phase == FlutterPointerPhase::kHover);
+}
+
+// Returns whether |event| ends the sequence of events of a pointer, after
+// which its device id may be given to another pointer.
+bool IsLastEvent(const FlutterPointerEvent& event) {
+  if (event.phase == FlutterPointerPhase::kRemove ||
+      event.phase == FlutterPointerPhase::kCancel) {
+    return true;
+  }
+  return event.device_kind == kFlutterPointerDeviceKindTouch &&
+         event.phase == FlutterPointerPhase::kUp;
+}
+
+// Moves |event| to the position on the line through |a| and |b| at
+// |time_micros|.
+void Interpolate(const FlutterPointerEvent& a,
+                 const FlutterPointerEvent& b,
+                 uint64_t time_micros,
+                 FlutterPointerEvent* event) {
+  auto alpha = static_cast<double>(static_cast<int64_t>(time_micros) -
+                                   static_cast<int64_t>(a.timestamp)) /
+               (b.timestamp - a.timestamp);
+  event->x = a.x + (b.x - a.x) * alpha;
+  event->y = a.y + (b.y - a.y) * alpha;
+  event->timestamp = time_micros;
+}
+
+}  // namespace
+
+void PointerResampler::Filter(std::vector<FlutterPointerEvent>* events) {
+  filtered_events_.clear();
+  for (const auto& event : *events) {
+    auto& pointer = GetPointer(event);
+    if (IsMove(event)) {
+      pointer.moves.push_back(event);
+      continue;
+    }
+
+    if (!pointer.moves.empty()) {
+      filtered_events_.push_back(pointer.moves.back());
+      AddHistory(pointer, pointer.moves.back());
+      pointer.moves.clear();
+    }
+    filtered_events_.push_back(event);
+    if (IsLastEvent(event)) {
+      pointer.history_size = 0;
+    } else {
+      AddHistory(pointer, event);
+    }
+  }
+  events->swap(filtered_events_);
+}
+
+bool PointerResampler::HasPendingMoves() const {
+  return std::any_of(pointers_.begin(), pointers_.end(),
+                     [](const Pointer& pointer) {
+                       return !pointer.moves.empty();
+                     });
+}
+
+void PointerResampler::Resample(
+    uint64_t frame_start_time_micros,
+    std::vector<FlutterPointerEvent>* events,
+    std::vector<uint64_t>* input_timestamps_micros) {
+  auto sample_time_micros =
+      frame_start_time_micros > kResampleLatencyMicros
+          ? frame_start_time_micros - kResampleLatencyMicros
+          : 0;
+  for (auto& pointer : pointers_) {
+    FlutterPointerEvent event;
+    uint64_t input_timestamp_micros;
+    if (!pointer.moves.empty() &&
+        ResamplePointer(pointer, sample_time_micros, &event,
+                        &input_timestamp_micros)) {
+      events->push_back(event);
+      input_timestamps_micros->push_back(input_timestamp_micros);
+    }
+  }
+}
+
+PointerResampler::Pointer& PointerResampler::GetPointer(
+    const FlutterPointerEvent& event) {
+  for (auto& pointer : pointers_) {
+    if (pointer.device_kind == event.device_kind &&
+        pointer.device == event.device) {
+      return pointer;
+    }
+  }
+  // Device ids are reused, so there are only as many pointers as there can be
+  // at once.
+  pointers_.emplace_back();
+  auto& pointer = pointers_.back();
+  pointer.device_kind = event.device_kind;
+  pointer.device = event.device;
+  pointer.history_size = 0;
+  return pointer;
+}
+
+void PointerResampler::AddHistory(Pointer& pointer,
+                                  const FlutterPointerEvent& event) {
+  if (pointer.history_size == 2) {
+    pointer.history[0] = pointer.history[1];
+    pointer.history_size = 1;
+  }
+  pointer.history[pointer.history_size++] = event;
+}
+
+bool PointerResampler::ResamplePointer(Pointer& pointer,
+                                       uint64_t sample_time_micros,
+                                       FlutterPointerEvent* event,
+                                       uint64_t* input_timestamp_micros) {
+  auto& moves = pointer.moves;
+  auto next = std::find_if(moves.begin(), moves.end(),
+                           [sample_time_micros](const FlutterPointerEvent& e) {
+                             return e.timestamp > sample_time_micros;
+                           });
+  auto has_consumed = next != moves.begin();
+  for (auto it = moves.begin(); it != next; ++it) {
+    AddHistory(pointer, *it);
+  }
+  const auto* latest =
+      pointer.history_size > 0 ? &pointer.history[pointer.history_size - 1]
+                               : nullptr;
+
+  if (next != moves.end()) {
+    // Interpolate between the samples around the sample time. Without an
+    // earlier sample, the moves wait for a later frame.
+    if (!latest) {
+      return false;
+    }
+    if (latest->timestamp >= sample_time_micros) {
+      if (!has_consumed) {
+        return false;
+      }
+      *event = *latest;
+      *input_timestamp_micros = latest->timestamp;
+      moves.erase(moves.begin(), next);
+      return true;
+    }
+    *event = *next;
+    if (next->timestamp - latest->timestamp >= kMinDeltaMicros) {
+      Interpolate(*latest, *next, sample_time_micros, event);
+      *input_timestamp_micros = next->timestamp;
+    } else {
+      event->x = latest->x;
+      event->y = latest->y;
+      event->timestamp = latest->timestamp;
+      *input_timestamp_micros = latest->timestamp;
+    }
+    moves.erase(moves.begin(), next);
+    return true;
+  }
+
+  // All the samples are before the sample time, so extrapolate from the last
+  // two of them, by at most half the time between them.
+  *event = moves.back();
+  *input_timestamp_micros = event->timestamp;
+  moves.clear();
+  if (pointer.history_size == 2) {
+    const auto& previous = pointer.history[0];
+    auto delta_micros = latest->timestamp - previous.timestamp;
+    if (latest->timestamp > previous.timestamp &&
+        delta_micros >= kMinDeltaMicros && delta_micros <= kMaxDeltaMicros) {
+      auto prediction_time_micros =
+          std::min(sample_time_micros,
+                   latest->timestamp +
+                       std::min(delta_micros / 2, kMaxPredictionMicros));
+      if (prediction_time_micros > latest->timestamp) {
+        Interpolate(previous, *latest, prediction_time_micros, event);
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,107 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_POINTER_RESAMPLER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_POINTER_RESAMPLER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+namespace flutter {
+
+// Resamples the moves of mouse pointers and touch points to one move per
+// pointer and frame, at a time aligned with the frame.
+//
+// Input devices which report faster than the display refreshes, such as
+// 240 Hz touch panels on 60 Hz displays, deliver several moves per frame at a
+// varying phase, so that the distance a list scrolls varies from frame to
+// frame. The moves are held until the frame starts instead, and each pointer
+// is moved to its position at a fixed time before the frame start: by
+// interpolating between the samples around that time, or, if none has been
+// received since, by extrapolating a little from the last two samples.
+//
+// The other events, e.g. presses and releases, are not delayed. This class
+// doesn't read the clock, so it gives the same results for recorded events.
+class PointerResampler {
+ public:
+  // How long before the frame start the pointers are sampled, so that there
+  // is usually a sample after that time to interpolate with.
+  static constexpr uint64_t kResampleLatencyMicros = 5000;
+
+  // Samples closer than this are not interpolated nor extrapolated from.
+  static constexpr uint64_t kMinDeltaMicros = 2000;
+
+  // Samples further apart than this are not extrapolated from.
+  static constexpr uint64_t kMaxDeltaMicros = 20000;
+
+  // How far a pointer can be extrapolated.
+  static constexpr uint64_t kMaxPredictionMicros = 8000;
+
+  PointerResampler() = default;
+  ~PointerResampler() = default;
+
+  // Prevent copying.
+  PointerResampler(PointerResampler const&) = delete;
+  PointerResampler& operator=(PointerResampler const&) = delete;
+
+  // Takes the moves out of |events| to resample them, and leaves the other
+  // events, which are to be sent now. The latest move of a pointer which is
+  // held is put back before any other event of the pointer, so that e.g. a
+  // release happens where the pointer was last moved to.
+  void Filter(std::vector<FlutterPointerEvent>* events);
+
+  // Returns whether moves are held until the next call of Resample().
+  bool HasPendingMoves() const;
+
+  // Appends a move to |events| for each pointer which has moved, at
+  // |frame_start_time_micros| - kResampleLatencyMicros or at the time it was
+  // extrapolated to. The moves received after that time are held for the
+  // next frame, unless they were used for the interpolation.
+  //
+  // The timestamps of the appended moves are made up, so the timestamp of
+  // the latest received move each of them is computed from is appended to
+  // |input_timestamps_micros|, e.g. to measure the input latency.
+  void Resample(uint64_t frame_start_time_micros,
+                std::vector<FlutterPointerEvent>* events,
+                std::vector<uint64_t>* input_timestamps_micros);
+
+ private:
+  struct Pointer {
+    FlutterPointerDeviceKind device_kind;
+    int32_t device;
+
+    // The moves which are held.
+    std::vector<FlutterPointerEvent> moves;
+
+    // The last two samples which have been sent, as received, oldest first.
+    FlutterPointerEvent history[2];
+    int history_size;
+  };
+
+  // Returns the state of the pointer of |event|, which is added if needed.
+  Pointer& GetPointer(const FlutterPointerEvent& event);
+
+  // Records that |event| has been sent.
+  static void AddHistory(Pointer& pointer, const FlutterPointerEvent& event);
+
+  // Computes the move of |pointer| at |sample_time_micros| into |event|, and
+  // the timestamp of the latest move it is computed from into
+  // |input_timestamp_micros|, and removes the moves which it covers. Returns
+  // false if it has no move to send.
+  static bool ResamplePointer(Pointer& pointer,
+                              uint64_t sample_time_micros,
+                              FlutterPointerEvent* event,
+                              uint64_t* input_timestamp_micros);
+
+  std::vector<Pointer> pointers_;
+
+  // Reused by Filter() to avoid allocations.
+  std::vector<FlutterPointerEvent> filtered_events_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_POINTER_RESAMPLER_H_
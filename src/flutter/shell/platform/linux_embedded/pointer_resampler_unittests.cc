@@ -0,0 +1,179 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/pointer_resampler.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// The frame interval of a 60 Hz display.
+constexpr uint64_t kFrameIntervalMicros = 16667;
+
+// Returns the time of the |index|th sample of a device reporting at |hz|.
+uint64_t SampleTime(uint64_t index, uint64_t hz) {
+  return index * 1000000 / hz;
+}
+
+// Returns an event of the only finger, which moves right by 1 pixel per
+// millisecond.
+FlutterPointerEvent TouchEvent(FlutterPointerPhase phase,
+                               uint64_t timestamp_micros) {
+  FlutterPointerEvent event = {};
+  event.struct_size = sizeof(event);
+  event.phase = phase;
+  event.timestamp = timestamp_micros;
+  event.x = timestamp_micros / 1000.0;
+  event.y = 100;
+  event.device = 1;
+  event.signal_kind = kFlutterPointerSignalKindNone;
+  event.device_kind = kFlutterPointerDeviceKindTouch;
+  return event;
+}
+
+// Filters |event| as if it was the only event of an input frame, and returns
+// the events which are sent now.
+std::vector<FlutterPointerEvent> FilterEvent(PointerResampler& resampler,
+                                             const FlutterPointerEvent& event) {
+  std::vector<FlutterPointerEvent> events = {event};
+  resampler.Filter(&events);
+  return events;
+}
+
+}  // namespace
+
+TEST(PointerResamplerTest, InterpolatesMovesOf240HzPanelAt60HzFrames) {
+  PointerResampler resampler;
+  EXPECT_EQ(FilterEvent(resampler, TouchEvent(kDown, 0)).size(), 1u);
+
+  // Frames start at a phase which doesn't match the samples.
+  constexpr uint64_t kFirstFrameStartMicros = 30000;
+  uint64_t sample = 1;
+  for (uint64_t frame = 0; frame < 20; frame++) {
+    auto frame_start = kFirstFrameStartMicros + frame * kFrameIntervalMicros;
+    // The panel reports until just before the frame starts.
+    while (SampleTime(sample, 240) < frame_start) {
+      EXPECT_TRUE(
+          FilterEvent(resampler, TouchEvent(kMove, SampleTime(sample, 240)))
+              .empty());
+      sample++;
+    }
+    ASSERT_TRUE(resampler.HasPendingMoves());
+
+    std::vector<FlutterPointerEvent> events;
+    std::vector<uint64_t> input_timestamps;
+    resampler.Resample(frame_start, &events, &input_timestamps);
+    ASSERT_EQ(events.size(), 1u);
+    ASSERT_EQ(input_timestamps.size(), 1u);
+    auto sample_time = frame_start - PointerResampler::kResampleLatencyMicros;
+    EXPECT_EQ(events[0].phase, kMove);
+    EXPECT_EQ(events[0].timestamp, sample_time);
+    EXPECT_NEAR(events[0].x, sample_time / 1000.0, 1e-9);
+    EXPECT_EQ(events[0].y, 100);
+    // The latency is measured from the first sample at or after the sample
+    // time, which the move is interpolated towards.
+    EXPECT_GE(input_timestamps[0], sample_time);
+    EXPECT_LT(input_timestamps[0], frame_start);
+    EXPECT_LE(input_timestamps[0] - sample_time, SampleTime(1, 240));
+  }
+}
+
+TEST(PointerResamplerTest, LimitsExtrapolationOf60HzPanel) {
+  PointerResampler resampler;
+  FilterEvent(resampler, TouchEvent(kDown, 0));
+  auto last_sample_time = SampleTime(1, 60);
+  EXPECT_TRUE(
+      FilterEvent(resampler, TouchEvent(kMove, last_sample_time)).empty());
+
+  // No sample follows the sample time, so the move is extrapolated from the
+  // last two, by at most kMaxPredictionMicros even though they are further
+  // apart than twice that.
+  std::vector<FlutterPointerEvent> events;
+  std::vector<uint64_t> input_timestamps;
+  resampler.Resample(last_sample_time + 50000, &events, &input_timestamps);
+  ASSERT_EQ(events.size(), 1u);
+  auto prediction_time =
+      last_sample_time + PointerResampler::kMaxPredictionMicros;
+  EXPECT_EQ(events[0].timestamp, prediction_time);
+  EXPECT_NEAR(events[0].x, prediction_time / 1000.0, 1e-9);
+  ASSERT_EQ(input_timestamps.size(), 1u);
+  EXPECT_EQ(input_timestamps[0], last_sample_time);
+  EXPECT_FALSE(resampler.HasPendingMoves());
+}
+
+TEST(PointerResamplerTest, ExtrapolatesByHalfTheSampleInterval) {
+  PointerResampler resampler;
+  FilterEvent(resampler, TouchEvent(kDown, 0));
+  auto last_sample_time = SampleTime(1, 120);
+  FilterEvent(resampler, TouchEvent(kMove, last_sample_time));
+
+  std::vector<FlutterPointerEvent> events;
+  std::vector<uint64_t> input_timestamps;
+  resampler.Resample(last_sample_time + 50000, &events, &input_timestamps);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].timestamp, last_sample_time + last_sample_time / 2);
+}
+
+TEST(PointerResamplerTest, SendsHeldMoveBeforeOtherEvents) {
+  for (auto phase : {kUp, kCancel}) {
+    PointerResampler resampler;
+    FilterEvent(resampler, TouchEvent(kDown, 0));
+    FilterEvent(resampler, TouchEvent(kMove, 4000));
+    FilterEvent(resampler, TouchEvent(kMove, 8000));
+    ASSERT_TRUE(resampler.HasPendingMoves());
+
+    auto events = FilterEvent(resampler, TouchEvent(phase, 9000));
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].phase, kMove);
+    EXPECT_EQ(events[0].timestamp, 8000u);
+    EXPECT_EQ(events[1].phase, phase);
+    EXPECT_FALSE(resampler.HasPendingMoves());
+
+    // Nothing is left to resample.
+    std::vector<FlutterPointerEvent> resampled;
+    std::vector<uint64_t> input_timestamps;
+    resampler.Resample(30000, &resampled, &input_timestamps);
+    EXPECT_TRUE(resampled.empty());
+  }
+
+  // A mouse is pressed where it last hovered to.
+  PointerResampler resampler;
+  auto hover = TouchEvent(kHover, 4000);
+  hover.device_kind = kFlutterPointerDeviceKindMouse;
+  FilterEvent(resampler, hover);
+  auto down = TouchEvent(kDown, 5000);
+  down.device_kind = kFlutterPointerDeviceKindMouse;
+  auto events = FilterEvent(resampler, down);
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].phase, kHover);
+  EXPECT_EQ(events[1].phase, kDown);
+  EXPECT_FALSE(resampler.HasPendingMoves());
+}
+
+TEST(PointerResamplerTest, KeepsMovesAfterSampleTimeForNextFrame) {
+  PointerResampler resampler;
+  FilterEvent(resampler, TouchEvent(kDown, 0));
+  FilterEvent(resampler, TouchEvent(kMove, 4000));
+  FilterEvent(resampler, TouchEvent(kMove, 8000));
+  FilterEvent(resampler, TouchEvent(kMove, 12000));
+
+  // Sampled at 7 ms, between the moves at 4 and 8 ms.
+  std::vector<FlutterPointerEvent> events;
+  std::vector<uint64_t> input_timestamps;
+  resampler.Resample(12000, &events, &input_timestamps);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].timestamp, 7000u);
+  EXPECT_NEAR(events[0].x, 7.0, 1e-9);
+  EXPECT_EQ(input_timestamps[0], 8000u);
+  EXPECT_TRUE(resampler.HasPendingMoves());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -114,8 +114,32 @@ FLUTTER_EXPORT FlutterDesktopEngineRef FlutterDesktopViewControllerGetEngine(
 FLUTTER_EXPORT FlutterDesktopViewRef
 FlutterDesktopViewControllerGetView(FlutterDesktopViewControllerRef controller);
 
+// Dispatches window events such as mouse and keyboard inputs without
+// blocking. Returns false if the window has been closed.
 FLUTTER_EXPORT bool FlutterDesktopViewDispatchEvent(FlutterDesktopViewRef view);
 
+// Returns a pollable file descriptor that becomes readable when there are
+// window events to be dispatched by FlutterDesktopViewDispatchEvent, or when
+// a task posted from another thread needs FlutterDesktopEngineProcessMessages
+// to be called earlier than its last return value. Returns -1 on error.
+//
+// This is intended for applications which integrate Flutter into their own
+// event loop. Such a loop should wait on this file descriptor no longer than
+// the last return value of FlutterDesktopEngineProcessMessages, and call
+// FlutterDesktopViewDispatchEvent after FlutterDesktopEngineProcessMessages so
+// that the requests made by the tasks are sent to the display server before
+// it waits. The file descriptor is owned by |view|.
+FLUTTER_EXPORT int FlutterDesktopViewGetEventFd(FlutterDesktopViewRef view);
+
+// Runs the event loop of the view managed by |controller| until the window is
+// closed.
+//
+// The calling thread sleeps until either a window event arrives or the next
+// Flutter task is due, and there is no fixed-interval polling. This must be
+// called on the thread which created |controller|.
+FLUTTER_EXPORT void FlutterDesktopRunLoop(
+    FlutterDesktopViewControllerRef controller);
+
 // ========== Engine ==========
 
 // Creates a Flutter engine with the given properties.
@@ -171,6 +195,106 @@ FLUTTER_EXPORT FlutterDesktopTextureRegistrarRef
 FlutterDesktopEngineGetTextureRegistrar(
     FlutterDesktopTextureRegistrarRef texture_registrar);
 
+// Tells the engine and the embedder that the system is low on memory, so that
+// they release what can be recreated later, such as caches and idle backing
+// stores.
+FLUTTER_EXPORT void FlutterDesktopEngineNotifyLowMemoryWarning(
+    FlutterDesktopEngineRef engine);
+
+// ========== Frame timeline ==========
+
+// The steps of the render path recorded in the frame timeline.
+typedef enum {
+  // The engine makes the onscreen GL context current.
+  kFlutterDesktopFrameEventMakeCurrent,
+  // The engine asks for the onscreen framebuffer.
+  kFlutterDesktopFrameEventGetOnscreenFbo,
+  // The engine presents a frame. This includes the buffer swap.
+  kFlutterDesktopFrameEventPresent,
+  // The EGL buffer swap, and handing the buffer to the display. With the
+  // software renderer, copying the frame to the display buffer.
+  kFlutterDesktopFrameEventSwapBuffers,
+  // From queueing a page flip until the display has flipped.
+  kFlutterDesktopFrameEventPageFlip,
+  // The engine asks for the contents of an external texture.
+  kFlutterDesktopFrameEventPopulateTexture,
+  kFlutterDesktopFrameEventCount
+} FlutterDesktopFrameEventType;
+
+// A step recorded in the frame timeline. The times are on the monotonic clock.
+typedef struct {
+  FlutterDesktopFrameEventType type;
+  uint64_t start_time_nanos;
+  uint64_t end_time_nanos;
+} FlutterDesktopFrameEvent;
+
+// Enables or disables recording the frame timeline. Recording is disabled by
+// default, unless the FLUTTER_LINUXES_FRAME_STATS environment variable is set.
+// This function can be called from any thread.
+FLUTTER_EXPORT void FlutterDesktopFrameTimelineSetEnabled(bool enabled);
+
+// Copies up to |max_events| of the most recently recorded events to |events|,
+// oldest first, and returns the number of copied events. Only a bounded
+// number of events is kept. This function can be called from any thread.
+FLUTTER_EXPORT size_t
+FlutterDesktopFrameTimelineGetEvents(FlutterDesktopFrameEvent* events,
+                                     size_t max_events);
+
+// ========== Input latency ==========
+
+// The latencies measured from the time at which a pointer or touch event was
+// generated, e.g. by the kernel.
+typedef enum {
+  // Until the first frame which the engine presents after receiving the event
+  // has been handed to the display.
+  kFlutterDesktopInputLatencyPresent,
+  // Until the display has started to scan out that frame, as reported by the
+  // page flip event. Only measured with the DRM backends.
+  kFlutterDesktopInputLatencyScanout,
+  kFlutterDesktopInputLatencyCount
+} FlutterDesktopInputLatencyType;
+
+// Enables or disables measuring the input latency. Measuring is disabled by
+// default, unless the FLUTTER_LINUXES_INPUT_LATENCY environment variable is
+// set. This function can be called from any thread.
+FLUTTER_EXPORT void FlutterDesktopInputLatencySetEnabled(bool enabled);
+
+// Copies the histogram of the latencies of |type| measured so far to
+// |counts|, and returns the number of copied buckets, which is at most
+// |bucket_count|. |counts|[i] is the number of events whose latency was at
+// least i and less than i + 1 milliseconds, except the last bucket of the
+// histogram, which also counts the longer latencies. This function can be
+// called from any thread.
+FLUTTER_EXPORT size_t
+FlutterDesktopInputLatencyGetHistogram(FlutterDesktopInputLatencyType type,
+                                       uint64_t* counts,
+                                       size_t bucket_count);
+
+// ========== Backing store pool ==========
+
+// The reuse statistics of the backing stores which the compositor renders the
+// layers of a frame into.
+typedef struct {
+  // Layers rendered into a backing store of a previous frame.
+  uint64_t hits;
+  // Layers which needed a new backing store.
+  uint64_t misses;
+  // Idle backing stores destroyed to stay within the memory cap, or on low
+  // memory.
+  uint64_t evictions;
+  // The idle backing stores kept for the next frames, and their memory.
+  size_t pooled_count;
+  size_t pooled_bytes;
+  // The memory cap of the idle backing stores.
+  size_t max_bytes;
+} FlutterDesktopBackingStorePoolStats;
+
+// Copies the statistics of the backing store pool of |engine| to |stats|.
+// Returns false if the engine doesn't use a compositor. This function must be
+// called on the platform thread.
+FLUTTER_EXPORT bool FlutterDesktopEngineGetBackingStorePoolStats(
+    FlutterDesktopEngineRef engine, FlutterDesktopBackingStorePoolStats* stats);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
@@ -0,0 +1,76 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SPSC_RING_BUFFER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SPSC_RING_BUFFER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace flutter {
+
+// A bounded single-producer single-consumer queue of trivially copyable
+// values, which hands values from one thread to another without locks or
+// allocations.
+//
+// The producer only writes |tail_| and the consumer only writes |head_|, so
+// each side publishes its progress with a single release store. The indices
+// are kept on separate cache lines so that the two threads don't contend on
+// them.
+template <typename T, size_t kCapacity>
+class SpscRingBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Values are copied in and out of the buffer.");
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "The capacity must be a power of two.");
+
+ public:
+  SpscRingBuffer() = default;
+  ~SpscRingBuffer() = default;
+
+  // Prevent copying.
+  SpscRingBuffer(SpscRingBuffer const&) = delete;
+  SpscRingBuffer& operator=(SpscRingBuffer const&) = delete;
+
+  // Appends |value|. Returns false if the buffer is full. Producer thread
+  // only.
+  bool Push(const T& value) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    values_[tail & (kCapacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Removes the oldest value into |value|. Returns false if the buffer is
+  // empty. Consumer thread only.
+  bool Pop(T* value) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = values_[head & (kCapacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  // The number of values which have been popped.
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+
+  // The number of values which have been pushed.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+
+  alignas(kCacheLineSize) std::array<T, kCapacity> values_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SPSC_RING_BUFFER_H_
@@ -0,0 +1,68 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/spsc_ring_buffer.h"
+
+#include <cstdint>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(SpscRingBufferTest, PopsInOrderAndRejectsWhenFull) {
+  SpscRingBuffer<int, 4> buffer;
+  int value;
+  EXPECT_FALSE(buffer.Pop(&value));
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(buffer.Push(i));
+  }
+  EXPECT_FALSE(buffer.Push(4));
+
+  EXPECT_TRUE(buffer.Pop(&value));
+  EXPECT_EQ(value, 0);
+  // The freed slot is reused when the indices wrap around.
+  EXPECT_TRUE(buffer.Push(4));
+  for (int i = 1; i <= 4; i++) {
+    EXPECT_TRUE(buffer.Pop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(buffer.Pop(&value));
+}
+
+TEST(SpscRingBufferTest, HandsOverEveryValueBetweenThreads) {
+  // Many more values than the capacity, so that the producer often finds the
+  // buffer full, like the input thread when the platform thread is busy.
+  constexpr uint64_t kValueCount = 200000;
+  SpscRingBuffer<uint64_t, 16> buffer;
+
+  std::thread producer([&buffer]() {
+    for (uint64_t i = 0; i < kValueCount; i++) {
+      while (!buffer.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint64_t received = 0;
+  auto in_order = true;
+  while (received < kValueCount) {
+    uint64_t value;
+    if (!buffer.Pop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_order = in_order && value == received;
+    received++;
+  }
+  producer.join();
+  EXPECT_TRUE(in_order);
+  uint64_t value;
+  EXPECT_FALSE(buffer.Pop(&value));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,69 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/stats_dumper.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace flutter {
+
+namespace {
+
+// Returns the 1-based rank of the |percentile| of |count| values.
+uint64_t NearestRank(uint64_t count, int percentile) {
+  return std::max<uint64_t>((count * percentile + 99) / 100, 1);
+}
+
+}  // namespace
+
+uint64_t Percentile(const std::vector<uint64_t>& values, int percentile) {
+  auto rank = std::min<uint64_t>(NearestRank(values.size(), percentile),
+                                 values.size());
+  return values[rank - 1];
+}
+
+size_t HistogramPercentile(const uint64_t* counts,
+                           size_t bucket_count,
+                           uint64_t total_count,
+                           int percentile) {
+  auto rank = NearestRank(total_count, percentile);
+  uint64_t count = 0;
+  for (size_t bucket = 0; bucket < bucket_count; bucket++) {
+    count += counts[bucket];
+    if (count >= rank) {
+      return bucket;
+    }
+  }
+  return bucket_count - 1;
+}
+
+StatsDumper::~StatsDumper() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void StatsDumper::Start(std::chrono::seconds interval, DumpCallback dump) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+  thread_ = std::thread([this, interval, dump = std::move(dump)]() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval, [this]() { return stopped_; })) {
+      // Written to stderr directly so that the stats are also shown in
+      // release builds, which filter out informational logs.
+      std::cerr << dump();
+    }
+  });
+}
+
+}  // namespace flutter
@@ -0,0 +1,62 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_STATS_DUMPER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_STATS_DUMPER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter {
+
+// The percentiles which are dumped.
+constexpr int kDumpedPercentiles[] = {50, 95, 99};
+
+// Returns the |percentile| of the sorted |values| by the nearest-rank method.
+// |values| must not be empty.
+uint64_t Percentile(const std::vector<uint64_t>& values, int percentile);
+
+// Returns the index of the bucket which holds the |percentile| of the
+// |total_count| values counted in |counts|, by the nearest-rank method.
+size_t HistogramPercentile(const uint64_t* counts,
+                           size_t bucket_count,
+                           uint64_t total_count,
+                           int percentile);
+
+// Runs a thread which periodically writes a line of stats to stderr.
+class StatsDumper {
+ public:
+  // Returns the line to write, which ends with a newline.
+  using DumpCallback = std::function<std::string()>;
+
+  StatsDumper() = default;
+
+  // Stops the thread.
+  ~StatsDumper();
+
+  // Prevent copying.
+  StatsDumper(StatsDumper const&) = delete;
+  StatsDumper& operator=(StatsDumper const&) = delete;
+
+  // Starts the thread, which calls |dump| every |interval|. Does nothing if
+  // the thread has already been started.
+  void Start(std::chrono::seconds interval, DumpCallback dump);
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  bool stopped_ = false;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_STATS_DUMPER_H_
@@ -0,0 +1,35 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/stats_dumper.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(StatsDumperTest, PercentileUsesNearestRank) {
+  std::vector<uint64_t> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  EXPECT_EQ(Percentile(values, 50), 5u);
+  EXPECT_EQ(Percentile(values, 95), 10u);
+  EXPECT_EQ(Percentile(values, 0), 1u);
+  EXPECT_EQ(Percentile({7}, 99), 7u);
+}
+
+TEST(StatsDumperTest, HistogramPercentileMatchesSortedValues) {
+  // The values 0, 1, 1, 3 and 3, counted in buckets of 1.
+  const uint64_t counts[] = {1, 2, 0, 2, 0};
+  std::vector<uint64_t> values = {0, 1, 1, 3, 3};
+  for (int percentile : {0, 20, 40, 50, 60, 95, 100}) {
+    EXPECT_EQ(HistogramPercentile(counts, 5, values.size(), percentile),
+              Percentile(values, percentile))
+        << "p" << percentile;
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
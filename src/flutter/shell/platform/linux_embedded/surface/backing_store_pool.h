@@ -0,0 +1,144 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_BACKING_STORE_POOL_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_BACKING_STORE_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
+
+namespace flutter {
+
+// The environment variable which sets the memory cap of the idle backing
+// stores in megabytes.
+constexpr char kBackingStorePoolSizeEnvironmentKey[] =
+    "FLUTTER_LINUXES_BACKING_STORE_POOL_MB";
+constexpr size_t kDefaultBackingStorePoolMegabytes = 64;
+
+// Identifies the backing stores which can replace each other.
+struct BackingStoreKey {
+  uint32_t width;
+  uint32_t height;
+  uint32_t format;
+
+  bool operator==(const BackingStoreKey& other) const {
+    return width == other.width && height == other.height &&
+           format == other.format;
+  }
+};
+
+// Keeps the backing stores which the engine no longer uses, so that the
+// layers of the next frames are rendered into them instead of new ones. When
+// the idle stores exceed the memory cap, the least recently used ones are
+// destroyed.
+//
+// The pool is used on the raster thread, where the stores can be destroyed.
+// The statistics can be used from any thread.
+template <typename T>
+class BackingStorePool {
+ public:
+  explicit BackingStorePool(size_t max_bytes) : max_bytes_(max_bytes) {}
+  ~BackingStorePool() = default;
+
+  // Prevent copying.
+  BackingStorePool(BackingStorePool const&) = delete;
+  BackingStorePool& operator=(BackingStorePool const&) = delete;
+
+  // Takes the most recently used idle store of |key| out of the pool.
+  // Returns nullptr if there is none, and the caller allocates a new one.
+  std::unique_ptr<T> Acquire(const BackingStoreKey& key) {
+    auto found = entries_.size();
+    for (size_t i = 0; i < entries_.size(); i++) {
+      if (entries_[i].key == key &&
+          (found == entries_.size() ||
+           entries_[i].last_used > entries_[found].last_used)) {
+        found = i;
+      }
+    }
+    if (found == entries_.size()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return RemoveEntry(found);
+  }
+
+  // Puts |store|, which takes |bytes| of memory, into the pool.
+  void Release(const BackingStoreKey& key, std::unique_ptr<T> store,
+               size_t bytes) {
+    // The vector keeps its capacity, so this doesn't allocate once the pool
+    // has been filled.
+    entries_.push_back({key, std::move(store), bytes, ++clock_});
+    pooled_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    pooled_count_.fetch_add(1, std::memory_order_relaxed);
+    EvictUntil(max_bytes_);
+  }
+
+  // Destroys all the idle stores, e.g. on memory pressure.
+  void Purge() { EvictUntil(0); }
+
+  FlutterDesktopBackingStorePoolStats GetStats() const {
+    FlutterDesktopBackingStorePoolStats stats = {};
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.pooled_count = pooled_count_.load(std::memory_order_relaxed);
+    stats.pooled_bytes = pooled_bytes_.load(std::memory_order_relaxed);
+    stats.max_bytes = max_bytes_;
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    BackingStoreKey key;
+    std::unique_ptr<T> store;
+    size_t bytes;
+    uint64_t last_used;
+  };
+
+  // Destroys the least recently used stores until the idle stores take at
+  // most |max_bytes|.
+  void EvictUntil(size_t max_bytes) {
+    while (!entries_.empty() &&
+           pooled_bytes_.load(std::memory_order_relaxed) > max_bytes) {
+      size_t oldest = 0;
+      for (size_t i = 1; i < entries_.size(); i++) {
+        if (entries_[i].last_used < entries_[oldest].last_used) {
+          oldest = i;
+        }
+      }
+      RemoveEntry(oldest);
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  std::unique_ptr<T> RemoveEntry(size_t index) {
+    auto store = std::move(entries_[index].store);
+    pooled_bytes_.fetch_sub(entries_[index].bytes, std::memory_order_relaxed);
+    pooled_count_.fetch_sub(1, std::memory_order_relaxed);
+    if (index != entries_.size() - 1) {
+      entries_[index] = std::move(entries_.back());
+    }
+    entries_.pop_back();
+    return store;
+  }
+
+  const size_t max_bytes_;
+  std::vector<Entry> entries_;
+  uint64_t clock_ = 0;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<size_t> pooled_count_{0};
+  std::atomic<size_t> pooled_bytes_{0};
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_BACKING_STORE_POOL_H_
@@ -0,0 +1,82 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/backing_store_pool.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr BackingStoreKey kKey = {640, 480, 0};
+constexpr BackingStoreKey kOtherKey = {320, 240, 0};
+constexpr size_t kStoreBytes = 640 * 480 * 4;
+
+// A store which counts how many of its kind exist.
+struct FakeStore {
+  explicit FakeStore(int id) : id(id) { live_count++; }
+  ~FakeStore() { live_count--; }
+
+  int id;
+  static int live_count;
+};
+
+int FakeStore::live_count = 0;
+
+}  // namespace
+
+TEST(BackingStorePoolTest, ReusesMostRecentlyUsedStoreOfSameKey) {
+  BackingStorePool<FakeStore> pool(kStoreBytes * 4);
+  EXPECT_EQ(pool.Acquire(kKey), nullptr);
+
+  pool.Release(kKey, std::make_unique<FakeStore>(1), kStoreBytes);
+  pool.Release(kKey, std::make_unique<FakeStore>(2), kStoreBytes);
+  EXPECT_EQ(pool.Acquire(kOtherKey), nullptr);
+  auto store = pool.Acquire(kKey);
+  ASSERT_NE(store, nullptr);
+  EXPECT_EQ(store->id, 2);
+
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.pooled_count, 1u);
+  EXPECT_EQ(stats.pooled_bytes, kStoreBytes);
+}
+
+TEST(BackingStorePoolTest, EvictsLeastRecentlyUsedStoresOverCap) {
+  FakeStore::live_count = 0;
+  BackingStorePool<FakeStore> pool(kStoreBytes * 2);
+  for (int i = 0; i < 3; i++) {
+    pool.Release(kKey, std::make_unique<FakeStore>(i), kStoreBytes);
+  }
+  EXPECT_EQ(FakeStore::live_count, 2);
+  EXPECT_EQ(pool.GetStats().evictions, 1u);
+
+  // The oldest one has gone.
+  EXPECT_EQ(pool.Acquire(kKey)->id, 2);
+  EXPECT_EQ(pool.Acquire(kKey)->id, 1);
+  EXPECT_EQ(pool.Acquire(kKey), nullptr);
+}
+
+TEST(BackingStorePoolTest, PurgeDestroysAllIdleStores) {
+  FakeStore::live_count = 0;
+  BackingStorePool<FakeStore> pool(kStoreBytes * 4);
+  pool.Release(kKey, std::make_unique<FakeStore>(1), kStoreBytes);
+  pool.Release(kOtherKey, std::make_unique<FakeStore>(2), kStoreBytes / 4);
+
+  pool.Purge();
+  EXPECT_EQ(FakeStore::live_count, 0);
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.pooled_count, 0u);
+  EXPECT_EQ(stats.pooled_bytes, 0u);
+  EXPECT_EQ(stats.evictions, 2u);
+  EXPECT_EQ(pool.Acquire(kKey), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,777 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/compositor_drm_gbm.h"
+
+#include <drm_fourcc.h>
+#include <unistd.h>
+#include <xf86drmMode.h>
+
+#include <cstdlib>
+
+#ifdef USE_GLES3
+#include <GLES3/gl32.h>
+#else
+#include <GLES2/gl2.h>
+#endif
+#include <GLES2/gl2ext.h>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/window/native_window_drm_gbm.h"
+
+namespace {
+
+#ifdef USE_GLES3
+constexpr uint32_t kFramebufferFormat = GL_RGBA8;
+#else
+constexpr uint32_t kFramebufferFormat = GL_RGBA8_OES;
+#endif
+
+constexpr GLuint kPositionAttribute = 0;
+
+// A unit quad drawn as a triangle strip, which covers the viewport.
+constexpr GLfloat kQuadVertices[] = {0.0f, 0.0f, 1.0f, 0.0f,
+                                     0.0f, 1.0f, 1.0f, 1.0f};
+
+// The layers and the render surface are both bottom-up, so the texture is
+// drawn as is.
+constexpr char kVertexShader[] = R"(
+attribute vec2 position;
+varying vec2 texcoord;
+void main() {
+  texcoord = position;
+  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+constexpr char kFragmentShader[] = R"(
+precision mediump float;
+varying vec2 texcoord;
+uniform sampler2D layer;
+void main() {
+  gl_FragColor = texture2D(layer, texcoord);
+}
+)";
+
+typedef GLuint (*glCreateShaderProc)(GLenum type);
+typedef void (*glShaderSourceProc)(GLuint shader,
+                                   GLsizei count,
+                                   const GLchar* const* string,
+                                   const GLint* length);
+typedef void (*glCompileShaderProc)(GLuint shader);
+typedef void (*glGetShaderivProc)(GLuint shader, GLenum pname, GLint* params);
+typedef void (*glDeleteShaderProc)(GLuint shader);
+typedef GLuint (*glCreateProgramProc)();
+typedef void (*glAttachShaderProc)(GLuint program, GLuint shader);
+typedef void (*glBindAttribLocationProc)(GLuint program,
+                                         GLuint index,
+                                         const GLchar* name);
+typedef void (*glLinkProgramProc)(GLuint program);
+typedef void (*glGetProgramivProc)(GLuint program,
+                                   GLenum pname,
+                                   GLint* params);
+typedef void (*glDeleteProgramProc)(GLuint program);
+typedef void (*glUseProgramProc)(GLuint program);
+typedef GLint (*glGetUniformLocationProc)(GLuint program, const GLchar* name);
+typedef void (*glUniform1iProc)(GLint location, GLint v0);
+typedef void (*glGenFramebuffersProc)(GLsizei n, GLuint* framebuffers);
+typedef void (*glDeleteFramebuffersProc)(GLsizei n, const GLuint* framebuffers);
+typedef void (*glBindFramebufferProc)(GLenum target, GLuint framebuffer);
+typedef void (*glFramebufferTexture2DProc)(GLenum target,
+                                           GLenum attachment,
+                                           GLenum textarget,
+                                           GLuint texture,
+                                           GLint level);
+typedef GLenum (*glCheckFramebufferStatusProc)(GLenum target);
+typedef void (*glGenTexturesProc)(GLsizei n, GLuint* textures);
+typedef void (*glDeleteTexturesProc)(GLsizei n, const GLuint* textures);
+typedef void (*glBindTextureProc)(GLenum target, GLuint texture);
+typedef void (*glActiveTextureProc)(GLenum texture);
+typedef void (*glTexParameteriProc)(GLenum target, GLenum pname, GLint param);
+typedef void (*glGetIntegervProc)(GLenum pname, GLint* data);
+typedef void (*glGetFloatvProc)(GLenum pname, GLfloat* data);
+typedef GLboolean (*glIsEnabledProc)(GLenum cap);
+typedef void (*glEnableProc)(GLenum cap);
+typedef void (*glDisableProc)(GLenum cap);
+typedef void (*glBlendFuncProc)(GLenum sfactor, GLenum dfactor);
+typedef void (*glBlendFuncSeparateProc)(GLenum src_rgb,
+                                        GLenum dst_rgb,
+                                        GLenum src_alpha,
+                                        GLenum dst_alpha);
+typedef void (*glClearColorProc)(GLfloat red,
+                                 GLfloat green,
+                                 GLfloat blue,
+                                 GLfloat alpha);
+typedef void (*glClearProc)(GLbitfield mask);
+typedef void (*glViewportProc)(GLint x, GLint y, GLsizei width, GLsizei height);
+typedef void (*glBindBufferProc)(GLenum target, GLuint buffer);
+typedef void (*glVertexAttribPointerProc)(GLuint index,
+                                          GLint size,
+                                          GLenum type,
+                                          GLboolean normalized,
+                                          GLsizei stride,
+                                          const void* pointer);
+typedef void (*glGetVertexAttribivProc)(GLuint index,
+                                        GLenum pname,
+                                        GLint* params);
+typedef void (*glGetVertexAttribPointervProc)(GLuint index,
+                                              GLenum pname,
+                                              void** pointer);
+typedef void (*glEnableVertexAttribArrayProc)(GLuint index);
+typedef void (*glDisableVertexAttribArrayProc)(GLuint index);
+typedef void (*glDrawArraysProc)(GLenum mode, GLint first, GLsizei count);
+typedef void (*glFlushProc)();
+#ifdef USE_GLES3
+typedef void (*glBindVertexArrayProc)(GLuint array);
+#endif
+
+// A struct containing pointers to resolved gl* and egl* functions.
+struct CompositorProcs {
+  glCreateShaderProc glCreateShader;
+  glShaderSourceProc glShaderSource;
+  glCompileShaderProc glCompileShader;
+  glGetShaderivProc glGetShaderiv;
+  glDeleteShaderProc glDeleteShader;
+  glCreateProgramProc glCreateProgram;
+  glAttachShaderProc glAttachShader;
+  glBindAttribLocationProc glBindAttribLocation;
+  glLinkProgramProc glLinkProgram;
+  glGetProgramivProc glGetProgramiv;
+  glDeleteProgramProc glDeleteProgram;
+  glUseProgramProc glUseProgram;
+  glGetUniformLocationProc glGetUniformLocation;
+  glUniform1iProc glUniform1i;
+  glGenFramebuffersProc glGenFramebuffers;
+  glDeleteFramebuffersProc glDeleteFramebuffers;
+  glBindFramebufferProc glBindFramebuffer;
+  glFramebufferTexture2DProc glFramebufferTexture2D;
+  glCheckFramebufferStatusProc glCheckFramebufferStatus;
+  glGenTexturesProc glGenTextures;
+  glDeleteTexturesProc glDeleteTextures;
+  glBindTextureProc glBindTexture;
+  glActiveTextureProc glActiveTexture;
+  glTexParameteriProc glTexParameteri;
+  glGetIntegervProc glGetIntegerv;
+  glGetFloatvProc glGetFloatv;
+  glIsEnabledProc glIsEnabled;
+  glEnableProc glEnable;
+  glDisableProc glDisable;
+  glBlendFuncProc glBlendFunc;
+  glBlendFuncSeparateProc glBlendFuncSeparate;
+  glClearColorProc glClearColor;
+  glClearProc glClear;
+  glViewportProc glViewport;
+  glBindBufferProc glBindBuffer;
+  glVertexAttribPointerProc glVertexAttribPointer;
+  glGetVertexAttribivProc glGetVertexAttribiv;
+  glGetVertexAttribPointervProc glGetVertexAttribPointerv;
+  glEnableVertexAttribArrayProc glEnableVertexAttribArray;
+  glDisableVertexAttribArrayProc glDisableVertexAttribArray;
+  glDrawArraysProc glDrawArrays;
+  glFlushProc glFlush;
+#ifdef USE_GLES3
+  glBindVertexArrayProc glBindVertexArray;
+#endif
+  PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+  PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR;
+  PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR;
+  bool valid;
+};
+
+template <typename T>
+void ResolveProc(T* proc, const char* name) {
+  *proc = reinterpret_cast<T>(eglGetProcAddress(name));
+}
+
+static const CompositorProcs& CompositorProcs() {
+  static struct CompositorProcs procs = {};
+  static bool initialized = false;
+  if (!initialized) {
+    ResolveProc(&procs.glCreateShader, "glCreateShader");
+    ResolveProc(&procs.glShaderSource, "glShaderSource");
+    ResolveProc(&procs.glCompileShader, "glCompileShader");
+    ResolveProc(&procs.glGetShaderiv, "glGetShaderiv");
+    ResolveProc(&procs.glDeleteShader, "glDeleteShader");
+    ResolveProc(&procs.glCreateProgram, "glCreateProgram");
+    ResolveProc(&procs.glAttachShader, "glAttachShader");
+    ResolveProc(&procs.glBindAttribLocation, "glBindAttribLocation");
+    ResolveProc(&procs.glLinkProgram, "glLinkProgram");
+    ResolveProc(&procs.glGetProgramiv, "glGetProgramiv");
+    ResolveProc(&procs.glDeleteProgram, "glDeleteProgram");
+    ResolveProc(&procs.glUseProgram, "glUseProgram");
+    ResolveProc(&procs.glGetUniformLocation, "glGetUniformLocation");
+    ResolveProc(&procs.glUniform1i, "glUniform1i");
+    ResolveProc(&procs.glGenFramebuffers, "glGenFramebuffers");
+    ResolveProc(&procs.glDeleteFramebuffers, "glDeleteFramebuffers");
+    ResolveProc(&procs.glBindFramebuffer, "glBindFramebuffer");
+    ResolveProc(&procs.glFramebufferTexture2D, "glFramebufferTexture2D");
+    ResolveProc(&procs.glCheckFramebufferStatus, "glCheckFramebufferStatus");
+    ResolveProc(&procs.glGenTextures, "glGenTextures");
+    ResolveProc(&procs.glDeleteTextures, "glDeleteTextures");
+    ResolveProc(&procs.glBindTexture, "glBindTexture");
+    ResolveProc(&procs.glActiveTexture, "glActiveTexture");
+    ResolveProc(&procs.glTexParameteri, "glTexParameteri");
+    ResolveProc(&procs.glGetIntegerv, "glGetIntegerv");
+    ResolveProc(&procs.glGetFloatv, "glGetFloatv");
+    ResolveProc(&procs.glIsEnabled, "glIsEnabled");
+    ResolveProc(&procs.glEnable, "glEnable");
+    ResolveProc(&procs.glDisable, "glDisable");
+    ResolveProc(&procs.glBlendFunc, "glBlendFunc");
+    ResolveProc(&procs.glBlendFuncSeparate, "glBlendFuncSeparate");
+    ResolveProc(&procs.glClearColor, "glClearColor");
+    ResolveProc(&procs.glClear, "glClear");
+    ResolveProc(&procs.glViewport, "glViewport");
+    ResolveProc(&procs.glBindBuffer, "glBindBuffer");
+    ResolveProc(&procs.glVertexAttribPointer, "glVertexAttribPointer");
+    ResolveProc(&procs.glGetVertexAttribiv, "glGetVertexAttribiv");
+    ResolveProc(&procs.glGetVertexAttribPointerv, "glGetVertexAttribPointerv");
+    ResolveProc(&procs.glEnableVertexAttribArray, "glEnableVertexAttribArray");
+    ResolveProc(&procs.glDisableVertexAttribArray,
+                "glDisableVertexAttribArray");
+    ResolveProc(&procs.glDrawArrays, "glDrawArrays");
+    ResolveProc(&procs.glFlush, "glFlush");
+#ifdef USE_GLES3
+    ResolveProc(&procs.glBindVertexArray, "glBindVertexArray");
+#endif
+    ResolveProc(&procs.glEGLImageTargetTexture2DOES,
+                "glEGLImageTargetTexture2DOES");
+    ResolveProc(&procs.eglCreateImageKHR, "eglCreateImageKHR");
+    ResolveProc(&procs.eglDestroyImageKHR, "eglDestroyImageKHR");
+
+    procs.valid =
+        procs.glCreateShader && procs.glShaderSource && procs.glCompileShader &&
+        procs.glGetShaderiv && procs.glDeleteShader && procs.glCreateProgram &&
+        procs.glAttachShader && procs.glBindAttribLocation &&
+        procs.glLinkProgram && procs.glGetProgramiv && procs.glDeleteProgram &&
+        procs.glUseProgram && procs.glGetUniformLocation && procs.glUniform1i &&
+        procs.glGenFramebuffers && procs.glDeleteFramebuffers &&
+        procs.glBindFramebuffer && procs.glFramebufferTexture2D &&
+        procs.glCheckFramebufferStatus && procs.glGenTextures &&
+        procs.glDeleteTextures && procs.glBindTexture &&
+        procs.glActiveTexture && procs.glTexParameteri &&
+        procs.glGetIntegerv && procs.glGetFloatv && procs.glIsEnabled &&
+        procs.glEnable && procs.glDisable && procs.glBlendFunc &&
+        procs.glBlendFuncSeparate && procs.glClearColor && procs.glClear &&
+        procs.glViewport && procs.glBindBuffer && procs.glVertexAttribPointer &&
+        procs.glGetVertexAttribiv && procs.glGetVertexAttribPointerv &&
+        procs.glEnableVertexAttribArray && procs.glDisableVertexAttribArray &&
+        procs.glDrawArrays && procs.glFlush &&
+        procs.glEGLImageTargetTexture2DOES && procs.eglCreateImageKHR &&
+        procs.eglDestroyImageKHR;
+#ifdef USE_GLES3
+    procs.valid = procs.valid && procs.glBindVertexArray;
+#endif
+    initialized = true;
+  }
+  return procs;
+}
+
+GLuint CompileShader(GLenum type, const char* source) {
+  const auto& gl = CompositorProcs();
+  auto shader = gl.glCreateShader(type);
+  gl.glShaderSource(shader, 1, &source, nullptr);
+  gl.glCompileShader(shader);
+
+  GLint compiled = GL_FALSE;
+  gl.glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (compiled != GL_TRUE) {
+    gl.glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+// The GL state which the composition changes. The engine doesn't expect the
+// compositor to touch its context, so the state is restored afterwards.
+class ScopedGlState {
+ public:
+  ScopedGlState() : gl_(CompositorProcs()) {
+    gl_.glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer_);
+    gl_.glGetIntegerv(GL_VIEWPORT, viewport_);
+    gl_.glGetIntegerv(GL_CURRENT_PROGRAM, &program_);
+    gl_.glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &array_buffer_);
+    gl_.glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture_);
+    gl_.glActiveTexture(GL_TEXTURE0);
+    gl_.glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture_);
+    gl_.glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src_rgb_);
+    gl_.glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst_rgb_);
+    gl_.glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_src_alpha_);
+    gl_.glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_dst_alpha_);
+    gl_.glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color_);
+#ifdef USE_GLES3
+    // The compositor draws with the default vertex array object, whose
+    // attribute is saved below.
+    gl_.glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array_);
+    gl_.glBindVertexArray(0);
+#endif
+    gl_.glGetVertexAttribiv(kPositionAttribute,
+                            GL_VERTEX_ATTRIB_ARRAY_ENABLED,
+                            &attrib_enabled_);
+    gl_.glGetVertexAttribiv(kPositionAttribute, GL_VERTEX_ATTRIB_ARRAY_SIZE,
+                            &attrib_size_);
+    gl_.glGetVertexAttribiv(kPositionAttribute, GL_VERTEX_ATTRIB_ARRAY_TYPE,
+                            &attrib_type_);
+    gl_.glGetVertexAttribiv(kPositionAttribute,
+                            GL_VERTEX_ATTRIB_ARRAY_NORMALIZED,
+                            &attrib_normalized_);
+    gl_.glGetVertexAttribiv(kPositionAttribute, GL_VERTEX_ATTRIB_ARRAY_STRIDE,
+                            &attrib_stride_);
+    gl_.glGetVertexAttribiv(kPositionAttribute,
+                            GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING,
+                            &attrib_buffer_);
+    gl_.glGetVertexAttribPointerv(kPositionAttribute,
+                                  GL_VERTEX_ATTRIB_ARRAY_POINTER,
+                                  &attrib_pointer_);
+    for (size_t i = 0; i < kCapabilityCount; i++) {
+      capabilities_enabled_[i] = gl_.glIsEnabled(kCapabilities[i]);
+      gl_.glDisable(kCapabilities[i]);
+    }
+  }
+
+  ~ScopedGlState() {
+    for (size_t i = 0; i < kCapabilityCount; i++) {
+      if (capabilities_enabled_[i]) {
+        gl_.glEnable(kCapabilities[i]);
+      }
+    }
+    // The pointer is relative to the buffer which is bound when it is set.
+    gl_.glBindBuffer(GL_ARRAY_BUFFER, attrib_buffer_);
+    gl_.glVertexAttribPointer(kPositionAttribute, attrib_size_, attrib_type_,
+                              attrib_normalized_, attrib_stride_,
+                              attrib_pointer_);
+    if (attrib_enabled_) {
+      gl_.glEnableVertexAttribArray(kPositionAttribute);
+    } else {
+      gl_.glDisableVertexAttribArray(kPositionAttribute);
+    }
+#ifdef USE_GLES3
+    gl_.glBindVertexArray(vertex_array_);
+#endif
+    gl_.glClearColor(clear_color_[0], clear_color_[1], clear_color_[2],
+                     clear_color_[3]);
+    gl_.glBlendFuncSeparate(blend_src_rgb_, blend_dst_rgb_, blend_src_alpha_,
+                            blend_dst_alpha_);
+    gl_.glBindTexture(GL_TEXTURE_2D, texture_);
+    gl_.glActiveTexture(active_texture_);
+    gl_.glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
+    gl_.glUseProgram(program_);
+    gl_.glViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+    gl_.glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  }
+
+ private:
+  static constexpr GLenum kCapabilities[] = {
+      GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST};
+  static constexpr size_t kCapabilityCount =
+      sizeof(kCapabilities) / sizeof(kCapabilities[0]);
+
+  const struct CompositorProcs& gl_;
+  GLint framebuffer_ = 0;
+  GLint viewport_[4] = {};
+  GLint program_ = 0;
+  GLint array_buffer_ = 0;
+  GLint active_texture_ = GL_TEXTURE0;
+  GLint texture_ = 0;
+  GLint blend_src_rgb_ = GL_ONE;
+  GLint blend_dst_rgb_ = GL_ZERO;
+  GLint blend_src_alpha_ = GL_ONE;
+  GLint blend_dst_alpha_ = GL_ZERO;
+  GLfloat clear_color_[4] = {};
+#ifdef USE_GLES3
+  GLint vertex_array_ = 0;
+#endif
+  // The state of the vertex attribute of the compositor in the default vertex
+  // array object.
+  GLint attrib_enabled_ = GL_FALSE;
+  GLint attrib_size_ = 4;
+  GLint attrib_type_ = GL_FLOAT;
+  GLint attrib_normalized_ = GL_FALSE;
+  GLint attrib_stride_ = 0;
+  GLint attrib_buffer_ = 0;
+  void* attrib_pointer_ = nullptr;
+  GLboolean capabilities_enabled_[kCapabilityCount] = {};
+};
+
+// Returns the memory cap of the idle stores. 0 disables the reuse.
+size_t GetPoolMaxBytes() {
+  auto megabytes = static_cast<int>(flutter::kDefaultBackingStorePoolMegabytes);
+  if (auto value = std::getenv(flutter::kBackingStorePoolSizeEnvironmentKey)) {
+    megabytes = std::atoi(value);
+    if (megabytes < 0) {
+      megabytes = flutter::kDefaultBackingStorePoolMegabytes;
+    }
+  }
+  return static_cast<size_t>(megabytes) * 1024 * 1024;
+}
+
+}  // namespace
+
+namespace flutter {
+
+CompositorDrmGbm::BackingStore::~BackingStore() {
+  const auto& gl = CompositorProcs();
+  // The stores which remain when the compositor is destroyed after the engine
+  // has shut down go away with the GL context.
+  if (eglGetCurrentContext() != EGL_NO_CONTEXT) {
+    if (framebuffer != 0) {
+      gl.glDeleteFramebuffers(1, &framebuffer);
+    }
+    if (texture != 0) {
+      gl.glDeleteTextures(1, &texture);
+    }
+  }
+  if (image != EGL_NO_IMAGE_KHR) {
+    gl.eglDestroyImageKHR(egl_display, image);
+  }
+  if (fb_id != 0) {
+    drmModeRmFB(drm_device, fb_id);
+  }
+  if (bo) {
+    gbm_bo_destroy(bo);
+  }
+}
+
+CompositorDrmGbm::CompositorDrmGbm(NativeWindowDrmGbm* native_window,
+                                   SurfaceGlDrm<ContextEgl>* render_surface)
+    : native_window_(native_window),
+      render_surface_(render_surface),
+      plane_assigner_(native_window, native_window->Width(),
+                      native_window->Height()),
+      pool_(GetPoolMaxBytes()) {}
+
+CompositorDrmGbm::~CompositorDrmGbm() {
+  if (eglGetCurrentContext() != EGL_NO_CONTEXT && program_ != 0) {
+    CompositorProcs().glDeleteProgram(program_);
+  }
+}
+
+bool CompositorDrmGbm::CreateBackingStore(
+    const FlutterBackingStoreConfig& config,
+    FlutterBackingStore* backing_store_out) {
+  BackingStoreKey key = {static_cast<uint32_t>(config.size.width),
+                         static_cast<uint32_t>(config.size.height),
+                         DRM_FORMAT_ARGB8888};
+  auto owned_store = pool_.Acquire(key);
+  if (!owned_store) {
+    owned_store = std::make_unique<BackingStore>();
+    owned_store->key = key;
+    if (!AllocateStore(owned_store.get())) {
+      return false;
+    }
+  }
+  auto store = owned_store.get();
+  store->in_use = true;
+  live_stores_.push_back(std::move(owned_store));
+
+  backing_store_out->type = kFlutterBackingStoreTypeOpenGL;
+  backing_store_out->open_gl.type = kFlutterOpenGLTargetTypeFramebuffer;
+  backing_store_out->open_gl.framebuffer.target = kFramebufferFormat;
+  backing_store_out->open_gl.framebuffer.name = store->framebuffer;
+  backing_store_out->open_gl.framebuffer.user_data = store;
+  // The store is owned by the compositor and released in
+  // CollectBackingStore().
+  backing_store_out->open_gl.framebuffer.destruction_callback =
+      [](void* user_data) {};
+  return true;
+}
+
+bool CompositorDrmGbm::CollectBackingStore(
+    const FlutterBackingStore& backing_store) {
+  auto store = GetStore(&backing_store);
+  // It may still be scanned out, so it is reused only after that.
+  store->in_use = false;
+  ReleaseStoreIfIdle(store);
+  return true;
+}
+
+bool CompositorDrmGbm::PresentLayers(const FlutterLayer** layers,
+                                     size_t layers_count) {
+  std::vector<const FlutterLayer*> backing_store_layers;
+  std::vector<DrmPlaneLayer> plane_layers;
+  for (size_t i = 0; i < layers_count; i++) {
+    const auto* layer = layers[i];
+    if (layer->type != kFlutterLayerContentTypeBackingStore) {
+      if (!platform_view_warned_) {
+        LINUXES_LOG(WARNING) << "Platform views are not supported.";
+        platform_view_warned_ = true;
+      }
+      continue;
+    }
+    auto store = GetStore(layer->backing_store);
+    backing_store_layers.push_back(layer);
+    plane_layers.push_back({store->fb_id,
+                            static_cast<int32_t>(layer->offset.x),
+                            static_cast<int32_t>(layer->offset.y),
+                            static_cast<uint32_t>(layer->size.width),
+                            static_cast<uint32_t>(layer->size.height)});
+  }
+  if (backing_store_layers.empty()) {
+    return true;
+  }
+
+  // The planes read the stores without waiting for GL, so the rendering has
+  // to be submitted first. The implicit fences of the buffers do the rest.
+  CompositorProcs().glFlush();
+
+  auto assignment = plane_assigner_.Assign(plane_layers);
+  if (!assignment.scanout_first_layer) {
+    std::vector<const FlutterLayer*> gl_layers(
+        backing_store_layers.begin(),
+        backing_store_layers.begin() + assignment.first_overlay_layer);
+    if (!CompositeLayers(gl_layers) ||
+        !render_surface_->SwapOnscreenBuffers()) {
+      return false;
+    }
+  }
+
+  std::vector<BackingStore*> scanout_stores;
+  for (size_t i = 0; i < backing_store_layers.size(); i++) {
+    if (i >= assignment.first_overlay_layer ||
+        (i == 0 && assignment.scanout_first_layer)) {
+      auto store = GetStore(backing_store_layers[i]->backing_store);
+      store->scanout_count++;
+      scanout_stores.push_back(store);
+    }
+  }
+
+  auto committed = native_window_->CommitLayers(
+      plane_layers, assignment, [this, scanout_stores]() {
+        for (auto store : scanout_stores) {
+          store->scanout_count--;
+          ReleaseStoreIfIdle(store);
+        }
+      });
+  if (!committed) {
+    // The display may reject what the test accepted, e.g. when the bandwidth
+    // changes. Check it again in the next frame.
+    plane_assigner_.Invalidate();
+  }
+  return committed;
+}
+
+void CompositorDrmGbm::ReleaseIdleBackingStores() {
+  // The GL objects of the stores can only be deleted with the context
+  // current, which the engine may have cleared between frames.
+  auto made_current = false;
+  if (eglGetCurrentContext() == EGL_NO_CONTEXT) {
+    if (!render_surface_->GLContextMakeCurrent()) {
+      LINUXES_LOG(ERROR) << "Failed to make the context current.";
+      return;
+    }
+    made_current = true;
+  }
+  pool_.Purge();
+  if (made_current) {
+    render_surface_->GLContextClearCurrent();
+  }
+}
+
+CompositorDrmGbm::BackingStore* CompositorDrmGbm::GetStore(
+    const FlutterBackingStore* backing_store) {
+  return static_cast<BackingStore*>(
+      backing_store->open_gl.framebuffer.user_data);
+}
+
+bool CompositorDrmGbm::AllocateStore(BackingStore* store) {
+  const auto& gl = CompositorProcs();
+  if (!gl.valid) {
+    LINUXES_LOG(ERROR) << "Failed to resolve GL functions for the compositor.";
+    return false;
+  }
+  auto width = store->key.width;
+  auto height = store->key.height;
+  store->drm_device = native_window_->GetDrmDevice();
+  store->egl_display = eglGetCurrentDisplay();
+  store->bo = gbm_bo_create(native_window_->GetGbmDevice(), width, height,
+                            GBM_FORMAT_ARGB8888,
+                            GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+  if (!store->bo) {
+    LINUXES_LOG(ERROR) << "Failed to create a buffer of " << width << "x"
+                       << height;
+    return false;
+  }
+
+  auto stride = gbm_bo_get_stride(store->bo);
+  store->bytes = static_cast<size_t>(stride) * height;
+  uint32_t handles[4] = {gbm_bo_get_handle(store->bo).u32};
+  uint32_t pitches[4] = {stride};
+  uint32_t offsets[4] = {0};
+  auto result =
+      drmModeAddFB2(store->drm_device, width, height, DRM_FORMAT_ARGB8888,
+                    handles, pitches, offsets, &store->fb_id, 0);
+  if (result != 0) {
+    LINUXES_LOG(ERROR) << "Failed to add a framebuffer. (" << result << ")";
+    store->fb_id = 0;
+    return false;
+  }
+
+  auto fd = gbm_bo_get_fd(store->bo);
+  if (fd < 0) {
+    LINUXES_LOG(ERROR) << "Failed to export a buffer.";
+    return false;
+  }
+  EGLint attributes[] = {
+      EGL_WIDTH,
+      static_cast<EGLint>(width),
+      EGL_HEIGHT,
+      static_cast<EGLint>(height),
+      EGL_LINUX_DRM_FOURCC_EXT,
+      DRM_FORMAT_ARGB8888,
+      EGL_DMA_BUF_PLANE0_FD_EXT,
+      fd,
+      EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+      0,
+      EGL_DMA_BUF_PLANE0_PITCH_EXT,
+      static_cast<EGLint>(stride),
+      EGL_NONE,
+  };
+  store->image = gl.eglCreateImageKHR(store->egl_display, EGL_NO_CONTEXT,
+                                      EGL_LINUX_DMA_BUF_EXT, nullptr,
+                                      attributes);
+  // The image keeps its own reference to the buffer.
+  close(fd);
+  if (store->image == EGL_NO_IMAGE_KHR) {
+    LINUXES_LOG(ERROR) << "Failed to import a buffer into EGL.";
+    return false;
+  }
+
+  GLint texture_binding = 0;
+  GLint framebuffer_binding = 0;
+  gl.glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture_binding);
+  gl.glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer_binding);
+
+  gl.glGenTextures(1, &store->texture);
+  gl.glBindTexture(GL_TEXTURE_2D, store->texture);
+  gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  gl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  gl.glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, store->image);
+
+  gl.glGenFramebuffers(1, &store->framebuffer);
+  gl.glBindFramebuffer(GL_FRAMEBUFFER, store->framebuffer);
+  gl.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_TEXTURE_2D, store->texture, 0);
+  auto status = gl.glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+  gl.glBindTexture(GL_TEXTURE_2D, texture_binding);
+  gl.glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_binding);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    LINUXES_LOG(ERROR) << "The backing store framebuffer is incomplete.";
+    return false;
+  }
+  return true;
+}
+
+void CompositorDrmGbm::ReleaseStoreIfIdle(BackingStore* store) {
+  if (store->in_use || store->scanout_count > 0) {
+    return;
+  }
+  for (auto& live_store : live_stores_) {
+    if (live_store.get() != store) {
+      continue;
+    }
+    auto owned_store = std::move(live_store);
+    live_store = std::move(live_stores_.back());
+    live_stores_.pop_back();
+    auto key = owned_store->key;
+    auto bytes = owned_store->bytes;
+    pool_.Release(key, std::move(owned_store), bytes);
+    return;
+  }
+}
+
+bool CompositorDrmGbm::CompositeLayers(
+    const std::vector<const FlutterLayer*>& layers) {
+  const auto& gl = CompositorProcs();
+  ScopedGlState scoped_state;
+
+  auto program = GetProgram();
+  if (program == 0) {
+    return false;
+  }
+
+  gl.glBindFramebuffer(GL_FRAMEBUFFER, render_surface_->GLContextFBO());
+  gl.glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  gl.glClear(GL_COLOR_BUFFER_BIT);
+
+#ifdef USE_GLES3
+  // Client-side vertex arrays can only be used with the default vertex array
+  // object.
+  gl.glBindVertexArray(0);
+#endif
+  gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+  gl.glUseProgram(program);
+  gl.glActiveTexture(GL_TEXTURE0);
+  // The layers have premultiplied alpha.
+  gl.glEnable(GL_BLEND);
+  gl.glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  gl.glVertexAttribPointer(kPositionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
+                           kQuadVertices);
+  gl.glEnableVertexAttribArray(kPositionAttribute);
+
+  auto display_height = static_cast<GLint>(native_window_->Height());
+  for (const auto* layer : layers) {
+    auto store = GetStore(layer->backing_store);
+    // The offsets are from the top of the display, and the viewport is from
+    // the bottom.
+    auto x = static_cast<GLint>(layer->offset.x);
+    auto y = static_cast<GLint>(layer->offset.y);
+    auto width = static_cast<GLsizei>(layer->size.width);
+    auto height = static_cast<GLsizei>(layer->size.height);
+    gl.glViewport(x, display_height - (y + height), width, height);
+    gl.glBindTexture(GL_TEXTURE_2D, store->texture);
+    gl.glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  }
+  gl.glDisableVertexAttribArray(kPositionAttribute);
+  return true;
+}
+
+uint32_t CompositorDrmGbm::GetProgram() {
+  if (program_ != 0) {
+    return program_;
+  }
+
+  const auto& gl = CompositorProcs();
+  auto vertex_shader = CompileShader(GL_VERTEX_SHADER, kVertexShader);
+  auto fragment_shader = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+  if (vertex_shader == 0 || fragment_shader == 0) {
+    LINUXES_LOG(ERROR) << "Failed to compile the compositor shader.";
+    if (vertex_shader != 0) {
+      gl.glDeleteShader(vertex_shader);
+    }
+    if (fragment_shader != 0) {
+      gl.glDeleteShader(fragment_shader);
+    }
+    return 0;
+  }
+
+  auto program = gl.glCreateProgram();
+  gl.glAttachShader(program, vertex_shader);
+  gl.glAttachShader(program, fragment_shader);
+  gl.glBindAttribLocation(program, kPositionAttribute, "position");
+  gl.glLinkProgram(program);
+  gl.glDeleteShader(vertex_shader);
+  gl.glDeleteShader(fragment_shader);
+
+  GLint linked = GL_FALSE;
+  gl.glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE) {
+    LINUXES_LOG(ERROR) << "Failed to link the compositor program.";
+    gl.glDeleteProgram(program);
+    return 0;
+  }
+
+  // The layer is always drawn from the first texture unit.
+  gl.glUseProgram(program);
+  auto location = gl.glGetUniformLocation(program, "layer");
+  if (location >= 0) {
+    gl.glUniform1i(location, 0);
+  }
+
+  program_ = program;
+  return program;
+}
+
+}  // namespace flutter
@@ -0,0 +1,109 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_COMPOSITOR_DRM_GBM_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_COMPOSITOR_DRM_GBM_H_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <gbm.h>
+
+#include <memory>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/surface/backing_store_pool.h"
+#include "flutter/shell/platform/linux_embedded/surface/context_egl.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_compositor.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_drm.h"
+#include "flutter/shell/platform/linux_embedded/window/drm_plane_assigner.h"
+
+namespace flutter {
+
+class NativeWindowDrmGbm;
+
+// Renders the layers of a frame into GBM buffers, which the planes of the
+// display scan out directly where the driver allows it. The other layers are
+// composited into the render surface by GL.
+class CompositorDrmGbm : public LinuxesCompositor {
+ public:
+  CompositorDrmGbm(NativeWindowDrmGbm* native_window,
+                   SurfaceGlDrm<ContextEgl>* render_surface);
+  ~CompositorDrmGbm();
+
+  // Prevent copying.
+  CompositorDrmGbm(CompositorDrmGbm const&) = delete;
+  CompositorDrmGbm& operator=(CompositorDrmGbm const&) = delete;
+
+  // |LinuxesCompositor|
+  bool CreateBackingStore(const FlutterBackingStoreConfig& config,
+                          FlutterBackingStore* backing_store_out) override;
+
+  // |LinuxesCompositor|
+  bool CollectBackingStore(const FlutterBackingStore& backing_store) override;
+
+  // |LinuxesCompositor|
+  bool PresentLayers(const FlutterLayer** layers,
+                     size_t layers_count) override;
+
+  // |LinuxesCompositor|
+  FlutterDesktopBackingStorePoolStats GetBackingStorePoolStats()
+      const override {
+    return pool_.GetStats();
+  }
+
+  // |LinuxesCompositor|
+  void ReleaseIdleBackingStores() override;
+
+ private:
+  // A GBM buffer which the engine renders into through a GL framebuffer, and
+  // which a plane can scan out.
+  struct BackingStore {
+    // Releases the GL objects only if a GL context is current.
+    ~BackingStore();
+
+    BackingStoreKey key = {};
+    size_t bytes = 0;
+    int drm_device = -1;
+    EGLDisplay egl_display = EGL_NO_DISPLAY;
+    gbm_bo* bo = nullptr;
+    uint32_t fb_id = 0;
+    EGLImageKHR image = EGL_NO_IMAGE_KHR;
+    uint32_t texture = 0;
+    uint32_t framebuffer = 0;
+
+    // Whether the engine owns the store.
+    bool in_use = false;
+
+    // The number of frames which scan out the store, or wait to.
+    int scanout_count = 0;
+  };
+
+  // Returns the store which |backing_store| was created from.
+  static BackingStore* GetStore(const FlutterBackingStore* backing_store);
+
+  bool AllocateStore(BackingStore* store);
+
+  // Returns |store| to the pool once neither the engine nor a plane uses it.
+  void ReleaseStoreIfIdle(BackingStore* store);
+
+  // Composites |layers| into the render surface by GL.
+  bool CompositeLayers(const std::vector<const FlutterLayer*>& layers);
+
+  // Returns the program which draws a layer, creating it on first use, or 0.
+  uint32_t GetProgram();
+
+  NativeWindowDrmGbm* native_window_;
+  SurfaceGlDrm<ContextEgl>* render_surface_;
+  DrmPlaneAssigner plane_assigner_;
+  uint32_t program_ = 0;
+  bool platform_view_warned_ = false;
+
+  // The stores used by the engine or scanned out.
+  std::vector<std::unique_ptr<BackingStore>> live_stores_;
+  BackingStorePool<BackingStore> pool_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_COMPOSITOR_DRM_GBM_H_
@@ -75,8 +75,9 @@ std::unique_ptr<LinuxesEGLSurface> ContextEgl::CreateOnscreenSurface(
 
 std::unique_ptr<LinuxesEGLSurface> ContextEgl::CreateOffscreenSurface(
     NativeWindow* window_resource) const {
-#if defined(DISPLAY_BACKEND_TYPE_X11) || \
-    defined(DISPLAY_BACKEND_TYPE_DRM_EGLSTREAM)
+#if defined(DISPLAY_BACKEND_TYPE_X11) ||           \
+    defined(DISPLAY_BACKEND_TYPE_DRM_EGLSTREAM) || \
+    defined(DISPLAY_BACKEND_TYPE_HEADLESS)
   const EGLint attribs[] = {
       // clang-format off
       EGL_WIDTH, 1,
@@ -0,0 +1,34 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/context_egl_headless.h"
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+ContextEglHeadless::ContextEglHeadless(
+    std::unique_ptr<EnvironmentEglHeadless> environment)
+    : ContextEgl(std::move(environment), EGL_PBUFFER_BIT) {}
+
+std::unique_ptr<LinuxesEGLSurface> ContextEglHeadless::CreateOnscreenSurface(
+    NativeWindow* window) const {
+  const EGLint attribs[] = {
+      // clang-format off
+      EGL_WIDTH,  window->Width(),
+      EGL_HEIGHT, window->Height(),
+      EGL_NONE
+      // clang-format on
+  };
+  EGLSurface surface =
+      eglCreatePbufferSurface(environment_->Display(), config_, attribs);
+  if (surface == EGL_NO_SURFACE) {
+    LINUXES_LOG(ERROR) << "Failed to create EGL pbuffer surface: "
+                       << get_egl_error_cause();
+  }
+  return std::make_unique<LinuxesEGLSurface>(surface, environment_->Display(),
+                                             context_);
+}
+
+}  // namespace flutter
@@ -0,0 +1,31 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_CONTEXT_EGL_HEADLESS_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_CONTEXT_EGL_HEADLESS_H_
+
+#include <EGL/egl.h>
+
+#include <memory>
+
+#include "flutter/shell/platform/linux_embedded/surface/context_egl.h"
+#include "flutter/shell/platform/linux_embedded/surface/environment_egl_headless.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_egl_surface.h"
+
+namespace flutter {
+
+// Renders into pbuffer surfaces instead of windows.
+class ContextEglHeadless : public ContextEgl {
+ public:
+  ContextEglHeadless(std::unique_ptr<EnvironmentEglHeadless> environment);
+  ~ContextEglHeadless() = default;
+
+  // |ContextEgl|
+  std::unique_ptr<LinuxesEGLSurface> CreateOnscreenSurface(
+      NativeWindow* window) const override;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_CONTEXT_EGL_HEADLESS_H_
@@ -0,0 +1,53 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/environment_egl_headless.h"
+
+#include <cstring>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+EnvironmentEglHeadless::EnvironmentEglHeadless() : EnvironmentEgl() {
+  auto eglGetPlatformDisplayEXT =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (eglGetPlatformDisplayEXT &&
+      HasClientExtension("EGL_MESA_platform_surfaceless")) {
+    display_ = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA,
+                                        EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (display_ == EGL_NO_DISPLAY) {
+    LINUXES_LOG(WARNING) << "EGL surfaceless platform isn't available. "
+                         << "Use the default display instead.";
+    display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  if (display_ == EGL_NO_DISPLAY) {
+    LINUXES_LOG(ERROR) << "Failed to get the EGL display: "
+                       << get_egl_error_cause();
+    return;
+  }
+
+  valid_ = InitializeEgl();
+}
+
+bool EnvironmentEglHeadless::HasClientExtension(const char* extension) const {
+  auto extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (!extensions) {
+    return false;
+  }
+
+  // Extensions are separated by spaces, and one can be a prefix of another.
+  const auto length = std::strlen(extension);
+  for (auto p = extensions; (p = std::strstr(p, extension)); p += length) {
+    if ((p == extensions || p[-1] == ' ') &&
+        (p[length] == ' ' || p[length] == '\0')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace flutter
@@ -0,0 +1,30 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_ENVIRONMENT_EGL_HEADLESS_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_ENVIRONMENT_EGL_HEADLESS_H_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "flutter/shell/platform/linux_embedded/surface/environment_egl.h"
+
+namespace flutter {
+
+// An EGL display which isn't connected to any window system or display
+// device. Mesa's surfaceless platform is used if available, so that this also
+// works with llvmpipe on machines without a GPU.
+class EnvironmentEglHeadless : public EnvironmentEgl {
+ public:
+  EnvironmentEglHeadless();
+  ~EnvironmentEglHeadless() = default;
+
+ private:
+  // Returns whether the EGL client supports |extension|.
+  bool HasClientExtension(const char* extension) const;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_ENVIRONMENT_EGL_HEADLESS_H_
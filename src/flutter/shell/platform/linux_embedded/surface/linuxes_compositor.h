@@ -0,0 +1,46 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_COMPOSITOR_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_COMPOSITOR_H_
+
+#include <cstddef>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
+
+namespace flutter {
+
+// Shows the layers of a frame on the display, which the engine renders into
+// separate backing stores instead of the render surface. These are called on
+// the raster thread with the GL context current.
+class LinuxesCompositor {
+ public:
+  virtual ~LinuxesCompositor() = default;
+
+  // Provides a backing store for the engine to render a layer into.
+  virtual bool CreateBackingStore(const FlutterBackingStoreConfig& config,
+                                  FlutterBackingStore* backing_store_out) = 0;
+
+  // Takes back a backing store which the engine no longer uses.
+  virtual bool CollectBackingStore(
+      const FlutterBackingStore& backing_store) = 0;
+
+  // Shows |layers|, bottom first.
+  virtual bool PresentLayers(const FlutterLayer** layers,
+                             size_t layers_count) = 0;
+
+  // Returns the reuse statistics of the backing stores. This can be called
+  // from any thread.
+  virtual FlutterDesktopBackingStorePoolStats GetBackingStorePoolStats()
+      const = 0;
+
+  // Releases the backing stores which are kept for the next frames. This must
+  // be called on the raster thread.
+  virtual void ReleaseIdleBackingStores() = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_COMPOSITOR_H_
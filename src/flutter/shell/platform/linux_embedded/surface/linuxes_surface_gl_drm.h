@@ -7,6 +7,7 @@
 
 #include <memory>
 
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_egl_surface.h"
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface.h"
@@ -85,7 +86,7 @@ class SurfaceGlDrm final : public Surface, public SurfaceGlDelegate {
 
   // |SurfaceGlDelegate|
   bool GLContextPresent(uint32_t fbo_id) const override {
-    if (!onscreen_surface_->SwapBuffers()) {
+    if (!SwapOnscreenBuffers()) {
       return false;
     }
     static_cast<NativeWindowDrm<SurfaceGlDrm<T>>*>(native_window_)
@@ -96,6 +97,13 @@ class SurfaceGlDrm final : public Surface, public SurfaceGlDelegate {
   // |SurfaceGlDelegate|
   uint32_t GLContextFBO() const override { return 0; }
 
+  // Swaps the buffers of the onscreen surface without showing the new front
+  // buffer, which a compositor shows together with the other layers.
+  bool SwapOnscreenBuffers() const {
+    ScopedFrameEvent frame_event(kFlutterDesktopFrameEventSwapBuffers);
+    return onscreen_surface_->SwapBuffers();
+  }
+
   // |SurfaceGlDelegate|
   void* GlProcResolver(const char* name) const override {
     return context_->GlProcResolver(name);
@@ -0,0 +1,145 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_headless.h"
+
+#include <GLES2/gl2.h>
+
+#include <algorithm>
+
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+namespace {
+
+typedef void (*glReadPixelsProc)(GLint x,
+                                 GLint y,
+                                 GLsizei width,
+                                 GLsizei height,
+                                 GLenum format,
+                                 GLenum type,
+                                 void* pixels);
+typedef void (*glPixelStoreiProc)(GLenum pname, GLint param);
+
+struct ReadPixelsProcs {
+  glReadPixelsProc glReadPixels;
+  glPixelStoreiProc glPixelStorei;
+  bool valid;
+};
+
+const ReadPixelsProcs& GetReadPixelsProcs() {
+  static ReadPixelsProcs procs = []() {
+    ReadPixelsProcs procs;
+    procs.glReadPixels = reinterpret_cast<glReadPixelsProc>(
+        eglGetProcAddress("glReadPixels"));
+    procs.glPixelStorei = reinterpret_cast<glPixelStoreiProc>(
+        eglGetProcAddress("glPixelStorei"));
+    procs.valid = procs.glReadPixels && procs.glPixelStorei;
+    return procs;
+  }();
+  return procs;
+}
+
+}  // namespace
+
+SurfaceGlHeadless::SurfaceGlHeadless(
+    std::unique_ptr<ContextEglHeadless> context)
+    : native_window_(nullptr),
+      onscreen_surface_(nullptr),
+      offscreen_surface_(nullptr) {
+  context_ = std::move(context);
+}
+
+bool SurfaceGlHeadless::IsValid() const {
+  return offscreen_surface_ && context_->IsValid();
+}
+
+bool SurfaceGlHeadless::SetNativeWindow(NativeWindow* window) {
+  native_window_ = static_cast<NativeWindowHeadless*>(window);
+
+  onscreen_surface_ = context_->CreateOnscreenSurface(native_window_);
+  if (!onscreen_surface_->IsValid()) {
+    return false;
+  }
+
+  offscreen_surface_ = context_->CreateOffscreenSurface(nullptr);
+  if (!offscreen_surface_->IsValid()) {
+    LINUXES_LOG(WARNING) << "Off-Screen surface is invalid.";
+    offscreen_surface_ = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+bool SurfaceGlHeadless::OnScreenSurfaceResize(const size_t width,
+                                              const size_t height) const {
+  return native_window_->Resize(width, height);
+}
+
+void SurfaceGlHeadless::DestroyOnScreenContext() {
+  context_->ClearCurrent();
+  onscreen_surface_ = nullptr;
+}
+
+bool SurfaceGlHeadless::ResourceContextMakeCurrent() const {
+  return offscreen_surface_->MakeCurrent();
+}
+
+bool SurfaceGlHeadless::ClearCurrentContext() const {
+  return context_->ClearCurrent();
+}
+
+bool SurfaceGlHeadless::GLContextMakeCurrent() const {
+  return onscreen_surface_->MakeCurrent();
+}
+
+bool SurfaceGlHeadless::GLContextClearCurrent() const {
+  return context_->ClearCurrent();
+}
+
+bool SurfaceGlHeadless::GLContextPresent(uint32_t fbo_id) const {
+  // The frame must be read before swapping because the content of a pbuffer
+  // is undefined after that.
+  if (!ReadPixels()) {
+    return false;
+  }
+  native_window_->OnFrameRendered();
+
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventSwapBuffers);
+  return onscreen_surface_->SwapBuffers();
+}
+
+uint32_t SurfaceGlHeadless::GLContextFBO() const { return 0; }
+
+void* SurfaceGlHeadless::GlProcResolver(const char* name) const {
+  return context_->GlProcResolver(name);
+}
+
+bool SurfaceGlHeadless::ReadPixels() const {
+  const auto& gl = GetReadPixelsProcs();
+  if (!gl.valid) {
+    LINUXES_LOG(ERROR) << "Failed to resolve the procs to read pixels.";
+    return false;
+  }
+
+  const auto width = native_window_->Width();
+  const auto height = native_window_->Height();
+  auto pixels = native_window_->FrameBuffer();
+  gl.glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  gl.glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  gl.glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+  // GL returns the bottom row first.
+  const auto stride = width * 4;
+  for (int32_t y = 0; y < height / 2; y++) {
+    std::swap_ranges(pixels + y * stride, pixels + (y + 1) * stride,
+                     pixels + (height - 1 - y) * stride);
+  }
+  return true;
+}
+
+}  // namespace flutter
@@ -4,6 +4,7 @@
 
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_wayland.h"
 
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
 
 namespace flutter {
@@ -68,6 +69,7 @@ bool SurfaceGlWayland::GLContextClearCurrent() const {
 }
 
 bool SurfaceGlWayland::GLContextPresent(uint32_t fbo_id) const {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventSwapBuffers);
   return onscreen_surface_->SwapBuffers();
 }
 
@@ -4,6 +4,7 @@
 
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_x11.h"
 
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
 
 namespace flutter {
@@ -64,6 +65,7 @@ bool SurfaceGlX11::GLContextClearCurrent() const {
 }
 
 bool SurfaceGlX11::GLContextPresent(uint32_t fbo_id) const {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventSwapBuffers);
   return onscreen_surface_->SwapBuffers();
 }
 
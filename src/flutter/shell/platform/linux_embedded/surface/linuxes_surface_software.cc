@@ -0,0 +1,176 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+namespace {
+
+// The maximum number of damage rectangles of a frame. Beyond it, the last
+// rectangle grows to cover the remaining changes.
+constexpr size_t kMaxDamageRects = 16;
+
+// Runs of changed rows which are separated by fewer unchanged rows than this
+// share a rectangle, so that a line of text isn't split at the gaps between
+// its glyphs.
+constexpr size_t kDamageMergeRows = 8;
+
+// Returns the offset of the first byte which differs between |a| and |b|, or
+// |size| if they are equal.
+size_t FindFirstDifference(const uint8_t* a, const uint8_t* b, size_t size) {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t x, y;
+    std::memcpy(&x, a + i, sizeof(x));
+    std::memcpy(&y, b + i, sizeof(y));
+    if (x != y) {
+      break;
+    }
+  }
+  while (i < size && a[i] == b[i]) {
+    i++;
+  }
+  return i;
+}
+
+// Returns the offset past the last byte which differs between |a| and |b|, or
+// 0 if they are equal.
+size_t FindLastDifference(const uint8_t* a, const uint8_t* b, size_t size) {
+  size_t i = size;
+  for (; i >= sizeof(uint64_t); i -= sizeof(uint64_t)) {
+    uint64_t x, y;
+    std::memcpy(&x, a + i - sizeof(x), sizeof(x));
+    std::memcpy(&y, b + i - sizeof(y), sizeof(y));
+    if (x != y) {
+      break;
+    }
+  }
+  while (i > 0 && a[i - 1] == b[i - 1]) {
+    i--;
+  }
+  return i;
+}
+
+// Copies |count| rows of |row_bytes| bytes. memcpy of the C library is
+// already vectorized, so contiguous rows are copied in a single call.
+void CopyRows(uint8_t* dst, size_t dst_stride, const uint8_t* src,
+              size_t src_stride, size_t row_bytes, size_t count) {
+  if (dst_stride == row_bytes && src_stride == row_bytes) {
+    std::memcpy(dst, src, row_bytes * count);
+    return;
+  }
+  for (size_t y = 0; y < count; y++, dst += dst_stride, src += src_stride) {
+    std::memcpy(dst, src, row_bytes);
+  }
+}
+
+}  // namespace
+
+bool SurfaceSoftware::Present(const void* allocation, size_t row_bytes,
+                              size_t height) {
+  ScopedFrameEvent frame_event(kFlutterDesktopFrameEventSwapBuffers);
+  auto width = row_bytes / kBytesPerPixel;
+  size_t index;
+  Buffer buffer;
+  if (!AcquireBuffer(width, height, &index, &buffer)) {
+    return false;
+  }
+  if (index >= buffer_count_) {
+    LINUXES_LOG(ERROR) << "Invalid buffer index: " << index;
+    return false;
+  }
+
+  // Find the rectangles which have changed since the previous frame.
+  auto frame = static_cast<const uint8_t*>(allocation);
+  auto frame_size = row_bytes * height;
+  damage_.clear();
+  if (previous_row_bytes_ != row_bytes ||
+      previous_frame_.size() != frame_size) {
+    previous_frame_.assign(frame, frame + frame_size);
+    previous_row_bytes_ = row_bytes;
+    stale_rows_.assign(buffer_count_ * height, 1);
+    damage_.push_back({0, 0, width, height});
+  } else {
+    for (size_t y = 0; y < height; y++) {
+      auto offset = y * row_bytes;
+      auto current_row = frame + offset;
+      auto previous_row = &previous_frame_[offset];
+      if (std::memcmp(current_row, previous_row, row_bytes) == 0) {
+        continue;
+      }
+      auto left =
+          FindFirstDifference(current_row, previous_row, row_bytes) /
+          kBytesPerPixel;
+      auto right =
+          (FindLastDifference(current_row, previous_row, row_bytes) +
+           kBytesPerPixel - 1) /
+          kBytesPerPixel;
+      std::memcpy(previous_row, current_row, row_bytes);
+      for (size_t i = 0; i < buffer_count_; i++) {
+        stale_rows_[i * height + y] = 1;
+      }
+
+      if (!damage_.empty() &&
+          (y - (damage_.back().y + damage_.back().height) < kDamageMergeRows ||
+           damage_.size() == kMaxDamageRects)) {
+        auto& rect = damage_.back();
+        auto rect_right = std::max(rect.x + rect.width, right);
+        rect.x = std::min(rect.x, left);
+        rect.width = rect_right - rect.x;
+        rect.height = y + 1 - rect.y;
+      } else {
+        damage_.push_back({left, y, right - left, 1});
+      }
+    }
+  }
+
+  // Copy the runs of rows which the buffer is missing.
+  auto copy_width = std::min(width, buffer.width);
+  auto copy_height = std::min(height, buffer.height);
+  auto copy_bytes = copy_width * kBytesPerPixel;
+  auto stale = &stale_rows_[index * height];
+  for (size_t y = 0; y < copy_height;) {
+    if (!stale[y]) {
+      y++;
+      continue;
+    }
+    auto top = y;
+    while (y < copy_height && stale[y]) {
+      stale[y++] = 0;
+    }
+    CopyRows(buffer.pixels + top * buffer.stride, buffer.stride,
+             frame + top * row_bytes, row_bytes, copy_bytes, y - top);
+  }
+
+  // Clip the damage to the buffer.
+  for (auto& rect : damage_) {
+    auto right = std::min(rect.x + rect.width, copy_width);
+    auto bottom = std::min(rect.y + rect.height, copy_height);
+    rect.x = std::min(rect.x, right);
+    rect.y = std::min(rect.y, bottom);
+    rect.width = right - rect.x;
+    rect.height = bottom - rect.y;
+  }
+  damage_.erase(std::remove_if(damage_.begin(), damage_.end(),
+                               [](const DamageRect& rect) {
+                                 return rect.width == 0 || rect.height == 0;
+                               }),
+                damage_.end());
+  return CommitBuffer(index, damage_);
+}
+
+void SurfaceSoftware::ResetBuffers(size_t buffer_count) {
+  buffer_count_ = buffer_count;
+  previous_row_bytes_ = 0;
+  stale_rows_.clear();
+}
+
+}  // namespace flutter
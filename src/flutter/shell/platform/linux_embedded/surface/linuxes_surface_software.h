@@ -0,0 +1,85 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter {
+
+// Shows the frames rendered by the software renderer of the engine.
+//
+// Each frame is copied into one of the buffers of the backend, which is then
+// shown. The previous frame is kept in system memory to find the rows which
+// have changed, because the buffers are often write-combined memory which is
+// very slow to read. Only the rows which a buffer is missing are copied, and
+// the rectangles which changed are passed to the display, so that it only
+// updates them.
+class SurfaceSoftware {
+ public:
+  SurfaceSoftware() = default;
+  virtual ~SurfaceSoftware() = default;
+
+  // Prevent copying.
+  SurfaceSoftware(SurfaceSoftware const&) = delete;
+  SurfaceSoftware& operator=(SurfaceSoftware const&) = delete;
+
+  // Shows a frame. |allocation| has |height| rows of |row_bytes| bytes in the
+  // native 32-bit format, which is BGRA in memory on little-endian machines,
+  // i.e. DRM_FORMAT_ARGB8888 and WL_SHM_FORMAT_ARGB8888.
+  bool Present(const void* allocation, size_t row_bytes, size_t height);
+
+ protected:
+  static constexpr size_t kBytesPerPixel = 4;
+
+  struct Buffer {
+    uint8_t* pixels;
+    size_t stride;
+    size_t width;
+    size_t height;
+  };
+
+  // A rectangle of a frame which differs from the previous frame, in pixels.
+  struct DamageRect {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+  };
+
+  // Returns a buffer which is not being shown and sets |index| to its index.
+  // The buffer should be |width|x|height|. If it's smaller, the frame is
+  // clipped.
+  virtual bool AcquireBuffer(size_t width, size_t height, size_t* index,
+                             Buffer* buffer) = 0;
+
+  // Shows the buffer |index|. Only the rectangles in |damage| differ from the
+  // previous frame, and |damage| is empty if the frame hasn't changed.
+  virtual bool CommitBuffer(size_t index,
+                            const std::vector<DamageRect>& damage) = 0;
+
+  // Forgets the contents of the buffers, so that the next frame is copied
+  // in full. Must be called whenever the buffers are (re)allocated.
+  void ResetBuffers(size_t buffer_count);
+
+ private:
+  // The previous frame.
+  std::vector<uint8_t> previous_frame_;
+  size_t previous_row_bytes_ = 0;
+
+  // Whether each row of each buffer is older than the previous frame. Indexed
+  // by buffer * height + row.
+  std::vector<uint8_t> stale_rows_;
+  size_t buffer_count_ = 0;
+
+  // The damage of the current frame, kept to reuse its allocation.
+  std::vector<DamageRect> damage_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_H_
@@ -0,0 +1,261 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_drm.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+namespace {
+// Bounds the wait for a page flip, which never completes while the display is
+// turned off, for example.
+constexpr int kPageFlipTimeoutMs = 1000;
+}  // namespace
+
+SurfaceSoftwareDrm::SurfaceSoftwareDrm(int drm_device, uint32_t crtc_id,
+                                       uint32_t connector_id,
+                                       const drmModeModeInfo& mode,
+                                       const DamagePlane& damage_plane,
+                                       PageFlipCallback page_flip_callback)
+    : drm_device_(drm_device),
+      crtc_id_(crtc_id),
+      connector_id_(connector_id),
+      mode_(mode),
+      damage_plane_(damage_plane),
+      page_flip_callback_(std::move(page_flip_callback)) {
+  for (auto& buffer : buffers_) {
+    if (!CreateDumbBuffer(&buffer)) {
+      return;
+    }
+  }
+  ResetBuffers(kBufferCount);
+  valid_ = true;
+}
+
+SurfaceSoftwareDrm::~SurfaceSoftwareDrm() {
+  WaitForPageFlip();
+  for (auto& buffer : buffers_) {
+    DestroyDumbBuffer(&buffer);
+  }
+}
+
+bool SurfaceSoftwareDrm::AcquireBuffer(size_t width, size_t height,
+                                       size_t* index, Buffer* buffer) {
+  if (!valid_) {
+    return false;
+  }
+
+  // The buffers always have the size of the display mode.
+  for (int i = 0; i < static_cast<int>(kBufferCount); i++) {
+    if (i != front_buffer_ && i != pending_buffer_) {
+      *index = i;
+      *buffer = {buffers_[i].pixels, buffers_[i].stride, mode_.hdisplay,
+                 mode_.vdisplay};
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SurfaceSoftwareDrm::CommitBuffer(size_t index,
+                                      const std::vector<DamageRect>& damage) {
+  // Only one page flip can be queued at a time.
+  WaitForPageFlip();
+  if (pending_buffer_ != kNoBuffer) {
+    // The display is not flipping. Drop this frame.
+    damage_lost_ = true;
+    return true;
+  }
+
+  auto fb = buffers_[index].fb_id;
+  if (front_buffer_ == kNoBuffer) {
+    auto result = drmModeSetCrtc(drm_device_, crtc_id_, fb, 0, 0,
+                                 &connector_id_, 1, &mode_);
+    if (result != 0) {
+      LINUXES_LOG(ERROR) << "Failed to set the CRTC mode. (" << result << ")";
+      return false;
+    }
+    front_buffer_ = index;
+    return true;
+  }
+
+  int result = -1;
+  if (damage_plane_.damage_clips_property && !damage_lost_) {
+    result = CommitDamagedPageFlip(fb, damage);
+    if (result != 0) {
+      LINUXES_LOG(WARNING) << "Failed to commit the damage clips, use the "
+                              "legacy page flip API. ("
+                           << result << ")";
+      damage_plane_ = DamagePlane();
+    }
+  }
+  if (result != 0) {
+    result = drmModePageFlip(drm_device_, crtc_id_, fb,
+                             DRM_MODE_PAGE_FLIP_EVENT, this);
+  }
+  if (result != 0) {
+    LINUXES_LOG(ERROR) << "Failed to queue a page flip. (" << result << ")";
+    return false;
+  }
+  pending_buffer_ = index;
+  damage_lost_ = false;
+  page_flip_start_time_nanos_ =
+      FrameTimeline::IsEnabled() ? FrameTimeline::Now() : 0;
+  return true;
+}
+
+bool SurfaceSoftwareDrm::CreateDumbBuffer(DumbBuffer* buffer) {
+  drm_mode_create_dumb create = {};
+  create.width = mode_.hdisplay;
+  create.height = mode_.vdisplay;
+  create.bpp = 32;
+  if (drmIoctl(drm_device_, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0) {
+    LINUXES_LOG(ERROR) << "Failed to create a dumb buffer.";
+    return false;
+  }
+  buffer->handle = create.handle;
+  buffer->stride = create.pitch;
+  buffer->size = create.size;
+
+  auto result =
+      drmModeAddFB(drm_device_, create.width, create.height, 24, 32,
+                   create.pitch, create.handle, &buffer->fb_id);
+  if (result != 0) {
+    LINUXES_LOG(ERROR) << "Failed to add a framebuffer. (" << result << ")";
+    return false;
+  }
+
+  drm_mode_map_dumb map = {};
+  map.handle = create.handle;
+  if (drmIoctl(drm_device_, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0) {
+    LINUXES_LOG(ERROR) << "Failed to map a dumb buffer.";
+    return false;
+  }
+  auto pixels = mmap(nullptr, buffer->size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, drm_device_, map.offset);
+  if (pixels == MAP_FAILED) {
+    LINUXES_LOG(ERROR) << "Failed to mmap a dumb buffer.";
+    return false;
+  }
+  buffer->pixels = static_cast<uint8_t*>(pixels);
+  return true;
+}
+
+void SurfaceSoftwareDrm::DestroyDumbBuffer(DumbBuffer* buffer) {
+  if (buffer->pixels) {
+    munmap(buffer->pixels, buffer->size);
+    buffer->pixels = nullptr;
+  }
+  if (buffer->fb_id) {
+    drmModeRmFB(drm_device_, buffer->fb_id);
+    buffer->fb_id = 0;
+  }
+  if (buffer->handle) {
+    drm_mode_destroy_dumb destroy = {};
+    destroy.handle = buffer->handle;
+    drmIoctl(drm_device_, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    buffer->handle = 0;
+  }
+}
+
+int SurfaceSoftwareDrm::CommitDamagedPageFlip(
+    uint32_t fb, const std::vector<DamageRect>& damage) {
+  damage_clips_.clear();
+  for (const auto& rect : damage) {
+    damage_clips_.push_back({static_cast<int32_t>(rect.x),
+                             static_cast<int32_t>(rect.y),
+                             static_cast<int32_t>(rect.x + rect.width),
+                             static_cast<int32_t>(rect.y + rect.height)});
+  }
+  if (damage_clips_.empty()) {
+    // The page flip is still needed for the vblank event. No clips would mean
+    // that the whole plane has changed, so mark a single pixel instead.
+    damage_clips_.push_back({0, 0, 1, 1});
+  }
+
+  uint32_t blob_id = 0;
+  auto result = drmModeCreatePropertyBlob(
+      drm_device_, damage_clips_.data(),
+      damage_clips_.size() * sizeof(drm_mode_rect), &blob_id);
+  if (result != 0) {
+    return result;
+  }
+
+  auto atomic = drmModeAtomicAlloc();
+  if (!atomic) {
+    drmModeDestroyPropertyBlob(drm_device_, blob_id);
+    return -ENOMEM;
+  }
+  if (drmModeAtomicAddProperty(atomic, damage_plane_.plane_id,
+                               damage_plane_.fb_id_property, fb) < 0 ||
+      drmModeAtomicAddProperty(atomic, damage_plane_.plane_id,
+                               damage_plane_.damage_clips_property,
+                               blob_id) < 0) {
+    result = -EINVAL;
+  } else {
+    result = drmModeAtomicCommit(
+        drm_device_, atomic,
+        DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, this);
+  }
+  drmModeAtomicFree(atomic);
+  // The committed state keeps a reference to the blob.
+  drmModeDestroyPropertyBlob(drm_device_, blob_id);
+  return result;
+}
+
+void SurfaceSoftwareDrm::WaitForPageFlip() {
+  drmEventContext context = {};
+  context.version = 2;
+  context.page_flip_handler = OnPageFlip;
+
+  while (pending_buffer_ != kNoBuffer) {
+    pollfd fds = {drm_device_, POLLIN, 0};
+    auto result = poll(&fds, 1, kPageFlipTimeoutMs);
+    if (result == -1 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      LINUXES_LOG(ERROR) << "Failed to wait for a page flip.";
+      return;
+    }
+    drmHandleEvent(drm_device_, &context);
+  }
+}
+
+void SurfaceSoftwareDrm::OnPageFlip(int fd, unsigned int sequence,
+                                    unsigned int tv_sec, unsigned int tv_usec,
+                                    void* user_data) {
+  auto self = static_cast<SurfaceSoftwareDrm*>(user_data);
+  self->front_buffer_ = self->pending_buffer_;
+  self->pending_buffer_ = kNoBuffer;
+
+  // The time of the vblank on CLOCK_MONOTONIC, which is also the clock of
+  // FrameTimeline::Now(). The event may be handled much later, e.g. when the
+  // next frame waits for it.
+  uint64_t flip_time_nanos = tv_sec * 1000000000ull + tv_usec * 1000ull;
+  if (self->page_flip_start_time_nanos_ != 0) {
+    FrameTimeline::GetInstance().Record(
+        kFlutterDesktopFrameEventPageFlip, self->page_flip_start_time_nanos_,
+        std::max(flip_time_nanos, self->page_flip_start_time_nanos_));
+  }
+
+  if (InputLatencyTracker::IsEnabled()) {
+    InputLatencyTracker::GetInstance().OnFrameScannedOut(flip_time_nanos);
+  }
+
+  if (self->page_flip_callback_) {
+    self->page_flip_callback_(tv_sec, tv_usec);
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,110 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_DRM_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_DRM_H_
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <functional>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.h"
+
+namespace flutter {
+
+// Shows the frames of the software renderer in DRM dumb buffers, which any
+// KMS driver supports without a GPU driver.
+class SurfaceSoftwareDrm : public SurfaceSoftware {
+ public:
+  // Called with the time of a page flip given by the DRM event.
+  using PageFlipCallback =
+      std::function<void(uint64_t tv_sec, uint64_t tv_usec)>;
+
+  // The primary plane of the CRTC and the ids of its properties, which are
+  // needed to pass the damage of a frame to the driver with FB_DAMAGE_CLIPS.
+  // All are 0 if the driver doesn't support it.
+  struct DamagePlane {
+    uint32_t plane_id = 0;
+    uint32_t fb_id_property = 0;
+    uint32_t damage_clips_property = 0;
+  };
+
+  SurfaceSoftwareDrm(int drm_device, uint32_t crtc_id, uint32_t connector_id,
+                     const drmModeModeInfo& mode,
+                     const DamagePlane& damage_plane,
+                     PageFlipCallback page_flip_callback);
+  ~SurfaceSoftwareDrm();
+
+  bool IsValid() const { return valid_; }
+
+ protected:
+  // |SurfaceSoftware|
+  bool AcquireBuffer(size_t width, size_t height, size_t* index,
+                     Buffer* buffer) override;
+
+  // |SurfaceSoftware|
+  bool CommitBuffer(size_t index,
+                    const std::vector<DamageRect>& damage) override;
+
+ private:
+  // A buffer to render the next frame into while one is scanned out and
+  // another one waits for the page flip.
+  static constexpr size_t kBufferCount = 3;
+  static constexpr int kNoBuffer = -1;
+
+  struct DumbBuffer {
+    uint32_t handle = 0;
+    uint32_t fb_id = 0;
+    uint8_t* pixels = nullptr;
+    size_t stride = 0;
+    size_t size = 0;
+  };
+
+  bool CreateDumbBuffer(DumbBuffer* buffer);
+
+  void DestroyDumbBuffer(DumbBuffer* buffer);
+
+  // Queues a page flip to |fb| with an atomic commit which only marks
+  // |damage| as changed. Returns 0 on success or a negative error code.
+  int CommitDamagedPageFlip(uint32_t fb,
+                            const std::vector<DamageRect>& damage);
+
+  // Waits until the queued page flip, if any, has completed.
+  void WaitForPageFlip();
+
+  static void OnPageFlip(int fd, unsigned int sequence, unsigned int tv_sec,
+                         unsigned int tv_usec, void* user_data);
+
+  int drm_device_;
+  uint32_t crtc_id_;
+  uint32_t connector_id_;
+  drmModeModeInfo mode_;
+  DamagePlane damage_plane_;
+  PageFlipCallback page_flip_callback_;
+
+  DumbBuffer buffers_[kBufferCount];
+  bool valid_ = false;
+
+  // The buffer being scanned out.
+  int front_buffer_ = kNoBuffer;
+
+  // The buffer which will be scanned out when the queued page flip completes.
+  int pending_buffer_ = kNoBuffer;
+
+  // When the pending page flip was queued, for the frame timeline.
+  uint64_t page_flip_start_time_nanos_ = 0;
+
+  // Whether a frame has been dropped since the last page flip. The damage of
+  // the next frame doesn't cover the changes of the dropped one then.
+  bool damage_lost_ = false;
+
+  // The damage clips of the current frame, kept to reuse their allocation.
+  std::vector<drm_mode_rect> damage_clips_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_DRM_H_
@@ -0,0 +1,48 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_headless.h"
+
+namespace flutter {
+
+SurfaceSoftwareHeadless::SurfaceSoftwareHeadless(
+    NativeWindowHeadless* native_window)
+    : native_window_(native_window) {
+  buffer_.resize(native_window_->Width() * native_window_->Height() *
+                 kBytesPerPixel);
+  ResetBuffers(1);
+}
+
+bool SurfaceSoftwareHeadless::AcquireBuffer(size_t width, size_t height,
+                                            size_t* index, Buffer* buffer) {
+  // The size of the headless window cannot be changed.
+  size_t window_width = native_window_->Width();
+  *index = 0;
+  *buffer = {buffer_.data(), window_width * kBytesPerPixel, window_width,
+             static_cast<size_t>(native_window_->Height())};
+  return true;
+}
+
+bool SurfaceSoftwareHeadless::CommitBuffer(
+    size_t index, const std::vector<DamageRect>& damage) {
+  size_t width = native_window_->Width();
+  auto stride = width * kBytesPerPixel;
+  for (const auto& rect : damage) {
+    for (auto y = rect.y; y < rect.y + rect.height; y++) {
+      auto offset = y * stride + rect.x * kBytesPerPixel;
+      auto src = &buffer_[offset];
+      auto dst = native_window_->FrameBuffer() + offset;
+      for (size_t x = 0; x < rect.width; x++, src += 4, dst += 4) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = src[3];
+      }
+    }
+  }
+  native_window_->OnFrameRendered();
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,41 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_HEADLESS_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_HEADLESS_H_
+
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.h"
+#include "flutter/shell/platform/linux_embedded/window/native_window_headless.h"
+
+namespace flutter {
+
+// Shows the frames of the software renderer in the frame buffer of a headless
+// window.
+class SurfaceSoftwareHeadless : public SurfaceSoftware {
+ public:
+  explicit SurfaceSoftwareHeadless(NativeWindowHeadless* native_window);
+  ~SurfaceSoftwareHeadless() = default;
+
+ protected:
+  // |SurfaceSoftware|
+  bool AcquireBuffer(size_t width, size_t height, size_t* index,
+                     Buffer* buffer) override;
+
+  // |SurfaceSoftware|
+  bool CommitBuffer(size_t index,
+                    const std::vector<DamageRect>& damage) override;
+
+ private:
+  NativeWindowHeadless* native_window_;
+
+  // The frame in the native format, which is converted to RGBA for the frame
+  // buffer of the window.
+  std::vector<uint8_t> buffer_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_HEADLESS_H_
@@ -0,0 +1,156 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_wayland.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+const wl_buffer_listener SurfaceSoftwareWayland::kWlBufferListener = {
+    .release = [](void* data, wl_buffer* buffer) -> void {
+      auto shm_buffer = reinterpret_cast<ShmBuffer*>(data);
+      shm_buffer->busy = false;
+    },
+};
+
+SurfaceSoftwareWayland::SurfaceSoftwareWayland(wl_display* display,
+                                               wl_shm* shm,
+                                               wl_surface* surface)
+    : wl_display_(display), wl_shm_(shm), wl_surface_(surface) {
+  if (!wl_shm_) {
+    LINUXES_LOG(ERROR) << "wl_shm is not available.";
+    return;
+  }
+  event_queue_ = wl_display_create_queue(wl_display_);
+  if (!event_queue_) {
+    LINUXES_LOG(ERROR) << "Failed to create an event queue.";
+  }
+}
+
+SurfaceSoftwareWayland::~SurfaceSoftwareWayland() {
+  DestroyBuffers();
+  if (event_queue_) {
+    wl_event_queue_destroy(event_queue_);
+  }
+}
+
+bool SurfaceSoftwareWayland::AcquireBuffer(size_t width, size_t height,
+                                           size_t* index, Buffer* buffer) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  if (width != width_ || height != height_) {
+    DestroyBuffers();
+    if (!CreateBuffers(width, height)) {
+      return false;
+    }
+  }
+
+  if (wl_display_dispatch_queue_pending(wl_display_, event_queue_) == -1) {
+    return false;
+  }
+  while (true) {
+    for (size_t i = 0; i < kBufferCount; i++) {
+      if (!buffers_[i].busy) {
+        auto stride = width_ * kBytesPerPixel;
+        *index = i;
+        *buffer = {pool_data_ + i * stride * height_, stride, width_, height_};
+        return true;
+      }
+    }
+    // Wait until the compositor releases one.
+    if (wl_display_dispatch_queue(wl_display_, event_queue_) == -1) {
+      LINUXES_LOG(ERROR) << "Failed to wait for a buffer release.";
+      return false;
+    }
+  }
+}
+
+bool SurfaceSoftwareWayland::CommitBuffer(
+    size_t index, const std::vector<DamageRect>& damage) {
+  wl_surface_attach(wl_surface_, buffers_[index].buffer, 0, 0);
+  // The damage is in buffer coordinates, which older compositors only accept
+  // in surface coordinates. They are the same because the buffer is neither
+  // scaled nor transformed.
+  auto damage_buffer =
+      wl_proxy_get_version(reinterpret_cast<wl_proxy*>(wl_surface_)) >=
+      WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION;
+  for (const auto& rect : damage) {
+    if (damage_buffer) {
+      wl_surface_damage_buffer(wl_surface_, rect.x, rect.y, rect.width,
+                               rect.height);
+    } else {
+      wl_surface_damage(wl_surface_, rect.x, rect.y, rect.width, rect.height);
+    }
+  }
+  buffers_[index].busy = true;
+  wl_surface_commit(wl_surface_);
+  return wl_display_flush(wl_display_) != -1 || errno == EAGAIN;
+}
+
+bool SurfaceSoftwareWayland::CreateBuffers(size_t width, size_t height) {
+  auto stride = width * kBytesPerPixel;
+  auto size = stride * height * kBufferCount;
+  auto fd = memfd_create("flutter-shm", MFD_CLOEXEC);
+  if (fd == -1) {
+    LINUXES_LOG(ERROR) << "Failed to create a shared memory.";
+    return false;
+  }
+  if (ftruncate(fd, size) == -1) {
+    LINUXES_LOG(ERROR) << "Failed to allocate a shared memory: " << size;
+    close(fd);
+    return false;
+  }
+  auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    LINUXES_LOG(ERROR) << "Failed to mmap a shared memory.";
+    close(fd);
+    return false;
+  }
+
+  auto pool = wl_shm_create_pool(wl_shm_, fd, size);
+  for (size_t i = 0; i < kBufferCount; i++) {
+    auto& buffer = buffers_[i];
+    buffer.busy = false;
+    buffer.buffer =
+        wl_shm_pool_create_buffer(pool, i * stride * height, width, height,
+                                  stride, WL_SHM_FORMAT_ARGB8888);
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(buffer.buffer),
+                       event_queue_);
+    wl_buffer_add_listener(buffer.buffer, &kWlBufferListener, &buffer);
+  }
+  // The buffers keep the pool alive.
+  wl_shm_pool_destroy(pool);
+  close(fd);
+
+  pool_data_ = static_cast<uint8_t*>(data);
+  pool_size_ = size;
+  width_ = width;
+  height_ = height;
+  ResetBuffers(kBufferCount);
+  return true;
+}
+
+void SurfaceSoftwareWayland::DestroyBuffers() {
+  for (auto& buffer : buffers_) {
+    if (buffer.buffer) {
+      wl_buffer_destroy(buffer.buffer);
+      buffer.buffer = nullptr;
+    }
+  }
+  if (pool_data_) {
+    munmap(pool_data_, pool_size_);
+    pool_data_ = nullptr;
+  }
+  width_ = 0;
+  height_ = 0;
+}
+
+}  // namespace flutter
@@ -0,0 +1,66 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_WAYLAND_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_WAYLAND_H_
+
+#include <wayland-client.h>
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.h"
+
+namespace flutter {
+
+// Shows the frames of the software renderer in wl_shm buffers.
+//
+// Frames are presented on the raster thread, so the buffers have their own
+// event queue and their releases are dispatched there.
+class SurfaceSoftwareWayland : public SurfaceSoftware {
+ public:
+  SurfaceSoftwareWayland(wl_display* display, wl_shm* shm,
+                         wl_surface* surface);
+  ~SurfaceSoftwareWayland();
+
+  bool IsValid() const { return event_queue_ != nullptr; }
+
+ protected:
+  // |SurfaceSoftware|
+  bool AcquireBuffer(size_t width, size_t height, size_t* index,
+                     Buffer* buffer) override;
+
+  // |SurfaceSoftware|
+  bool CommitBuffer(size_t index,
+                    const std::vector<DamageRect>& damage) override;
+
+ private:
+  // The compositor may hold one buffer while showing another one.
+  static constexpr size_t kBufferCount = 3;
+
+  struct ShmBuffer {
+    wl_buffer* buffer = nullptr;
+    // Whether the compositor is using the buffer.
+    bool busy = false;
+  };
+
+  // Allocates the buffers of |width|x|height| in a new shared memory pool.
+  bool CreateBuffers(size_t width, size_t height);
+
+  void DestroyBuffers();
+
+  static const wl_buffer_listener kWlBufferListener;
+
+  wl_display* wl_display_;
+  wl_shm* wl_shm_;
+  wl_surface* wl_surface_;
+  wl_event_queue* event_queue_ = nullptr;
+
+  ShmBuffer buffers_[kBufferCount];
+  uint8_t* pool_data_ = nullptr;
+  size_t pool_size_ = 0;
+  size_t width_ = 0;
+  size_t height_ = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_WAYLAND_H_
@@ -0,0 +1,132 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_x11.h"
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+SurfaceSoftwareX11::SurfaceSoftwareX11(Window window) : window_(window) {
+  display_ = XOpenDisplay(nullptr);
+  if (!display_) {
+    LINUXES_LOG(ERROR) << "Failed to open display.";
+    return;
+  }
+  if (!XShmQueryExtension(display_)) {
+    LINUXES_LOG(ERROR) << "MIT-SHM extension is not available.";
+    XCloseDisplay(display_);
+    display_ = nullptr;
+    return;
+  }
+  gc_ = XCreateGC(display_, window_, 0, nullptr);
+}
+
+SurfaceSoftwareX11::~SurfaceSoftwareX11() {
+  if (!display_) {
+    return;
+  }
+  DestroyImage();
+  XFreeGC(display_, gc_);
+  XCloseDisplay(display_);
+}
+
+bool SurfaceSoftwareX11::AcquireBuffer(size_t width, size_t height,
+                                       size_t* index, Buffer* buffer) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  if (!image_ || image_->width != static_cast<int>(width) ||
+      image_->height != static_cast<int>(height)) {
+    DestroyImage();
+    if (!CreateImage(width, height)) {
+      return false;
+    }
+  }
+
+  // There is only one image, which the X server has finished reading.
+  *index = 0;
+  *buffer = {reinterpret_cast<uint8_t*>(image_->data),
+             static_cast<size_t>(image_->bytes_per_line), width, height};
+  return true;
+}
+
+bool SurfaceSoftwareX11::CommitBuffer(size_t index,
+                                      const std::vector<DamageRect>& damage) {
+  if (damage.empty()) {
+    return true;
+  }
+  for (const auto& rect : damage) {
+    XShmPutImage(display_, window_, gc_, image_, rect.x, rect.y, rect.x,
+                 rect.y, rect.width, rect.height, False);
+  }
+  // Wait until the X server has read the image, so that the next frame can
+  // be written into it.
+  XSync(display_, False);
+  return true;
+}
+
+bool SurfaceSoftwareX11::CreateImage(size_t width, size_t height) {
+  XWindowAttributes attributes;
+  if (!XGetWindowAttributes(display_, window_, &attributes)) {
+    LINUXES_LOG(ERROR) << "Failed to get the window attributes.";
+    return false;
+  }
+
+  image_ = XShmCreateImage(display_, attributes.visual, attributes.depth,
+                           ZPixmap, nullptr, &shm_info_, width, height);
+  if (!image_) {
+    LINUXES_LOG(ERROR) << "Failed to create a shared memory image.";
+    return false;
+  }
+  if (image_->bits_per_pixel != 32) {
+    LINUXES_LOG(ERROR) << "Not supported visual: " << image_->bits_per_pixel
+                       << " bits per pixel";
+    XDestroyImage(image_);
+    image_ = nullptr;
+    return false;
+  }
+
+  shm_info_.shmid = shmget(IPC_PRIVATE, image_->bytes_per_line * height,
+                           IPC_CREAT | 0600);
+  if (shm_info_.shmid == -1) {
+    LINUXES_LOG(ERROR) << "Failed to create a shared memory.";
+    XDestroyImage(image_);
+    image_ = nullptr;
+    return false;
+  }
+  auto data = shmat(shm_info_.shmid, nullptr, 0);
+  // Removed when both processes have detached it, even if this crashes.
+  shmctl(shm_info_.shmid, IPC_RMID, nullptr);
+  if (data == reinterpret_cast<void*>(-1)) {
+    LINUXES_LOG(ERROR) << "Failed to attach a shared memory.";
+    XDestroyImage(image_);
+    image_ = nullptr;
+    return false;
+  }
+  shm_info_.shmaddr = image_->data = static_cast<char*>(data);
+  shm_info_.readOnly = False;
+  XShmAttach(display_, &shm_info_);
+  XSync(display_, False);
+
+  ResetBuffers(1);
+  return true;
+}
+
+void SurfaceSoftwareX11::DestroyImage() {
+  if (!image_) {
+    return;
+  }
+  XShmDetach(display_, &shm_info_);
+  XDestroyImage(image_);
+  image_ = nullptr;
+  shmdt(shm_info_.shmaddr);
+  shm_info_ = {};
+}
+
+}  // namespace flutter
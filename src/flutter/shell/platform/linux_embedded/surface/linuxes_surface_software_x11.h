@@ -0,0 +1,51 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_X11_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_X11_H_
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.h"
+
+namespace flutter {
+
+// Shows the frames of the software renderer in a window with MIT-SHM images.
+//
+// Frames are presented on the raster thread, so this uses its own connection
+// to the X server instead of sharing the one of the platform thread.
+class SurfaceSoftwareX11 : public SurfaceSoftware {
+ public:
+  explicit SurfaceSoftwareX11(Window window);
+  ~SurfaceSoftwareX11();
+
+  bool IsValid() const { return display_ != nullptr; }
+
+ protected:
+  // |SurfaceSoftware|
+  bool AcquireBuffer(size_t width, size_t height, size_t* index,
+                     Buffer* buffer) override;
+
+  // |SurfaceSoftware|
+  bool CommitBuffer(size_t index,
+                    const std::vector<DamageRect>& damage) override;
+
+ private:
+  // Creates the image of |width|x|height| in a new shared memory segment.
+  bool CreateImage(size_t width, size_t height);
+
+  void DestroyImage();
+
+  Display* display_ = nullptr;
+  Window window_;
+  GC gc_ = nullptr;
+  XShmSegmentInfo shm_info_ = {};
+  XImage* image_ = nullptr;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_SURFACE_LINUXES_SURFACE_SOFTWARE_X11_H_
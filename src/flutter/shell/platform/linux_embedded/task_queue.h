@@ -0,0 +1,246 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TASK_QUEUE_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TASK_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+namespace flutter {
+
+// A multi-producer single-consumer queue of delayed tasks.
+//
+// Producers push tasks onto a lock-free inbox (an intrusive stack). The
+// consumer moves them into a pairing heap ordered by fire time, which only the
+// consumer thread touches, so neither side takes a lock. Nodes are recycled
+// through a lock-free free list with per-thread caches, so that a steady flow
+// of tasks does not allocate.
+template <typename T>
+class DelayedTaskQueue {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  DelayedTaskQueue() = default;
+
+  ~DelayedTaskQueue() {
+    DrainInbox();
+    while (heap_) {
+      auto top = heap_;
+      heap_ = MergePairs(top->child);
+      ReleaseNode(top);
+    }
+  }
+
+  // Prevent copying.
+  DelayedTaskQueue(DelayedTaskQueue const&) = delete;
+  DelayedTaskQueue& operator=(DelayedTaskQueue const&) = delete;
+
+  // Pushes |value| to fire at |fire_time|. Tasks which have the same fire time
+  // are ordered by |order|. This can be called from any thread.
+  //
+  // Returns true if the task is due earlier than the time published by the
+  // last call of PublishNextFireTime(), i.e. the consumer needs to be woken
+  // up.
+  bool Push(TimePoint fire_time, uint64_t order, T value) {
+    auto node = AllocateNode();
+    node->fire_time = fire_time;
+    node->order = order;
+    node->value = std::move(value);
+    node->child = nullptr;
+    node->sibling = nullptr;
+
+    auto head = inbox_.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!inbox_.compare_exchange_weak(head, node));
+
+    return fire_time.time_since_epoch().count() < sleep_deadline_.load();
+  }
+
+  // Pops the earliest task into |value| if its fire time is not later than
+  // |now|. Returns false if there is no such task. Consumer thread only.
+  bool Pop(TimePoint now, T* value) {
+    DrainInbox();
+    if (!heap_ || heap_->fire_time > now) {
+      return false;
+    }
+
+    auto top = heap_;
+    heap_ = MergePairs(top->child);
+    *value = std::move(top->value);
+    ReleaseNode(top);
+    return true;
+  }
+
+  // Returns the fire time of the earliest task, or TimePoint::max() if there
+  // is none, and publishes it as the time the consumer will sleep until.
+  // Consumer thread only.
+  TimePoint PublishNextFireTime() {
+    DrainInbox();
+    auto next_fire_time = heap_ ? heap_->fire_time : TimePoint::max();
+    sleep_deadline_.store(next_fire_time.time_since_epoch().count());
+    return next_fire_time;
+  }
+
+ private:
+  struct Node {
+    TimePoint fire_time;
+    uint64_t order;
+    T value;
+
+    // Link in the inbox or in the free list.
+    Node* next;
+
+    // Links in the pairing heap.
+    Node* child;
+    Node* sibling;
+  };
+
+  // Per-thread cache of free nodes. Nodes left in it are returned to the
+  // shared free list when the thread exits.
+  struct NodeCache {
+    ~NodeCache() {
+      while (head) {
+        auto node = head;
+        head = node->next;
+        ReleaseNode(node);
+      }
+    }
+
+    Node* head = nullptr;
+  };
+
+  static bool Less(const Node* a, const Node* b) {
+    if (a->fire_time == b->fire_time) {
+      return a->order < b->order;
+    }
+    return a->fire_time < b->fire_time;
+  }
+
+  static Node* Meld(Node* a, Node* b) {
+    if (!a) {
+      return b;
+    }
+    if (!b) {
+      return a;
+    }
+    if (Less(b, a)) {
+      std::swap(a, b);
+    }
+    b->sibling = a->child;
+    a->child = b;
+    return a;
+  }
+
+  // Melds the list of subheaps starting at |first| with the standard two-pass
+  // pairing. Iterative so that a long list does not overflow the stack.
+  static Node* MergePairs(Node* first) {
+    // Meld pairs from left to right, collecting the results in reverse order.
+    Node* pairs = nullptr;
+    while (first) {
+      auto a = first;
+      auto b = a->sibling;
+      if (!b) {
+        a->sibling = pairs;
+        pairs = a;
+        break;
+      }
+      first = b->sibling;
+      a->sibling = nullptr;
+      b->sibling = nullptr;
+      auto melded = Meld(a, b);
+      melded->sibling = pairs;
+      pairs = melded;
+    }
+
+    // Meld the results from right to left.
+    Node* root = nullptr;
+    while (pairs) {
+      auto next = pairs->sibling;
+      pairs->sibling = nullptr;
+      root = Meld(pairs, root);
+      pairs = next;
+    }
+    return root;
+  }
+
+  // Moves all tasks posted by producers into the heap.
+  void DrainInbox() {
+    // From here until the next PublishNextFireTime(), producers have to wake
+    // the consumer up for any task because it is not sleeping until a known
+    // deadline.
+    if (sleep_deadline_.load(std::memory_order_relaxed) != kNoDeadline) {
+      sleep_deadline_.store(kNoDeadline);
+    }
+
+    if (!inbox_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto node = inbox_.exchange(nullptr);
+    while (node) {
+      auto next = node->next;
+      heap_ = Meld(heap_, node);
+      node = next;
+    }
+  }
+
+  static Node* AllocateNode() {
+    auto& cache = LocalNodeCache();
+    if (!cache.head) {
+      // Taking the whole list at once avoids the ABA problem of popping a
+      // single node from a lock-free stack.
+      cache.head = FreeNodes().exchange(nullptr, std::memory_order_acquire);
+    }
+    if (cache.head) {
+      auto node = cache.head;
+      cache.head = node->next;
+      return node;
+    }
+    return new Node();
+  }
+
+  static void ReleaseNode(Node* node) {
+    // Destroy the task (e.g. closure captures) now rather than on reuse.
+    node->value = T();
+
+    auto& free_nodes = FreeNodes();
+    auto head = free_nodes.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!free_nodes.compare_exchange_weak(
+        head, node, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  static NodeCache& LocalNodeCache() {
+    thread_local NodeCache cache;
+    return cache;
+  }
+
+  static std::atomic<Node*>& FreeNodes() {
+    // Never destroyed so that it outlives the thread-local caches which are
+    // flushed into it at exit.
+    static auto free_nodes = new std::atomic<Node*>(nullptr);
+    return *free_nodes;
+  }
+
+  static constexpr TimePoint::rep kNoDeadline =
+      TimePoint::max().time_since_epoch().count();
+
+  // Tasks posted by producers, which the consumer has not seen yet.
+  std::atomic<Node*> inbox_{nullptr};
+
+  // The time until which the consumer sleeps, in the representation of
+  // TimePoint.
+  std::atomic<TimePoint::rep> sleep_deadline_{kNoDeadline};
+
+  // The pairing heap owned by the consumer.
+  Node* heap_ = nullptr;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TASK_QUEUE_H_
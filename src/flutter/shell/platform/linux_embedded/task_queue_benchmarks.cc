@@ -0,0 +1,145 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/task_queue.h"
+
+namespace flutter {
+
+namespace {
+
+using TimePoint = std::chrono::steady_clock::time_point;
+using Closure = std::function<void()>;
+
+constexpr int kTasksPerIteration = 10000;
+
+// The queue which TaskRunner used before DelayedTaskQueue: a priority queue
+// guarded by a mutex, from which the consumer copies the expired tasks out
+// before running them.
+class LockedTaskQueue {
+ public:
+  bool Push(TimePoint fire_time, uint64_t order, Closure value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push({fire_time, order, std::move(value)});
+    return queue_.top().order == order;
+  }
+
+  bool Pop(TimePoint now, std::vector<Closure>* values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!queue_.empty() && queue_.top().fire_time <= now) {
+      values->push_back(queue_.top().value);
+      queue_.pop();
+    }
+    return !values->empty();
+  }
+
+ private:
+  struct Task {
+    TimePoint fire_time;
+    uint64_t order;
+    Closure value;
+
+    struct Comparer {
+      bool operator()(const Task& a, const Task& b) {
+        if (a.fire_time == b.fire_time) {
+          return a.order > b.order;
+        }
+        return a.fire_time > b.fire_time;
+      }
+    };
+  };
+
+  std::mutex mutex_;
+  std::priority_queue<Task, std::vector<Task>, Task::Comparer> queue_;
+};
+
+// Pushes |kTasksPerIteration| tasks split across |producer_count| threads
+// while the calling thread consumes them, and returns once all of them ran.
+template <typename Queue, typename ConsumeFunction>
+void PushAndConsume(Queue* queue,
+                    int producer_count,
+                    ConsumeFunction consume) {
+  static std::atomic_uint64_t order(0);
+  std::atomic<int> run_count{0};
+  std::vector<std::thread> producers;
+  for (int i = 0; i < producer_count; i++) {
+    producers.emplace_back([queue, producer_count, &run_count]() {
+      for (int j = 0; j < kTasksPerIteration / producer_count; j++) {
+        queue->Push(std::chrono::steady_clock::now(), ++order,
+                    [&run_count]() { run_count++; });
+      }
+    });
+  }
+
+  auto expected = kTasksPerIteration / producer_count * producer_count;
+  while (run_count.load() < expected) {
+    if (!consume(queue, std::chrono::steady_clock::now())) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+}
+
+void BM_DelayedTaskQueue(benchmark::State& state) {
+  DelayedTaskQueue<Closure> queue;
+  auto consume = [](DelayedTaskQueue<Closure>* queue, TimePoint now) {
+    Closure task;
+    auto consumed = false;
+    while (queue->Pop(now, &task)) {
+      task();
+      consumed = true;
+    }
+    queue->PublishNextFireTime();
+    return consumed;
+  };
+  for (auto _ : state) {
+    PushAndConsume(&queue, state.range(0), consume);
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+BENCHMARK(BM_DelayedTaskQueue)
+    ->ArgName("producers")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+void BM_LockedTaskQueue(benchmark::State& state) {
+  LockedTaskQueue queue;
+  auto consume = [](LockedTaskQueue* queue, TimePoint now) {
+    std::vector<Closure> tasks;
+    if (!queue->Pop(now, &tasks)) {
+      return false;
+    }
+    for (const auto& task : tasks) {
+      task();
+    }
+    return true;
+  };
+  for (auto _ : state) {
+    PushAndConsume(&queue, state.range(0), consume);
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+BENCHMARK(BM_LockedTaskQueue)
+    ->ArgName("producers")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace flutter
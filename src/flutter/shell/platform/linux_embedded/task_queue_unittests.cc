@@ -0,0 +1,83 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/task_queue.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+using TimePoint = DelayedTaskQueue<int>::TimePoint;
+}  // namespace
+
+TEST(DelayedTaskQueueTest, PopsInFireTimeAndOrder) {
+  DelayedTaskQueue<int> queue;
+  TimePoint base;
+  queue.Push(base + std::chrono::milliseconds(2), 1, 3);
+  queue.Push(base + std::chrono::milliseconds(1), 3, 2);
+  queue.Push(base + std::chrono::milliseconds(1), 2, 1);
+  queue.Push(base + std::chrono::milliseconds(5), 4, 4);
+
+  std::vector<int> values;
+  int value;
+  while (queue.Pop(base + std::chrono::milliseconds(2), &value)) {
+    values.push_back(value);
+  }
+  EXPECT_EQ(values, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(queue.PublishNextFireTime(), base + std::chrono::milliseconds(5));
+}
+
+TEST(DelayedTaskQueueTest, PushReportsEarlierThanPublishedDeadline) {
+  DelayedTaskQueue<int> queue;
+  TimePoint base;
+  queue.Push(base + std::chrono::milliseconds(10), 1, 1);
+  EXPECT_EQ(queue.PublishNextFireTime(), base + std::chrono::milliseconds(10));
+
+  EXPECT_FALSE(queue.Push(base + std::chrono::milliseconds(20), 2, 2));
+  EXPECT_TRUE(queue.Push(base + std::chrono::milliseconds(5), 3, 3));
+  EXPECT_EQ(queue.PublishNextFireTime(), base + std::chrono::milliseconds(5));
+}
+
+TEST(DelayedTaskQueueTest, ConsumesTasksFromManyProducers) {
+  constexpr int kProducerCount = 8;
+  constexpr int kTasksPerProducer = 1000;
+  DelayedTaskQueue<int> queue;
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kProducerCount; i++) {
+    producers.emplace_back([&queue, i]() {
+      for (int j = 0; j < kTasksPerProducer; j++) {
+        auto id = i * kTasksPerProducer + j;
+        queue.Push(TimePoint(), id, id);
+      }
+    });
+  }
+
+  // Tasks of each producer keep their order.
+  std::vector<int> last(kProducerCount, -1);
+  int count = 0;
+  while (count < kProducerCount * kTasksPerProducer) {
+    int value;
+    if (!queue.Pop(TimePoint(), &value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto producer = value / kTasksPerProducer;
+    EXPECT_LT(last[producer], value % kTasksPerProducer);
+    last[producer] = value % kTasksPerProducer;
+    count++;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(queue.PublishNextFireTime(), TimePoint::max());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -4,10 +4,17 @@
 
 #include "flutter/shell/platform/linux_embedded/task_runner.h"
 
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include <atomic>
 #include <utility>
 #include <iostream>
 
+#include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/trace_event.h"
+
 namespace flutter {
 
 TaskRunner::TaskRunner(std::thread::id main_thread_id,
@@ -15,7 +22,18 @@ TaskRunner::TaskRunner(std::thread::id main_thread_id,
                        const TaskExpiredCallback& on_task_expired)
     : main_thread_id_(main_thread_id),
       get_current_time_(get_current_time),
-      on_task_expired_(std::move(on_task_expired)) {}
+      on_task_expired_(std::move(on_task_expired)) {
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ == -1) {
+    LINUXES_LOG(ERROR) << "Failed to create eventfd: " << strerror(errno);
+  }
+}
+
+TaskRunner::~TaskRunner() {
+  if (event_fd_ != -1) {
+    close(event_fd_);
+  }
+}
 
 bool TaskRunner::RunsTasksOnCurrentThread() const {
   return std::this_thread::get_id() == main_thread_id_;
@@ -23,75 +41,77 @@ bool TaskRunner::RunsTasksOnCurrentThread() const {
 
 void TaskRunner::PostFlutterTask(FlutterTask flutter_task,
                                       uint64_t flutter_target_time_nanos) {
-  Task task;
-  task.fire_time = TimePointFromFlutterTime(flutter_target_time_nanos);
-  task.variant = flutter_task;
-  EnqueueTask(std::move(task));
+  EnqueueTask(TimePointFromFlutterTime(flutter_target_time_nanos),
+              flutter_task);
 }
 
 void TaskRunner::PostTask(TaskClosure closure) {
-  Task task;
-  task.fire_time = TaskTimePoint::clock::now();
-  task.variant = std::move(closure);
-  EnqueueTask(std::move(task));
+  EnqueueTask(TaskTimePoint::clock::now(), std::move(closure));
 }
 
-void TaskRunner::EnqueueTask(Task task) {
+void TaskRunner::PostDelayedTask(TaskClosure closure,
+                                 std::chrono::nanoseconds delay) {
+  EnqueueTask(TaskTimePoint::clock::now() + delay, std::move(closure));
+}
+
+void TaskRunner::EnqueueTask(TaskTimePoint fire_time, TaskVariant task) {
   static std::atomic_uint64_t sGlobalTaskOrder(0);
 
-  task.order = ++sGlobalTaskOrder;
+  auto is_earlier_than_deadline =
+      task_queue_.Push(fire_time, ++sGlobalTaskOrder, std::move(task));
+
+  // The main thread may be sleeping until a later deadline, so wake it up.
+  // Tasks posted from the main thread itself are picked up by the next call of
+  // ProcessTasks(), and a wakeup which is already pending covers this task
+  // too.
+  if (is_earlier_than_deadline && !RunsTasksOnCurrentThread() &&
+      !wakeup_pending_.exchange(true)) {
+    WakeUp();
+  }
+}
 
-  std::lock_guard<std::mutex> lock(task_queue_mutex_);
-  task_queue_.push(task);
+void TaskRunner::WakeUp() {
+  if (event_fd_ == -1) {
+    return;
+  }
+  uint64_t value = 1;
+  if (write(event_fd_, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+    LINUXES_LOG(ERROR) << "Failed to write eventfd: " << strerror(errno);
+  }
 }
 
 std::chrono::nanoseconds TaskRunner::ProcessTasks() {
-  const TaskTimePoint now = TaskTimePoint::clock::now();
-
-  std::vector<Task> expired_tasks;
-
-  // Process expired tasks.
-  {
-    std::lock_guard<std::mutex> lock(task_queue_mutex_);
-    while (!task_queue_.empty()) {
-      const auto& top = task_queue_.top();
-      // If this task (and all tasks after this) has not yet expired, there is
-      // nothing more to do. Quit iterating.
-      if (top.fire_time > now) {
-        break;
-      }
-
-      // Make a record of the expired task. Do NOT service the task here
-      // because we are still holding onto the task queue mutex. We don't want
-      // other threads to block on posting tasks onto this thread till we are
-      // done processing expired tasks.
-      expired_tasks.push_back(task_queue_.top());
-
-      // Remove the tasks from the delayed tasks queue.
-      task_queue_.pop();
-    }
+  LINUXES_TRACE_EVENT("TaskRunner::ProcessTasks");
+
+  // Clear pending wakeups. This must be done before checking the queue so
+  // that a task posted after this point signals the eventfd again.
+  wakeup_pending_ = false;
+  if (event_fd_ != -1) {
+    uint64_t value;
+    read(event_fd_, &value, sizeof(value));
   }
 
-  // Fire expired tasks.
-  {
-    // Flushing tasks here without holing onto the task queue mutex.
-    for (const auto& task : expired_tasks) {
-      if (auto flutter_task = std::get_if<FlutterTask>(&task.variant)) {
-        on_task_expired_(flutter_task);
-      } else if (auto closure = std::get_if<TaskClosure>(&task.variant))
-        (*closure)();
+  const TaskTimePoint now = TaskTimePoint::clock::now();
+
+  // Fire expired tasks. Only this thread touches the heap of the queue, so
+  // tasks are run without holding onto any lock and without being copied.
+  TaskVariant task;
+  while (task_queue_.Pop(now, &task)) {
+    if (auto flutter_task = std::get_if<FlutterTask>(&task)) {
+      LINUXES_TRACE_EVENT("TaskRunner::RunFlutterTask");
+      on_task_expired_(flutter_task);
+    } else if (auto closure = std::get_if<TaskClosure>(&task)) {
+      LINUXES_TRACE_EVENT("TaskRunner::RunClosure");
+      (*closure)();
     }
   }
 
   // Calculate duration to sleep for on next iteration.
-  {
-    std::lock_guard<std::mutex> lock(task_queue_mutex_);
-    if (task_queue_.empty()) {
-      return TaskTimePoint::max().time_since_epoch();
-    }
-    const auto next_wake = task_queue_.top().fire_time;
-    return std::min(next_wake - now, std::chrono::nanoseconds::max());
+  const auto next_wake = task_queue_.PublishNextFireTime();
+  if (next_wake == TaskTimePoint::max()) {
+    return TaskTimePoint::max().time_since_epoch();
   }
+  return std::min(next_wake - now, std::chrono::nanoseconds::max());
 }
 
 TaskRunner::TaskTimePoint TaskRunner::TimePointFromFlutterTime(
@@ -5,15 +5,15 @@
 #ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TASK_RUNNER_H_
 #define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TASK_RUNNER_H_
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
-#include <mutex>
-#include <queue>
 #include <thread>
 #include <variant>
 
 #include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/task_queue.h"
 
 namespace flutter {
 
@@ -28,7 +28,7 @@ class TaskRunner {
 
   TaskRunner(std::thread::id main_thread_id, CurrentTimeProc get_current_time,
              const TaskExpiredCallback& on_task_expired);
-  ~TaskRunner() = default;
+  ~TaskRunner();
 
   // Returns if the current thread is the UI thread.
   bool RunsTasksOnCurrentThread() const;
@@ -40,6 +40,9 @@ class TaskRunner {
   // Post a task to the event loop
   void PostTask(TaskClosure closure);
 
+  // Post a task to the event loop to run after |delay|.
+  void PostDelayedTask(TaskClosure closure, std::chrono::nanoseconds delay);
+
   // Post a task to the event loop or run it immediately if this is being called
   // from the main thread.
   void RunNowOrPostTask(TaskClosure task) {
@@ -53,26 +56,19 @@ class TaskRunner {
   // Process a Flutter engine tasks.
   std::chrono::nanoseconds ProcessTasks();
 
+  // Returns an eventfd which becomes readable when a task posted from another
+  // thread changes the earliest deadline of the queue, so that the main thread
+  // can wake up and call ProcessTasks() again. Returns -1 if not available.
+  int GetEventFd() const { return event_fd_; }
+
  private:
   typedef std::variant<FlutterTask, TaskClosure> TaskVariant;
 
-  struct Task {
-    uint64_t order;
-    TaskTimePoint fire_time;
-    TaskVariant variant;
-
-    struct Comparer {
-      bool operator()(const Task& a, const Task& b) {
-        if (a.fire_time == b.fire_time) {
-          return a.order > b.order;
-        }
-        return a.fire_time > b.fire_time;
-      }
-    };
-  };
-
   // Enqueues the given task.
-  void EnqueueTask(Task task);
+  void EnqueueTask(TaskTimePoint fire_time, TaskVariant task);
+
+  // Wakes up the main thread waiting on the eventfd.
+  void WakeUp();
 
   // Returns a TaskTimePoint computed from the given target time from Flutter.
   TaskTimePoint TimePointFromFlutterTime(
@@ -81,8 +77,9 @@ class TaskRunner {
   std::thread::id main_thread_id_;
   CurrentTimeProc get_current_time_;
   TaskExpiredCallback on_task_expired_;
-  std::mutex task_queue_mutex_;
-  std::priority_queue<Task, std::deque<Task>, Task::Comparer> task_queue_;
+  DelayedTaskQueue<TaskVariant> task_queue_;
+  std::atomic_bool wakeup_pending_{false};
+  int event_fd_ = -1;
 };
 
 }  // namespace flutter
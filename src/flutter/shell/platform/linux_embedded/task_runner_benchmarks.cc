@@ -0,0 +1,99 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "flutter/shell/platform/linux_embedded/event_loop.h"
+#include "flutter/shell/platform/linux_embedded/task_runner.h"
+
+namespace flutter {
+
+namespace {
+
+// How long the platform thread sleeps at most when it cannot be woken up,
+// as the examples did before the event loop.
+constexpr std::chrono::milliseconds kPollingInterval(13);
+
+uint64_t GetCurrentTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Runs the loop of the platform thread, which processes the tasks of
+// |task_runner| and waits for the next one like FlutterDesktopRunLoop().
+// The loop is woken up by the eventfd of the task runner if
+// |wakeup_enabled|, and polls otherwise.
+void RunPlatformLoop(bool wakeup_enabled,
+                     std::atomic<TaskRunner*>* task_runner_out,
+                     const std::atomic<bool>* stopped) {
+  TaskRunner task_runner(std::this_thread::get_id(), GetCurrentTime,
+                         [](const FlutterTask*) {});
+  EventLoop event_loop;
+  if (wakeup_enabled) {
+    event_loop.AddFd(task_runner.GetEventFd());
+  }
+  task_runner_out->store(&task_runner);
+
+  while (!stopped->load()) {
+    auto timeout = task_runner.ProcessTasks();
+    if (!wakeup_enabled) {
+      timeout = std::min<std::chrono::nanoseconds>(timeout, kPollingInterval);
+    }
+    event_loop.Wait(timeout);
+  }
+  // Let the last posted task run before |task_runner| is destroyed.
+  task_runner.ProcessTasks();
+}
+
+// Measures the time from posting a task from another thread to running it on
+// the platform thread while it sleeps.
+void BM_PostToRun(benchmark::State& state) {
+  auto wakeup_enabled = state.range(0) != 0;
+  std::atomic<TaskRunner*> task_runner{nullptr};
+  std::atomic<bool> stopped{false};
+  std::thread platform_thread(RunPlatformLoop, wakeup_enabled, &task_runner,
+                              &stopped);
+  while (!task_runner.load()) {
+    std::this_thread::yield();
+  }
+
+  for (auto _ : state) {
+    // Let the platform thread go to sleep.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::atomic<int64_t> run_time{0};
+    auto post_time = std::chrono::steady_clock::now();
+    task_runner.load()->PostTask([&run_time]() {
+      run_time = std::chrono::steady_clock::now().time_since_epoch().count();
+    });
+    while (!run_time.load()) {
+      std::this_thread::yield();
+    }
+    auto latency = std::chrono::steady_clock::time_point(
+                       std::chrono::steady_clock::duration(run_time.load())) -
+                   post_time;
+    state.SetIterationTime(
+        std::chrono::duration<double>(latency).count());
+  }
+
+  stopped = true;
+  task_runner.load()->PostTask([]() {});
+  platform_thread.join();
+}
+BENCHMARK(BM_PostToRun)
+    ->ArgName("wakeup")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace flutter
@@ -0,0 +1,52 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/testing/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// The number of allocations made by each thread so far.
+thread_local size_t allocation_count = 0;
+
+void* CountedAllocate(size_t size) {
+  allocation_count++;
+  auto* memory = std::malloc(size == 0 ? 1 : size);
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+}  // namespace
+
+// The nothrow and sized variants of the standard library forward to these.
+void* operator new(size_t size) { return CountedAllocate(size); }
+
+void* operator new[](size_t size) { return CountedAllocate(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete[](void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, size_t size) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, size_t size) noexcept {
+  std::free(memory);
+}
+
+namespace flutter {
+namespace testing {
+
+ScopedAllocationCounter::ScopedAllocationCounter()
+    : start_count_(allocation_count) {}
+
+size_t ScopedAllocationCounter::count() const {
+  return allocation_count - start_count_;
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,40 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_ALLOCATION_COUNTER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_ALLOCATION_COUNTER_H_
+
+#include <cstddef>
+
+namespace flutter {
+namespace testing {
+
+// Counts the allocations with operator new on the calling thread while it
+// exists. The tests and benchmarks are linked with a replacement of the
+// global operator new, which keeps the count.
+//
+// Example:
+//   ScopedAllocationCounter counter;
+//   HandleMessage();
+//   EXPECT_EQ(counter.count(), 0u);
+class ScopedAllocationCounter {
+ public:
+  ScopedAllocationCounter();
+  ~ScopedAllocationCounter() = default;
+
+  // Prevent copying.
+  ScopedAllocationCounter(ScopedAllocationCounter const&) = delete;
+  ScopedAllocationCounter& operator=(ScopedAllocationCounter const&) = delete;
+
+  // Returns the number of allocations since this was created.
+  size_t count() const;
+
+ private:
+  size_t start_count_;
+};
+
+}  // namespace testing
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_ALLOCATION_COUNTER_H_
@@ -0,0 +1,36 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_ENGINE_EMBEDDER_API_MODIFIER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_ENGINE_EMBEDDER_API_MODIFIER_H_
+
+#include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/shell/platform/linux_embedded/flutter_linuxes_engine.h"
+
+namespace flutter {
+
+// A test utility class providing the ability to access and alter the embedder
+// API proc table for an engine instance.
+//
+// This simply provides a way to access the normally-private embedder proc
+// table, so the lifetime of any changes made to the proc table is that of the
+// engine object, not this helper.
+class EngineEmbedderApiModifier {
+ public:
+  explicit EngineEmbedderApiModifier(FlutterLinuxesEngine* engine)
+      : engine_(engine) {}
+
+  // Returns the engine's embedder API proc table, allowing for modification.
+  //
+  // Modifications are to the engine, and will last for the lifetime of the
+  // engine unless overwritten again.
+  FlutterEngineProcTable& embedder_api() { return engine_->embedder_api_; }
+
+ private:
+  FlutterLinuxesEngine* engine_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_ENGINE_EMBEDDER_API_MODIFIER_H_
@@ -0,0 +1,102 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A fake of the Flutter engine library, which the tests are linked with
+// instead of libflutter_engine.so. It provides the functions which the
+// embedder calls directly. The procs of the table succeed without doing
+// anything, and tests replace the ones they observe through
+// EngineEmbedderApiModifier.
+
+#include <chrono>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+namespace {
+
+template <typename Proc>
+struct DefaultProc;
+
+template <typename Result, typename... Args>
+struct DefaultProc<Result (*)(Args...)> {
+  static Result Call(Args...) { return Result(); }
+};
+
+template <typename... Args>
+struct DefaultProc<FlutterEngineResult (*)(Args...)> {
+  static FlutterEngineResult Call(Args...) { return kSuccess; }
+};
+
+template <typename Proc>
+void SetDefault(Proc& proc) {
+  proc = &DefaultProc<Proc>::Call;
+}
+
+// The handle of the running fake engine.
+int fake_engine;
+
+FlutterEngineResult Run(size_t version,
+                        const FlutterRendererConfig* config,
+                        const FlutterProjectArgs* args,
+                        void* user_data,
+                        FLUTTER_API_SYMBOL(FlutterEngine) * engine_out) {
+  *engine_out = reinterpret_cast<FLUTTER_API_SYMBOL(FlutterEngine)>(
+      &fake_engine);
+  return kSuccess;
+}
+
+uint64_t GetCurrentTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+FlutterEngineResult FlutterEngineCollectAOTData(FlutterEngineAOTData data) {
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineGetProcAddresses(
+    FlutterEngineProcTable* table) {
+  if (!table || table->struct_size != sizeof(FlutterEngineProcTable)) {
+    return kInvalidArguments;
+  }
+  SetDefault(table->CreateAOTData);
+  SetDefault(table->CollectAOTData);
+  SetDefault(table->Run);
+  SetDefault(table->Shutdown);
+  SetDefault(table->Initialize);
+  SetDefault(table->Deinitialize);
+  SetDefault(table->RunInitialized);
+  SetDefault(table->SendWindowMetricsEvent);
+  SetDefault(table->SendPointerEvent);
+  SetDefault(table->SendKeyEvent);
+  SetDefault(table->SendPlatformMessage);
+  SetDefault(table->PlatformMessageCreateResponseHandle);
+  SetDefault(table->PlatformMessageReleaseResponseHandle);
+  SetDefault(table->SendPlatformMessageResponse);
+  SetDefault(table->RegisterExternalTexture);
+  SetDefault(table->UnregisterExternalTexture);
+  SetDefault(table->MarkExternalTextureFrameAvailable);
+  SetDefault(table->UpdateSemanticsEnabled);
+  SetDefault(table->UpdateAccessibilityFeatures);
+  SetDefault(table->DispatchSemanticsAction);
+  SetDefault(table->OnVsync);
+  SetDefault(table->ReloadSystemFonts);
+  SetDefault(table->TraceEventDurationBegin);
+  SetDefault(table->TraceEventDurationEnd);
+  SetDefault(table->TraceEventInstant);
+  SetDefault(table->PostRenderThreadTask);
+  SetDefault(table->GetCurrentTime);
+  SetDefault(table->RunTask);
+  SetDefault(table->UpdateLocales);
+  SetDefault(table->RunsAOTCompiledDartCode);
+  SetDefault(table->PostDartObject);
+  SetDefault(table->NotifyLowMemoryWarning);
+  SetDefault(table->PostCallbackOnAllNativeThreads);
+  SetDefault(table->NotifyDisplayUpdate);
+  table->Run = Run;
+  table->GetCurrentTime = GetCurrentTime;
+  return kSuccess;
+}
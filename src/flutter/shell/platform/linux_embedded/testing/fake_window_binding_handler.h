@@ -0,0 +1,104 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_FAKE_WINDOW_BINDING_HANDLER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_FAKE_WINDOW_BINDING_HANDLER_H_
+
+#include <string>
+
+#include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
+
+namespace flutter {
+namespace testing {
+
+// A window without any display, so that a FlutterLinuxesView can be created
+// in tests. Tests feed input to the view through its
+// WindowBindingHandlerDelegate interface, which |view()| returns.
+class FakeWindowBindingHandler : public WindowBindingHandler {
+ public:
+  static constexpr size_t kWidth = 800;
+  static constexpr size_t kHeight = 600;
+
+  FakeWindowBindingHandler() = default;
+  ~FakeWindowBindingHandler() override = default;
+
+  // Prevent copying.
+  FakeWindowBindingHandler(FakeWindowBindingHandler const&) = delete;
+  FakeWindowBindingHandler& operator=(FakeWindowBindingHandler const&) =
+      delete;
+
+  WindowBindingHandlerDelegate* view() const { return view_; }
+
+  // Makes GetCompositor() return |compositor|, which the caller owns.
+  void set_compositor(LinuxesCompositor* compositor) {
+    compositor_ = compositor;
+  }
+
+  // |WindowBindingHandler|
+  bool DispatchEvent() override { return true; }
+
+  // |WindowBindingHandler|
+  int GetEventFd() override { return -1; }
+
+  // |WindowBindingHandler|
+  bool CreateRenderSurface(int32_t width, int32_t height) override {
+    return false;
+  }
+
+  // |WindowBindingHandler|
+  bool CreateSoftwareRenderSurface(int32_t width, int32_t height) override {
+    return false;
+  }
+
+  // |WindowBindingHandler|
+  void DestroyRenderSurface() override {}
+
+  // |WindowBindingHandler|
+  LinuxesRenderSurfaceTarget* GetRenderSurfaceTarget() const override {
+    return nullptr;
+  }
+
+  // |WindowBindingHandler|
+  SurfaceSoftware* GetSoftwareRenderSurface() const override {
+    return nullptr;
+  }
+
+  // |WindowBindingHandler|
+  LinuxesCompositor* GetCompositor() const override { return compositor_; }
+
+  // |WindowBindingHandler|
+  void SetView(WindowBindingHandlerDelegate* view) override { view_ = view; }
+
+  // |WindowBindingHandler|
+  double GetDpiScale() override { return 1.0; }
+
+  // |WindowBindingHandler|
+  PhysicalWindowBounds GetPhysicalWindowBounds() override {
+    return {kWidth, kHeight};
+  }
+
+  // |WindowBindingHandler|
+  void UpdateFlutterCursor(const std::string& cursor_name) override {}
+
+  // |WindowBindingHandler|
+  void UpdateVirtualKeyboardStatus(const bool show) override {}
+
+  // |WindowBindingHandler|
+  std::string GetClipboardData() override { return clipboard_data_; }
+
+  // |WindowBindingHandler|
+  void SetClipboardData(const std::string& data) override {
+    clipboard_data_ = data;
+  }
+
+ private:
+  WindowBindingHandlerDelegate* view_ = nullptr;
+  LinuxesCompositor* compositor_ = nullptr;
+  std::string clipboard_data_;
+};
+
+}  // namespace testing
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_FAKE_WINDOW_BINDING_HANDLER_H_
@@ -0,0 +1,85 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/testing/test_egl_context.h"
+
+#include <EGL/eglext.h>
+
+namespace flutter {
+namespace testing {
+
+TestEglContext::TestEglContext() {
+  auto get_platform_display =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (!get_platform_display) {
+    return;
+  }
+  display_ = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                  EGL_DEFAULT_DISPLAY, nullptr);
+  if (display_ == EGL_NO_DISPLAY) {
+    return;
+  }
+  if (!eglInitialize(display_, nullptr, nullptr)) {
+    display_ = EGL_NO_DISPLAY;
+    return;
+  }
+  if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+    return;
+  }
+
+  // Surfaceless displays have no window configs.
+  const EGLint config_attributes[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+      EGL_OPENGL_ES2_BIT, EGL_NONE,
+  };
+  EGLConfig config;
+  EGLint config_count = 0;
+  if (!eglChooseConfig(display_, config_attributes, &config, 1,
+                       &config_count) ||
+      config_count == 0) {
+    return;
+  }
+
+  const EGLint context_attributes[] = {
+      EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE,
+  };
+  auto context =
+      eglCreateContext(display_, config, EGL_NO_CONTEXT, context_attributes);
+  if (context == EGL_NO_CONTEXT) {
+    return;
+  }
+  if (!eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    eglDestroyContext(display_, context);
+    return;
+  }
+  context_ = context;
+}
+
+TestEglContext::~TestEglContext() {
+  if (display_ == EGL_NO_DISPLAY) {
+    return;
+  }
+  if (context_ != EGL_NO_CONTEXT) {
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display_, context_);
+  }
+  eglTerminate(display_);
+}
+
+bool TestEglContext::HasExtension(const std::string& name) const {
+  if (display_ == EGL_NO_DISPLAY) {
+    return false;
+  }
+  auto extensions = eglQueryString(display_, EGL_EXTENSIONS);
+  if (!extensions) {
+    return false;
+  }
+  // Match whole names only, e.g. not EGL_EXT_foo in EGL_EXT_foo_bar.
+  auto list = " " + std::string(extensions) + " ";
+  return list.find(" " + name + " ") != std::string::npos;
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,42 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_TEST_EGL_CONTEXT_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_TEST_EGL_CONTEXT_H_
+
+#include <EGL/egl.h>
+
+#include <string>
+
+namespace flutter {
+namespace testing {
+
+// An OpenGL ES context without any window system, e.g. Mesa's software
+// renderer on EGL_MESA_platform_surfaceless, for the tests of GL code.
+class TestEglContext {
+ public:
+  TestEglContext();
+  ~TestEglContext();
+
+  // Prevent copying.
+  TestEglContext(TestEglContext const&) = delete;
+  TestEglContext& operator=(TestEglContext const&) = delete;
+
+  // Returns true if the context has been created and made current.
+  bool IsValid() const { return context_ != EGL_NO_CONTEXT; }
+
+  // Returns true if the display supports the EGL extension |name|.
+  bool HasExtension(const std::string& name) const;
+
+  EGLDisplay display() const { return display_; }
+
+ private:
+  EGLDisplay display_ = EGL_NO_DISPLAY;
+  EGLContext context_ = EGL_NO_CONTEXT;
+};
+
+}  // namespace testing
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_TEST_EGL_CONTEXT_H_
@@ -0,0 +1,20 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/testing/test_engine.h"
+
+namespace flutter {
+namespace testing {
+
+std::unique_ptr<FlutterLinuxesEngine> CreateTestEngine() {
+  // The fake engine doesn't load anything, so the paths needn't exist.
+  FlutterDesktopEngineProperties properties = {};
+  properties.assets_path = L"/nonexistent/flutter_assets";
+  properties.icu_data_path = L"/nonexistent/icudtl.dat";
+  FlutterProjectBundle project(properties);
+  return std::make_unique<FlutterLinuxesEngine>(project);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,23 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_TEST_ENGINE_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_TEST_ENGINE_H_
+
+#include <memory>
+
+#include "flutter/shell/platform/linux_embedded/flutter_linuxes_engine.h"
+
+namespace flutter {
+namespace testing {
+
+// Returns an engine which runs on the fake embedder API the tests are linked
+// with. Tests can replace its procs with EngineEmbedderApiModifier before or
+// after running it.
+std::unique_ptr<FlutterLinuxesEngine> CreateTestEngine();
+
+}  // namespace testing
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TESTING_TEST_ENGINE_H_
@@ -0,0 +1,56 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/touch_tracker.h"
+
+#include <algorithm>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+void TouchTracker::Reserve(size_t count) {
+  count = std::min(count, kMaxTouchPoints);
+  if (count > points_.size()) {
+    points_.resize(count);
+  }
+}
+
+TouchTracker::TouchPoint* TouchTracker::Down(int32_t id, double x, double y) {
+  if (id < 0 || static_cast<size_t>(id) >= kMaxTouchPoints) {
+    LINUXES_LOG(WARNING) << "Touch id " << id << " is out of range.";
+    return nullptr;
+  }
+  if (static_cast<size_t>(id) >= points_.size()) {
+    points_.resize(id + 1);
+  }
+
+  auto& point = points_[id];
+  if (!point.active) {
+    point.active = true;
+    active_count_++;
+  }
+  point.device = kDeviceIdOffset + id;
+  point.x = x;
+  point.y = y;
+  return &point;
+}
+
+TouchTracker::TouchPoint* TouchTracker::Find(int32_t id) {
+  if (id < 0 || static_cast<size_t>(id) >= points_.size() ||
+      !points_[id].active) {
+    return nullptr;
+  }
+  return &points_[id];
+}
+
+void TouchTracker::Up(int32_t id) {
+  auto point = Find(id);
+  if (point) {
+    point->active = false;
+    active_count_--;
+  }
+}
+
+}  // namespace flutter
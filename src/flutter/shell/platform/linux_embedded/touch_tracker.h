@@ -0,0 +1,80 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TOUCH_TRACKER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TOUCH_TRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter {
+
+// Tracks the touch points which are currently down and gives each of them its
+// own pointer device id, so that Flutter can tell the fingers apart.
+//
+// Touch points are looked up in constant time by their touch id, which is the
+// seat slot for libinput and the touch id for Wayland. Both are small numbers
+// which are reused once the finger is lifted.
+class TouchTracker {
+ public:
+  // The largest number of touch points that can be tracked at once.
+  static constexpr size_t kMaxTouchPoints = 256;
+
+  // Device ids up to this value are left for mice.
+  static constexpr int32_t kDeviceIdOffset = 1;
+
+  struct TouchPoint {
+    bool active = false;
+    // The device id of the touch point in FlutterPointerEvent.
+    int32_t device = 0;
+    double x = 0;
+    double y = 0;
+  };
+
+  TouchTracker() = default;
+  ~TouchTracker() = default;
+
+  // Prevent copying.
+  TouchTracker(TouchTracker const&) = delete;
+  TouchTracker& operator=(TouchTracker const&) = delete;
+
+  // Makes room for |count| touch points so that no allocation is made while
+  // touching. Typically the touch count reported by the device.
+  void Reserve(size_t count);
+
+  // Starts tracking the touch point |id| at (|x|, |y|). Returns nullptr if
+  // |id| is out of range.
+  TouchPoint* Down(int32_t id, double x, double y);
+
+  // Returns the touch point |id| if it is down, otherwise nullptr.
+  TouchPoint* Find(int32_t id);
+
+  // Stops tracking the touch point |id| so that its slot can be reused.
+  void Up(int32_t id);
+
+  // Calls |callback| with each touch point which is down and stops tracking
+  // all of them.
+  template <typename Callback>
+  void CancelAll(Callback callback) {
+    for (auto& point : points_) {
+      if (point.active) {
+        callback(point);
+        point.active = false;
+      }
+    }
+    active_count_ = 0;
+  }
+
+  // Returns the number of touch points which are down.
+  size_t active_count() const { return active_count_; }
+
+ private:
+  std::vector<TouchPoint> points_;
+  size_t active_count_ = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TOUCH_TRACKER_H_
@@ -0,0 +1,63 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/touch_tracker.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(TouchTrackerTest, TracksPointsBySlot) {
+  TouchTracker tracker;
+  tracker.Reserve(10);
+  auto point = tracker.Down(2, 1.0, 2.0);
+  ASSERT_NE(point, nullptr);
+  EXPECT_EQ(point->device, TouchTracker::kDeviceIdOffset + 2);
+  EXPECT_EQ(tracker.Find(2), point);
+  EXPECT_EQ(tracker.Find(3), nullptr);
+  EXPECT_EQ(tracker.active_count(), 1u);
+
+  // A second down of the same slot doesn't count twice.
+  tracker.Down(2, 3.0, 4.0);
+  EXPECT_EQ(tracker.active_count(), 1u);
+  EXPECT_EQ(tracker.Find(2)->x, 3.0);
+
+  tracker.Up(2);
+  EXPECT_EQ(tracker.Find(2), nullptr);
+  EXPECT_EQ(tracker.active_count(), 0u);
+  tracker.Up(2);
+  EXPECT_EQ(tracker.active_count(), 0u);
+}
+
+TEST(TouchTrackerTest, RejectsOutOfRangeSlots) {
+  TouchTracker tracker;
+  EXPECT_EQ(tracker.Down(-1, 0, 0), nullptr);
+  EXPECT_EQ(tracker.Down(TouchTracker::kMaxTouchPoints, 0, 0), nullptr);
+  EXPECT_NE(tracker.Down(TouchTracker::kMaxTouchPoints - 1, 0, 0), nullptr);
+  EXPECT_EQ(tracker.Find(-1), nullptr);
+  EXPECT_EQ(tracker.active_count(), 1u);
+}
+
+TEST(TouchTrackerTest, CancelAllReportsActivePoints) {
+  TouchTracker tracker;
+  for (int32_t slot = 0; slot < 12; slot++) {
+    tracker.Down(slot, slot, 0);
+  }
+  tracker.Up(5);
+
+  std::vector<int32_t> cancelled;
+  tracker.CancelAll([&cancelled](const TouchTracker::TouchPoint& point) {
+    cancelled.push_back(point.device - TouchTracker::kDeviceIdOffset);
+  });
+  EXPECT_EQ(cancelled,
+            std::vector<int32_t>({0, 1, 2, 3, 4, 6, 7, 8, 9, 10, 11}));
+  EXPECT_EQ(tracker.active_count(), 0u);
+  EXPECT_EQ(tracker.Find(0), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
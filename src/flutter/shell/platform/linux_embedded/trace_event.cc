@@ -0,0 +1,137 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/trace_event.h"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+namespace {
+
+// Writes |value| as a JSON string.
+void WriteJsonString(FILE* file, const std::string& value) {
+  fputc('"', file);
+  for (auto c : value) {
+    if (c == '"' || c == '\\') {
+      fputc('\\', file);
+      fputc(c, file);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      fprintf(file, "\\u%04x", c);
+    } else {
+      fputc(c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+}  // namespace
+
+TraceLog& TraceLog::GetInstance() {
+  // Never destroyed because threads may still record while the process exits.
+  static auto instance = new TraceLog();
+  return *instance;
+}
+
+void TraceLog::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceLog::AddCompleteEvent(const char* name,
+                                uint64_t start_time_nanos,
+                                uint64_t end_time_nanos) {
+  auto buffer = GetThreadBuffer();
+  auto size = buffer->size.load(std::memory_order_relaxed);
+  if (size >= kThreadBufferCapacity) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer->events[size] = {name, start_time_nanos,
+                          end_time_nanos - start_time_nanos};
+  buffer->size.store(size + 1, std::memory_order_release);
+}
+
+TraceLog::ThreadBuffer* TraceLog::GetThreadBuffer() {
+  thread_local ThreadBuffer* thread_buffer = nullptr;
+  if (thread_buffer) {
+    return thread_buffer;
+  }
+
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->thread_id = syscall(SYS_gettid);
+  char thread_name[16] = {};
+  if (pthread_getname_np(pthread_self(), thread_name, sizeof(thread_name)) ==
+      0) {
+    buffer->thread_name = thread_name;
+  }
+  buffer->events = std::make_unique<Event[]>(kThreadBufferCapacity);
+
+  thread_buffer = buffer.get();
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  buffers_.push_back(std::move(buffer));
+  return thread_buffer;
+}
+
+bool TraceLog::WriteJson(const std::string& path) {
+  auto file = fopen(path.c_str(), "w");
+  if (!file) {
+    LINUXES_LOG(ERROR) << "Failed to open the trace file: " << path;
+    return false;
+  }
+
+  const auto pid = getpid();
+  bool first = true;
+  auto separator = [&first, file]() {
+    fputs(first ? "\n" : ",\n", file);
+    first = false;
+  };
+
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (const auto& buffer : buffers_) {
+    if (!buffer->thread_name.empty()) {
+      separator();
+      fprintf(file,
+              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+              "\"tid\":%lld,\"args\":{\"name\":",
+              pid, static_cast<long long>(buffer->thread_id));
+      WriteJsonString(file, buffer->thread_name);
+      fputs("}}", file);
+    }
+
+    auto size = buffer->size.load(std::memory_order_acquire);
+    for (size_t i = 0; i < size; i++) {
+      const auto& event = buffer->events[i];
+      // Chrome trace events are in microseconds.
+      separator();
+      fprintf(file,
+              "{\"name\":\"%s\",\"cat\":\"embedder\",\"ph\":\"X\","
+              "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%lld}",
+              event.name, event.start_time_nanos / 1e3,
+              event.duration_nanos / 1e3, pid,
+              static_cast<long long>(buffer->thread_id));
+    }
+
+    auto dropped = buffer->dropped.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+      LINUXES_LOG(WARNING) << dropped << " trace events of thread "
+                           << buffer->thread_id << " were dropped.";
+    }
+  }
+  fputs("\n]}\n", file);
+
+  auto result = fclose(file) == 0;
+  if (!result) {
+    LINUXES_LOG(ERROR) << "Failed to write the trace file: " << path;
+  }
+  return result;
+}
+
+}  // namespace flutter
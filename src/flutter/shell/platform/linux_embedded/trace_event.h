@@ -0,0 +1,130 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TRACE_EVENT_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TRACE_EVENT_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace flutter {
+
+// The environment variable which enables tracing. Its value is the path of the
+// trace file written when the engine shuts down.
+constexpr char kTraceFileEnvironmentKey[] = "FLUTTER_LINUXES_TRACE_FILE";
+
+// Collects trace events of the embedder and writes them in the Chrome trace
+// event format, which chrome://tracing and Perfetto UI can open. The times are
+// on the monotonic clock like the engine's timeline, so both can be lined up.
+//
+// Each thread records into its own buffer without taking a lock. A thread
+// takes the lock only once, to register its buffer. Events are dropped when
+// the buffer of the thread is full.
+class TraceLog {
+ public:
+  // The number of events each thread can record.
+  static constexpr size_t kThreadBufferCapacity = 64 * 1024;
+
+  // Returns the process-wide trace log.
+  static TraceLog& GetInstance();
+
+  // Returns whether recording is enabled.
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns the current time on the monotonic clock.
+  static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Prevent copying.
+  TraceLog(TraceLog const&) = delete;
+  TraceLog& operator=(TraceLog const&) = delete;
+
+  void SetEnabled(bool enabled);
+
+  // Records a complete event. |name| must be a string literal because only
+  // the pointer is stored.
+  void AddCompleteEvent(const char* name,
+                        uint64_t start_time_nanos,
+                        uint64_t end_time_nanos);
+
+  // Writes the recorded events to |path| as Chrome trace event JSON. This can
+  // be called while other threads are recording.
+  bool WriteJson(const std::string& path);
+
+ private:
+  struct Event {
+    const char* name;
+    uint64_t start_time_nanos;
+    uint64_t duration_nanos;
+  };
+
+  struct ThreadBuffer {
+    int64_t thread_id;
+    std::string thread_name;
+    std::unique_ptr<Event[]> events;
+    // The number of events written. Only the owning thread increments it.
+    std::atomic<size_t> size{0};
+    std::atomic<size_t> dropped{0};
+  };
+
+  TraceLog() = default;
+
+  // Returns the buffer of the calling thread, registering it on first use.
+  ThreadBuffer* GetThreadBuffer();
+
+  static inline std::atomic<bool> enabled_{false};
+
+  // Buffers are kept until the process exits because threads may exit before
+  // the trace is written.
+  std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Records the duration of the enclosing scope. Use LINUXES_TRACE_EVENT.
+class ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(const char* name)
+      : name_(name),
+        start_time_nanos_(TraceLog::IsEnabled() ? TraceLog::Now() : 0) {}
+
+  ~ScopedTraceEvent() {
+    if (start_time_nanos_ != 0) {
+      TraceLog::GetInstance().AddCompleteEvent(name_, start_time_nanos_,
+                                               TraceLog::Now());
+    }
+  }
+
+  // Prevent copying.
+  ScopedTraceEvent(ScopedTraceEvent const&) = delete;
+  ScopedTraceEvent& operator=(ScopedTraceEvent const&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_time_nanos_;
+};
+
+}  // namespace flutter
+
+#define __LINUXES_TRACE_CONCAT_INNER(a, b) a##b
+#define __LINUXES_TRACE_CONCAT(a, b) __LINUXES_TRACE_CONCAT_INNER(a, b)
+
+// Traces the enclosing scope as |name|, which must be a string literal.
+// Compiled out unless the embedder is built with ENABLE_TRACE.
+#if defined(ENABLE_LINUXES_TRACE)
+#define LINUXES_TRACE_EVENT(name)                                  \
+  ::flutter::ScopedTraceEvent __LINUXES_TRACE_CONCAT(trace_event_, \
+                                                     __LINE__)(name)
+#else
+#define LINUXES_TRACE_EVENT(name)
+#endif
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_TRACE_EVENT_H_
@@ -0,0 +1,48 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/vsync_waiter.h"
+
+namespace flutter {
+
+VsyncWaiter::VsyncWaiter(CurrentTimeProc get_current_time)
+    : get_current_time_(get_current_time) {}
+
+void VsyncWaiter::NotifyVblank(uint64_t vblank_time_nanos,
+                               uint64_t vsync_interval_nanos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (vblank_time_nanos > last_vblank_time_nanos_) {
+    last_vblank_time_nanos_ = vblank_time_nanos;
+  }
+  if (vsync_interval_nanos > 0) {
+    vsync_interval_nanos_ = vsync_interval_nanos;
+  }
+}
+
+void VsyncWaiter::GetNextFrameTimes(uint64_t* frame_start_time_nanos,
+                                    uint64_t* frame_target_time_nanos) {
+  const uint64_t now = get_current_time_();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t interval = vsync_interval_nanos_;
+
+  // The latest vblank which is not later than now, extrapolated from the last
+  // reported one. The display keeps refreshing even if we don't present.
+  uint64_t start = last_vblank_time_nanos_;
+  if (now > start) {
+    start = now - (now - start) % interval;
+  }
+
+  // Never give out the same vblank twice. Otherwise the engine would produce
+  // more than one frame per refresh period.
+  if (start <= last_frame_start_time_nanos_) {
+    start = last_frame_start_time_nanos_ + interval;
+  }
+  last_frame_start_time_nanos_ = start;
+
+  *frame_start_time_nanos = start;
+  *frame_target_time_nanos = start + interval;
+}
+
+}  // namespace flutter
@@ -0,0 +1,57 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_VSYNC_WAITER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_VSYNC_WAITER_H_
+
+#include <cstdint>
+#include <mutex>
+
+#include "flutter/shell/platform/linux_embedded/task_runner.h"
+
+namespace flutter {
+
+// Computes the frame times given to FlutterEngineOnVsync from the vblanks
+// reported by the display backend (DRM page-flip events, Wayland frame
+// callbacks), so that frames are aligned with the display refresh.
+//
+// Until the first vblank is reported, this acts as a free-running vsync source
+// driven by |get_current_time|. Passing a fake clock makes it usable without
+// any display, e.g. in headless tests.
+class VsyncWaiter {
+ public:
+  // 60Hz.
+  static constexpr uint64_t kDefaultVsyncIntervalNanos = 16666667;
+
+  explicit VsyncWaiter(CurrentTimeProc get_current_time);
+  ~VsyncWaiter() = default;
+
+  // Prevent copying.
+  VsyncWaiter(VsyncWaiter const&) = delete;
+  VsyncWaiter& operator=(VsyncWaiter const&) = delete;
+
+  // Notifies that a vblank happened at |vblank_time_nanos| on the engine clock
+  // and that the display refreshes every |vsync_interval_nanos|. A zero
+  // interval keeps the current one. This can be called from any thread.
+  void NotifyVblank(uint64_t vblank_time_nanos, uint64_t vsync_interval_nanos);
+
+  // Computes the start and the target time of the next frame. The start time
+  // is the latest vblank which has not been given out yet, so it is in the
+  // future if a frame has already been started in the current refresh period.
+  // The engine waits until then before it begins the frame.
+  void GetNextFrameTimes(uint64_t* frame_start_time_nanos,
+                         uint64_t* frame_target_time_nanos);
+
+ private:
+  CurrentTimeProc get_current_time_;
+
+  std::mutex mutex_;
+  uint64_t last_vblank_time_nanos_ = 0;
+  uint64_t vsync_interval_nanos_ = kDefaultVsyncIntervalNanos;
+  uint64_t last_frame_start_time_nanos_ = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_VSYNC_WAITER_H_
@@ -0,0 +1,94 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/vsync_waiter.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr uint64_t kInterval = VsyncWaiter::kDefaultVsyncIntervalNanos;
+
+// A fake clock driven by the tests.
+uint64_t fake_now = 0;
+
+uint64_t GetFakeTime() {
+  return fake_now;
+}
+
+class VsyncWaiterTest : public ::testing::Test {
+ protected:
+  void SetUp() override { fake_now = 1000000000; }
+
+  void GetNextFrameTimes(uint64_t* start, uint64_t* target) {
+    waiter_.GetNextFrameTimes(start, target);
+  }
+
+  VsyncWaiter waiter_{GetFakeTime};
+};
+
+}  // namespace
+
+TEST_F(VsyncWaiterTest, FreeRunsWithoutVblanks) {
+  uint64_t start, target;
+  GetNextFrameTimes(&start, &target);
+  EXPECT_LE(start, fake_now);
+  EXPECT_GT(start + kInterval, fake_now);
+  EXPECT_EQ(target, start + kInterval);
+
+  // The next request in the same refresh period gets the next vblank.
+  auto first_start = start;
+  fake_now += kInterval / 4;
+  GetNextFrameTimes(&start, &target);
+  EXPECT_EQ(start, first_start + kInterval);
+  EXPECT_EQ(target, start + kInterval);
+}
+
+TEST_F(VsyncWaiterTest, AlignsFramesWithReportedVblanks) {
+  // 120Hz display whose last vblank was 3ms ago.
+  constexpr uint64_t kDisplayInterval = 8333333;
+  const uint64_t vblank = fake_now - 3000000;
+  waiter_.NotifyVblank(vblank, kDisplayInterval);
+
+  uint64_t start, target;
+  GetNextFrameTimes(&start, &target);
+  EXPECT_EQ(start, vblank);
+  EXPECT_EQ(target, vblank + kDisplayInterval);
+
+  // Vblanks which are not reported are extrapolated.
+  fake_now = vblank + kDisplayInterval * 5 + 1000;
+  GetNextFrameTimes(&start, &target);
+  EXPECT_EQ(start, vblank + kDisplayInterval * 5);
+  EXPECT_EQ(target, vblank + kDisplayInterval * 6);
+}
+
+TEST_F(VsyncWaiterTest, IgnoresOlderVblanksAndZeroInterval) {
+  const uint64_t vblank = fake_now - 1000;
+  waiter_.NotifyVblank(vblank, 0);
+  waiter_.NotifyVblank(vblank - kInterval, 0);
+
+  uint64_t start, target;
+  GetNextFrameTimes(&start, &target);
+  EXPECT_EQ(start, vblank);
+  EXPECT_EQ(target, vblank + kInterval);
+}
+
+TEST_F(VsyncWaiterTest, NeverGivesOutTheSameVblankTwice) {
+  waiter_.NotifyVblank(fake_now, kInterval);
+
+  uint64_t previous_start = 0;
+  for (int i = 0; i < 10; i++) {
+    uint64_t start, target;
+    GetNextFrameTimes(&start, &target);
+    EXPECT_GT(start, previous_start);
+    EXPECT_EQ((start - fake_now) % kInterval, 0u);
+    previous_start = start;
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
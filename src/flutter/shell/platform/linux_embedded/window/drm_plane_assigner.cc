@@ -0,0 +1,76 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/window/drm_plane_assigner.h"
+
+namespace flutter {
+
+DrmPlaneAssigner::DrmPlaneAssigner(DrmPlaneBackend* backend,
+                                   uint32_t display_width,
+                                   uint32_t display_height)
+    : backend_(backend),
+      display_width_(display_width),
+      display_height_(display_height) {}
+
+DrmPlaneAssignment DrmPlaneAssigner::Assign(
+    const std::vector<DrmPlaneLayer>& layers) {
+  if (!last_layers_.empty() && IsSameLayout(layers)) {
+    return last_assignment_;
+  }
+
+  // By default, GL composites everything into the primary plane, which
+  // always works.
+  auto layer_count = layers.size();
+  DrmPlaneAssignment assignment;
+  assignment.first_overlay_layer = layer_count;
+
+  // Try to show as many layers as possible on the planes. The planes are
+  // stacked in the order of the layers, so only the top layers can get
+  // overlays.
+  const auto& overlays = backend_->GetOverlayPlanes();
+  auto first = layer_count > overlays.size() + 1
+                   ? layer_count - overlays.size()
+                   : static_cast<size_t>(1);
+  for (; first <= layer_count; first++) {
+    DrmPlaneAssignment candidate;
+    candidate.first_overlay_layer = first;
+    candidate.scanout_first_layer = first == 1 && IsFullscreen(layers[0]);
+    candidate.overlay_planes.assign(overlays.begin(),
+                                    overlays.begin() + (layer_count - first));
+    if (candidate.overlay_planes.empty() && !candidate.scanout_first_layer) {
+      break;
+    }
+    if (backend_->TestAssignment(layers, candidate)) {
+      assignment = std::move(candidate);
+      break;
+    }
+  }
+
+  last_layers_ = layers;
+  last_assignment_ = assignment;
+  return assignment;
+}
+
+bool DrmPlaneAssigner::IsSameLayout(
+    const std::vector<DrmPlaneLayer>& layers) const {
+  if (layers.size() != last_layers_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < layers.size(); i++) {
+    const auto& a = layers[i];
+    const auto& b = last_layers_[i];
+    if (a.x != b.x || a.y != b.y || a.width != b.width ||
+        a.height != b.height) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DrmPlaneAssigner::IsFullscreen(const DrmPlaneLayer& layer) const {
+  return layer.x == 0 && layer.y == 0 && layer.width == display_width_ &&
+         layer.height == display_height_;
+}
+
+}  // namespace flutter
@@ -0,0 +1,88 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_DRM_PLANE_ASSIGNER_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_DRM_PLANE_ASSIGNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter {
+
+// A layer of a frame, in the coordinates of the display.
+struct DrmPlaneLayer {
+  // The framebuffer which a plane can scan out.
+  uint32_t fb_id;
+  int32_t x;
+  int32_t y;
+  uint32_t width;
+  uint32_t height;
+};
+
+// Where the layers of a frame are shown.
+struct DrmPlaneAssignment {
+  // The layers below this index are shown by the primary plane, and the
+  // others by |overlay_planes| in the same order.
+  size_t first_overlay_layer = 0;
+
+  // Whether the primary plane scans out the first layer as is. Otherwise the
+  // layers below |first_overlay_layer| are composited into it by GL.
+  bool scanout_first_layer = false;
+
+  std::vector<uint32_t> overlay_planes;
+};
+
+// The display side of the plane assignment.
+class DrmPlaneBackend {
+ public:
+  virtual ~DrmPlaneBackend() = default;
+
+  // Returns the overlay planes which can show layers, bottom first.
+  virtual const std::vector<uint32_t>& GetOverlayPlanes() const = 0;
+
+  // Returns whether the display can show |layers| as |assignment| says,
+  // without showing them.
+  virtual bool TestAssignment(const std::vector<DrmPlaneLayer>& layers,
+                              const DrmPlaneAssignment& assignment) = 0;
+};
+
+// Decides which layers of each frame the display planes show by themselves,
+// so that GL composites as few of them as possible.
+class DrmPlaneAssigner {
+ public:
+  DrmPlaneAssigner(DrmPlaneBackend* backend, uint32_t display_width,
+                   uint32_t display_height);
+  ~DrmPlaneAssigner() = default;
+
+  // Prevent copying.
+  DrmPlaneAssigner(DrmPlaneAssigner const&) = delete;
+  DrmPlaneAssigner& operator=(DrmPlaneAssigner const&) = delete;
+
+  // Returns where |layers|, bottom first, are shown. A new layout is checked
+  // with the backend, and the decision is reused while the position and the
+  // size of every layer stay the same.
+  DrmPlaneAssignment Assign(const std::vector<DrmPlaneLayer>& layers);
+
+  // Forgets the last decision, e.g. when the display rejected it.
+  void Invalidate() { last_layers_.clear(); }
+
+ private:
+  // Returns true if |layers| have the same geometry as the last ones.
+  bool IsSameLayout(const std::vector<DrmPlaneLayer>& layers) const;
+
+  // Returns true if |layer| covers the whole display.
+  bool IsFullscreen(const DrmPlaneLayer& layer) const;
+
+  DrmPlaneBackend* backend_;
+  uint32_t display_width_;
+  uint32_t display_height_;
+
+  std::vector<DrmPlaneLayer> last_layers_;
+  DrmPlaneAssignment last_assignment_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_DRM_PLANE_ASSIGNER_H_
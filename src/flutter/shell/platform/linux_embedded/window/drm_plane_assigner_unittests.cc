@@ -0,0 +1,231 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/window/drm_plane_assigner.h"
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr uint32_t kDisplayWidth = 1920;
+constexpr uint32_t kDisplayHeight = 1080;
+
+// A display with |overlay_planes| which accepts an assignment like the
+// atomic TEST_ONLY commit of NativeWindowDrmGbm does: every plane showing a
+// backing store must support REFLECT_Y, and at most |max_overlays| overlays
+// can be enabled at once.
+class FakeDrmPlaneBackend : public DrmPlaneBackend {
+ public:
+  explicit FakeDrmPlaneBackend(std::vector<uint32_t> overlay_planes)
+      : overlay_planes_(std::move(overlay_planes)),
+        max_overlays_(overlay_planes_.size()) {}
+
+  // |DrmPlaneBackend|
+  const std::vector<uint32_t>& GetOverlayPlanes() const override {
+    return overlay_planes_;
+  }
+
+  // |DrmPlaneBackend|
+  bool TestAssignment(const std::vector<DrmPlaneLayer>& layers,
+                      const DrmPlaneAssignment& assignment) override {
+    tested_.push_back(assignment);
+    if (reject_all_) {
+      return false;
+    }
+    if (assignment.scanout_first_layer && !primary_reflect_y_) {
+      return false;
+    }
+    if (assignment.overlay_planes.size() > max_overlays_) {
+      return false;
+    }
+    for (auto plane : assignment.overlay_planes) {
+      if (no_reflect_y_planes_.count(plane)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void set_reject_all(bool reject) { reject_all_ = reject; }
+  void set_max_overlays(size_t count) { max_overlays_ = count; }
+  void set_primary_reflect_y(bool supported) {
+    primary_reflect_y_ = supported;
+  }
+  void RemoveReflectY(uint32_t plane) { no_reflect_y_planes_.insert(plane); }
+
+  const std::vector<DrmPlaneAssignment>& tested() const { return tested_; }
+  void ClearTested() { tested_.clear(); }
+
+ private:
+  std::vector<uint32_t> overlay_planes_;
+  size_t max_overlays_;
+  bool reject_all_ = false;
+  bool primary_reflect_y_ = true;
+  std::set<uint32_t> no_reflect_y_planes_;
+  std::vector<DrmPlaneAssignment> tested_;
+};
+
+// Returns |count| layers. The first one covers the display and the others
+// are smaller, like platform views above the Flutter content.
+std::vector<DrmPlaneLayer> CreateLayers(size_t count) {
+  std::vector<DrmPlaneLayer> layers;
+  layers.push_back({100, 0, 0, kDisplayWidth, kDisplayHeight});
+  for (size_t i = 1; i < count; i++) {
+    auto offset = static_cast<int32_t>(i * 10);
+    layers.push_back({static_cast<uint32_t>(100 + i), offset, offset, 320,
+                      240});
+  }
+  return layers;
+}
+
+}  // namespace
+
+TEST(DrmPlaneAssignerTest, FallsBackToGlWhenTestFails) {
+  FakeDrmPlaneBackend backend({31, 32, 33});
+  backend.set_reject_all(true);
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  auto layers = CreateLayers(3);
+  auto assignment = assigner.Assign(layers);
+  EXPECT_EQ(assignment.first_overlay_layer, layers.size());
+  EXPECT_FALSE(assignment.scanout_first_layer);
+  EXPECT_TRUE(assignment.overlay_planes.empty());
+
+  // Every candidate which uses a plane, from the most planes to the fewest,
+  // was tested before giving up.
+  ASSERT_EQ(backend.tested().size(), 2u);
+  EXPECT_EQ(backend.tested()[0].overlay_planes.size(), 2u);
+  EXPECT_TRUE(backend.tested()[0].scanout_first_layer);
+  EXPECT_EQ(backend.tested()[1].overlay_planes.size(), 1u);
+  EXPECT_FALSE(backend.tested()[1].scanout_first_layer);
+}
+
+TEST(DrmPlaneAssignerTest, StacksOverlaysInLayerOrder) {
+  FakeDrmPlaneBackend backend({31, 32, 33});
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  auto layers = CreateLayers(4);
+  auto assignment = assigner.Assign(layers);
+  // The bottom layer is scanned out by the primary plane, and the layers
+  // above it by the overlays, bottom first.
+  EXPECT_EQ(assignment.first_overlay_layer, 1u);
+  EXPECT_TRUE(assignment.scanout_first_layer);
+  EXPECT_EQ(assignment.overlay_planes, std::vector<uint32_t>({31, 32, 33}));
+  EXPECT_EQ(backend.tested().size(), 1u);
+}
+
+TEST(DrmPlaneAssignerTest, CompositesBottomLayersWhenOutOfPlanes) {
+  FakeDrmPlaneBackend backend({31, 32});
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  // Only the top layers can get overlays, so the bottom ones are composited
+  // by GL into the primary plane.
+  auto layers = CreateLayers(5);
+  auto assignment = assigner.Assign(layers);
+  EXPECT_EQ(assignment.first_overlay_layer, 3u);
+  EXPECT_FALSE(assignment.scanout_first_layer);
+  EXPECT_EQ(assignment.overlay_planes, std::vector<uint32_t>({31, 32}));
+}
+
+TEST(DrmPlaneAssignerTest, UsesFewerOverlaysWhenTheDisplayRejectsMore) {
+  FakeDrmPlaneBackend backend({31, 32, 33});
+  backend.set_max_overlays(1);
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  auto layers = CreateLayers(4);
+  auto assignment = assigner.Assign(layers);
+  EXPECT_EQ(assignment.first_overlay_layer, 3u);
+  EXPECT_FALSE(assignment.scanout_first_layer);
+  EXPECT_EQ(assignment.overlay_planes, std::vector<uint32_t>({31}));
+  EXPECT_EQ(backend.tested().size(), 3u);
+}
+
+TEST(DrmPlaneAssignerTest, CompositesWithoutOverlayPlanes) {
+  FakeDrmPlaneBackend backend({});
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  // A single fullscreen layer is scanned out as is.
+  auto assignment = assigner.Assign(CreateLayers(1));
+  EXPECT_EQ(assignment.first_overlay_layer, 1u);
+  EXPECT_TRUE(assignment.scanout_first_layer);
+  EXPECT_TRUE(assignment.overlay_planes.empty());
+
+  // Otherwise there is nothing to test, and GL composites everything.
+  backend.ClearTested();
+  assignment = assigner.Assign(CreateLayers(2));
+  EXPECT_EQ(assignment.first_overlay_layer, 2u);
+  EXPECT_FALSE(assignment.scanout_first_layer);
+  EXPECT_TRUE(backend.tested().empty());
+}
+
+TEST(DrmPlaneAssignerTest, CompositesFirstLayerIfPrimaryCannotReflectY) {
+  FakeDrmPlaneBackend backend({31, 32});
+  backend.set_primary_reflect_y(false);
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  // The first layer can't be scanned out flipped, so it is composited by
+  // GL while the layers above it still get overlays.
+  auto layers = CreateLayers(3);
+  auto assignment = assigner.Assign(layers);
+  EXPECT_EQ(assignment.first_overlay_layer, 2u);
+  EXPECT_FALSE(assignment.scanout_first_layer);
+  EXPECT_EQ(assignment.overlay_planes, std::vector<uint32_t>({31}));
+}
+
+TEST(DrmPlaneAssignerTest, FallsBackToGlIfOverlayCannotReflectY) {
+  FakeDrmPlaneBackend backend({31, 32});
+  backend.RemoveReflectY(31);
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  // Every overlay assignment includes the bottom overlay, which is why
+  // NativeWindowDrmGbm doesn't offer planes that can't be rotated.
+  auto layers = CreateLayers(3);
+  auto assignment = assigner.Assign(layers);
+  EXPECT_EQ(assignment.first_overlay_layer, layers.size());
+  EXPECT_TRUE(assignment.overlay_planes.empty());
+  for (const auto& tested : backend.tested()) {
+    if (!tested.overlay_planes.empty()) {
+      EXPECT_EQ(tested.overlay_planes[0], 31u);
+    }
+  }
+}
+
+TEST(DrmPlaneAssignerTest, ReusesDecisionWhileLayoutIsUnchanged) {
+  FakeDrmPlaneBackend backend({31, 32});
+  DrmPlaneAssigner assigner(&backend, kDisplayWidth, kDisplayHeight);
+
+  auto layers = CreateLayers(3);
+  auto first = assigner.Assign(layers);
+  EXPECT_EQ(backend.tested().size(), 1u);
+
+  // New framebuffers in the same places don't need a new test.
+  for (auto& layer : layers) {
+    layer.fb_id += 10;
+  }
+  auto second = assigner.Assign(layers);
+  EXPECT_EQ(backend.tested().size(), 1u);
+  EXPECT_EQ(second.first_overlay_layer, first.first_overlay_layer);
+  EXPECT_EQ(second.overlay_planes, first.overlay_planes);
+
+  // A moved layer does.
+  layers[2].x += 1;
+  assigner.Assign(layers);
+  EXPECT_EQ(backend.tested().size(), 2u);
+
+  // And so does a layout after Invalidate(), e.g. when the commit failed.
+  backend.set_reject_all(true);
+  assigner.Invalidate();
+  auto assignment = assigner.Assign(layers);
+  EXPECT_GT(backend.tested().size(), 2u);
+  EXPECT_EQ(assignment.first_overlay_layer, layers.size());
+}
+
+}  // namespace testing
+}  // namespace flutter
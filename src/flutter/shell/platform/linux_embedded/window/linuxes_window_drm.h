@@ -8,14 +8,21 @@
 #include <fcntl.h>
 #include <libinput.h>
 #include <linux/input-event-codes.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <systemd/sd-event.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <memory>
 #include <thread>
 
 #include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/spsc_ring_buffer.h"
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_drm.h"
+#include "flutter/shell/platform/linux_embedded/trace_event.h"
 #include "flutter/shell/platform/linux_embedded/window/linuxes_window.h"
 #include "flutter/shell/platform/linux_embedded/window/native_window_drm.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
@@ -25,6 +32,9 @@ namespace flutter {
 namespace {
 constexpr char kFlutterDrmDeviceEnvironmentKey[] = "FLUTTER_DRM_DEVICE";
 constexpr char kDrmDeviceDefaultFilename[] = "/dev/dri/card0";
+constexpr char kFlutterDrmCompositorEnvironmentKey[] = "FLUTTER_DRM_COMPOSITOR";
+constexpr char kFlutterDrmInputThreadEnvironmentKey[] =
+    "FLUTTER_DRM_INPUT_THREAD";
 }  // namespace
 
 template <typename W, typename S>
@@ -32,7 +42,13 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
  public:
   LinuxesWindowDrm(FlutterWindowMode window_mode, int32_t width, int32_t height,
                    bool show_cursor)
-      : display_valid_(false), is_pending_cursor_add_event_(false) {
+      : display_valid_(false),
+        is_pending_cursor_add_event_(false),
+        libinput_event_loop_(nullptr),
+        libinput_(nullptr),
+        touch_count_(0),
+        input_wake_fd_(-1),
+        input_stop_fd_(-1) {
     window_mode_ = window_mode;
     current_width_ = width;
     current_height_ = height;
@@ -63,6 +79,15 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
       LINUXES_LOG(ERROR) << "Failed to create libinput event loop.";
       return;
     }
+
+    auto input_thread = std::getenv(kFlutterDrmInputThreadEnvironmentKey);
+    if (input_thread && std::strcmp(input_thread, "0") != 0) {
+      if (StartInputThread()) {
+        return;
+      }
+      LINUXES_LOG(WARNING) << "Read user input on the platform thread.";
+    }
+
     ret =
         sd_event_add_io(libinput_event_loop_, NULL, libinput_get_fd(libinput_),
                         EPOLLIN | EPOLLRDHUP | EPOLLPRI, OnLibinputEvent, this);
@@ -74,6 +99,8 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
   }
 
   ~LinuxesWindowDrm() {
+    // The input thread uses libinput until it is stopped.
+    StopInputThread();
     if (libinput_event_loop_) {
       sd_event_unref(libinput_event_loop_);
     }
@@ -83,11 +110,13 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
 
   // |LinuxesWindow|
   bool IsValid() const override {
-    if (!display_valid_ || !native_window_ || !render_surface_ ||
-        !native_window_->IsValid() || !render_surface_->IsValid()) {
+    if (!display_valid_ || !native_window_ || !native_window_->IsValid()) {
       return false;
     }
-    return true;
+    if (software_surface_) {
+      return software_surface_->IsValid();
+    }
+    return render_surface_ && render_surface_->IsValid();
   }
 
   // |FlutterWindowBindingHandler|
@@ -97,20 +126,16 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
     return true;
   }
 
+  // |FlutterWindowBindingHandler|
+  int GetEventFd() override {
+    return libinput_event_loop_ ? sd_event_get_fd(libinput_event_loop_) : -1;
+  }
+
   // |FlutterWindowBindingHandler|
   bool CreateRenderSurface(int32_t width, int32_t height) override {
-    auto device_filename = std::getenv(kFlutterDrmDeviceEnvironmentKey);
-    if ((!device_filename) || (device_filename[0] == '\0')) {
-      LINUXES_LOG(WARNING) << kFlutterDrmDeviceEnvironmentKey
-                           << " is not set, use " << kDrmDeviceDefaultFilename;
-      device_filename = const_cast<char*>(kDrmDeviceDefaultFilename);
-    }
-    native_window_ = std::make_unique<W>(device_filename);
-    if (!native_window_->IsValid()) {
-      LINUXES_LOG(ERROR) << "Failed to create the native window";
+    if (!CreateNativeWindow()) {
       return false;
     }
-    display_valid_ = true;
 
     render_surface_ = native_window_->CreateRenderSurface();
     if (!render_surface_->SetNativeWindow(native_window_.get())) {
@@ -118,31 +143,40 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
     }
     render_surface_->SetNativeWindowResource(native_window_.get());
 
-    if (window_mode_ == FlutterWindowMode::kFullscreen) {
-      current_width_ = native_window_->Width();
-      current_height_ = native_window_->Height();
-      LINUXES_LOG(INFO) << "Display output resolution: " << current_width_
-                        << "x" << current_height_;
-      if (binding_handler_delegate_) {
-        binding_handler_delegate_->OnWindowSizeChanged(current_width_,
-                                                       current_height_);
+    auto compositor = std::getenv(kFlutterDrmCompositorEnvironmentKey);
+    if (compositor && std::strcmp(compositor, "0") != 0) {
+      compositor_ = native_window_->CreateCompositor(render_surface_.get());
+      if (!compositor_) {
+        LINUXES_LOG(WARNING) << "The compositor is not available, present "
+                                "frames through the render surface.";
       }
-    } else {
-      // todo: implement here.
-      LINUXES_LOG(ERROR) << "Not supported specific surface size.";
     }
 
-    if (is_pending_cursor_add_event_) {
-      native_window_->ShowCursor(pointer_x_, pointer_y_);
-      is_pending_cursor_add_event_ = false;
+    OnRenderSurfaceCreated();
+    return true;
+  }
+
+  // |FlutterWindowBindingHandler|
+  bool CreateSoftwareRenderSurface(int32_t width, int32_t height) override {
+    if (!CreateNativeWindow()) {
+      return false;
     }
 
+    software_surface_ = native_window_->CreateSoftwareRenderSurface();
+    if (!software_surface_ || !software_surface_->IsValid()) {
+      LINUXES_LOG(ERROR) << "Failed to create the software surface";
+      return false;
+    }
+
+    OnRenderSurfaceCreated();
     return true;
   }
 
   // |FlutterWindowBindingHandler|
   void DestroyRenderSurface() override {
     // destroy the main surface before destroying the client window on DRM.
+    compositor_ = nullptr;
+    software_surface_ = nullptr;
     render_surface_ = nullptr;
     native_window_ = nullptr;
   }
@@ -150,6 +184,9 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
   // |FlutterWindowBindingHandler|
   void SetView(WindowBindingHandlerDelegate* view) override {
     binding_handler_delegate_ = view;
+    if (binding_handler_delegate_ && touch_count_ > 0) {
+      binding_handler_delegate_->OnTouchDeviceAdded(touch_count_);
+    }
   }
 
   // |FlutterWindowBindingHandler|
@@ -157,6 +194,16 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
     return render_surface_.get();
   }
 
+  // |FlutterWindowBindingHandler|
+  SurfaceSoftware* GetSoftwareRenderSurface() const override {
+    return software_surface_.get();
+  }
+
+  // |FlutterWindowBindingHandler|
+  LinuxesCompositor* GetCompositor() const override {
+    return compositor_.get();
+  }
+
   // |FlutterWindowBindingHandler|
   double GetDpiScale() override { return current_scale_; }
 
@@ -186,6 +233,55 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
   }
 
  protected:
+  // Opens the DRM device and starts to follow its vblanks.
+  bool CreateNativeWindow() {
+    auto device_filename = std::getenv(kFlutterDrmDeviceEnvironmentKey);
+    if ((!device_filename) || (device_filename[0] == '\0')) {
+      LINUXES_LOG(WARNING) << kFlutterDrmDeviceEnvironmentKey
+                           << " is not set, use " << kDrmDeviceDefaultFilename;
+      device_filename = const_cast<char*>(kDrmDeviceDefaultFilename);
+    }
+    native_window_ = std::make_unique<W>(device_filename);
+    if (!native_window_->IsValid()) {
+      LINUXES_LOG(ERROR) << "Failed to create the native window";
+      return false;
+    }
+    display_valid_ = true;
+
+    // Align frames with the vblanks of the display.
+    native_window_->SetVblankCallback(
+        [this](uint64_t vblank_time_nanos, uint64_t vsync_interval_nanos) {
+          if (binding_handler_delegate_) {
+            binding_handler_delegate_->OnVblank(vblank_time_nanos,
+                                                vsync_interval_nanos);
+          }
+        });
+    native_window_->NotifyLatestVblank();
+    return true;
+  }
+
+  // Tells the view the size of the display once a surface can show frames.
+  void OnRenderSurfaceCreated() {
+    if (window_mode_ == FlutterWindowMode::kFullscreen) {
+      current_width_ = native_window_->Width();
+      current_height_ = native_window_->Height();
+      LINUXES_LOG(INFO) << "Display output resolution: " << current_width_
+                        << "x" << current_height_;
+      if (binding_handler_delegate_) {
+        binding_handler_delegate_->OnWindowSizeChanged(current_width_,
+                                                       current_height_);
+      }
+    } else {
+      // todo: implement here.
+      LINUXES_LOG(ERROR) << "Not supported specific surface size.";
+    }
+
+    if (is_pending_cursor_add_event_) {
+      native_window_->ShowCursor(pointer_x_, pointer_y_);
+      is_pending_cursor_add_event_ = false;
+    }
+  }
+
   static constexpr libinput_interface kLibinputInterface = {
       .open_restricted = [](const char* path, int flags,
                             void* user_data) -> int {
@@ -199,8 +295,57 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
       .close_restricted = [](int fd, void* user_data) -> void { close(fd); },
   };
 
+  // An input event read from libinput, which can be handed to the platform
+  // thread after the libinput event has been destroyed.
+  struct InputRecord {
+    enum class Type : uint8_t {
+      kDeviceAdded,
+      kDeviceRemoved,
+      kKey,
+      kPointerMotion,
+      kPointerMotionAbsolute,
+      kPointerButton,
+      kPointerAxis,
+      kTouchDown,
+      kTouchUp,
+      kTouchMotion,
+      kTouchCancel,
+      kTouchFrame,
+      // The end of the events which were read at once.
+      kFrame,
+    };
+
+    Type type;
+
+    // The time at which the kernel received the event, in microseconds on
+    // CLOCK_MONOTONIC.
+    uint64_t time_usec;
+
+    // The key, the button or the scroll axis, or the capabilities of a device
+    // as kDeviceHasTouch and kDeviceHasPointer bits.
+    uint32_t code;
+
+    // The state of a key or a button, the seat slot of a touch point, or the
+    // touch count of a device.
+    int32_t value;
+
+    // The motion of a relative pointer, or the position of an absolute
+    // pointer or a touch point as a fraction of the display size. |x| is also
+    // the value of a scroll.
+    double x;
+    double y;
+  };
+
+  static constexpr uint32_t kDeviceHasTouch = 1 << 0;
+  static constexpr uint32_t kDeviceHasPointer = 1 << 1;
+
+  // The number of records which can wait for the platform thread. The input
+  // thread stops reading libinput when they are all used.
+  static constexpr size_t kInputRecordCapacity = 1024;
+
   static int OnLibinputEvent(sd_event_source* source, int fd, uint32_t revents,
                              void* data) {
+    LINUXES_TRACE_EVENT("LinuxesWindowDrm::OnLibinputEvent");
     auto self = reinterpret_cast<LinuxesWindowDrm*>(data);
     auto ret = libinput_dispatch(self->libinput_);
     if (ret < 0) {
@@ -211,230 +356,291 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
     auto previous_pointer_x = self->pointer_x_;
     auto previous_pointer_y = self->pointer_y_;
 
-    while (libinput_next_event_type(self->libinput_) != LIBINPUT_EVENT_NONE) {
-      auto event = libinput_get_event(self->libinput_);
-      auto event_type = libinput_event_get_type(event);
-
-      switch (event_type) {
-        case LIBINPUT_EVENT_DEVICE_ADDED:
-          self->OnDeviceAdded(event);
-          break;
-        case LIBINPUT_EVENT_DEVICE_REMOVED:
-          self->OnDeviceRemoved(event);
-          break;
-        case LIBINPUT_EVENT_KEYBOARD_KEY:
-          self->OnKeyEvent(event);
-          break;
-        case LIBINPUT_EVENT_POINTER_MOTION:
-          self->OnPointerMotion(event);
-          break;
-        case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-          self->OnPointerMotionAbsolute(event);
-          break;
-        case LIBINPUT_EVENT_POINTER_BUTTON:
-          self->OnPointerButton(event);
-          break;
-        case LIBINPUT_EVENT_POINTER_AXIS:
-          self->OnPointerAxis(event);
-          break;
-        case LIBINPUT_EVENT_TOUCH_DOWN:
-          self->OnTouchDown(event);
-          break;
-        case LIBINPUT_EVENT_TOUCH_UP:
-          self->OnTouchUp(event);
-          break;
-        case LIBINPUT_EVENT_TOUCH_MOTION:
-          self->OnTouchMotion(event);
-          break;
-        case LIBINPUT_EVENT_TOUCH_CANCEL:
-          self->OnTouchCancel(event);
-          break;
-        case LIBINPUT_EVENT_TOUCH_FRAME:
-          // do nothing.
-          break;
-        default:
-          break;
+    while (auto event = libinput_get_event(self->libinput_)) {
+      InputRecord record;
+      if (ReadInputEvent(event, &record)) {
+        self->HandleInputRecord(record);
       }
       libinput_event_destroy(event);
     }
 
-    if (self->show_cursor_ && ((self->pointer_x_ != previous_pointer_x) ||
-                               (self->pointer_y_ != previous_pointer_y))) {
-      self->native_window_->MoveCursor(self->pointer_x_, self->pointer_y_);
-    }
-
+    self->OnInputFrame(previous_pointer_x, previous_pointer_y);
     return 0;
   }
 
-  void OnDeviceAdded(libinput_event* event) {
-    auto device = libinput_event_get_device(event);
-    if ((show_cursor_) &&
-        (libinput_device_has_capability(device, LIBINPUT_DEVICE_CAP_POINTER))) {
-      // When launching the application, either route will be used depending on
-      // the timing.
-      if (native_window_) {
-        native_window_->ShowCursor(pointer_x_, pointer_y_);
-      } else {
-        is_pending_cursor_add_event_ = true;
-      }
+  // Starts a thread which reads libinput and hands the events to the platform
+  // thread through |input_records_|. The events are read as soon as they
+  // arrive, even when the platform thread is busy, and they keep the time at
+  // which the kernel received them.
+  bool StartInputThread() {
+    input_wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    input_stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (input_wake_fd_ == -1 || input_stop_fd_ == -1) {
+      LINUXES_LOG(ERROR) << "Failed to create eventfd: " << strerror(errno);
+      CloseInputThreadFds();
+      return false;
     }
-  }
 
-  void OnDeviceRemoved(libinput_event* event) {
-    auto device = libinput_event_get_device(event);
-    if (show_cursor_ &&
-        (libinput_device_has_capability(device, LIBINPUT_DEVICE_CAP_POINTER))) {
-      native_window_->DismissCursor();
+    auto ret = sd_event_add_io(libinput_event_loop_, NULL, input_wake_fd_,
+                               EPOLLIN, OnInputRecordsReady, this);
+    if (ret < 0) {
+      LINUXES_LOG(ERROR) << "Failed to listen for the input thread.";
+      CloseInputThreadFds();
+      return false;
     }
-  }
 
-  void OnKeyEvent(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto key_event = libinput_event_get_keyboard_event(event);
-      auto evdev_keycode =
-          static_cast<uint16_t>(libinput_event_keyboard_get_key(key_event));
-      auto key_state = libinput_event_keyboard_get_key_state(key_event);
-      binding_handler_delegate_->OnKey(evdev_keycode,
-                                       (key_state == LIBINPUT_KEY_STATE_PRESSED)
-                                           ? FLUTTER_LINUXES_BUTTON_DOWN
-                                           : FLUTTER_LINUXES_BUTTON_UP);
-    }
+    input_thread_ = std::thread(&LinuxesWindowDrm::RunInputThread, this);
+    return true;
   }
 
-  void OnPointerMotion(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto pointer_event = libinput_event_get_pointer_event(event);
-      auto dx = libinput_event_pointer_get_dx(pointer_event);
-      auto dy = libinput_event_pointer_get_dy(pointer_event);
-
-      auto new_pointer_x = pointer_x_ + dx;
-      new_pointer_x = std::max(0.0, new_pointer_x);
-      new_pointer_x =
-          std::min(static_cast<double>(current_width_ - 1), new_pointer_x);
-      auto new_pointer_y = pointer_y_ + dy;
-      new_pointer_y = std::max(0.0, new_pointer_y);
-      new_pointer_y =
-          std::min(static_cast<double>(current_height_ - 1), new_pointer_y);
-
-      binding_handler_delegate_->OnPointerMove(new_pointer_x, new_pointer_y);
-      pointer_x_ = new_pointer_x;
-      pointer_y_ = new_pointer_y;
+  void StopInputThread() {
+    if (input_thread_.joinable()) {
+      uint64_t value = 1;
+      if (write(input_stop_fd_, &value, sizeof(value)) == -1) {
+        LINUXES_LOG(ERROR) << "Failed to stop the input thread: "
+                           << strerror(errno);
+      }
+      input_thread_.join();
     }
+    CloseInputThreadFds();
   }
 
-  void OnPointerMotionAbsolute(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto pointer_event = libinput_event_get_pointer_event(event);
-      auto x = libinput_event_pointer_get_absolute_x_transformed(
-          pointer_event, current_width_);
-      auto y = libinput_event_pointer_get_absolute_y_transformed(
-          pointer_event, current_height_);
-
-      binding_handler_delegate_->OnPointerMove(x, y);
-      pointer_x_ = x;
-      pointer_y_ = y;
+  void CloseInputThreadFds() {
+    if (input_wake_fd_ != -1) {
+      close(input_wake_fd_);
+      input_wake_fd_ = -1;
+    }
+    if (input_stop_fd_ != -1) {
+      close(input_stop_fd_);
+      input_stop_fd_ = -1;
     }
   }
 
-  void OnPointerButton(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto pointer_event = libinput_event_get_pointer_event(event);
-      auto button = libinput_event_pointer_get_button(pointer_event);
-      auto state = libinput_event_pointer_get_button_state(pointer_event);
-
-      FlutterPointerMouseButtons flutter_button;
-      switch (button) {
-        case BTN_LEFT:
-          flutter_button = kFlutterPointerButtonMousePrimary;
-          break;
-        case BTN_RIGHT:
-          flutter_button = kFlutterPointerButtonMouseSecondary;
-          break;
-        case BTN_MIDDLE:
-          flutter_button = kFlutterPointerButtonMouseMiddle;
-          break;
-        case BTN_BACK:
-          flutter_button = kFlutterPointerButtonMouseBack;
-          break;
-        case BTN_FORWARD:
-          flutter_button = kFlutterPointerButtonMouseForward;
-          break;
-        default:
-          LINUXES_LOG(ERROR) << "Not expected button input: " << button;
-          return;
+  // The loop of the input thread, which owns |libinput_| until it is stopped.
+  void RunInputThread() {
+    pollfd fds[] = {
+        {libinput_get_fd(libinput_), POLLIN, 0},
+        {input_stop_fd_, POLLIN, 0},
+    };
+    while (true) {
+      if (poll(fds, 2, -1) == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LINUXES_LOG(ERROR) << "Failed to wait for user input: "
+                           << strerror(errno);
+        return;
+      }
+      if (fds[1].revents) {
+        return;
+      }
+      if (libinput_dispatch(libinput_) < 0) {
+        LINUXES_LOG(ERROR) << "Failed to dispatch libinput events.";
+        return;
       }
 
-      if (state == LIBINPUT_BUTTON_STATE_PRESSED) {
-        binding_handler_delegate_->OnPointerDown(pointer_x_, pointer_y_,
-                                                 flutter_button);
-      } else {
-        binding_handler_delegate_->OnPointerUp(pointer_x_, pointer_y_,
-                                               flutter_button);
+      auto has_records = false;
+      while (auto event = libinput_get_event(libinput_)) {
+        InputRecord record;
+        auto is_read = ReadInputEvent(event, &record);
+        libinput_event_destroy(event);
+        if (is_read) {
+          if (!PushInputRecord(record)) {
+            return;
+          }
+          has_records = true;
+        }
+      }
+      if (has_records) {
+        InputRecord frame = {};
+        frame.type = InputRecord::Type::kFrame;
+        if (!PushInputRecord(frame)) {
+          return;
+        }
+        WakePlatformThread();
       }
     }
   }
 
-  void OnPointerAxis(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto pointer_event = libinput_event_get_pointer_event(event);
-      if (libinput_event_pointer_has_axis(
-              pointer_event, LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL)) {
-        ProcessPointerAxis(pointer_event,
-                           LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL);
-      }
-      if (libinput_event_pointer_has_axis(
-              pointer_event, LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL)) {
-        ProcessPointerAxis(pointer_event,
-                           LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL);
+  // Pushes |record| to the platform thread. When it is behind, waits for room
+  // rather than dropping the record, which may be a key or a button release.
+  // Returns false if the thread is stopped meanwhile.
+  bool PushInputRecord(const InputRecord& record) {
+    constexpr int kRetryIntervalMillis = 1;
+    while (!input_records_.Push(record)) {
+      WakePlatformThread();
+      pollfd fd = {input_stop_fd_, POLLIN, 0};
+      if (poll(&fd, 1, kRetryIntervalMillis) > 0) {
+        return false;
       }
     }
+    return true;
   }
 
-  void OnTouchDown(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto touch_event = libinput_event_get_touch_event(event);
-      auto time = libinput_event_touch_get_time(touch_event);
-      auto slot = libinput_event_touch_get_seat_slot(touch_event);
-      auto x =
-          libinput_event_touch_get_x_transformed(touch_event, current_width_);
-      auto y =
-          libinput_event_touch_get_y_transformed(touch_event, current_height_);
-      binding_handler_delegate_->OnTouchDown(time, slot, x, y);
+  void WakePlatformThread() {
+    uint64_t value = 1;
+    if (write(input_wake_fd_, &value, sizeof(value)) == -1 &&
+        errno != EAGAIN) {
+      LINUXES_LOG(ERROR) << "Failed to wake up the platform thread: "
+                         << strerror(errno);
     }
   }
 
-  void OnTouchUp(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto touch_event = libinput_event_get_touch_event(event);
-      auto time = libinput_event_touch_get_time(touch_event);
-      auto slot = libinput_event_touch_get_seat_slot(touch_event);
-      binding_handler_delegate_->OnTouchUp(time, slot);
+  static int OnInputRecordsReady(sd_event_source* source, int fd,
+                                 uint32_t revents, void* data) {
+    LINUXES_TRACE_EVENT("LinuxesWindowDrm::OnInputRecordsReady");
+    auto self = reinterpret_cast<LinuxesWindowDrm*>(data);
+    // Reset the eventfd before popping, so that the records pushed after the
+    // last pop wake up the platform thread again.
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+      LINUXES_LOG(ERROR) << "Failed to read eventfd: " << strerror(errno);
     }
-  }
 
-  void OnTouchMotion(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      auto touch_event = libinput_event_get_touch_event(event);
-      auto time = libinput_event_touch_get_time(touch_event);
-      auto slot = libinput_event_touch_get_seat_slot(touch_event);
-      auto x =
-          libinput_event_touch_get_x_transformed(touch_event, current_width_);
-      auto y =
-          libinput_event_touch_get_y_transformed(touch_event, current_height_);
-      binding_handler_delegate_->OnTouchMotion(time, slot, x, y);
+    auto previous_pointer_x = self->pointer_x_;
+    auto previous_pointer_y = self->pointer_y_;
+    InputRecord record;
+    while (self->input_records_.Pop(&record)) {
+      if (record.type == InputRecord::Type::kFrame) {
+        self->OnInputFrame(previous_pointer_x, previous_pointer_y);
+        previous_pointer_x = self->pointer_x_;
+        previous_pointer_y = self->pointer_y_;
+      } else {
+        self->HandleInputRecord(record);
+      }
     }
+    return 0;
   }
 
-  void OnTouchCancel(libinput_event* event) {
-    if (binding_handler_delegate_) {
-      binding_handler_delegate_->OnTouchCancel();
+  // Converts |event| into |record|. Returns false if the event is not used.
+  // This doesn't touch the state of the window, so that it can be called on
+  // the input thread.
+  static bool ReadInputEvent(libinput_event* event, InputRecord* record) {
+    *record = {};
+    switch (libinput_event_get_type(event)) {
+      case LIBINPUT_EVENT_DEVICE_ADDED: {
+        record->type = InputRecord::Type::kDeviceAdded;
+        auto device = libinput_event_get_device(event);
+        if (libinput_device_has_capability(device, LIBINPUT_DEVICE_CAP_TOUCH)) {
+          record->code |= kDeviceHasTouch;
+          // Returns 0 if the count is unknown, or -1 on error.
+          record->value =
+              std::max(libinput_device_touch_get_touch_count(device), 0);
+        }
+        if (libinput_device_has_capability(device,
+                                           LIBINPUT_DEVICE_CAP_POINTER)) {
+          record->code |= kDeviceHasPointer;
+        }
+        return true;
+      }
+      case LIBINPUT_EVENT_DEVICE_REMOVED: {
+        record->type = InputRecord::Type::kDeviceRemoved;
+        auto device = libinput_event_get_device(event);
+        if (libinput_device_has_capability(device, LIBINPUT_DEVICE_CAP_TOUCH)) {
+          record->code |= kDeviceHasTouch;
+          record->value =
+              std::max(libinput_device_touch_get_touch_count(device), 0);
+        }
+        if (libinput_device_has_capability(device,
+                                           LIBINPUT_DEVICE_CAP_POINTER)) {
+          record->code |= kDeviceHasPointer;
+        }
+        return true;
+      }
+      case LIBINPUT_EVENT_KEYBOARD_KEY: {
+        auto key_event = libinput_event_get_keyboard_event(event);
+        record->type = InputRecord::Type::kKey;
+        record->time_usec = libinput_event_keyboard_get_time_usec(key_event);
+        record->code = libinput_event_keyboard_get_key(key_event);
+        record->value = libinput_event_keyboard_get_key_state(key_event) ==
+                                LIBINPUT_KEY_STATE_PRESSED
+                            ? FLUTTER_LINUXES_BUTTON_DOWN
+                            : FLUTTER_LINUXES_BUTTON_UP;
+        return true;
+      }
+      case LIBINPUT_EVENT_POINTER_MOTION: {
+        auto pointer_event = libinput_event_get_pointer_event(event);
+        record->type = InputRecord::Type::kPointerMotion;
+        record->time_usec = libinput_event_pointer_get_time_usec(pointer_event);
+        record->x = libinput_event_pointer_get_dx(pointer_event);
+        record->y = libinput_event_pointer_get_dy(pointer_event);
+        return true;
+      }
+      case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: {
+        auto pointer_event = libinput_event_get_pointer_event(event);
+        record->type = InputRecord::Type::kPointerMotionAbsolute;
+        record->time_usec = libinput_event_pointer_get_time_usec(pointer_event);
+        record->x =
+            libinput_event_pointer_get_absolute_x_transformed(pointer_event, 1);
+        record->y =
+            libinput_event_pointer_get_absolute_y_transformed(pointer_event, 1);
+        return true;
+      }
+      case LIBINPUT_EVENT_POINTER_BUTTON: {
+        auto pointer_event = libinput_event_get_pointer_event(event);
+        record->type = InputRecord::Type::kPointerButton;
+        record->time_usec = libinput_event_pointer_get_time_usec(pointer_event);
+        record->code = libinput_event_pointer_get_button(pointer_event);
+        record->value = libinput_event_pointer_get_button_state(
+                            pointer_event) == LIBINPUT_BUTTON_STATE_PRESSED
+                            ? FLUTTER_LINUXES_BUTTON_DOWN
+                            : FLUTTER_LINUXES_BUTTON_UP;
+        return true;
+      }
+      case LIBINPUT_EVENT_POINTER_AXIS: {
+        // The event is split into one record per axis.
+        auto pointer_event = libinput_event_get_pointer_event(event);
+        record->type = InputRecord::Type::kPointerAxis;
+        record->time_usec = libinput_event_pointer_get_time_usec(pointer_event);
+        auto has_value = false;
+        for (auto axis : {LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL,
+                          LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL}) {
+          double value;
+          if (libinput_event_pointer_has_axis(pointer_event, axis) &&
+              ReadPointerAxis(pointer_event, axis, &value)) {
+            (axis == LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL ? record->y
+                                                           : record->x) =
+                value;
+            has_value = true;
+          }
+        }
+        return has_value;
+      }
+      case LIBINPUT_EVENT_TOUCH_DOWN:
+      case LIBINPUT_EVENT_TOUCH_MOTION: {
+        auto touch_event = libinput_event_get_touch_event(event);
+        record->type = libinput_event_get_type(event) ==
+                               LIBINPUT_EVENT_TOUCH_DOWN
+                           ? InputRecord::Type::kTouchDown
+                           : InputRecord::Type::kTouchMotion;
+        record->time_usec = libinput_event_touch_get_time_usec(touch_event);
+        record->value = libinput_event_touch_get_seat_slot(touch_event);
+        record->x = libinput_event_touch_get_x_transformed(touch_event, 1);
+        record->y = libinput_event_touch_get_y_transformed(touch_event, 1);
+        return true;
+      }
+      case LIBINPUT_EVENT_TOUCH_UP: {
+        auto touch_event = libinput_event_get_touch_event(event);
+        record->type = InputRecord::Type::kTouchUp;
+        record->time_usec = libinput_event_touch_get_time_usec(touch_event);
+        record->value = libinput_event_touch_get_seat_slot(touch_event);
+        return true;
+      }
+      case LIBINPUT_EVENT_TOUCH_CANCEL:
+        record->type = InputRecord::Type::kTouchCancel;
+        return true;
+      case LIBINPUT_EVENT_TOUCH_FRAME:
+        record->type = InputRecord::Type::kTouchFrame;
+        return true;
+      default:
+        return false;
     }
   }
 
-  void ProcessPointerAxis(libinput_event_pointer* pointer_event,
-                          libinput_pointer_axis axis) {
+  // Returns the scroll value of |axis| in |value|.
+  static bool ReadPointerAxis(libinput_event_pointer* pointer_event,
+                              libinput_pointer_axis axis, double* value) {
     auto source = libinput_event_pointer_get_axis_source(pointer_event);
-    double value = 0.0;
     switch (source) {
       case LIBINPUT_POINTER_AXIS_SOURCE_WHEEL:
         /* libinput < 0.8 sent wheel click events with value 10. Since 0.8
@@ -442,24 +648,176 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
            backwards-compat with existing clients, we just send multiples of
            the click count.
          */
-        value = 10 * libinput_event_pointer_get_axis_value_discrete(
-                         pointer_event, axis);
-        break;
+        *value = 10 * libinput_event_pointer_get_axis_value_discrete(
+                          pointer_event, axis);
+        return true;
       case LIBINPUT_POINTER_AXIS_SOURCE_FINGER:
       case LIBINPUT_POINTER_AXIS_SOURCE_CONTINUOUS:
-        value = libinput_event_pointer_get_axis_value(pointer_event, axis);
-        break;
+        *value = libinput_event_pointer_get_axis_value(pointer_event, axis);
+        return true;
       default:
         LINUXES_LOG(ERROR) << "Not expected axis source: " << source;
+        return false;
+    }
+  }
+
+  // Applies |record| to the window and sends it to the view. This must be
+  // called on the platform thread.
+  void HandleInputRecord(const InputRecord& record) {
+    switch (record.type) {
+      case InputRecord::Type::kDeviceAdded:
+        OnDeviceAdded(record);
+        return;
+      case InputRecord::Type::kDeviceRemoved:
+        OnDeviceRemoved(record);
         return;
+      default:
+        break;
     }
 
-    constexpr int32_t kScrollOffsetMultiplier = 20;
-    binding_handler_delegate_->OnScroll(
-        pointer_x_, pointer_y_,
-        axis == LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL ? 0 : value,
-        axis == LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL ? value : 0,
-        kScrollOffsetMultiplier);
+    if (!binding_handler_delegate_) {
+      return;
+    }
+    if (record.time_usec != 0) {
+      binding_handler_delegate_->OnInputTimestamp(record.time_usec);
+    }
+    // The windows give touch times in milliseconds.
+    auto touch_time = static_cast<uint32_t>(record.time_usec / 1000);
+    switch (record.type) {
+      case InputRecord::Type::kKey:
+        binding_handler_delegate_->OnKey(record.code, record.value);
+        break;
+      case InputRecord::Type::kPointerMotion:
+        OnPointerMotion(record);
+        break;
+      case InputRecord::Type::kPointerMotionAbsolute:
+        pointer_x_ = record.x * current_width_;
+        pointer_y_ = record.y * current_height_;
+        binding_handler_delegate_->OnPointerMove(pointer_x_, pointer_y_);
+        break;
+      case InputRecord::Type::kPointerButton:
+        OnPointerButton(record);
+        break;
+      case InputRecord::Type::kPointerAxis: {
+        constexpr int32_t kScrollOffsetMultiplier = 20;
+        binding_handler_delegate_->OnScroll(pointer_x_, pointer_y_, record.x,
+                                            record.y, kScrollOffsetMultiplier);
+        break;
+      }
+      case InputRecord::Type::kTouchDown:
+        binding_handler_delegate_->OnTouchDown(touch_time, record.value,
+                                               record.x * current_width_,
+                                               record.y * current_height_);
+        break;
+      case InputRecord::Type::kTouchUp:
+        binding_handler_delegate_->OnTouchUp(touch_time, record.value);
+        break;
+      case InputRecord::Type::kTouchMotion:
+        binding_handler_delegate_->OnTouchMotion(touch_time, record.value,
+                                                 record.x * current_width_,
+                                                 record.y * current_height_);
+        break;
+      case InputRecord::Type::kTouchCancel:
+        binding_handler_delegate_->OnTouchCancel();
+        break;
+      case InputRecord::Type::kTouchFrame:
+        binding_handler_delegate_->OnTouchFrame();
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Ends the input frame of the events which were read at once, and moves the
+  // cursor if the pointer has moved from (|previous_pointer_x|,
+  // |previous_pointer_y|).
+  void OnInputFrame(double previous_pointer_x, double previous_pointer_y) {
+    // libinput has no pointer frames, so the events read at once make up one.
+    if (binding_handler_delegate_) {
+      binding_handler_delegate_->OnPointerFrame();
+    }
+
+    if (show_cursor_ && ((pointer_x_ != previous_pointer_x) ||
+                         (pointer_y_ != previous_pointer_y))) {
+      native_window_->MoveCursor(pointer_x_, pointer_y_);
+    }
+  }
+
+  void OnDeviceAdded(const InputRecord& record) {
+    if (record.code & kDeviceHasTouch) {
+      // Seat slots are numbered across all the touch devices of the seat.
+      touch_count_ += record.value;
+      if (binding_handler_delegate_) {
+        binding_handler_delegate_->OnTouchDeviceAdded(touch_count_);
+      }
+    }
+    if (show_cursor_ && (record.code & kDeviceHasPointer)) {
+      // When launching the application, either route will be used depending on
+      // the timing.
+      if (native_window_) {
+        native_window_->ShowCursor(pointer_x_, pointer_y_);
+      } else {
+        is_pending_cursor_add_event_ = true;
+      }
+    }
+  }
+
+  void OnDeviceRemoved(const InputRecord& record) {
+    if (record.code & kDeviceHasTouch) {
+      // The view keeps the slots it has reserved, so that a device which is
+      // plugged in again doesn't make it reserve more.
+      touch_count_ = std::max(touch_count_ - record.value, 0);
+    }
+    if (show_cursor_ && (record.code & kDeviceHasPointer)) {
+      native_window_->DismissCursor();
+    }
+  }
+
+  void OnPointerMotion(const InputRecord& record) {
+    auto new_pointer_x = pointer_x_ + record.x;
+    new_pointer_x = std::max(0.0, new_pointer_x);
+    new_pointer_x =
+        std::min(static_cast<double>(current_width_ - 1), new_pointer_x);
+    auto new_pointer_y = pointer_y_ + record.y;
+    new_pointer_y = std::max(0.0, new_pointer_y);
+    new_pointer_y =
+        std::min(static_cast<double>(current_height_ - 1), new_pointer_y);
+
+    binding_handler_delegate_->OnPointerMove(new_pointer_x, new_pointer_y);
+    pointer_x_ = new_pointer_x;
+    pointer_y_ = new_pointer_y;
+  }
+
+  void OnPointerButton(const InputRecord& record) {
+    FlutterPointerMouseButtons flutter_button;
+    switch (record.code) {
+      case BTN_LEFT:
+        flutter_button = kFlutterPointerButtonMousePrimary;
+        break;
+      case BTN_RIGHT:
+        flutter_button = kFlutterPointerButtonMouseSecondary;
+        break;
+      case BTN_MIDDLE:
+        flutter_button = kFlutterPointerButtonMouseMiddle;
+        break;
+      case BTN_BACK:
+        flutter_button = kFlutterPointerButtonMouseBack;
+        break;
+      case BTN_FORWARD:
+        flutter_button = kFlutterPointerButtonMouseForward;
+        break;
+      default:
+        LINUXES_LOG(ERROR) << "Not expected button input: " << record.code;
+        return;
+    }
+
+    if (record.value == FLUTTER_LINUXES_BUTTON_DOWN) {
+      binding_handler_delegate_->OnPointerDown(pointer_x_, pointer_y_,
+                                               flutter_button);
+    } else {
+      binding_handler_delegate_->OnPointerUp(pointer_x_, pointer_y_,
+                                             flutter_button);
+    }
   }
 
   // A pointer to a FlutterWindowsView that can be used to update engine
@@ -468,12 +826,30 @@ class LinuxesWindowDrm : public LinuxesWindow, public WindowBindingHandler {
 
   std::unique_ptr<W> native_window_;
   std::unique_ptr<S> render_surface_;
+  std::unique_ptr<SurfaceSoftwareDrm> software_surface_;
+  std::unique_ptr<LinuxesCompositor> compositor_;
 
   bool display_valid_;
   bool is_pending_cursor_add_event_;
 
   sd_event* libinput_event_loop_;
   libinput* libinput_;
+
+  // The number of touch points all the touch devices can track at once.
+  int32_t touch_count_;
+
+  // Reads libinput if FLUTTER_DRM_INPUT_THREAD is enabled.
+  std::thread input_thread_;
+
+  // Wakes up the platform thread when records have been pushed.
+  int input_wake_fd_;
+
+  // Stops |input_thread_|.
+  int input_stop_fd_;
+
+  // The records which the input thread has read and the platform thread
+  // hasn't handled yet.
+  SpscRingBuffer<InputRecord, kInputRecordCapacity> input_records_;
 };
 
 }  // namespace flutter
@@ -0,0 +1,282 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/window/linuxes_window_headless.h"
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/surface/context_egl_headless.h"
+
+namespace flutter {
+
+namespace {
+// Used when no size is given, e.g. in the fullscreen mode.
+constexpr int32_t kDefaultWidth = 1280;
+constexpr int32_t kDefaultHeight = 720;
+}  // namespace
+
+LinuxesWindowHeadless::LinuxesWindowHeadless(FlutterWindowMode window_mode,
+                                             int32_t width, int32_t height,
+                                             bool show_cursor) {
+  window_mode_ = window_mode;
+  current_width_ = width > 0 ? width : kDefaultWidth;
+  current_height_ = height > 0 ? height : kDefaultHeight;
+  show_cursor_ = show_cursor;
+
+  auto input_file = std::getenv(kHeadlessInputFileEnvironmentKey);
+  if (input_file && input_file[0] != '\0' && LoadReplayEvents(input_file)) {
+    replay_timer_fd_ =
+        timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (replay_timer_fd_ == -1) {
+      LINUXES_LOG(ERROR) << "Failed to create timerfd: " << strerror(errno);
+    }
+  }
+}
+
+LinuxesWindowHeadless::~LinuxesWindowHeadless() {
+  if (replay_timer_fd_ != -1) {
+    close(replay_timer_fd_);
+  }
+}
+
+bool LinuxesWindowHeadless::IsValid() const {
+  if (!native_window_ || !native_window_->IsValid()) {
+    return false;
+  }
+  if (software_surface_) {
+    return true;
+  }
+  return render_surface_ && render_surface_->IsValid();
+}
+
+bool LinuxesWindowHeadless::DispatchEvent() {
+  // There are no window events other than the replayed input.
+  if (replay_timer_fd_ != -1) {
+    DispatchReplayEvents();
+  }
+  return true;
+}
+
+int LinuxesWindowHeadless::GetEventFd() { return replay_timer_fd_; }
+
+bool LinuxesWindowHeadless::CreateRenderSurface(int32_t width,
+                                                int32_t height) {
+  auto context_egl = std::make_unique<ContextEglHeadless>(
+      std::make_unique<EnvironmentEglHeadless>());
+  if (!context_egl->IsValid()) {
+    LINUXES_LOG(ERROR) << "Failed to create the EGL context";
+    return false;
+  }
+
+  native_window_ = std::make_unique<NativeWindowHeadless>(width, height);
+  if (!native_window_->IsValid()) {
+    LINUXES_LOG(ERROR) << "Failed to create the native window";
+    return false;
+  }
+
+  render_surface_ = std::make_unique<SurfaceGlHeadless>(std::move(context_egl));
+  return render_surface_->SetNativeWindow(native_window_.get());
+}
+
+bool LinuxesWindowHeadless::CreateSoftwareRenderSurface(int32_t width,
+                                                        int32_t height) {
+  native_window_ = std::make_unique<NativeWindowHeadless>(width, height);
+  if (!native_window_->IsValid()) {
+    LINUXES_LOG(ERROR) << "Failed to create the native window";
+    return false;
+  }
+
+  software_surface_ =
+      std::make_unique<SurfaceSoftwareHeadless>(native_window_.get());
+  return true;
+}
+
+void LinuxesWindowHeadless::DestroyRenderSurface() {
+  software_surface_ = nullptr;
+  render_surface_ = nullptr;
+  native_window_ = nullptr;
+}
+
+void LinuxesWindowHeadless::SetView(WindowBindingHandlerDelegate* window) {
+  binding_handler_delegate_ = window;
+  if (binding_handler_delegate_ && replay_timer_fd_ != -1) {
+    replay_start_time_ = std::chrono::steady_clock::now().time_since_epoch();
+    next_replay_event_ = 0;
+    ArmReplayTimer();
+  }
+}
+
+LinuxesRenderSurfaceTarget* LinuxesWindowHeadless::GetRenderSurfaceTarget()
+    const {
+  return render_surface_.get();
+}
+
+SurfaceSoftware* LinuxesWindowHeadless::GetSoftwareRenderSurface() const {
+  return software_surface_.get();
+}
+
+LinuxesCompositor* LinuxesWindowHeadless::GetCompositor() const {
+  return nullptr;
+}
+
+double LinuxesWindowHeadless::GetDpiScale() { return current_scale_; }
+
+PhysicalWindowBounds LinuxesWindowHeadless::GetPhysicalWindowBounds() {
+  return {GetCurrentWidth(), GetCurrentHeight()};
+}
+
+void LinuxesWindowHeadless::UpdateFlutterCursor(
+    const std::string& cursor_name) {
+  // There is no cursor.
+}
+
+void LinuxesWindowHeadless::UpdateVirtualKeyboardStatus(const bool show) {
+  // There is no virtual keyboard.
+}
+
+std::string LinuxesWindowHeadless::GetClipboardData() {
+  return clipboard_data_;
+}
+
+void LinuxesWindowHeadless::SetClipboardData(const std::string& data) {
+  clipboard_data_ = data;
+}
+
+bool LinuxesWindowHeadless::LoadReplayEvents(const char* filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    LINUXES_LOG(ERROR) << "Failed to open " << filename;
+    return false;
+  }
+
+  std::string line;
+  for (int line_number = 1; std::getline(file, line); line_number++) {
+    std::istringstream stream(line);
+    double time_millis;
+    std::string type;
+    if (!(stream >> time_millis)) {
+      // An empty line or a comment.
+      continue;
+    }
+
+    ReplayEvent event = {};
+    event.time = std::chrono::nanoseconds(
+        static_cast<int64_t>(time_millis * 1000000));
+    auto is_valid = false;
+    if (stream >> type) {
+      if (type == "move" || type == "down" || type == "up") {
+        event.type = type == "move"   ? ReplayEvent::Type::kPointerMove
+                     : type == "down" ? ReplayEvent::Type::kPointerDown
+                                      : ReplayEvent::Type::kPointerUp;
+        is_valid = static_cast<bool>(stream >> event.x >> event.y);
+      } else if (type == "touch_down" || type == "touch_move") {
+        event.type = type == "touch_down" ? ReplayEvent::Type::kTouchDown
+                                          : ReplayEvent::Type::kTouchMotion;
+        is_valid = static_cast<bool>(stream >> event.id >> event.x >> event.y);
+      } else if (type == "touch_up") {
+        event.type = ReplayEvent::Type::kTouchUp;
+        is_valid = static_cast<bool>(stream >> event.id);
+      }
+    }
+    if (!is_valid) {
+      LINUXES_LOG(ERROR) << filename << ":" << line_number
+                         << ": Invalid input event: " << line;
+      return false;
+    }
+    replay_events_.push_back(event);
+  }
+
+  std::stable_sort(replay_events_.begin(), replay_events_.end(),
+                   [](const ReplayEvent& a, const ReplayEvent& b) {
+                     return a.time < b.time;
+                   });
+  LINUXES_LOG(INFO) << "Replay " << replay_events_.size()
+                    << " input events from " << filename;
+  return !replay_events_.empty();
+}
+
+void LinuxesWindowHeadless::ArmReplayTimer() {
+  if (next_replay_event_ >= replay_events_.size()) {
+    return;
+  }
+
+  auto due_time = replay_start_time_ + replay_events_[next_replay_event_].time;
+  itimerspec spec = {};
+  spec.it_value.tv_sec =
+      std::chrono::duration_cast<std::chrono::seconds>(due_time).count();
+  spec.it_value.tv_nsec = (due_time % std::chrono::seconds(1)).count();
+  // A zero time would disarm the timer.
+  if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+    spec.it_value.tv_nsec = 1;
+  }
+  if (timerfd_settime(replay_timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) ==
+      -1) {
+    LINUXES_LOG(ERROR) << "Failed to arm timerfd: " << strerror(errno);
+  }
+}
+
+void LinuxesWindowHeadless::DispatchReplayEvents() {
+  uint64_t expirations;
+  if (read(replay_timer_fd_, &expirations, sizeof(expirations)) == -1) {
+    // The timer hasn't expired, e.g. woken up by another file descriptor.
+    return;
+  }
+  if (!binding_handler_delegate_) {
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  while (next_replay_event_ < replay_events_.size()) {
+    const auto& event = replay_events_[next_replay_event_];
+    auto due_time = replay_start_time_ + event.time;
+    if (due_time > now) {
+      break;
+    }
+    next_replay_event_++;
+
+    binding_handler_delegate_->OnInputTimestamp(
+        std::chrono::duration_cast<std::chrono::microseconds>(due_time)
+            .count());
+    auto time_millis = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(due_time)
+            .count());
+    switch (event.type) {
+      case ReplayEvent::Type::kPointerMove:
+        binding_handler_delegate_->OnPointerMove(event.x, event.y);
+        break;
+      case ReplayEvent::Type::kPointerDown:
+        binding_handler_delegate_->OnPointerDown(
+            event.x, event.y, kFlutterPointerButtonMousePrimary);
+        break;
+      case ReplayEvent::Type::kPointerUp:
+        binding_handler_delegate_->OnPointerUp(
+            event.x, event.y, kFlutterPointerButtonMousePrimary);
+        break;
+      case ReplayEvent::Type::kTouchDown:
+        binding_handler_delegate_->OnTouchDown(time_millis, event.id, event.x,
+                                               event.y);
+        break;
+      case ReplayEvent::Type::kTouchMotion:
+        binding_handler_delegate_->OnTouchMotion(time_millis, event.id,
+                                                 event.x, event.y);
+        break;
+      case ReplayEvent::Type::kTouchUp:
+        binding_handler_delegate_->OnTouchUp(time_millis, event.id);
+        break;
+    }
+  }
+  ArmReplayTimer();
+}
+
+}  // namespace flutter
@@ -0,0 +1,148 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_LINUXES_WINDOW_HEADLESS_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_LINUXES_WINDOW_HEADLESS_H_
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_headless.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_headless.h"
+#include "flutter/shell/platform/linux_embedded/window/linuxes_window.h"
+#include "flutter/shell/platform/linux_embedded/window/native_window_headless.h"
+#include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
+
+namespace flutter {
+
+// The environment variable which names a file of input events to replay, see
+// LinuxesWindowHeadless::LoadReplayEvents().
+constexpr char kHeadlessInputFileEnvironmentKey[] =
+    "FLUTTER_HEADLESS_INPUT_FILE";
+
+// A window without any display or input devices, for running Flutter apps in
+// CI or on servers. Input events can be replayed from a file.
+class LinuxesWindowHeadless : public LinuxesWindow,
+                              public WindowBindingHandler {
+ public:
+  LinuxesWindowHeadless(FlutterWindowMode window_mode, int32_t width,
+                        int32_t height, bool show_cursor);
+  ~LinuxesWindowHeadless();
+
+  // |LinuxesWindow|
+  bool IsValid() const override;
+
+  // |FlutterWindowBindingHandler|
+  bool DispatchEvent() override;
+
+  // |FlutterWindowBindingHandler|
+  int GetEventFd() override;
+
+  // |FlutterWindowBindingHandler|
+  bool CreateRenderSurface(int32_t width, int32_t height) override;
+
+  // |FlutterWindowBindingHandler|
+  bool CreateSoftwareRenderSurface(int32_t width, int32_t height) override;
+
+  // |FlutterWindowBindingHandler|
+  void DestroyRenderSurface() override;
+
+  // |FlutterWindowBindingHandler|
+  void SetView(WindowBindingHandlerDelegate* view) override;
+
+  // |FlutterWindowBindingHandler|
+  LinuxesRenderSurfaceTarget* GetRenderSurfaceTarget() const override;
+
+  // |FlutterWindowBindingHandler|
+  SurfaceSoftware* GetSoftwareRenderSurface() const override;
+
+  // |FlutterWindowBindingHandler|
+  LinuxesCompositor* GetCompositor() const override;
+
+  // |FlutterWindowBindingHandler|
+  double GetDpiScale() override;
+
+  // |FlutterWindowBindingHandler|
+  PhysicalWindowBounds GetPhysicalWindowBounds() override;
+
+  // |FlutterWindowBindingHandler|
+  void UpdateFlutterCursor(const std::string& cursor_name) override;
+
+  // |FlutterWindowBindingHandler|
+  void UpdateVirtualKeyboardStatus(const bool show) override;
+
+  // |FlutterWindowBindingHandler|
+  std::string GetClipboardData() override;
+
+  // |FlutterWindowBindingHandler|
+  void SetClipboardData(const std::string& data) override;
+
+ private:
+  // An input event replayed from a file.
+  struct ReplayEvent {
+    enum class Type {
+      kPointerMove,
+      kPointerDown,
+      kPointerUp,
+      kTouchDown,
+      kTouchMotion,
+      kTouchUp,
+    };
+
+    Type type;
+
+    // The time of the event from the start of the replay.
+    std::chrono::nanoseconds time;
+
+    // The id of a touch point.
+    int32_t id;
+
+    double x;
+    double y;
+  };
+
+  // Loads the events to replay from |filename|. Each line is an event of the
+  // form "<time in milliseconds> <type> <arguments>", where the type and the
+  // arguments are one of:
+  //   move <x> <y>
+  //   down <x> <y>  (the primary mouse button)
+  //   up <x> <y>
+  //   touch_down <id> <x> <y>
+  //   touch_move <id> <x> <y>
+  //   touch_up <id>
+  // The times are relative to the creation of the view. Empty lines and lines
+  // starting with '#' are ignored.
+  bool LoadReplayEvents(const char* filename);
+
+  // Arms |replay_timer_fd_| to expire at the time of the next event.
+  void ArmReplayTimer();
+
+  // Sends the events which are due to the view. Each event is stamped with
+  // the time at which it was due, so that the delay of the platform thread is
+  // included in the input latency.
+  void DispatchReplayEvents();
+
+  // A pointer to a FlutterWindowsView that can be used to update engine
+  // windowing and input state.
+  WindowBindingHandlerDelegate* binding_handler_delegate_ = nullptr;
+
+  std::unique_ptr<NativeWindowHeadless> native_window_;
+  std::unique_ptr<SurfaceGlHeadless> render_surface_;
+  std::unique_ptr<SurfaceSoftwareHeadless> software_surface_;
+
+  // The events to replay, in the order of their times.
+  std::vector<ReplayEvent> replay_events_;
+  size_t next_replay_event_ = 0;
+
+  // The monotonic time at which the replay has started.
+  std::chrono::nanoseconds replay_start_time_{0};
+
+  // Expires when the next event is due.
+  int replay_timer_fd_ = -1;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_LINUXES_WINDOW_HEADLESS_H_
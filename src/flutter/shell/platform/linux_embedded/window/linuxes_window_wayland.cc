@@ -4,8 +4,11 @@
 
 #include "flutter/shell/platform/linux_embedded/window/linuxes_window_wayland.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <linux/input-event-codes.h>
+#include <poll.h>
+#include <time.h>
 #include <unistd.h>
 #include <xkbcommon/xkbcommon-keysyms.h>
 
@@ -14,6 +17,7 @@
 
 #include "flutter/shell/platform/linux_embedded/logger.h"
 #include "flutter/shell/platform/linux_embedded/surface/context_egl.h"
+#include "flutter/shell/platform/linux_embedded/trace_event.h"
 
 namespace flutter {
 
@@ -36,6 +40,14 @@ constexpr char kWlCursorThemeHand1[] = "hand1";
 constexpr char kWlCursorThemeWatch[] = "watch";
 constexpr char kCursorNameNone[] = "none";
 
+constexpr uint64_t kNanosecondsPerSecond = 1000000000;
+
+uint64_t GetMonotonicTimeNanos() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * kNanosecondsPerSecond + ts.tv_nsec;
+}
+
 constexpr char kClipboardMimeTypeText[] = "text/plain";
 }  // namespace
 
@@ -94,12 +106,14 @@ const wl_seat_listener LinuxesWindowWayland::kWlSeatListener = {
         self->wl_keyboard_ = nullptr;
       }
     },
+    .name = [](void* data, wl_seat* wl_seat, const char* name) -> void {},
 };
 
 const wl_pointer_listener LinuxesWindowWayland::kWlPointerListener = {
     .enter = [](void* data, wl_pointer* wl_pointer, uint32_t serial,
                 wl_surface* surface, wl_fixed_t surface_x,
                 wl_fixed_t surface_y) -> void {
+      LINUXES_TRACE_EVENT("wl_pointer.enter");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       self->serial_ = serial;
       if (self->show_cursor_) {
@@ -117,6 +131,7 @@ const wl_pointer_listener LinuxesWindowWayland::kWlPointerListener = {
     },
     .leave = [](void* data, wl_pointer* pointer, uint32_t serial,
                 wl_surface* surface) -> void {
+      LINUXES_TRACE_EVENT("wl_pointer.leave");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       self->serial_ = serial;
       if (self->binding_handler_delegate_) {
@@ -127,6 +142,7 @@ const wl_pointer_listener LinuxesWindowWayland::kWlPointerListener = {
     },
     .motion = [](void* data, wl_pointer* pointer, uint32_t time,
                  wl_fixed_t surface_x, wl_fixed_t surface_y) -> void {
+      LINUXES_TRACE_EVENT("wl_pointer.motion");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       if (self->binding_handler_delegate_) {
         double x = wl_fixed_to_double(surface_x);
@@ -138,6 +154,7 @@ const wl_pointer_listener LinuxesWindowWayland::kWlPointerListener = {
     },
     .button = [](void* data, wl_pointer* pointer, uint32_t serial,
                  uint32_t time, uint32_t button, uint32_t status) -> void {
+      LINUXES_TRACE_EVENT("wl_pointer.button");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       self->serial_ = serial;
       if (self->binding_handler_delegate_) {
@@ -174,6 +191,7 @@ const wl_pointer_listener LinuxesWindowWayland::kWlPointerListener = {
     },
     .axis = [](void* data, wl_pointer* wl_pointer, uint32_t time, uint32_t axis,
                wl_fixed_t value) -> void {
+      LINUXES_TRACE_EVENT("wl_pointer.axis");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       if (self->binding_handler_delegate_) {
         double delta = wl_fixed_to_double(value);
@@ -185,12 +203,25 @@ const wl_pointer_listener LinuxesWindowWayland::kWlPointerListener = {
             kScrollOffsetMultiplier);
       }
     },
+    .frame = [](void* data, wl_pointer* wl_pointer) -> void {
+      auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
+      if (self->binding_handler_delegate_) {
+        self->binding_handler_delegate_->OnPointerFrame();
+      }
+    },
+    .axis_source = [](void* data, wl_pointer* wl_pointer,
+                      uint32_t axis_source) -> void {},
+    .axis_stop = [](void* data, wl_pointer* wl_pointer, uint32_t time,
+                    uint32_t axis) -> void {},
+    .axis_discrete = [](void* data, wl_pointer* wl_pointer, uint32_t axis,
+                        int32_t discrete) -> void {},
 };  // namespace flutter
 
 const wl_touch_listener LinuxesWindowWayland::kWlTouchListener = {
     .down = [](void* data, wl_touch* wl_touch, uint32_t serial, uint32_t time,
                wl_surface* surface, int32_t id, wl_fixed_t surface_x,
                wl_fixed_t surface_y) -> void {
+      LINUXES_TRACE_EVENT("wl_touch.down");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       self->serial_ = serial;
       if (self->binding_handler_delegate_) {
@@ -201,6 +232,7 @@ const wl_touch_listener LinuxesWindowWayland::kWlTouchListener = {
     },
     .up = [](void* data, wl_touch* wl_touch, uint32_t serial, uint32_t time,
              int32_t id) -> void {
+      LINUXES_TRACE_EVENT("wl_touch.up");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       self->serial_ = serial;
       if (self->binding_handler_delegate_) {
@@ -209,6 +241,7 @@ const wl_touch_listener LinuxesWindowWayland::kWlTouchListener = {
     },
     .motion = [](void* data, wl_touch* wl_touch, uint32_t time, int32_t id,
                  wl_fixed_t surface_x, wl_fixed_t surface_y) -> void {
+      LINUXES_TRACE_EVENT("wl_touch.motion");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       if (self->binding_handler_delegate_) {
         double x = wl_fixed_to_double(surface_x);
@@ -216,8 +249,14 @@ const wl_touch_listener LinuxesWindowWayland::kWlTouchListener = {
         self->binding_handler_delegate_->OnTouchMotion(time, id, x, y);
       }
     },
-    .frame = [](void* data, wl_touch* wl_touch) -> void {},
+    .frame = [](void* data, wl_touch* wl_touch) -> void {
+      auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
+      if (self->binding_handler_delegate_) {
+        self->binding_handler_delegate_->OnTouchFrame();
+      }
+    },
     .cancel = [](void* data, wl_touch* wl_touch) -> void {
+      LINUXES_TRACE_EVENT("wl_touch.cancel");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       if (self->binding_handler_delegate_) {
         self->binding_handler_delegate_->OnTouchCancel();
@@ -246,6 +285,7 @@ const wl_keyboard_listener LinuxesWindowWayland::kWlKeyboardListener = {
     },
     .key = [](void* data, wl_keyboard* wl_keyboard, uint32_t serial,
               uint32_t time, uint32_t key, uint32_t state) -> void {
+      LINUXES_TRACE_EVENT("wl_keyboard.key");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       self->serial_ = serial;
       if (self->binding_handler_delegate_) {
@@ -258,6 +298,7 @@ const wl_keyboard_listener LinuxesWindowWayland::kWlKeyboardListener = {
     .modifiers = [](void* data, wl_keyboard* wl_keyboard, uint32_t serial,
                     uint32_t mods_depressed, uint32_t mods_latched,
                     uint32_t mods_locked, uint32_t group) -> void {
+      LINUXES_TRACE_EVENT("wl_keyboard.modifiers");
       auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
       if (self->binding_handler_delegate_) {
         self->binding_handler_delegate_->OnKeyModifiers(
@@ -279,6 +320,10 @@ const wl_output_listener LinuxesWindowWayland::kWlOutputListener = {
       if (flags & WL_OUTPUT_MODE_CURRENT) {
         LINUXES_LOG(INFO) << "Display output resolution: " << width << "x"
                           << height;
+        if (refresh > 0) {
+          // The refresh rate is in mHz.
+          self->vsync_interval_nanos_ = kNanosecondsPerSecond * 1000 / refresh;
+        }
         if (self->window_mode_ == FlutterWindowMode::kFullscreen) {
           self->current_width_ = width;
           self->current_height_ = height;
@@ -296,6 +341,26 @@ const wl_output_listener LinuxesWindowWayland::kWlOutputListener = {
     },
 };
 
+const wl_callback_listener LinuxesWindowWayland::kWlSurfaceFrameListener = {
+    .done = [](void* data, wl_callback* wl_callback, uint32_t time) -> void {
+      LINUXES_TRACE_EVENT("wl_surface.frame.done");
+      auto self = reinterpret_cast<LinuxesWindowWayland*>(data);
+
+      // |time| has an undefined base, so use the time the frame has been
+      // presented at, which is close enough to the vblank.
+      auto vblank_time_nanos = GetMonotonicTimeNanos();
+
+      wl_callback_destroy(wl_callback);
+      self->wl_frame_callback_ = nullptr;
+      self->RequestFrameCallback();
+
+      if (self->binding_handler_delegate_) {
+        self->binding_handler_delegate_->OnVblank(vblank_time_nanos,
+                                                  self->vsync_interval_nanos_);
+      }
+    },
+};
+
 const zwp_text_input_v1_listener LinuxesWindowWayland::kZwpTextInputV1Listener =
     {
         .enter = [](void* data, zwp_text_input_v1* zwp_text_input_v1,
@@ -467,6 +532,8 @@ LinuxesWindowWayland::LinuxesWindowWayland(FlutterWindowMode window_mode,
       zwp_text_input_v1_(nullptr),
       wl_shm_(nullptr),
       wl_cursor_theme_(nullptr),
+      wl_frame_callback_(nullptr),
+      vsync_interval_nanos_(0),
       wl_data_device_manager_(nullptr),
       wl_data_device_(nullptr),
       wl_data_offer_(nullptr),
@@ -620,6 +687,14 @@ LinuxesRenderSurfaceTarget* LinuxesWindowWayland::GetRenderSurfaceTarget()
   return render_surface_.get();
 }
 
+SurfaceSoftware* LinuxesWindowWayland::GetSoftwareRenderSurface() const {
+  return software_surface_.get();
+}
+
+LinuxesCompositor* LinuxesWindowWayland::GetCompositor() const {
+  return nullptr;
+}
+
 double LinuxesWindowWayland::GetDpiScale() { return current_scale_; }
 
 PhysicalWindowBounds LinuxesWindowWayland::GetPhysicalWindowBounds() {
@@ -632,11 +707,96 @@ bool LinuxesWindowWayland::DispatchEvent() {
     return false;
   }
 
-  // If Wayland compositor (Weston) terminates, -1 is returned.
-  return (wl_display_dispatch(wl_display_) != -1);
+  // Dispatch the events which have already been queued, and then read new
+  // events without blocking. The caller waits on GetEventFd() instead.
+  while (wl_display_prepare_read(wl_display_) != 0) {
+    if (wl_display_dispatch_pending(wl_display_) == -1) {
+      return false;
+    }
+  }
+  if (wl_display_flush(wl_display_) == -1 && errno != EAGAIN) {
+    wl_display_cancel_read(wl_display_);
+    return false;
+  }
+
+  pollfd fds = {wl_display_get_fd(wl_display_), POLLIN, 0};
+  if (poll(&fds, 1, 0) > 0) {
+    // If Wayland compositor (Weston) terminates, -1 is returned.
+    if (wl_display_read_events(wl_display_) == -1) {
+      return false;
+    }
+  } else {
+    wl_display_cancel_read(wl_display_);
+  }
+
+  return (wl_display_dispatch_pending(wl_display_) != -1);
+}
+
+int LinuxesWindowWayland::GetEventFd() {
+  return wl_display_ ? wl_display_get_fd(wl_display_) : -1;
+}
+
+bool LinuxesWindowWayland::PrepareWaitEvent() {
+  // The events which another thread, e.g. the raster thread in
+  // eglSwapBuffers(), has read into the default queue don't make the fd
+  // readable again, so they are dispatched instead of waited for.
+  if (!IsValid() || wl_display_prepare_read(wl_display_) != 0) {
+    return false;
+  }
+  // Send the requests made by the tasks, e.g. the frame callback requested
+  // for the vsync, before sleeping on their replies.
+  if (wl_display_flush(wl_display_) == -1 && errno != EAGAIN) {
+    wl_display_cancel_read(wl_display_);
+    return false;
+  }
+  return true;
+}
+
+void LinuxesWindowWayland::FinishWaitEvent() {
+  pollfd fds = {wl_display_get_fd(wl_display_), POLLIN, 0};
+  if (poll(&fds, 1, 0) > 0) {
+    // Errors are reported by the next DispatchEvent().
+    wl_display_read_events(wl_display_);
+  } else {
+    wl_display_cancel_read(wl_display_);
+  }
 }
 
 bool LinuxesWindowWayland::CreateRenderSurface(int32_t width, int32_t height) {
+  if (!CreateNativeWindow(width, height)) {
+    return false;
+  }
+
+  render_surface_ =
+      std::make_unique<SurfaceGlWayland>(std::make_unique<ContextEgl>(
+          std::make_unique<EnvironmentEgl>(wl_display_)));
+  render_surface_->SetNativeWindow(native_window_.get());
+
+  // The offscreen (resource) surface will not be mapped, but needs to be a
+  // wl_surface because ONLY window EGL surfaces are supported on Wayland.
+  render_surface_->SetNativeWindowResource(
+      std::make_unique<NativeWindowWayland>(wl_compositor_, 1, 1));
+
+  return true;
+}
+
+bool LinuxesWindowWayland::CreateSoftwareRenderSurface(int32_t width,
+                                                       int32_t height) {
+  if (!CreateNativeWindow(width, height)) {
+    return false;
+  }
+
+  software_surface_ = std::make_unique<SurfaceSoftwareWayland>(
+      wl_display_, wl_shm_, native_window_->Surface());
+  if (!software_surface_->IsValid()) {
+    LINUXES_LOG(ERROR) << "Failed to create the software surface";
+    return false;
+  }
+
+  return true;
+}
+
+bool LinuxesWindowWayland::CreateNativeWindow(int32_t width, int32_t height) {
   if (!display_valid_) {
     LINUXES_LOG(ERROR) << "Wayland display is invalid.";
     return false;
@@ -680,24 +840,21 @@ bool LinuxesWindowWayland::CreateRenderSurface(int32_t width, int32_t height) {
   xdg_surface_add_listener(xdg_surface_, &kXdgSurfaceListener, this);
   xdg_toplevel_ = xdg_surface_get_toplevel(xdg_surface_);
   xdg_toplevel_set_title(xdg_toplevel_, "Flutter");
+  RequestFrameCallback();
   wl_surface_commit(native_window_->Surface());
 
-  render_surface_ =
-      std::make_unique<SurfaceGlWayland>(std::make_unique<ContextEgl>(
-          std::make_unique<EnvironmentEgl>(wl_display_)));
-  render_surface_->SetNativeWindow(native_window_.get());
-
-  // The offscreen (resource) surface will not be mapped, but needs to be a
-  // wl_surface because ONLY window EGL surfaces are supported on Wayland.
-  render_surface_->SetNativeWindowResource(
-      std::make_unique<NativeWindowWayland>(wl_compositor_, 1, 1));
-
   return true;
 }
 
 void LinuxesWindowWayland::DestroyRenderSurface() {
+  if (wl_frame_callback_) {
+    wl_callback_destroy(wl_frame_callback_);
+    wl_frame_callback_ = nullptr;
+  }
+
   // destroy the main surface before destroying the client window on Wayland.
   {
+    software_surface_ = nullptr;
     render_surface_ = nullptr;
     native_window_ = nullptr;
   }
@@ -713,6 +870,14 @@ void LinuxesWindowWayland::DestroyRenderSurface() {
   }
 }
 
+void LinuxesWindowWayland::RequestFrameCallback() {
+  if (!native_window_ || wl_frame_callback_) {
+    return;
+  }
+  wl_frame_callback_ = wl_surface_frame(native_window_->Surface());
+  wl_callback_add_listener(wl_frame_callback_, &kWlSurfaceFrameListener, this);
+}
+
 void LinuxesWindowWayland::UpdateVirtualKeyboardStatus(const bool show) {
   // Not supported virtual keyboard.
   if (!zwp_text_input_v1_ || !wl_seat_) {
@@ -811,11 +976,13 @@ void LinuxesWindowWayland::SetClipboardData(const std::string& data) {
 }
 
 bool LinuxesWindowWayland::IsValid() const {
-  if (!display_valid_ || !native_window_ || !render_surface_ ||
-      !native_window_->IsValid() || !render_surface_->IsValid()) {
+  if (!display_valid_ || !native_window_ || !native_window_->IsValid()) {
     return false;
   }
-  return true;
+  if (software_surface_) {
+    return software_surface_->IsValid();
+  }
+  return render_surface_ && render_surface_->IsValid();
 }
 
 void LinuxesWindowWayland::WlRegistryHandler(wl_registry* wl_registry,
@@ -823,8 +990,12 @@ void LinuxesWindowWayland::WlRegistryHandler(wl_registry* wl_registry,
                                              const char* interface,
                                              uint32_t version) {
   if (!strcmp(interface, wl_compositor_interface.name)) {
+    // wl_surface.damage_buffer, which the software renderer uses, has been
+    // added in version 4.
+    constexpr uint32_t kMaxVersion = 4;
     wl_compositor_ = static_cast<decltype(wl_compositor_)>(
-        wl_registry_bind(wl_registry, name, &wl_compositor_interface, 1));
+        wl_registry_bind(wl_registry, name, &wl_compositor_interface,
+                         std::min(kMaxVersion, version)));
     return;
   }
 
@@ -836,8 +1007,11 @@ void LinuxesWindowWayland::WlRegistryHandler(wl_registry* wl_registry,
   }
 
   if (!strcmp(interface, wl_seat_interface.name)) {
-    wl_seat_ = static_cast<decltype(wl_seat_)>(
-        wl_registry_bind(wl_registry, name, &wl_seat_interface, 1));
+    // wl_pointer.frame, which groups the pointer events of the same input
+    // frame, has been added in version 5.
+    constexpr uint32_t kMaxVersion = 5;
+    wl_seat_ = static_cast<decltype(wl_seat_)>(wl_registry_bind(
+        wl_registry, name, &wl_seat_interface, std::min(kMaxVersion, version)));
     wl_seat_add_listener(wl_seat_, &kWlSeatListener, this);
     return;
   }
@@ -860,9 +1034,10 @@ void LinuxesWindowWayland::WlRegistryHandler(wl_registry* wl_registry,
   }
 
   if (!strcmp(interface, wl_shm_interface.name)) {
+    // Also used by the software renderer.
+    wl_shm_ = static_cast<decltype(wl_shm_)>(
+        wl_registry_bind(wl_registry, name, &wl_shm_interface, 1));
     if (show_cursor_) {
-      wl_shm_ = static_cast<decltype(wl_shm_)>(
-          wl_registry_bind(wl_registry, name, &wl_shm_interface, 1));
       wl_cursor_theme_ = wl_cursor_theme_load(nullptr, 32, wl_shm_);
       if (!wl_cursor_theme_) {
         LINUXES_LOG(ERROR) << "Failed to load cursor theme.";
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_wayland.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_wayland.h"
 #include "flutter/shell/platform/linux_embedded/window/linuxes_window.h"
 #include "flutter/shell/platform/linux_embedded/window/native_window_wayland.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
@@ -37,9 +38,21 @@ class LinuxesWindowWayland : public LinuxesWindow, public WindowBindingHandler {
   // |FlutterWindowBindingHandler|
   bool DispatchEvent() override;
 
+  // |FlutterWindowBindingHandler|
+  int GetEventFd() override;
+
+  // |FlutterWindowBindingHandler|
+  bool PrepareWaitEvent() override;
+
+  // |FlutterWindowBindingHandler|
+  void FinishWaitEvent() override;
+
   // |FlutterWindowBindingHandler|
   bool CreateRenderSurface(int32_t width, int32_t height) override;
 
+  // |FlutterWindowBindingHandler|
+  bool CreateSoftwareRenderSurface(int32_t width, int32_t height) override;
+
   // |FlutterWindowBindingHandler|
   void DestroyRenderSurface() override;
 
@@ -49,6 +62,12 @@ class LinuxesWindowWayland : public LinuxesWindow, public WindowBindingHandler {
   // |FlutterWindowBindingHandler|
   LinuxesRenderSurfaceTarget* GetRenderSurfaceTarget() const override;
 
+  // |FlutterWindowBindingHandler|
+  SurfaceSoftware* GetSoftwareRenderSurface() const override;
+
+  // |FlutterWindowBindingHandler|
+  LinuxesCompositor* GetCompositor() const override;
+
   // |FlutterWindowBindingHandler|
   double GetDpiScale() override;
 
@@ -79,10 +98,17 @@ class LinuxesWindowWayland : public LinuxesWindow, public WindowBindingHandler {
 
   void WlUnRegistryHandler(wl_registry* wl_registry, uint32_t name);
 
+  // Creates the xdg toplevel window which the render surfaces draw into.
+  bool CreateNativeWindow(int32_t width, int32_t height);
+
   void CreateSupportedWlCursorList();
 
   wl_cursor* GetWlCursor(const std::string& cursor_name);
 
+  // Requests a frame callback, which is committed together with the next
+  // frame and fires when the compositor presents it.
+  void RequestFrameCallback();
+
   static const wl_registry_listener kWlRegistryListener;
   static const xdg_wm_base_listener kXdgWmBaseListener;
   static const xdg_surface_listener kXdgSurfaceListener;
@@ -91,6 +117,7 @@ class LinuxesWindowWayland : public LinuxesWindow, public WindowBindingHandler {
   static const wl_touch_listener kWlTouchListener;
   static const wl_keyboard_listener kWlKeyboardListener;
   static const wl_output_listener kWlOutputListener;
+  static const wl_callback_listener kWlSurfaceFrameListener;
   static const zwp_text_input_v1_listener kZwpTextInputV1Listener;
   static const wl_data_device_listener kWlDataDeviceListener;
   static const wl_data_source_listener kWlDataSourceListener;
@@ -101,6 +128,7 @@ class LinuxesWindowWayland : public LinuxesWindow, public WindowBindingHandler {
 
   std::unique_ptr<NativeWindowWayland> native_window_;
   std::unique_ptr<SurfaceGlWayland> render_surface_;
+  std::unique_ptr<SurfaceSoftwareWayland> software_surface_;
 
   bool display_valid_;
 
@@ -118,9 +146,13 @@ class LinuxesWindowWayland : public LinuxesWindow, public WindowBindingHandler {
   wl_keyboard* wl_keyboard_;
   wl_surface* wl_cursor_surface_;
   wl_cursor_theme* wl_cursor_theme_;
+  wl_callback* wl_frame_callback_;
   zwp_text_input_manager_v1* zwp_text_input_manager_v1_;
   zwp_text_input_v1* zwp_text_input_v1_;
 
+  // The refresh interval of the output, or 0 if unknown.
+  uint64_t vsync_interval_nanos_;
+
   CursorInfo cursor_info_;
 
   // List of cursor name and wl_cursor supported by Wayland.
@@ -38,11 +38,13 @@ LinuxesWindowX11::~LinuxesWindowX11() {
 }
 
 bool LinuxesWindowX11::IsValid() const {
-  if (!display_valid_ || !native_window_ || !render_surface_ ||
-      !native_window_->IsValid() || !render_surface_->IsValid()) {
+  if (!display_valid_ || !native_window_ || !native_window_->IsValid()) {
     return false;
   }
-  return true;
+  if (software_surface_) {
+    return software_surface_->IsValid();
+  }
+  return render_surface_ && render_surface_->IsValid();
 }
 
 bool LinuxesWindowX11::DispatchEvent() {
@@ -108,6 +110,20 @@ bool LinuxesWindowX11::DispatchEvent() {
   return true;
 }
 
+int LinuxesWindowX11::GetEventFd() {
+  return display_ ? ConnectionNumber(display_) : -1;
+}
+
+bool LinuxesWindowX11::PrepareWaitEvent() {
+  if (!display_) {
+    return true;
+  }
+  // Send the buffered requests, and don't sleep on the connection if their
+  // replies have brought events into Xlib's queue.
+  XFlush(display_);
+  return XEventsQueued(display_, QueuedAlready) == 0;
+}
+
 bool LinuxesWindowX11::CreateRenderSurface(int32_t width, int32_t height) {
   auto context_egl =
       std::make_unique<ContextEgl>(std::make_unique<EnvironmentEgl>(display_));
@@ -125,8 +141,32 @@ bool LinuxesWindowX11::CreateRenderSurface(int32_t width, int32_t height) {
   return true;
 }
 
+bool LinuxesWindowX11::CreateSoftwareRenderSurface(int32_t width,
+                                                   int32_t height) {
+  auto visual = DefaultVisual(display_, DefaultScreen(display_));
+  native_window_ = std::make_unique<NativeWindowX11>(
+      display_, XVisualIDFromVisual(visual), width, height);
+  if (!native_window_->IsValid()) {
+    LINUXES_LOG(ERROR) << "Failed to create the native window";
+    return false;
+  }
+  // The software surface draws through its own connection, which needs the
+  // window to exist on the server.
+  XSync(display_, False);
+
+  software_surface_ =
+      std::make_unique<SurfaceSoftwareX11>(native_window_->Window());
+  if (!software_surface_->IsValid()) {
+    LINUXES_LOG(ERROR) << "Failed to create the software surface";
+    return false;
+  }
+
+  return true;
+}
+
 void LinuxesWindowX11::DestroyRenderSurface() {
   // destroy the main surface before destroying the client window on X11.
+  software_surface_ = nullptr;
   render_surface_ = nullptr;
   native_window_ = nullptr;
 }
@@ -139,6 +179,12 @@ LinuxesRenderSurfaceTarget* LinuxesWindowX11::GetRenderSurfaceTarget() const {
   return render_surface_.get();
 }
 
+SurfaceSoftware* LinuxesWindowX11::GetSoftwareRenderSurface() const {
+  return software_surface_.get();
+}
+
+LinuxesCompositor* LinuxesWindowX11::GetCompositor() const { return nullptr; }
+
 double LinuxesWindowX11::GetDpiScale() { return current_scale_; }
 
 PhysicalWindowBounds LinuxesWindowX11::GetPhysicalWindowBounds() {
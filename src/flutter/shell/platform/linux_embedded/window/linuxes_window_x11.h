@@ -8,6 +8,7 @@
 #include <memory>
 
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_x11.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_x11.h"
 #include "flutter/shell/platform/linux_embedded/window/linuxes_window.h"
 #include "flutter/shell/platform/linux_embedded/window/native_window_x11.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler.h"
@@ -26,9 +27,18 @@ class LinuxesWindowX11 : public LinuxesWindow, public WindowBindingHandler {
   // |FlutterWindowBindingHandler|
   bool DispatchEvent() override;
 
+  // |FlutterWindowBindingHandler|
+  int GetEventFd() override;
+
+  // |FlutterWindowBindingHandler|
+  bool PrepareWaitEvent() override;
+
   // |FlutterWindowBindingHandler|
   bool CreateRenderSurface(int32_t width, int32_t height) override;
 
+  // |FlutterWindowBindingHandler|
+  bool CreateSoftwareRenderSurface(int32_t width, int32_t height) override;
+
   // |FlutterWindowBindingHandler|
   void DestroyRenderSurface() override;
 
@@ -38,6 +48,12 @@ class LinuxesWindowX11 : public LinuxesWindow, public WindowBindingHandler {
   // |FlutterWindowBindingHandler|
   LinuxesRenderSurfaceTarget* GetRenderSurfaceTarget() const override;
 
+  // |FlutterWindowBindingHandler|
+  SurfaceSoftware* GetSoftwareRenderSurface() const override;
+
+  // |FlutterWindowBindingHandler|
+  LinuxesCompositor* GetCompositor() const override;
+
   // |FlutterWindowBindingHandler|
   double GetDpiScale() override;
 
@@ -68,6 +84,7 @@ class LinuxesWindowX11 : public LinuxesWindow, public WindowBindingHandler {
   Display* display_ = nullptr;
   std::unique_ptr<NativeWindowX11> native_window_;
   std::unique_ptr<SurfaceGlX11> render_surface_;
+  std::unique_ptr<SurfaceSoftwareX11> software_surface_;
 
   bool display_valid_;
 };
@@ -9,11 +9,16 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
 #include "flutter/shell/platform/linux_embedded/logger.h"
 #include "flutter/shell/platform/linux_embedded/surface/cursor_data.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_compositor.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software_drm.h"
 #include "flutter/shell/platform/linux_embedded/window/native_window.h"
 
 namespace flutter {
@@ -30,6 +35,11 @@ constexpr uint32_t kCursorBufferHeight = 64;
 template <typename S>
 class NativeWindowDrm : public NativeWindow {
  public:
+  // Called with the time of a vblank on CLOCK_MONOTONIC and the refresh
+  // interval of the display.
+  using VblankCallback = std::function<void(uint64_t vblank_time_nanos,
+                                            uint64_t vsync_interval_nanos)>;
+
   NativeWindowDrm(const char* deviceFilename) {
     drm_device_ = open(deviceFilename, O_RDWR | O_CLOEXEC);
     if (drm_device_ == -1) {
@@ -68,8 +78,61 @@ class NativeWindowDrm : public NativeWindow {
 
   virtual std::unique_ptr<S> CreateRenderSurface() = 0;
 
+  // Creates a surface which shows the frames of the software renderer in
+  // dumb buffers, bypassing EGL.
+  std::unique_ptr<SurfaceSoftwareDrm> CreateSoftwareRenderSurface() {
+    if (!drm_crtc_) {
+      LINUXES_LOG(ERROR) << "CRTC is not available.";
+      return nullptr;
+    }
+    return std::make_unique<SurfaceSoftwareDrm>(
+        drm_device_, drm_crtc_->crtc_id, drm_connector_id_, drm_mode_info_,
+        FindDamagePlane(), [this](uint64_t tv_sec, uint64_t tv_usec) {
+          NotifyVblank(tv_sec, tv_usec);
+        });
+  }
+
+  // Creates a compositor which shows the layers of a frame on the planes of
+  // the display, or returns nullptr if the backend can't.
+  virtual std::unique_ptr<LinuxesCompositor> CreateCompositor(
+      S* render_surface) {
+    return nullptr;
+  }
+
   virtual void SwapBuffer(){};
 
+  // Sets |callback| to be called when a vblank has been observed. It may be
+  // called from the raster thread.
+  void SetVblankCallback(VblankCallback callback) {
+    vblank_callback_ = std::move(callback);
+  }
+
+  // Returns the refresh interval of the current display mode.
+  uint64_t GetVsyncInterval() const {
+    if (drm_mode_info_.clock == 0) {
+      return 0;
+    }
+    // The pixel clock is in kHz.
+    return static_cast<uint64_t>(drm_mode_info_.htotal) *
+           drm_mode_info_.vtotal * 1000000 / drm_mode_info_.clock;
+  }
+
+  // Reports the time of the latest vblank of the CRTC, without waiting for the
+  // next one.
+  void NotifyLatestVblank() {
+    drmVBlank vblank = {};
+    vblank.request.type = static_cast<drmVBlankSeqType>(
+        DRM_VBLANK_RELATIVE | GetVblankCrtcSelector());
+    vblank.request.sequence = 0;
+    auto result = drmWaitVBlank(drm_device_, &vblank);
+    if (result != 0) {
+      LINUXES_LOG(ERROR) << "Failed to get the vblank time. (" << result
+                         << ")";
+      return;
+    }
+    NotifyVblank(vblank.reply.tval_sec, vblank.reply.tval_usec);
+  }
+
   bool MoveCursor(double x, double y) {
     auto result = drmModeMoveCursor(drm_device_, drm_crtc_->crtc_id,
                                     x - cursor_hotspot_.first,
@@ -106,6 +169,12 @@ class NativeWindowDrm : public NativeWindow {
     }
     if (encoder->crtc_id) {
       drm_crtc_ = drmModeGetCrtc(drm_device_, encoder->crtc_id);
+      for (int i = 0; i < resources->count_crtcs; i++) {
+        if (resources->crtcs[i] == encoder->crtc_id) {
+          drm_crtc_index_ = i;
+          break;
+        }
+      }
     }
 
     drmModeFreeEncoder(encoder);
@@ -138,6 +207,174 @@ class NativeWindowDrm : public NativeWindow {
     return nullptr;
   }
 
+  struct DrmProperty {
+    const char* name;
+    uint64_t value;
+  };
+
+  bool SetDrmClientCapabilities() {
+    if (drmSetClientCap(drm_device_, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0) {
+      LINUXES_LOG(ERROR) << "Couldn't set DRM_CLIENT_CAP_UNIVERSAL_PLANES";
+      return false;
+    }
+    if (drmSetClientCap(drm_device_, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+      LINUXES_LOG(ERROR) << "Couldn't set DRM_CLIENT_CAP_ATOMIC";
+      return false;
+    }
+    return true;
+  }
+
+  // Returns the primary plane which can be connected to the CRTC in use.
+  uint32_t FindPrimaryPlaneId(drmModePlaneResPtr resources) {
+    for (uint32_t i = 0; i < resources->count_planes; i++) {
+      auto plane = drmModeGetPlane(drm_device_, resources->planes[i]);
+      if (plane) {
+        auto possible_crtcs = plane->possible_crtcs;
+        drmModeFreePlane(plane);
+        if (!(possible_crtcs & (1 << drm_crtc_index_))) {
+          continue;
+        }
+
+        constexpr char kPropNamePlaneType[] = "type";
+        auto type = GetPropertyValue(resources->planes[i],
+                                     DRM_MODE_OBJECT_PLANE, kPropNamePlaneType);
+        if (type == DRM_PLANE_TYPE_PRIMARY) {
+          return resources->planes[i];
+        }
+      }
+    }
+    // no plane found
+    return -1;
+  }
+
+  uint64_t GetPropertyValue(uint32_t id, uint32_t type,
+                            const char* prop_name) {
+    uint64_t value = -1;
+    auto properties = drmModeObjectGetProperties(drm_device_, id, type);
+    if (properties) {
+      for (uint32_t i = 0; i < properties->count_props; i++) {
+        auto property = drmModeGetProperty(drm_device_, properties->props[i]);
+        if (property) {
+          if (std::strcmp(prop_name, property->name) == 0) {
+            value = properties->prop_values[i];
+            drmModeFreeProperty(property);
+            break;
+          }
+          drmModeFreeProperty(property);
+        }
+      }
+      drmModeFreeObjectProperties(properties);
+    }
+    return value;
+  }
+
+  // Returns the id of the property |prop_name| of the object, or 0 if not
+  // found. Useful to build atomic requests without looking up the properties
+  // every time.
+  uint32_t GetPropertyId(uint32_t id, uint32_t type, const char* prop_name) {
+    uint32_t prop_id = 0;
+    auto properties = drmModeObjectGetProperties(drm_device_, id, type);
+    if (properties) {
+      for (uint32_t i = 0; i < properties->count_props; i++) {
+        auto property = drmModeGetProperty(drm_device_, properties->props[i]);
+        if (property) {
+          if (std::strcmp(prop_name, property->name) == 0) {
+            prop_id = property->prop_id;
+            drmModeFreeProperty(property);
+            break;
+          }
+          drmModeFreeProperty(property);
+        }
+      }
+      drmModeFreeObjectProperties(properties);
+    }
+    return prop_id;
+  }
+
+  // Returns the primary plane of the CRTC in use if the driver accepts damage
+  // clips for it, so that the software renderer can tell which rectangles of
+  // a frame have changed. Drivers which copy the framebuffers to the display,
+  // such as those of USB and virtual displays, only copy these rectangles.
+  SurfaceSoftwareDrm::DamagePlane FindDamagePlane() {
+    SurfaceSoftwareDrm::DamagePlane damage_plane;
+    if (drmSetClientCap(drm_device_, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0) {
+      return damage_plane;
+    }
+    auto plane_resources = drmModeGetPlaneResources(drm_device_);
+    if (!plane_resources) {
+      return damage_plane;
+    }
+    auto plane_id = FindPrimaryPlaneId(plane_resources);
+    drmModeFreePlaneResources(plane_resources);
+    if (plane_id == static_cast<uint32_t>(-1)) {
+      return damage_plane;
+    }
+
+    constexpr char kPropNameFbId[] = "FB_ID";
+    constexpr char kPropNameFbDamageClips[] = "FB_DAMAGE_CLIPS";
+    auto damage_clips_property =
+        GetPropertyId(plane_id, DRM_MODE_OBJECT_PLANE, kPropNameFbDamageClips);
+    // The damage clips can only be set with atomic commits.
+    if (damage_clips_property == 0 ||
+        drmSetClientCap(drm_device_, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+      return damage_plane;
+    }
+    damage_plane.plane_id = plane_id;
+    damage_plane.fb_id_property =
+        GetPropertyId(plane_id, DRM_MODE_OBJECT_PLANE, kPropNameFbId);
+    damage_plane.damage_clips_property = damage_clips_property;
+    return damage_plane;
+  }
+
+  template <size_t N>
+  bool AssignAtomicPropertyValue(drmModeAtomicReqPtr atomic, uint32_t id,
+                                 uint32_t type, DrmProperty (&table)[N]) {
+    auto properties = drmModeObjectGetProperties(drm_device_, id, type);
+    if (properties) {
+      for (uint32_t i = 0; i < properties->count_props; i++) {
+        auto property = drmModeGetProperty(drm_device_, properties->props[i]);
+        if (property) {
+          for (uint32_t j = 0; j < N; j++) {
+            if (std::strcmp(table[j].name, property->name) == 0) {
+              if (drmModeAtomicAddProperty(atomic, id, property->prop_id,
+                                           table[j].value) < 0) {
+                LINUXES_LOG(ERROR)
+                    << "Failed to add " << table[j].name << " property";
+                drmModeFreeProperty(property);
+                drmModeFreeObjectProperties(properties);
+                return false;
+              }
+              break;
+            }
+          }
+        }
+        drmModeFreeProperty(property);
+      }
+      drmModeFreeObjectProperties(properties);
+    }
+    return true;
+  }
+
+  // Returns the bits of drmVBlankSeqType which select the CRTC in use.
+  uint32_t GetVblankCrtcSelector() const {
+    if (drm_crtc_index_ == 1) {
+      return DRM_VBLANK_SECONDARY;
+    }
+    if (drm_crtc_index_ > 1) {
+      return (drm_crtc_index_ << DRM_VBLANK_HIGH_CRTC_SHIFT) &
+             DRM_VBLANK_HIGH_CRTC_MASK;
+    }
+    return 0;
+  }
+
+  // Reports a vblank whose timestamp is given by a DRM event or reply.
+  void NotifyVblank(uint64_t tv_sec, uint64_t tv_usec) {
+    if (vblank_callback_) {
+      vblank_callback_(tv_sec * 1000000000 + tv_usec * 1000,
+                       GetVsyncInterval());
+    }
+  }
+
   // Convert Flutter's cursor value to cursor data.
   const uint32_t* GetCursorData(const std::string& cursor_name) {
     // const uint32_t* NativeWindowDrm::GetCursorData(const std::string&
@@ -203,7 +440,9 @@ class NativeWindowDrm : public NativeWindow {
   int drm_device_;
   uint32_t drm_connector_id_;
   drmModeCrtc* drm_crtc_ = nullptr;
+  uint32_t drm_crtc_index_ = 0;
   drmModeModeInfo drm_mode_info_;
+  VblankCallback vblank_callback_;
 
   std::string cursor_name_ = "";
   std::pair<int32_t, int32_t> cursor_hotspot_ = {0, 0};
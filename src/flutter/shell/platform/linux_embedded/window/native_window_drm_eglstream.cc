@@ -83,6 +83,12 @@ NativeWindowDrmEglstream::CreateRenderSurface() {
           std::make_unique<EnvironmentEglDrmEglstream>()));
 }
 
+void NativeWindowDrmEglstream::SwapBuffer() {
+  // The EGL output stream flips the buffers without notifying us, so ask the
+  // kernel when the last vblank was.
+  NotifyLatestVblank();
+}
+
 bool NativeWindowDrmEglstream::ConfigureDisplayAdditional() {
   if (!SetDrmClientCapabilities()) {
     LINUXES_LOG(ERROR) << "Couldn't set drm client capability";
@@ -120,58 +126,6 @@ bool NativeWindowDrmEglstream::ConfigureDisplayAdditional() {
   return true;
 }
 
-bool NativeWindowDrmEglstream::SetDrmClientCapabilities() {
-  if (drmSetClientCap(drm_device_, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0) {
-    LINUXES_LOG(ERROR) << "Couldn't set DRM_CLIENT_CAP_UNIVERSAL_PLANES";
-    return false;
-  }
-  if (drmSetClientCap(drm_device_, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
-    LINUXES_LOG(ERROR) << "Couldn't set DRM_CLIENT_CAP_ATOMIC";
-    return false;
-  }
-  return true;
-}
-
-uint32_t NativeWindowDrmEglstream::FindPrimaryPlaneId(
-    drmModePlaneResPtr resources) {
-  for (uint32_t i = 0; i < resources->count_planes; i++) {
-    auto plane = drmModeGetPlane(drm_device_, resources->planes[i]);
-    if (plane) {
-      drmModeFreePlane(plane);
-
-      constexpr char kPropNamePlaneType[] = "type";
-      auto type = GetPropertyValue(resources->planes[i], DRM_MODE_OBJECT_PLANE,
-                                   kPropNamePlaneType);
-      if (type == DRM_PLANE_TYPE_PRIMARY) {
-        return resources->planes[i];
-      }
-    }
-  }
-  // no plane found
-  return -1;
-}
-
-uint64_t NativeWindowDrmEglstream::GetPropertyValue(uint32_t id, uint32_t type,
-                                                    const char* prop_name) {
-  uint64_t value = -1;
-  auto properties = drmModeObjectGetProperties(drm_device_, id, type);
-  if (properties) {
-    for (uint32_t i = 0; i < properties->count_props; i++) {
-      auto property = drmModeGetProperty(drm_device_, properties->props[i]);
-      if (property) {
-        if (std::strcmp(prop_name, property->name) == 0) {
-          value = properties->prop_values[i];
-          drmModeFreeProperty(property);
-          break;
-        }
-        drmModeFreeProperty(property);
-      }
-    }
-    drmModeFreeObjectProperties(properties);
-  }
-  return value;
-}
-
 bool NativeWindowDrmEglstream::AssignAtomicRequest(drmModeAtomicReqPtr atomic) {
   if (drmModeCreatePropertyBlob(drm_device_, &drm_mode_info_,
                                 sizeof(drm_mode_info_),
@@ -181,7 +135,7 @@ bool NativeWindowDrmEglstream::AssignAtomicRequest(drmModeAtomicReqPtr atomic) {
   }
 
   // Set the crtc mode and activate.
-  NativeWindowDrmEglstream::DrmProperty crtc_table[] = {
+  DrmProperty crtc_table[] = {
       {"MODE_ID", drm_property_blob_},
       {"ACTIVE", 1},
   };
@@ -191,7 +145,7 @@ bool NativeWindowDrmEglstream::AssignAtomicRequest(drmModeAtomicReqPtr atomic) {
   }
 
   // Set the connector.
-  NativeWindowDrmEglstream::DrmProperty connector_table[] = {
+  DrmProperty connector_table[] = {
       {"CRTC_ID", drm_crtc_->crtc_id},
   };
   if (!AssignAtomicPropertyValue(atomic, drm_connector_id_,
@@ -201,7 +155,7 @@ bool NativeWindowDrmEglstream::AssignAtomicRequest(drmModeAtomicReqPtr atomic) {
 
   // Set the plane source position, plane destination position, and crtc to
   // connect plane.
-  NativeWindowDrmEglstream::DrmProperty plane_table[] = {
+  DrmProperty plane_table[] = {
       {"SRC_X", 0},
       {"SRC_Y", 0},
       {"SRC_W", static_cast<uint64_t>(drm_mode_info_.hdisplay << 16)},
@@ -220,34 +174,4 @@ bool NativeWindowDrmEglstream::AssignAtomicRequest(drmModeAtomicReqPtr atomic) {
   return true;
 }
 
-template <size_t N>
-bool NativeWindowDrmEglstream::AssignAtomicPropertyValue(
-    drmModeAtomicReqPtr atomic, uint32_t id, uint32_t type,
-    NativeWindowDrmEglstream::DrmProperty (&table)[N]) {
-  auto properties = drmModeObjectGetProperties(drm_device_, id, type);
-  if (properties) {
-    for (uint32_t i = 0; i < properties->count_props; i++) {
-      auto property = drmModeGetProperty(drm_device_, properties->props[i]);
-      if (property) {
-        for (uint32_t j = 0; j < N; j++) {
-          if (std::strcmp(table[j].name, property->name) == 0) {
-            if (drmModeAtomicAddProperty(atomic, id, property->prop_id,
-                                         table[j].value) < 0) {
-              LINUXES_LOG(ERROR)
-                  << "Failed to add " << table[j].name << " property";
-              drmModeFreeProperty(property);
-              drmModeFreeObjectProperties(properties);
-              return false;
-            }
-            break;
-          }
-        }
-      }
-      drmModeFreeProperty(property);
-    }
-    drmModeFreeObjectProperties(properties);
-  }
-  return true;
-}
-
 }  // namespace flutter
@@ -36,29 +36,16 @@ class NativeWindowDrmEglstream
   std::unique_ptr<SurfaceGlDrm<ContextEglDrmEglstream>> CreateRenderSurface()
       override;
 
+  // |NativeWindowDrm|
+  void SwapBuffer() override;
+
   uint32_t PlaneId() { return drm_plane_id_; }
 
  private:
-  struct DrmProperty {
-    const char* name;
-    uint64_t value;
-  };
-
   bool ConfigureDisplayAdditional();
 
-  bool SetDrmClientCapabilities();
-
-  uint32_t FindPrimaryPlaneId(drmModePlaneResPtr resources);
-
-  uint64_t GetPropertyValue(uint32_t id, uint32_t type, const char* prop_name);
-
   bool AssignAtomicRequest(drmModeAtomicReqPtr atomic);
 
-  template <size_t N>
-  bool AssignAtomicPropertyValue(
-      drmModeAtomicReqPtr atomic, uint32_t id, uint32_t type,
-      NativeWindowDrmEglstream::DrmProperty (&table)[N]);
-
   uint32_t drm_plane_id_;
   uint32_t drm_property_blob_ = 0;
 };
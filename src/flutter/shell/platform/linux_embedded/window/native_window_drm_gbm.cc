@@ -4,13 +4,27 @@
 
 #include "flutter/shell/platform/linux_embedded/window/native_window_drm_gbm.h"
 
+#include <drm_fourcc.h>
+#include <errno.h>
+#include <poll.h>
 #include <unistd.h>
 
+#include <algorithm>
+
+#include "flutter/shell/platform/linux_embedded/frame_timeline.h"
+#include "flutter/shell/platform/linux_embedded/input_latency_tracker.h"
 #include "flutter/shell/platform/linux_embedded/logger.h"
+#include "flutter/shell/platform/linux_embedded/surface/compositor_drm_gbm.h"
 #include "flutter/shell/platform/linux_embedded/surface/cursor_data.h"
 
 namespace flutter {
 
+namespace {
+// Bounds the wait for a page flip, which never completes while the display is
+// turned off, for example.
+constexpr int kPageFlipTimeoutMs = 1000;
+}  // namespace
+
 NativeWindowDrmGbm::NativeWindowDrmGbm(const char* deviceFilename)
     : NativeWindowDrm(deviceFilename) {
   if (!valid_) {
@@ -40,6 +54,12 @@ NativeWindowDrmGbm::NativeWindowDrmGbm(const char* deviceFilename)
     valid_ = false;
     return;
   }
+
+  atomic_modesetting_ = ConfigureAtomicModesetting();
+  if (!atomic_modesetting_) {
+    LINUXES_LOG(WARNING) << "Atomic modesetting is not available, use the "
+                            "legacy page flip API.";
+  }
 }
 
 NativeWindowDrmGbm::~NativeWindowDrmGbm() {
@@ -52,6 +72,16 @@ NativeWindowDrmGbm::~NativeWindowDrmGbm() {
     gbm_cursor_bo_ = nullptr;
   }
 
+  // The compositor has already been destroyed with its backing stores.
+  front_release_ = nullptr;
+  pending_release_ = nullptr;
+
+  WaitForPageFlip();
+  if (gbm_pending_bo_) {
+    gbm_surface_release_buffer(static_cast<gbm_surface*>(window_),
+                               gbm_pending_bo_);
+  }
+
   if (drm_crtc_) {
     drmModeSetCrtc(drm_device_, drm_crtc_->crtc_id, drm_crtc_->buffer_id,
                    drm_crtc_->x, drm_crtc_->y, &drm_connector_id_, 1,
@@ -60,13 +90,20 @@ NativeWindowDrmGbm::~NativeWindowDrmGbm() {
   }
 
   if (gbm_previous_bo_) {
-    drmModeRmFB(drm_device_, gbm_previous_fb_);
     gbm_surface_release_buffer(static_cast<gbm_surface*>(window_),
                                gbm_previous_bo_);
+  }
+
+  // Destroying the surface also removes the cached framebuffers.
+  if (window_) {
     gbm_surface_destroy(static_cast<gbm_surface*>(window_));
     window_ = nullptr;
   }
 
+  if (drm_property_blob_) {
+    drmModeDestroyPropertyBlob(drm_device_, drm_property_blob_);
+  }
+
   if (gbm_device_) {
     gbm_device_destroy(gbm_device_);
   }
@@ -132,8 +169,335 @@ NativeWindowDrmGbm::CreateRenderSurface() {
           std::make_unique<EnvironmentEgl>(gbm_device_)));
 }
 
+std::unique_ptr<LinuxesCompositor> NativeWindowDrmGbm::CreateCompositor(
+    SurfaceGlDrm<ContextEgl>* render_surface) {
+  if (!atomic_modesetting_) {
+    LINUXES_LOG(WARNING) << "The compositor requires atomic modesetting.";
+    return nullptr;
+  }
+  LINUXES_LOG(INFO) << "Compose layers with " << drm_overlay_planes_.size()
+                    << " overlay planes.";
+  return std::make_unique<CompositorDrmGbm>(this, render_surface);
+}
+
 void NativeWindowDrmGbm::SwapBuffer() {
+  // Only one page flip can be queued at a time. Since this frame has been
+  // rendered into a third buffer while the display was flipping, this only
+  // waits when the raster thread is ahead of the display.
+  WaitForPageFlip();
+
   auto* bo = gbm_surface_lock_front_buffer(static_cast<gbm_surface*>(window_));
+  if (!bo) {
+    LINUXES_LOG(ERROR) << "Failed to lock the front buffer.";
+    return;
+  }
+  if (page_flip_pending_) {
+    // The display is not flipping. Drop this frame.
+    gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+    return;
+  }
+
+  auto fb = GetFramebuffer(bo);
+  if (!fb) {
+    gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+    return;
+  }
+
+  if (!modeset_done_) {
+    if (!CommitModeset(fb)) {
+      gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+      return;
+    }
+    modeset_done_ = true;
+    gbm_previous_bo_ = bo;
+    NotifyLatestVblank();
+    return;
+  }
+
+  if (!CommitPageFlip(fb)) {
+    gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+    return;
+  }
+  gbm_pending_bo_ = bo;
+  page_flip_pending_ = true;
+  page_flip_start_time_nanos_ =
+      FrameTimeline::IsEnabled() ? FrameTimeline::Now() : 0;
+}
+
+bool NativeWindowDrmGbm::TestAssignment(
+    const std::vector<DrmPlaneLayer>& layers,
+    const DrmPlaneAssignment& assignment) {
+  // The primary plane must show something in the test. Until a frame has
+  // been shown, everything is composited by GL.
+  uint32_t primary_fb = 0;
+  if (assignment.scanout_first_layer) {
+    primary_fb = layers[0].fb_id;
+  } else if (gbm_previous_bo_) {
+    primary_fb = GetFramebuffer(gbm_previous_bo_);
+  }
+  if (!modeset_done_ || !primary_fb) {
+    return false;
+  }
+
+  auto atomic = drmModeAtomicAlloc();
+  if (!atomic) {
+    LINUXES_LOG(ERROR) << "Couldn't allocate atomic";
+    return false;
+  }
+  int result = -1;
+  if (AddLayerProperties(atomic, layers, assignment, primary_fb)) {
+    result = drmModeAtomicCommit(drm_device_, atomic,
+                                 DRM_MODE_ATOMIC_TEST_ONLY, nullptr);
+  }
+  drmModeAtomicFree(atomic);
+  return result == 0;
+}
+
+bool NativeWindowDrmGbm::CommitLayers(const std::vector<DrmPlaneLayer>& layers,
+                                      const DrmPlaneAssignment& assignment,
+                                      ScanoutReleaseCallback release) {
+  // Only one page flip can be queued at a time.
+  WaitForPageFlip();
+
+  gbm_bo* bo = nullptr;
+  uint32_t primary_fb = layers[0].fb_id;
+  if (!assignment.scanout_first_layer) {
+    bo = gbm_surface_lock_front_buffer(static_cast<gbm_surface*>(window_));
+    if (!bo) {
+      LINUXES_LOG(ERROR) << "Failed to lock the front buffer.";
+      release();
+      return false;
+    }
+    primary_fb = GetFramebuffer(bo);
+  }
+  if (page_flip_pending_ || !primary_fb) {
+    // The display is not flipping, or the buffer can't be scanned out. Drop
+    // this frame.
+    if (bo) {
+      gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+    }
+    release();
+    return primary_fb != 0;
+  }
+
+  auto atomic = drmModeAtomicAlloc();
+  if (!atomic) {
+    LINUXES_LOG(ERROR) << "Couldn't allocate atomic";
+    if (bo) {
+      gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+    }
+    release();
+    return false;
+  }
+  int result = -1;
+  auto modeset = !modeset_done_;
+  if ((!modeset || AddModesetProperties(atomic)) &&
+      AddLayerProperties(atomic, layers, assignment, primary_fb)) {
+    uint32_t flags = modeset
+                         ? DRM_MODE_ATOMIC_ALLOW_MODESET
+                         : DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT;
+    result = drmModeAtomicCommit(drm_device_, atomic, flags, this);
+  }
+  drmModeAtomicFree(atomic);
+  if (result != 0) {
+    LINUXES_LOG(ERROR) << "Failed to commit the layers. (" << result << ")";
+    if (bo) {
+      gbm_surface_release_buffer(static_cast<gbm_surface*>(window_), bo);
+    }
+    release();
+    return false;
+  }
+
+  drm_active_overlay_planes_ = assignment.overlay_planes;
+  gbm_pending_bo_ = bo;
+  pending_release_ = std::move(release);
+  if (modeset) {
+    // The modeset is blocking, so the frame is already shown.
+    modeset_done_ = true;
+    OnPageFlipCompleted();
+    NotifyLatestVblank();
+    return true;
+  }
+  page_flip_pending_ = true;
+  page_flip_start_time_nanos_ =
+      FrameTimeline::IsEnabled() ? FrameTimeline::Now() : 0;
+  return true;
+}
+
+bool NativeWindowDrmGbm::ConfigureAtomicModesetting() {
+  if (!drm_crtc_ || !SetDrmClientCapabilities()) {
+    return false;
+  }
+
+  auto plane_resources = drmModeGetPlaneResources(drm_device_);
+  if (!plane_resources) {
+    LINUXES_LOG(ERROR) << "Couldn't get plane resources";
+    return false;
+  }
+  drm_plane_id_ = FindPrimaryPlaneId(plane_resources);
+  if (drm_plane_id_ == static_cast<uint32_t>(-1)) {
+    LINUXES_LOG(ERROR) << "Couldn't find a plane.";
+    drmModeFreePlaneResources(plane_resources);
+    return false;
+  }
+  FindOverlayPlanes(plane_resources);
+  drmModeFreePlaneResources(plane_resources);
+
+  // Look up the properties once because they are set in every frame.
+  if (!LookUpPlaneProperties(drm_plane_id_)) {
+    LINUXES_LOG(ERROR) << "Couldn't find the properties of the plane.";
+    return false;
+  }
+  drm_plane_fb_id_property_ = drm_plane_properties_[drm_plane_id_].fb_id;
+
+  if (drmModeCreatePropertyBlob(drm_device_, &drm_mode_info_,
+                                sizeof(drm_mode_info_),
+                                &drm_property_blob_) != 0) {
+    LINUXES_LOG(ERROR) << "Failed to create property blob";
+    return false;
+  }
+  return true;
+}
+
+bool NativeWindowDrmGbm::LookUpPlaneProperties(uint32_t plane_id) {
+  PlaneProperties properties;
+  struct {
+    const char* name;
+    uint32_t* id;
+  } table[] = {
+      {"FB_ID", &properties.fb_id},   {"CRTC_ID", &properties.crtc_id},
+      {"SRC_X", &properties.src_x},   {"SRC_Y", &properties.src_y},
+      {"SRC_W", &properties.src_w},   {"SRC_H", &properties.src_h},
+      {"CRTC_X", &properties.crtc_x}, {"CRTC_Y", &properties.crtc_y},
+      {"CRTC_W", &properties.crtc_w}, {"CRTC_H", &properties.crtc_h},
+  };
+  for (auto& entry : table) {
+    *entry.id = GetPropertyId(plane_id, DRM_MODE_OBJECT_PLANE, entry.name);
+    if (!*entry.id) {
+      return false;
+    }
+  }
+  properties.rotation =
+      GetPropertyId(plane_id, DRM_MODE_OBJECT_PLANE, "rotation");
+  drm_plane_properties_[plane_id] = properties;
+  return true;
+}
+
+void NativeWindowDrmGbm::FindOverlayPlanes(drmModePlaneResPtr resources) {
+  for (uint32_t i = 0; i < resources->count_planes; i++) {
+    auto plane_id = resources->planes[i];
+    auto plane = drmModeGetPlane(drm_device_, plane_id);
+    if (!plane) {
+      continue;
+    }
+    auto usable = (plane->possible_crtcs & (1 << drm_crtc_index_)) &&
+                  std::find(plane->formats,
+                            plane->formats + plane->count_formats,
+                            DRM_FORMAT_ARGB8888) !=
+                      plane->formats + plane->count_formats;
+    drmModeFreePlane(plane);
+    if (!usable) {
+      continue;
+    }
+
+    constexpr char kPropNamePlaneType[] = "type";
+    auto type =
+        GetPropertyValue(plane_id, DRM_MODE_OBJECT_PLANE, kPropNamePlaneType);
+    if (type != DRM_PLANE_TYPE_OVERLAY || !LookUpPlaneProperties(plane_id)) {
+      continue;
+    }
+    // The backing stores are scanned out flipped vertically, so a plane which
+    // can't be rotated would fail every assignment that includes it.
+    if (!drm_plane_properties_[plane_id].rotation) {
+      drm_plane_properties_.erase(plane_id);
+      continue;
+    }
+    drm_overlay_planes_.push_back(plane_id);
+  }
+}
+
+bool NativeWindowDrmGbm::AddLayerProperties(
+    drmModeAtomicReqPtr atomic, const std::vector<DrmPlaneLayer>& layers,
+    const DrmPlaneAssignment& assignment, uint32_t primary_fb) {
+  DrmPlaneLayer fullscreen = {primary_fb, 0, 0, drm_mode_info_.hdisplay,
+                              drm_mode_info_.vdisplay};
+  if (!AddPlaneProperties(atomic, drm_plane_id_, primary_fb, fullscreen,
+                          assignment.scanout_first_layer)) {
+    return false;
+  }
+
+  const auto& overlays = assignment.overlay_planes;
+  for (size_t i = 0; i < overlays.size(); i++) {
+    const auto& layer = layers[assignment.first_overlay_layer + i];
+    if (!AddPlaneProperties(atomic, overlays[i], layer.fb_id, layer, true)) {
+      return false;
+    }
+  }
+
+  // Turn off the overlays which are no longer used.
+  for (auto plane_id : drm_active_overlay_planes_) {
+    if (std::find(overlays.begin(), overlays.end(), plane_id) !=
+        overlays.end()) {
+      continue;
+    }
+    const auto& properties = drm_plane_properties_[plane_id];
+    if (drmModeAtomicAddProperty(atomic, plane_id, properties.fb_id, 0) < 0 ||
+        drmModeAtomicAddProperty(atomic, plane_id, properties.crtc_id, 0) <
+            0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NativeWindowDrmGbm::AddPlaneProperties(drmModeAtomicReqPtr atomic,
+                                            uint32_t plane_id, uint32_t fb,
+                                            const DrmPlaneLayer& layer,
+                                            bool flip_y) {
+  const auto& properties = drm_plane_properties_[plane_id];
+  if (flip_y && !properties.rotation) {
+    return false;
+  }
+
+  // The source rectangle is in 16.16 fixed point.
+  struct {
+    uint32_t id;
+    uint64_t value;
+  } table[] = {
+      {properties.fb_id, fb},
+      {properties.crtc_id, drm_crtc_->crtc_id},
+      {properties.src_x, 0},
+      {properties.src_y, 0},
+      {properties.src_w, static_cast<uint64_t>(layer.width) << 16},
+      {properties.src_h, static_cast<uint64_t>(layer.height) << 16},
+      {properties.crtc_x, static_cast<uint64_t>(layer.x)},
+      {properties.crtc_y, static_cast<uint64_t>(layer.y)},
+      {properties.crtc_w, layer.width},
+      {properties.crtc_h, layer.height},
+  };
+  for (const auto& entry : table) {
+    if (drmModeAtomicAddProperty(atomic, plane_id, entry.id, entry.value) <
+        0) {
+      return false;
+    }
+  }
+  if (properties.rotation) {
+    uint64_t rotation =
+        flip_y ? DRM_MODE_ROTATE_0 | DRM_MODE_REFLECT_Y : DRM_MODE_ROTATE_0;
+    if (drmModeAtomicAddProperty(atomic, plane_id, properties.rotation,
+                                 rotation) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t NativeWindowDrmGbm::GetFramebuffer(gbm_bo* bo) {
+  auto framebuffer = static_cast<DrmFramebuffer*>(gbm_bo_get_user_data(bo));
+  if (framebuffer) {
+    return framebuffer->fb_id;
+  }
+
   auto width = gbm_bo_get_width(bo);
   auto height = gbm_bo_get_height(bo);
   auto handle = gbm_bo_get_handle(bo).u32;
@@ -143,20 +507,162 @@ void NativeWindowDrmGbm::SwapBuffer() {
       drmModeAddFB(drm_device_, width, height, 24, 32, stride, handle, &fb);
   if (result != 0) {
     LINUXES_LOG(ERROR) << "Failed to add a framebuffer. (" << result << ")";
+    return 0;
+  }
+
+  framebuffer = new DrmFramebuffer{drm_device_, fb};
+  gbm_bo_set_user_data(bo, framebuffer, OnBufferDestroyed);
+  return fb;
+}
+
+void NativeWindowDrmGbm::OnBufferDestroyed(gbm_bo* bo, void* user_data) {
+  auto framebuffer = static_cast<DrmFramebuffer*>(user_data);
+  drmModeRmFB(framebuffer->drm_device, framebuffer->fb_id);
+  delete framebuffer;
+}
+
+bool NativeWindowDrmGbm::AddModesetProperties(drmModeAtomicReqPtr atomic) {
+  DrmProperty crtc_table[] = {
+      {"MODE_ID", drm_property_blob_},
+      {"ACTIVE", 1},
+  };
+  DrmProperty connector_table[] = {
+      {"CRTC_ID", drm_crtc_->crtc_id},
+  };
+  return AssignAtomicPropertyValue(atomic, drm_crtc_->crtc_id,
+                                   DRM_MODE_OBJECT_CRTC, crtc_table) &&
+         AssignAtomicPropertyValue(atomic, drm_connector_id_,
+                                   DRM_MODE_OBJECT_CONNECTOR, connector_table);
+}
+
+bool NativeWindowDrmGbm::CommitModeset(uint32_t fb) {
+  if (!atomic_modesetting_) {
+    auto result = drmModeSetCrtc(drm_device_, drm_crtc_->crtc_id, fb, 0, 0,
+                                 &drm_connector_id_, 1, &drm_mode_info_);
+    if (result != 0) {
+      LINUXES_LOG(ERROR) << "Failed to set crct mode. (" << result << ")";
+      return false;
+    }
+    return true;
+  }
+
+  auto atomic = drmModeAtomicAlloc();
+  if (!atomic) {
+    LINUXES_LOG(ERROR) << "Couldn't allocate atomic";
+    return false;
+  }
+
+  DrmProperty plane_table[] = {
+      {"SRC_X", 0},
+      {"SRC_Y", 0},
+      {"SRC_W", static_cast<uint64_t>(drm_mode_info_.hdisplay << 16)},
+      {"SRC_H", static_cast<uint64_t>(drm_mode_info_.vdisplay << 16)},
+      {"CRTC_X", 0},
+      {"CRTC_Y", 0},
+      {"CRTC_W", static_cast<uint64_t>(drm_mode_info_.hdisplay)},
+      {"CRTC_H", static_cast<uint64_t>(drm_mode_info_.vdisplay)},
+      {"CRTC_ID", drm_crtc_->crtc_id},
+      {"FB_ID", fb},
+  };
+  int result = -1;
+  if (AddModesetProperties(atomic) &&
+      AssignAtomicPropertyValue(atomic, drm_plane_id_, DRM_MODE_OBJECT_PLANE,
+                                plane_table)) {
+    result = drmModeAtomicCommit(drm_device_, atomic,
+                                 DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+  }
+  drmModeAtomicFree(atomic);
+  if (result != 0) {
+    LINUXES_LOG(ERROR) << "Failed to commit the modeset. (" << result << ")";
+    return false;
+  }
+  return true;
+}
+
+bool NativeWindowDrmGbm::CommitPageFlip(uint32_t fb) {
+  int result;
+  if (atomic_modesetting_) {
+    auto atomic = drmModeAtomicAlloc();
+    if (!atomic) {
+      LINUXES_LOG(ERROR) << "Couldn't allocate atomic";
+      return false;
+    }
+    result = drmModeAtomicAddProperty(atomic, drm_plane_id_,
+                                      drm_plane_fb_id_property_, fb);
+    if (result >= 0) {
+      result = drmModeAtomicCommit(
+          drm_device_, atomic,
+          DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, this);
+    }
+    drmModeAtomicFree(atomic);
+  } else {
+    result = drmModePageFlip(drm_device_, drm_crtc_->crtc_id, fb,
+                             DRM_MODE_PAGE_FLIP_EVENT, this);
   }
-  result = drmModeSetCrtc(drm_device_, drm_crtc_->crtc_id, fb, 0, 0,
-                          &drm_connector_id_, 1, &drm_mode_info_);
   if (result != 0) {
-    LINUXES_LOG(ERROR) << "Failed to set crct mode. (" << result << ")";
+    LINUXES_LOG(ERROR) << "Failed to queue a page flip. (" << result << ")";
+    return false;
+  }
+  return true;
+}
+
+void NativeWindowDrmGbm::WaitForPageFlip() {
+  drmEventContext context = {};
+  context.version = 2;
+  context.page_flip_handler = OnPageFlip;
+
+  while (page_flip_pending_) {
+    pollfd fds = {drm_device_, POLLIN, 0};
+    auto result = poll(&fds, 1, kPageFlipTimeoutMs);
+    if (result == -1 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      LINUXES_LOG(ERROR) << "Failed to wait for a page flip.";
+      return;
+    }
+    drmHandleEvent(drm_device_, &context);
   }
+}
 
+void NativeWindowDrmGbm::OnPageFlipCompleted() {
+  // The previous buffer is no longer scanned out, so it can be rendered into
+  // again. Its framebuffer stays cached for the next time.
   if (gbm_previous_bo_) {
-    drmModeRmFB(drm_device_, gbm_previous_fb_);
     gbm_surface_release_buffer(static_cast<gbm_surface*>(window_),
                                gbm_previous_bo_);
   }
-  gbm_previous_bo_ = bo;
-  gbm_previous_fb_ = fb;
+  if (front_release_) {
+    front_release_();
+  }
+  gbm_previous_bo_ = gbm_pending_bo_;
+  gbm_pending_bo_ = nullptr;
+  front_release_ = std::move(pending_release_);
+  pending_release_ = nullptr;
+  page_flip_pending_ = false;
+}
+
+void NativeWindowDrmGbm::OnPageFlip(int fd, unsigned int sequence,
+                                    unsigned int tv_sec, unsigned int tv_usec,
+                                    void* user_data) {
+  auto self = static_cast<NativeWindowDrmGbm*>(user_data);
+  self->OnPageFlipCompleted();
+
+  // The time of the vblank on CLOCK_MONOTONIC, which is also the clock of
+  // FrameTimeline::Now(). The event may be handled much later, e.g. when the
+  // next frame waits for it.
+  uint64_t flip_time_nanos = tv_sec * 1000000000ull + tv_usec * 1000ull;
+  if (self->page_flip_start_time_nanos_ != 0) {
+    FrameTimeline::GetInstance().Record(
+        kFlutterDesktopFrameEventPageFlip, self->page_flip_start_time_nanos_,
+        std::max(flip_time_nanos, self->page_flip_start_time_nanos_));
+  }
+
+  if (InputLatencyTracker::IsEnabled()) {
+    InputLatencyTracker::GetInstance().OnFrameScannedOut(flip_time_nanos);
+  }
+
+  self->NotifyVblank(tv_sec, tv_usec);
 }
 
 bool NativeWindowDrmGbm::CreateCursorBuffer(const std::string& cursor_name) {
@@ -9,16 +9,25 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 
+#include <functional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "flutter/shell/platform/linux_embedded/surface/context_egl.h"
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_drm.h"
+#include "flutter/shell/platform/linux_embedded/window/drm_plane_assigner.h"
 #include "flutter/shell/platform/linux_embedded/window/native_window_drm.h"
 
 namespace flutter {
 
-class NativeWindowDrmGbm : public NativeWindowDrm<SurfaceGlDrm<ContextEgl>> {
+class NativeWindowDrmGbm : public NativeWindowDrm<SurfaceGlDrm<ContextEgl>>,
+                           public DrmPlaneBackend {
  public:
+  // Called when the framebuffers given to CommitLayers() are no longer
+  // scanned out.
+  using ScanoutReleaseCallback = std::function<void()>;
+
   NativeWindowDrmGbm(const char* deviceFilename);
   ~NativeWindowDrmGbm();
 
@@ -35,16 +44,141 @@ class NativeWindowDrmGbm : public NativeWindowDrm<SurfaceGlDrm<ContextEgl>> {
   // |NativeWindowDrm|
   std::unique_ptr<SurfaceGlDrm<ContextEgl>> CreateRenderSurface() override;
 
+  // |NativeWindowDrm|
+  std::unique_ptr<LinuxesCompositor> CreateCompositor(
+      SurfaceGlDrm<ContextEgl>* render_surface) override;
+
   // |NativeWindowDrm|
   void SwapBuffer() override;
 
+  // |DrmPlaneBackend|
+  const std::vector<uint32_t>& GetOverlayPlanes() const override {
+    return drm_overlay_planes_;
+  }
+
+  // |DrmPlaneBackend|
+  bool TestAssignment(const std::vector<DrmPlaneLayer>& layers,
+                      const DrmPlaneAssignment& assignment) override;
+
+  // Shows |layers| as |assignment| says at the next vblank. Unless the first
+  // layer is scanned out, the layers below the overlays must have been
+  // composited into the render surface, whose buffers are swapped. |release|
+  // is called once the framebuffers of |layers| are no longer scanned out,
+  // which is immediately if this fails or drops the frame.
+  bool CommitLayers(const std::vector<DrmPlaneLayer>& layers,
+                    const DrmPlaneAssignment& assignment,
+                    ScanoutReleaseCallback release);
+
+  gbm_device* GetGbmDevice() const { return gbm_device_; }
+
+  int GetDrmDevice() const { return drm_device_; }
+
  private:
+  // A DRM framebuffer cached in a gbm_bo. It is removed together with the
+  // gbm_bo.
+  struct DrmFramebuffer {
+    int drm_device;
+    uint32_t fb_id;
+  };
+
+  // The ids of the plane properties which are set in every frame.
+  struct PlaneProperties {
+    uint32_t fb_id = 0;
+    uint32_t crtc_id = 0;
+    uint32_t src_x = 0;
+    uint32_t src_y = 0;
+    uint32_t src_w = 0;
+    uint32_t src_h = 0;
+    uint32_t crtc_x = 0;
+    uint32_t crtc_y = 0;
+    uint32_t crtc_w = 0;
+    uint32_t crtc_h = 0;
+    // 0 if the plane can't be rotated.
+    uint32_t rotation = 0;
+  };
+
   bool CreateCursorBuffer(const std::string& cursor_name);
 
+  // Prepares the atomic modesetting. Returns false if the driver doesn't
+  // support it.
+  bool ConfigureAtomicModesetting();
+
+  // Looks up the properties of |plane_id|. Returns false if the plane lacks
+  // any of the mandatory ones.
+  bool LookUpPlaneProperties(uint32_t plane_id);
+
+  // Collects the overlay planes of the CRTC which can scan out ARGB8888 and
+  // be rotated.
+  void FindOverlayPlanes(drmModePlaneResPtr resources);
+
+  // Adds the properties which show |layers| as |assignment| says to
+  // |atomic|, with |primary_fb| on the primary plane.
+  bool AddLayerProperties(drmModeAtomicReqPtr atomic,
+                          const std::vector<DrmPlaneLayer>& layers,
+                          const DrmPlaneAssignment& assignment,
+                          uint32_t primary_fb);
+
+  // Adds the properties which show |fb| at the position of |layer| on
+  // |plane_id|. A backing store is rendered bottom-up by GL, so it is scanned
+  // out flipped vertically when |flip_y| is set.
+  bool AddPlaneProperties(drmModeAtomicReqPtr atomic, uint32_t plane_id,
+                          uint32_t fb, const DrmPlaneLayer& layer,
+                          bool flip_y);
+
+  // Returns the framebuffer to scan out |bo|, which is created on first use
+  // and cached as the user data of |bo|. Returns 0 on failure.
+  uint32_t GetFramebuffer(gbm_bo* bo);
+
+  static void OnBufferDestroyed(gbm_bo* bo, void* user_data);
+
+  // Adds the properties which set the display mode to |atomic|.
+  bool AddModesetProperties(drmModeAtomicReqPtr atomic);
+
+  // Shows |fb| with a modeset. This is needed for the first frame.
+  bool CommitModeset(uint32_t fb);
+
+  // Queues a page flip to |fb| at the next vblank without blocking.
+  bool CommitPageFlip(uint32_t fb);
+
+  // Waits until the queued page flip, if any, has completed.
+  void WaitForPageFlip();
+
+  // Makes the pending frame the one being scanned out.
+  void OnPageFlipCompleted();
+
+  static void OnPageFlip(int fd, unsigned int sequence, unsigned int tv_sec,
+                         unsigned int tv_usec, void* user_data);
+
+  // The buffer being scanned out. It is null while the compositor scans out
+  // a backing store on the primary plane.
   gbm_bo* gbm_previous_bo_ = nullptr;
-  uint32_t gbm_previous_fb_;
+
+  // The buffer which will be scanned out when the queued page flip completes.
+  gbm_bo* gbm_pending_bo_ = nullptr;
+
+  // Release the backing stores of the frames being and to be scanned out.
+  ScanoutReleaseCallback front_release_;
+  ScanoutReleaseCallback pending_release_;
+
+  bool page_flip_pending_ = false;
+  bool modeset_done_ = false;
+
+  // When the pending page flip was queued, for the frame timeline.
+  uint64_t page_flip_start_time_nanos_ = 0;
+
   gbm_device* gbm_device_ = nullptr;
   gbm_bo* gbm_cursor_bo_ = nullptr;
+
+  bool atomic_modesetting_ = false;
+  uint32_t drm_plane_id_ = 0;
+  uint32_t drm_plane_fb_id_property_ = 0;
+  uint32_t drm_property_blob_ = 0;
+
+  std::vector<uint32_t> drm_overlay_planes_;
+  std::unordered_map<uint32_t, PlaneProperties> drm_plane_properties_;
+
+  // The overlay planes enabled by the last commit.
+  std::vector<uint32_t> drm_active_overlay_planes_;
 };
 
 }  // namespace flutter
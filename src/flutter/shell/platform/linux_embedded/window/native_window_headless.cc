@@ -0,0 +1,84 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/window/native_window_headless.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "flutter/shell/platform/linux_embedded/logger.h"
+
+namespace flutter {
+
+namespace {
+constexpr size_t kBytesPerPixel = 4;
+}  // namespace
+
+NativeWindowHeadless::NativeWindowHeadless(const size_t width,
+                                           const size_t height)
+    : frame_count_(0) {
+  if (width == 0 || height == 0) {
+    LINUXES_LOG(ERROR) << "The headless window needs its size: " << width
+                       << "x" << height;
+    return;
+  }
+
+  auto dump_directory = std::getenv(kFlutterHeadlessDumpDirEnvironmentKey);
+  if (dump_directory) {
+    dump_directory_ = dump_directory;
+  }
+
+  // The window itself isn't used because frames are rendered to a pbuffer.
+  window_ = 0;
+  frame_buffer_.resize(width * height * kBytesPerPixel);
+  width_ = width;
+  height_ = height;
+  valid_ = true;
+}
+
+bool NativeWindowHeadless::Resize(const size_t width, const size_t height) {
+  LINUXES_LOG(ERROR) << "The size of the headless window cannot be changed.";
+  return false;
+}
+
+void NativeWindowHeadless::OnFrameRendered() {
+  frame_count_++;
+  if (dump_directory_.empty()) {
+    return;
+  }
+
+  char filename[32];
+  std::snprintf(filename, sizeof(filename), "/frame_%06llu.ppm",
+                static_cast<unsigned long long>(frame_count_));
+  DumpFrame(dump_directory_ + filename);
+}
+
+bool NativeWindowHeadless::DumpFrame(const std::string& path) const {
+  auto file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    LINUXES_LOG(ERROR) << "Failed to open " << path;
+    return false;
+  }
+
+  // PPM has no alpha channel, so only RGB is written.
+  std::fprintf(file, "P6\n%d %d\n255\n", width_, height_);
+  std::vector<uint8_t> row(width_ * 3);
+  for (int32_t y = 0; y < height_; y++) {
+    auto pixel = &frame_buffer_[y * width_ * kBytesPerPixel];
+    for (int32_t x = 0; x < width_; x++, pixel += kBytesPerPixel) {
+      row[x * 3 + 0] = pixel[0];
+      row[x * 3 + 1] = pixel[1];
+      row[x * 3 + 2] = pixel[2];
+    }
+    std::fwrite(row.data(), 1, row.size(), file);
+  }
+
+  if (std::fclose(file) != 0) {
+    LINUXES_LOG(ERROR) << "Failed to write " << path;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,52 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_NATIVE_WINDOW_HEADLESS_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_NATIVE_WINDOW_HEADLESS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "flutter/shell/platform/linux_embedded/window/native_window.h"
+
+namespace flutter {
+
+// The environment variable which enables dumping every frame. Its value is
+// the directory where the frames are written as PPM files.
+constexpr char kFlutterHeadlessDumpDirEnvironmentKey[] =
+    "FLUTTER_HEADLESS_DUMP_DIR";
+
+// A window which only exists in memory. Each rendered frame is copied into
+// the frame buffer, and can be dumped to a file.
+class NativeWindowHeadless : public NativeWindow {
+ public:
+  NativeWindowHeadless(const size_t width, const size_t height);
+  ~NativeWindowHeadless() = default;
+
+  // |NativeWindow|
+  bool Resize(const size_t width, const size_t height) override;
+
+  // Returns the latest frame as RGBA8888 pixels, top row first. The stride is
+  // four times the width.
+  uint8_t* FrameBuffer() { return frame_buffer_.data(); }
+
+  // Returns the number of frames rendered so far.
+  uint64_t FrameCount() const { return frame_count_; }
+
+  // Notifies that a new frame has been written to FrameBuffer().
+  void OnFrameRendered();
+
+ private:
+  // Writes the frame buffer to |path| as a binary PPM file.
+  bool DumpFrame(const std::string& path) const;
+
+  std::vector<uint8_t> frame_buffer_;
+  uint64_t frame_count_;
+  std::string dump_directory_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WINDOW_NATIVE_WINDOW_HEADLESS_H_
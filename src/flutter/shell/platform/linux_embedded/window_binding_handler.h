@@ -9,6 +9,8 @@
 #include <variant>
 
 #include "flutter/shell/platform/linux_embedded/public/flutter_linuxes.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_compositor.h"
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_software.h"
 #include "flutter/shell/platform/linux_embedded/window_binding_handler_delegate.h"
 
 #if defined(DISPLAY_BACKEND_TYPE_DRM_GBM)
@@ -21,6 +23,8 @@
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_drm.h"
 #elif defined(DISPLAY_BACKEND_TYPE_X11)
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_x11.h"
+#elif defined(DISPLAY_BACKEND_TYPE_HEADLESS)
+#include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_headless.h"
 #else
 #include "flutter/shell/platform/linux_embedded/surface/linuxes_surface_gl_wayland.h"
 #endif
@@ -42,6 +46,8 @@ using LinuxesRenderSurfaceTarget =
     SurfaceGlDrm<ContextEglDrmEglstream>;
 #elif defined(DISPLAY_BACKEND_TYPE_X11)
     SurfaceGlX11;
+#elif defined(DISPLAY_BACKEND_TYPE_HEADLESS)
+    SurfaceGlHeadless;
 #else
     SurfaceGlWayland;
 #endif
@@ -52,12 +58,30 @@ class WindowBindingHandler {
   virtual ~WindowBindingHandler() = default;
 
   // Dispatches window events such as mouse and keyboard inputs. For Wayland,
-  // you have to call this every time in the main loop.
+  // you have to call this every time in the main loop. This never blocks.
   virtual bool DispatchEvent() = 0;
 
+  // Returns a file descriptor that becomes readable when there are window
+  // events to be dispatched by DispatchEvent(), or -1 if not supported.
+  virtual int GetEventFd() = 0;
+
+  // Prepares to sleep until GetEventFd() becomes readable: sends the requests
+  // made since DispatchEvent(), and returns false if events have already been
+  // read into the queue, in which case they are dispatched without sleeping.
+  // If this returns true, FinishWaitEvent() must be called after the sleep.
+  virtual bool PrepareWaitEvent() { return true; }
+
+  // Reads the events which have arrived during the sleep started by
+  // PrepareWaitEvent(), without blocking.
+  virtual void FinishWaitEvent() {}
+
   // Create a surface.
   virtual bool CreateRenderSurface(int32_t width, int32_t height) = 0;
 
+  // Create a surface which shows the frames of the software renderer instead
+  // of an OpenGL ES surface.
+  virtual bool CreateSoftwareRenderSurface(int32_t width, int32_t height) = 0;
+
   // Destroy a surface which is currently used.
   virtual void DestroyRenderSurface() = 0;
 
@@ -65,6 +89,13 @@ class WindowBindingHandler {
   // window.
   virtual LinuxesRenderSurfaceTarget* GetRenderSurfaceTarget() const = 0;
 
+  // Returns the surface created by CreateSoftwareRenderSurface(), or nullptr.
+  virtual SurfaceSoftware* GetSoftwareRenderSurface() const = 0;
+
+  // Returns the compositor which shows the layers of a frame by itself, or
+  // nullptr if frames are presented through the render surface.
+  virtual LinuxesCompositor* GetCompositor() const = 0;
+
   // Sets the delegate used to communicate state changes from window to view
   // such as key presses, mouse position updates etc.
   virtual void SetView(WindowBindingHandlerDelegate* view) = 0;
@@ -18,6 +18,12 @@ class WindowBindingHandlerDelegate {
   // Typically called by currently configured WindowBindingHandler
   virtual void OnWindowSizeChanged(size_t width, size_t height) const = 0;
 
+  // Notifies delegate that the pointer events which follow, until the end of
+  // the input frame, were generated at |timestamp_micros| (CLOCK_MONOTONIC).
+  // Pointer events without such a timestamp are stamped when they are sent.
+  // Typically called by currently configured WindowBindingHandler
+  virtual void OnInputTimestamp(uint64_t timestamp_micros) = 0;
+
   // Notifies delegate that backing window mouse has moved.
   // Typically called by currently configured WindowBindingHandler
   virtual void OnPointerMove(double x, double y) = 0;
@@ -36,6 +42,11 @@ class WindowBindingHandlerDelegate {
   // Typically called by currently configured WindowBindingHandler
   virtual void OnPointerLeave() = 0;
 
+  // Notifies delegate that a group of mouse pointer events which belong to the
+  // same input frame has ended. Typically called by currently configured
+  // WindowBindingHandler
+  virtual void OnPointerFrame() = 0;
+
   // Notifies delegate that backing window touch pointer has been pressed.
   // Typically called by currently configured WindowBindingHandler
   virtual void OnTouchDown(uint32_t time, int32_t id, double x, double y) = 0;
@@ -52,6 +63,16 @@ class WindowBindingHandlerDelegate {
   // Typically called by currently configured WindowBindingHandler
   virtual void OnTouchCancel() = 0;
 
+  // Notifies delegate that a group of touch events which belong to the same
+  // input frame has ended. Typically called by currently configured
+  // WindowBindingHandler
+  virtual void OnTouchFrame() = 0;
+
+  // Notifies delegate that a touch device which tracks up to |touch_count|
+  // touch points at once has been added. Typically called by currently
+  // configured WindowBindingHandler
+  virtual void OnTouchDeviceAdded(int32_t touch_count) = 0;
+
   // Notifies delegate that backing window key has been cofigured.
   // Typically called by currently configured WindowBindingHandler
   virtual void OnKeyMap(uint32_t format, int fd, uint32_t size) = 0;
@@ -77,6 +98,13 @@ class WindowBindingHandlerDelegate {
   // Typically called by currently configured WindowBindingHandler
   virtual void OnScroll(double x, double y, double delta_x, double delta_y,
                         int scroll_offset_multiplier) = 0;
+
+  // Notifies delegate that the display has refreshed at |vblank_time_nanos|
+  // (CLOCK_MONOTONIC) and refreshes every |vsync_interval_nanos|. This may be
+  // called from any thread. Typically called by currently configured
+  // WindowBindingHandler
+  virtual void OnVblank(uint64_t vblank_time_nanos,
+                        uint64_t vsync_interval_nanos) = 0;
 };
 
 }  // namespace flutter
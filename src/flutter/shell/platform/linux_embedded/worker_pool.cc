@@ -0,0 +1,98 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/linux_embedded/worker_pool.h"
+
+#include <utility>
+
+namespace flutter {
+
+WorkerPool::WorkerPool(size_t thread_count) {
+  for (size_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back(&WorkerPool::Run, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::PostTask(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void WorkerPool::Run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+SerialTaskQueue::SerialTaskQueue(WorkerPool* pool) : pool_(pool) {}
+
+void SerialTaskQueue::PostTask(WorkerPool::Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    if (is_scheduled_) {
+      return;
+    }
+    is_scheduled_ = true;
+  }
+  pool_->PostTask([this]() { RunNextTask(); });
+}
+
+bool SerialTaskQueue::WaitUntilIdle(
+    std::chrono::steady_clock::time_point deadline) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return idle_cv_.wait_until(lock, deadline,
+                             [this]() { return !is_scheduled_; });
+}
+
+void SerialTaskQueue::WaitUntilIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this]() { return !is_scheduled_; });
+}
+
+void SerialTaskQueue::RunNextTask() {
+  WorkerPool::Task task;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+  }
+  task();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) {
+      is_scheduled_ = false;
+      idle_cv_.notify_all();
+      return;
+    }
+  }
+  pool_->PostTask([this]() { RunNextTask(); });
+}
+
+}  // namespace flutter
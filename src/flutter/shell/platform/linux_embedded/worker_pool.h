@@ -0,0 +1,93 @@
+// Copyright 2021 Sony Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WORKER_POOL_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WORKER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flutter {
+
+// A fixed set of threads which run tasks in the order they were posted.
+class WorkerPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkerPool(size_t thread_count);
+
+  // Runs the tasks which are still queued, then joins the threads.
+  ~WorkerPool();
+
+  // Prevent copying.
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+
+  // Posts |task| to be run on one of the threads. This can be called from any
+  // thread.
+  void PostTask(Task task);
+
+ private:
+  // The loop of each thread.
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> tasks_;
+  bool stopped_ = false;
+  std::vector<std::thread> threads_;
+};
+
+// Runs tasks on a WorkerPool one at a time, in the order they were posted.
+// Tasks of different queues run concurrently.
+//
+// A queue runs one task per task posted to the pool, so that a queue with a
+// long backlog doesn't keep a thread from the other queues.
+class SerialTaskQueue {
+ public:
+  // |pool| must outlive this object.
+  explicit SerialTaskQueue(WorkerPool* pool);
+  ~SerialTaskQueue() = default;
+
+  // Prevent copying.
+  SerialTaskQueue(SerialTaskQueue const&) = delete;
+  SerialTaskQueue& operator=(SerialTaskQueue const&) = delete;
+
+  // Posts |task| to be run after the tasks already posted. This can be called
+  // from any thread.
+  void PostTask(WorkerPool::Task task);
+
+  // Blocks until all the posted tasks have run, or until |deadline|. Returns
+  // false if tasks are still queued at |deadline|. Must not be called from a
+  // task of this queue.
+  bool WaitUntilIdle(std::chrono::steady_clock::time_point deadline);
+
+  // Blocks until all the posted tasks have run. Must not be called from a
+  // task of this queue.
+  void WaitUntilIdle();
+
+ private:
+  // Runs the oldest task, and posts itself to the pool again if more tasks
+  // are queued.
+  void RunNextTask();
+
+  WorkerPool* pool_;
+
+  std::mutex mutex_;
+  std::condition_variable idle_cv_;
+  std::deque<WorkerPool::Task> tasks_;
+
+  // Whether RunNextTask() is posted to the pool or running.
+  bool is_scheduled_ = false;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_EMBEDDED_WORKER_POOL_H_